@@ -14,9 +14,9 @@
 #include "pch.h"
 #include "Audio.h"
 #include "SoundCommon.h"
-
-#include <list>
-#include <unordered_map>
+#include "StreamingIOQueue.h"
+#include "VirtualVoiceScheduler.h"
+#include "VoicePool.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -262,7 +262,9 @@ public:
         mReverbEnabled( false ),
         mEngineFlags( AudioEngine_Default ),
         mCategory( AudioCategory_GameEffects ),
-        mVoiceInstances( 0 )
+        mVoiceInstances( 0 ),
+        mSuspended( false ),
+        mClockCount( 0 )
 #if (_WIN32_WINNT < _WIN32_WINNT_WIN8)
         ,mDLL(nullptr)
 #endif
@@ -304,6 +306,12 @@ public:
     void RegisterNotify( _In_ IVoiceNotify* notify, bool usesUpdate );
     void UnregisterNotify( _In_ IVoiceNotify* notify, bool oneshots, bool usesUpdate );
 
+    StreamingIOQueue* GetStreamingQueue();
+    VirtualVoiceScheduler* GetVoiceScheduler() const { return mVoiceScheduler.get(); }
+
+    void Suspend();
+    void Resume();
+
     ComPtr<IXAudio2>                    xaudio2;
     IXAudio2MasteringVoice*             mMasterVoice;
     IXAudio2SubmixVoice*                mReverbVoice;
@@ -325,18 +333,22 @@ public:
     AUDIO_ENGINE_FLAGS                  mEngineFlags;
 
 private:
+    void AdvancePlayClock();
+
     typedef std::set<IVoiceNotify*> notifylist_t;
-    typedef std::list<std::pair<unsigned int, IXAudio2SourceVoice*>> oneshotlist_t;
-    typedef std::unordered_multimap<unsigned int, IXAudio2SourceVoice*> voicepool_t;
+    typedef VoicePool<IXAudio2SourceVoice> voicepool_t;
 
     AUDIO_STREAM_CATEGORY               mCategory;
     ComPtr<IUnknown>                    mReverbEffect;
     ComPtr<IUnknown>                    mVolumeLimiter;
-    oneshotlist_t                       mOneShots;
-    voicepool_t                         mVoicePool;
+    voicepool_t                         mOneShots;
     notifylist_t                        mNotifyObjects;
     notifylist_t                        mNotifyUpdates;
     size_t                              mVoiceInstances;
+    std::unique_ptr<StreamingIOQueue>   mStreamingQueue;
+    std::unique_ptr<VirtualVoiceScheduler> mVoiceScheduler;
+    bool                                mSuspended;
+    int64_t                             mClockCount;
     VoiceCallback                       mVoiceCallback;
     EngineCallback                      mEngineCallback;
 
@@ -352,6 +364,11 @@ HRESULT AudioEngine::Impl::Initialize( AUDIO_ENGINE_FLAGS flags, const WAVEFORMA
     mEngineFlags = flags;
     mCategory = category;
 
+    if ( flags & AudioEngine_VirtualVoices )
+    {
+        mVoiceScheduler.reset( new VirtualVoiceScheduler );
+    }
+
     return Reset( wfx, deviceId );
 }
 
@@ -720,19 +737,7 @@ void AudioEngine::Impl::SetSilentMode()
         (*it)->OnCriticalError();
     }
 
-    for( auto it = mOneShots.begin(); it != mOneShots.end(); ++it )
-    {
-        assert( it->second != 0 );
-        it->second->DestroyVoice();
-    }
-    mOneShots.clear();
-
-    for( auto it = mVoicePool.begin(); it != mVoicePool.end(); ++it )
-    {
-        assert( it->second != 0 );
-        it->second->DestroyVoice();
-    }
-    mVoicePool.clear();
+    mOneShots.DestroyAll();
 
     mVoiceInstances = 0;
 
@@ -759,19 +764,7 @@ void AudioEngine::Impl::Shutdown()
 
         xaudio2->StopEngine();
 
-        for( auto it = mOneShots.begin(); it != mOneShots.end(); ++it )
-        {
-            assert( it->second != 0 );
-            it->second->DestroyVoice();
-        }
-        mOneShots.clear();
-
-        for( auto it = mVoicePool.begin(); it != mVoicePool.end(); ++it )
-        {
-            assert( it->second != 0 );
-            it->second->DestroyVoice();
-        }
-        mVoicePool.clear();
+        mOneShots.DestroyAll();
 
         mVoiceInstances = 0;
 
@@ -812,41 +805,36 @@ bool AudioEngine::Impl::Update()
     
     case WAIT_OBJECT_0 + 1: // OnBufferEnd
         // Scan for completed one-shot voices
-        for( auto it = mOneShots.begin(); it != mOneShots.end(); )
+        for( auto node = mOneShots.GetFirstActive(); node; )
         {
-            assert( it->second != 0 );
+            assert( node->voice != 0 );
 
             XAUDIO2_VOICE_STATE xstate;
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-            it->second->GetState( &xstate, XAUDIO2_VOICE_NOSAMPLESPLAYED );
+            node->voice->GetState( &xstate, XAUDIO2_VOICE_NOSAMPLESPLAYED );
 #else
-            it->second->GetState( &xstate );
+            node->voice->GetState( &xstate );
 #endif
 
             if ( !xstate.BuffersQueued )
             {
-                (void)it->second->Stop( 0 );
-                if ( it->first )
-                {
-                    // Put voice back into voice pool for reuse since it has a non-zero voiceKey
+                (void)node->voice->Stop( 0 );
+
+                // Voice goes back into the voice pool for reuse if it has a non-zero voiceKey, and is destroyed otherwise
 #ifdef VERBOSE_TRACE
-                    DebugTrace( "INFO: One-shot voice being saved for reuse (%08X)\n", it->first );
-#endif
-                    voicepool_t::value_type v( it->first, it->second );
-                    mVoicePool.emplace( v );
+                if ( node->key )
+                {
+                    DebugTrace( "INFO: One-shot voice being saved for reuse (%08X, high-water %Iu)\n", node->key, mOneShots.GetHighWater( node->key ) );
                 }
                 else
                 {
-                    // Voice is to be destroyed rather than reused
-#ifdef VERBOSE_TRACE
                     DebugTrace( "INFO: Destroying one-shot voice\n" );
-#endif
-                    it->second->DestroyVoice();
                 }
-                it = mOneShots.erase( it );
+#endif
+                node = mOneShots.Release( node );
             }
             else
-                ++it;
+                node = node->next;
         }
         break;
 
@@ -855,18 +843,83 @@ bool AudioEngine::Impl::Update()
     }
 
     //
-    // Inform any notify objects of updates
+    // Inform any notify objects of updates, with streaming reads completed beforehand and issued afterwards
     //
+    if ( mStreamingQueue )
+    {
+        mStreamingQueue->ProcessCompletions();
+    }
+
+    AdvancePlayClock();
+
     for( auto it = mNotifyUpdates.begin(); it != mNotifyUpdates.end(); ++it )
     {
         assert( *it != 0 );
         (*it)->OnUpdate();
     }
 
+    if ( mVoiceScheduler )
+    {
+        // Playing instances added themselves during OnUpdate, and get whatever voices the other instances leave free
+        size_t limit = ( maxVoiceInstances > 0 ) ? ( maxVoiceInstances - 1 ) : 0;
+        size_t others = mVoiceInstances - mVoiceScheduler->GetRealCount();
+        mVoiceScheduler->Schedule( ( limit > others ) ? ( limit - others ) : 0 );
+    }
+
+    if ( mStreamingQueue )
+    {
+        mStreamingQueue->IssueReads();
+    }
+
     return true;
 }
 
 
+void AudioEngine::Impl::Suspend()
+{
+    if ( !xaudio2 )
+        return;
+
+    // Time up to now counts, but none while stopped
+    AdvancePlayClock();
+    mSuspended = true;
+
+    xaudio2->StopEngine();
+}
+
+
+void AudioEngine::Impl::Resume()
+{
+    if ( !xaudio2 )
+        return;
+
+    HRESULT hr = xaudio2->StartEngine();
+    ThrowIfFailed( hr );
+
+    AdvancePlayClock();
+    mSuspended = false;
+}
+
+
+// Moves the virtual voice play clock on by the time since it was last moved, unless the engine was suspended.
+void AudioEngine::Impl::AdvancePlayClock()
+{
+    if ( !mVoiceScheduler )
+        return;
+
+    LARGE_INTEGER now, frequency;
+    (void)QueryPerformanceCounter( &now );
+    (void)QueryPerformanceFrequency( &frequency );
+
+    if ( !mSuspended && mClockCount > 0 && now.QuadPart > mClockCount )
+    {
+        mVoiceScheduler->AdvanceClock( double( now.QuadPart - mClockCount ) / double( frequency.QuadPart ) );
+    }
+
+    mClockCount = now.QuadPart;
+}
+
+
 _Use_decl_annotations_
 void AudioEngine::Impl::SetReverb( const XAUDIO2FX_REVERB_PARAMETERS* native )
 {
@@ -915,8 +968,8 @@ AudioStatistics AudioEngine::Impl::GetStatistics() const
 {
     AudioStatistics stats = {};
 
-    stats.allocatedVoices = stats.allocatedVoicesOneShot = mOneShots.size() + mVoicePool.size();
-    stats.allocatedVoicesIdle = mVoicePool.size();
+    stats.allocatedVoices = stats.allocatedVoicesOneShot = mOneShots.GetActiveCount() + mOneShots.GetIdleCount();
+    stats.allocatedVoicesIdle = mOneShots.GetIdleCount();
 
     for( auto it = mNotifyObjects.begin(); it != mNotifyObjects.end(); ++it )
     {
@@ -924,7 +977,18 @@ AudioStatistics AudioEngine::Impl::GetStatistics() const
         (*it)->GatherStatistics( stats );
     }
 
-    assert( stats.allocatedVoices == ( mOneShots.size() + mVoicePool.size() + mVoiceInstances ) );
+    assert( stats.allocatedVoices == ( mOneShots.GetActiveCount() + mOneShots.GetIdleCount() + mVoiceInstances ) );
+
+    if ( mStreamingQueue )
+    {
+        stats.streamingQueueDepth = mStreamingQueue->GetQueueDepth();
+        stats.streamingDeadlineMisses = mStreamingQueue->GetDeadlineMisses();
+    }
+
+    if ( mVoiceScheduler )
+    {
+        stats.virtualInstances = mVoiceScheduler->GetVirtualCount();
+    }
 
     return stats;
 }
@@ -938,12 +1002,7 @@ void AudioEngine::Impl::TrimVoicePool()
         (*it)->OnTrim();
     }
 
-    for( auto it = mVoicePool.begin(); it != mVoicePool.end(); ++it )
-    {
-        assert( it->second != 0 );
-        it->second->DestroyVoice();
-    }
-    mVoicePool.clear();
+    mOneShots.DestroyIdle();
 }
 
 
@@ -969,6 +1028,7 @@ void AudioEngine::Impl::AllocateVoice( const WAVEFORMATEX* wfx, SOUND_EFFECT_INS
 #endif
 
     unsigned int voiceKey = 0;
+    bool reused = false;
     if ( oneshot )
     {
         if ( flags & ( SoundEffectInstance_Use3D | SoundEffectInstance_ReverbUseFilters | SoundEffectInstance_NoSetPitch ) )
@@ -997,13 +1057,11 @@ void AudioEngine::Impl::AllocateVoice( const WAVEFORMATEX* wfx, SOUND_EFFECT_INS
             voiceKey = makeVoiceKey( wfx );
             if ( voiceKey != 0 )
             {
-                auto it = mVoicePool.find( voiceKey );
-                if ( it != mVoicePool.end() )
+                *voice = mOneShots.Acquire( voiceKey );
+                if ( *voice )
                 {
                     // Found a matching (stopped) voice to reuse
-                    assert( it->second != 0 );
-                    *voice = it->second;
-                    mVoicePool.erase( it );
+                    reused = true;
 
                     // Reset any volume/pitch-shifting
                     HRESULT hr = (*voice)->SetVolume(1.f);
@@ -1022,10 +1080,10 @@ void AudioEngine::Impl::AllocateVoice( const WAVEFORMATEX* wfx, SOUND_EFFECT_INS
                         ThrowIfFailed( hr );
                     }
                 }
-                else if ( ( mVoicePool.size() + mOneShots.size() + 1 ) >= maxVoiceOneshots )
+                else if ( ( mOneShots.GetIdleCount() + mOneShots.GetActiveCount() + 1 ) >= maxVoiceOneshots )
                 {
                     DebugTrace( "WARNING: Too many one-shot voices in use (%Iu + %Iu >= %Iu); one-shot not played\n",
-                                mVoicePool.size(), mOneShots.size() + 1, maxVoiceOneshots );
+                                mOneShots.GetIdleCount(), mOneShots.GetActiveCount() + 1, maxVoiceOneshots );
                     return;
                 }
                 else
@@ -1090,15 +1148,24 @@ void AudioEngine::Impl::AllocateVoice( const WAVEFORMATEX* wfx, SOUND_EFFECT_INS
     {
         if ( oneshot )
         {
-            if ( ( mVoicePool.size() + mOneShots.size() + 1 ) >= maxVoiceOneshots )
+            if ( ( mOneShots.GetIdleCount() + mOneShots.GetActiveCount() + 1 ) >= maxVoiceOneshots )
             {
                 DebugTrace( "WARNING: Too many one-shot voices in use (%Iu + %Iu >= %Iu); one-shot not played; see TrimVoicePool\n",
-                            mVoicePool.size(), mOneShots.size() + 1, maxVoiceOneshots );
+                            mOneShots.GetIdleCount(), mOneShots.GetActiveCount() + 1, maxVoiceOneshots );
                 return;
             }
         }
         else if ( ( mVoiceInstances + 1 ) >= maxVoiceInstances )
         {
+            if ( mVoiceScheduler )
+            {
+                // The instance plays virtually until the scheduler finds it a voice
+#ifdef VERBOSE_TRACE
+                DebugTrace( "INFO: Too many instance voices (%Iu >= %Iu); instance is virtual\n", mVoiceInstances + 1, maxVoiceInstances );
+#endif
+                return;
+            }
+
             DebugTrace( "ERROR: Too many instance voices (%Iu >= %Iu); see TrimVoicePool\n", mVoiceInstances + 1, maxVoiceInstances );
             throw std::exception( "Too many instance voices" );
         }
@@ -1142,10 +1209,10 @@ void AudioEngine::Impl::AllocateVoice( const WAVEFORMATEX* wfx, SOUND_EFFECT_INS
         }
     }
 
-    if ( oneshot )
+    if ( oneshot && !reused )
     {
         assert( *voice != 0 );
-        mOneShots.emplace_back( std::make_pair( voiceKey, *voice ) );
+        mOneShots.Add( voiceKey, *voice );
     }
 }
 
@@ -1156,22 +1223,16 @@ void AudioEngine::Impl::DestroyVoice( _In_ IXAudio2SourceVoice* voice )
         return;
 
 #ifndef NDEBUG
-    for( auto it = mOneShots.cbegin(); it != mOneShots.cend(); ++it )
+    if ( mOneShots.IsActive( voice ) )
     {
-        if ( it->second == voice )
-        {
-            DebugTrace( "ERROR: DestroyVoice should not be called for a one-shot voice\n" );
-            throw std::exception( "DestroyVoice" );
-        }
+        DebugTrace( "ERROR: DestroyVoice should not be called for a one-shot voice\n" );
+        throw std::exception( "DestroyVoice" );
     }
 
-    for( auto it = mVoicePool.cbegin(); it != mVoicePool.cend(); ++it )
+    if ( mOneShots.IsIdle( voice ) )
     {
-        if ( it->second == voice )
-        {
-            DebugTrace( "ERROR: DestroyVoice should not be called for a one-shot voice; see TrimVoicePool\n" );
-            throw std::exception( "DestroyVoice" );
-        }
+        DebugTrace( "ERROR: DestroyVoice should not be called for a one-shot voice; see TrimVoicePool\n" );
+        throw std::exception( "DestroyVoice" );
     }
 #endif
 
@@ -1203,21 +1264,21 @@ void AudioEngine::Impl::UnregisterNotify( _In_ IVoiceNotify* notify, bool usesOn
     {
         bool setevent = false;
 
-        for( auto it = mOneShots.begin(); it != mOneShots.end(); ++it )
+        for( auto node = mOneShots.GetFirstActive(); node; node = node->next )
         {
-            assert( it->second != 0 );
+            assert( node->voice != 0 );
 
             XAUDIO2_VOICE_STATE state;
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-            it->second->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED );
+            node->voice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED );
 #else
-            it->second->GetState(&state);
+            node->voice->GetState(&state);
 #endif
 
             if ( state.pCurrentBufferContext == notify )
             {
-                (void)it->second->Stop( 0 );
-                (void)it->second->FlushSourceBuffers();
+                (void)node->voice->Stop( 0 );
+                (void)node->voice->FlushSourceBuffers();
                 setevent = true;
             }
         }
@@ -1236,6 +1297,18 @@ void AudioEngine::Impl::UnregisterNotify( _In_ IVoiceNotify* notify, bool usesOn
 }
 
 
+// Shared by every streaming voice, and created when the first one needs it.
+StreamingIOQueue* AudioEngine::Impl::GetStreamingQueue()
+{
+    if ( !mStreamingQueue )
+    {
+        mStreamingQueue.reset( new StreamingIOQueue );
+    }
+
+    return mStreamingQueue.get();
+}
+
+
 //--------------------------------------------------------------------------------------
 // AudioEngine
 //--------------------------------------------------------------------------------------
@@ -1341,20 +1414,13 @@ bool AudioEngine::Reset( const WAVEFORMATEX* wfx, const wchar_t* deviceId )
 
 void AudioEngine::Suspend()
 {
-    if ( !pImpl->xaudio2 )
-        return;
-
-    pImpl->xaudio2->StopEngine();
+    pImpl->Suspend();
 }
  
 
 void AudioEngine::Resume()
 {
-    if ( !pImpl->xaudio2 )
-        return;
-
-    HRESULT hr = pImpl->xaudio2->StartEngine();
-    ThrowIfFailed( hr );
+    pImpl->Resume();
 }
 
 
@@ -1478,8 +1544,14 @@ void AudioEngine::SetDefaultSampleRate( int sampleRate )
 void AudioEngine::SetMaxVoicePool( size_t maxOneShots, size_t maxInstances )
 {
     if ( maxOneShots > 0 )
+    {
         pImpl->maxVoiceOneshots = maxOneShots;
 
+        // Set up the pool's storage now rather than as one-shots start playing
+        if ( maxOneShots != SIZE_MAX )
+            pImpl->mOneShots.Reserve( maxOneShots );
+    }
+
     if ( maxInstances > 0 )
         pImpl->maxVoiceInstances = maxInstances;
 }
@@ -1516,6 +1588,18 @@ void AudioEngine::UnregisterNotify( _In_ IVoiceNotify* notify, bool oneshots, bo
 }
 
 
+StreamingIOQueue* AudioEngine::GetStreamingQueue()
+{
+    return pImpl->GetStreamingQueue();
+}
+
+
+VirtualVoiceScheduler* AudioEngine::GetVoiceScheduler()
+{
+    return pImpl->GetVoiceScheduler();
+}
+
+
 IXAudio2* AudioEngine::GetInterface() const
 {
     return pImpl->xaudio2.Get();
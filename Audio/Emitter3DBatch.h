@@ -0,0 +1,296 @@
+//--------------------------------------------------------------------------------------
+// File: Emitter3DBatch.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+namespace DirectX
+{
+    // Output speakers for CalculateEmitter3DBatch, in channel mask bit order as for a voice output matrix
+    struct Emitter3DSpeakers
+    {
+        static const uint32_t MAX_CHANNELS = 8;
+
+        uint32_t    channels;
+        uint32_t    panned;                                 // Number of speakers sounds are panned between
+        int         lfeChannel;                             // -1 if there is no LFE speaker
+        bool        isPanned[ MAX_CHANNELS ];               // False for the LFE and any top speakers
+        float       azimuths[ MAX_CHANNELS ];               // Clockwise from the front, in radians
+        float       invGapClockwise[ MAX_CHANNELS ];        // Reciprocal of the angle to the next panned speaker each way
+        float       invGapCounterClockwise[ MAX_CHANNELS ];
+    };
+
+
+    // Positional audio for one omnidirectional emitter, as computed by CalculateEmitter3DBatch
+    struct Emitter3DResult
+    {
+        float   matrix[ Emitter3DSpeakers::MAX_CHANNELS ];  // Level of each source channel in each output channel, LFE included
+        float   doppler;                                    // Frequency ratio
+        float   reverbLevel;                                // Default linear reverb curve
+        float   lpfDirect;                                  // Default direct-path low-pass filter curve
+    };
+
+
+    // Sets up the speaker layout for a channel mask, with the speaker azimuths X3DAudioInitialize uses.
+    inline void InitializeEmitter3DSpeakers( uint32_t channelMask, uint32_t channels, Emitter3DSpeakers& speakers )
+    {
+        // SPEAKER_FRONT_LEFT through SPEAKER_SIDE_RIGHT; the LFE (bit 3) has no azimuth
+        static const float c_Azimuths[] =
+        {
+            XM_2PI - XM_PIDIV4, XM_PIDIV4, 0.f, -1.f,
+            XM_PI + XM_PIDIV4, XM_PI - XM_PIDIV4,
+            XM_2PI - XM_PI / 8.f, XM_PI / 8.f, XM_PI,
+            XM_PI + XM_PIDIV2, XM_PIDIV2
+        };
+        static const uint32_t c_LFE = 3;
+
+        assert( channels <= Emitter3DSpeakers::MAX_CHANNELS );
+
+        memset( &speakers, 0, sizeof(speakers) );
+        speakers.channels = channels;
+        speakers.lfeChannel = -1;
+
+        // A mono device with no mask is a single front center speaker
+        if ( !channelMask && channels == 1 )
+            channelMask = 1u << 2;
+
+        uint32_t order[ Emitter3DSpeakers::MAX_CHANNELS ];
+        uint32_t channel = 0;
+        for( uint32_t bit = 0; bit < 32 && channel < channels; ++bit )
+        {
+            if ( !( channelMask & ( 1u << bit ) ) )
+                continue;
+
+            if ( bit == c_LFE )
+            {
+                speakers.lfeChannel = static_cast<int>( channel );
+            }
+            else if ( bit < _countof( c_Azimuths ) )
+            {
+                speakers.isPanned[ channel ] = true;
+                speakers.azimuths[ channel ] = c_Azimuths[ bit ];
+
+                // Insertion sort by azimuth
+                uint32_t j = speakers.panned++;
+                for( ; j > 0 && speakers.azimuths[ order[ j - 1 ] ] > c_Azimuths[ bit ]; --j )
+                {
+                    order[ j ] = order[ j - 1 ];
+                }
+                order[ j ] = channel;
+            }
+
+            ++channel;
+        }
+
+        for( uint32_t j = 0; j < speakers.panned; ++j )
+        {
+            uint32_t c = order[ j ];
+
+            if ( speakers.panned == 1 )
+            {
+                // Everything goes to the one speaker
+                speakers.invGapClockwise[ c ] = speakers.invGapCounterClockwise[ c ] = 0.f;
+                continue;
+            }
+
+            float next = speakers.azimuths[ order[ ( j + 1 ) % speakers.panned ] ];
+            float prev = speakers.azimuths[ order[ ( j + speakers.panned - 1 ) % speakers.panned ] ];
+            float az = speakers.azimuths[ c ];
+
+            speakers.invGapClockwise[ c ] = 1.f / ( ( next > az ) ? ( next - az ) : ( next + XM_2PI - az ) );
+            speakers.invGapCounterClockwise[ c ] = 1.f / ( ( prev < az ) ? ( az - prev ) : ( az + XM_2PI - prev ) );
+        }
+    }
+
+
+    namespace Internal
+    {
+        // Loads up to four floats, filling unused lanes
+        inline XMVECTOR XM_CALLCONV LoadEmitterLanes( _In_reads_opt_(lanes) const float* data, size_t lanes, float fill )
+        {
+            if ( !data )
+                return XMVectorReplicate( fill );
+
+            if ( lanes == 4 )
+                return XMLoadFloat4( reinterpret_cast<const XMFLOAT4*>( data ) );
+
+            XMVECTORF32 v = { fill, fill, fill, fill };
+            for( size_t j = 0; j < lanes; ++j )
+            {
+                v.f[ j ] = data[ j ];
+            }
+            return v;
+        }
+    }
+
+
+    // Computes positional audio for many omnidirectional emitters against one listener, four at a time, giving the
+    // same matrix, doppler, reverb and direct-path filter values as X3DAudioCalculate for a single-channel emitter with
+    // no cone, a zero inner radius and the default curves. The emitter data is in structure-of-arrays form. Velocities
+    // (all three or none), curve distance scalers and doppler scalers are optional, and default to 0, 1 and 1
+    // respectively. Only needs DirectXMath.
+    inline void CalculateEmitter3DBatch( const Emitter3DSpeakers& speakers,
+                                         const XMFLOAT3& listenerPosition, const XMFLOAT3& listenerVelocity,
+                                         const XMFLOAT3& listenerFront, const XMFLOAT3& listenerTop,
+                                         size_t count,
+                                         _In_reads_(count) const float* positionsX, _In_reads_(count) const float* positionsY, _In_reads_(count) const float* positionsZ,
+                                         _In_reads_opt_(count) const float* velocitiesX, _In_reads_opt_(count) const float* velocitiesY, _In_reads_opt_(count) const float* velocitiesZ,
+                                         _In_reads_opt_(count) const float* curveDistanceScalers, _In_reads_opt_(count) const float* dopplerScalers,
+                                         float speedOfSound, bool rhcoords, _Out_writes_(count) Emitter3DResult* results )
+    {
+        assert( positionsX != 0 && positionsY != 0 && positionsZ != 0 && results != 0 );
+        assert( ( velocitiesX != 0 ) == ( velocitiesY != 0 ) && ( velocitiesX != 0 ) == ( velocitiesZ != 0 ) );
+        assert( speedOfSound > 0.f );
+
+        // X3DAudio works in left-handed coordinates
+        const XMVECTOR flip = rhcoords ? XMVectorSet( 1.f, 1.f, -1.f, 0.f ) : XMVectorSet( 1.f, 1.f, 1.f, 0.f );
+
+        XMVECTOR lpos = XMVectorMultiply( XMLoadFloat3( &listenerPosition ), flip );
+        XMVECTOR lvel = XMVectorMultiply( XMLoadFloat3( &listenerVelocity ), flip );
+        XMVECTOR front = XMVector3Normalize( XMVectorMultiply( XMLoadFloat3( &listenerFront ), flip ) );
+        XMVECTOR top = XMVector3Normalize( XMVectorMultiply( XMLoadFloat3( &listenerTop ), flip ) );
+        XMVECTOR right = XMVector3Cross( top, front );
+
+        // Listener values splatted across the lanes, which each hold one emitter
+        const XMVECTOR lx = XMVectorSplatX( lpos ), ly = XMVectorSplatY( lpos ), lz = XMVectorSplatZ( lpos );
+        const XMVECTOR lvx = XMVectorSplatX( lvel ), lvy = XMVectorSplatY( lvel ), lvz = XMVectorSplatZ( lvel );
+        const XMVECTOR fx = XMVectorSplatX( front ), fy = XMVectorSplatY( front ), fz = XMVectorSplatZ( front );
+        const XMVECTOR rx = XMVectorSplatX( right ), ry = XMVectorSplatY( right ), rz = XMVectorSplatZ( right );
+
+        const XMVECTOR one = g_XMOne;
+        const XMVECTOR zero = XMVectorZero();
+        const XMVECTOR twoPi = XMVectorReplicate( XM_2PI );
+        const XMVECTOR minDistance = XMVectorReplicate( 1e-6f );
+        const XMVECTOR speed = XMVectorReplicate( speedOfSound );
+        const XMVECTOR minDoppler = XMVectorReplicate( 0.5f );
+        const XMVECTOR maxDoppler = XMVectorReplicate( 4.f );
+        const XMVECTOR lpfRange = XMVectorReplicate( 0.25f );
+        const XMVECTOR overhead = XMVectorReplicate( ( speakers.panned > 0 ) ? ( 1.f / float( speakers.panned ) ) : 0.f );
+
+        for( size_t base = 0; base < count; base += 4 )
+        {
+            size_t lanes = ( count - base < 4 ) ? ( count - base ) : 4;
+
+            XMVECTOR px = Internal::LoadEmitterLanes( positionsX + base, lanes, 0.f );
+            XMVECTOR py = Internal::LoadEmitterLanes( positionsY + base, lanes, 0.f );
+            XMVECTOR pz = Internal::LoadEmitterLanes( positionsZ + base, lanes, 0.f );
+            XMVECTOR vx = Internal::LoadEmitterLanes( velocitiesX ? ( velocitiesX + base ) : nullptr, lanes, 0.f );
+            XMVECTOR vy = Internal::LoadEmitterLanes( velocitiesY ? ( velocitiesY + base ) : nullptr, lanes, 0.f );
+            XMVECTOR vz = Internal::LoadEmitterLanes( velocitiesZ ? ( velocitiesZ + base ) : nullptr, lanes, 0.f );
+            XMVECTOR scaler = Internal::LoadEmitterLanes( curveDistanceScalers ? ( curveDistanceScalers + base ) : nullptr, lanes, 1.f );
+            XMVECTOR dopplerScale = Internal::LoadEmitterLanes( dopplerScalers ? ( dopplerScalers + base ) : nullptr, lanes, 1.f );
+
+            if ( rhcoords )
+            {
+                pz = XMVectorNegate( pz );
+                vz = XMVectorNegate( vz );
+            }
+
+            // Listener to emitter
+            XMVECTOR dx = XMVectorSubtract( px, lx );
+            XMVECTOR dy = XMVectorSubtract( py, ly );
+            XMVECTOR dz = XMVectorSubtract( pz, lz );
+
+            XMVECTOR dist = XMVectorSqrt( XMVectorMultiplyAdd( dx, dx, XMVectorMultiplyAdd( dy, dy, XMVectorMultiply( dz, dz ) ) ) );
+            XMVECTOR invDist = XMVectorReciprocal( XMVectorMax( dist, minDistance ) );
+
+            // Inverse distance attenuation beyond the curve distance scaler
+            XMVECTOR normDist = XMVectorDivide( dist, scaler );
+            XMVECTOR attenuation = XMVectorMin( one, XMVectorReciprocal( XMVectorMax( normDist, minDistance ) ) );
+
+            // Azimuth in the listener's horizontal plane, clockwise from the front, so elevation only matters once the
+            // emitter is directly above or below, where it is spread evenly over every speaker
+            XMVECTOR ahead = XMVectorMultiplyAdd( dx, fx, XMVectorMultiplyAdd( dy, fy, XMVectorMultiply( dz, fz ) ) );
+            XMVECTOR side = XMVectorMultiplyAdd( dx, rx, XMVectorMultiplyAdd( dy, ry, XMVectorMultiply( dz, rz ) ) );
+            XMVECTOR planar = XMVectorSqrt( XMVectorMultiplyAdd( ahead, ahead, XMVectorMultiply( side, side ) ) );
+            XMVECTOR above = XMVectorLess( planar, minDistance );
+
+            XMVECTOR azimuth = XMVectorATan2( side, ahead );
+            azimuth = XMVectorSelect( azimuth, XMVectorAdd( azimuth, twoPi ), XMVectorLess( azimuth, zero ) );
+
+            XMVECTORF32 matrix[ Emitter3DSpeakers::MAX_CHANNELS ];
+
+            for( uint32_t c = 0; c < speakers.channels; ++c )
+            {
+                if ( !speakers.isPanned[ c ] )
+                {
+                    matrix[ c ].v = zero;
+                    continue;
+                }
+
+                // Linear panning between each pair of neighbouring speakers
+                XMVECTOR cw = XMVectorSubtract( azimuth, XMVectorReplicate( speakers.azimuths[ c ] ) );
+                cw = XMVectorSelect( cw, XMVectorAdd( cw, twoPi ), XMVectorLess( cw, zero ) );
+                XMVECTOR ccw = XMVectorSubtract( twoPi, cw );
+
+                XMVECTOR gain = XMVectorMax( XMVectorNegativeMultiplySubtract( cw, XMVectorReplicate( speakers.invGapClockwise[ c ] ), one ),
+                                             XMVectorNegativeMultiplySubtract( ccw, XMVectorReplicate( speakers.invGapCounterClockwise[ c ] ), one ) );
+                gain = XMVectorSelect( XMVectorMax( gain, zero ), overhead, above );
+
+                matrix[ c ].v = XMVectorMultiply( gain, attenuation );
+            }
+
+            XMVECTOR nearness = XMVectorSaturate( normDist );
+
+            if ( speakers.lfeChannel >= 0 )
+            {
+                // Default LFE curve
+                matrix[ speakers.lfeChannel ].v = XMVectorSubtract( one, nearness );
+            }
+
+            // Doppler from the velocity components along the emitter to listener direction, limited to two octaves up
+            // and one down
+            XMVECTOR ux = XMVectorNegate( XMVectorMultiply( dx, invDist ) );
+            XMVECTOR uy = XMVectorNegate( XMVectorMultiply( dy, invDist ) );
+            XMVECTOR uz = XMVectorNegate( XMVectorMultiply( dz, invDist ) );
+
+            XMVECTOR scaledSpeed = XMVectorDivide( speed, XMVectorMax( dopplerScale, minDistance ) );
+            XMVECTOR vl = XMVectorMultiplyAdd( lvx, ux, XMVectorMultiplyAdd( lvy, uy, XMVectorMultiply( lvz, uz ) ) );
+            XMVECTOR ve = XMVectorMultiplyAdd( vx, ux, XMVectorMultiplyAdd( vy, uy, XMVectorMultiply( vz, uz ) ) );
+            vl = XMVectorMultiply( XMVectorMin( vl, scaledSpeed ), dopplerScale );
+            ve = XMVectorMultiply( XMVectorMin( ve, scaledSpeed ), dopplerScale );
+
+            XMVECTOR dopplerFactor = XMVectorDivide( XMVectorSubtract( speed, vl ), XMVectorSubtract( speed, ve ) );
+            dopplerFactor = XMVectorSelect( dopplerFactor, one, XMVectorIsNaN( dopplerFactor ) );
+            dopplerFactor = XMVectorClamp( dopplerFactor, minDoppler, maxDoppler );
+
+            // No shift for an emitter at the listener, or with a zero doppler scaler
+            XMVECTOR noDoppler = XMVectorOrInt( XMVectorLess( dist, minDistance ), XMVectorLessOrEqual( dopplerScale, zero ) );
+            dopplerFactor = XMVectorSelect( dopplerFactor, one, noDoppler );
+
+            XMVECTORF32 out[3];
+            out[0].v = dopplerFactor;
+            out[1].v = XMVectorSubtract( one, nearness );
+            out[2].v = XMVectorNegativeMultiplySubtract( nearness, lpfRange, one );
+
+            for( size_t j = 0; j < lanes; ++j )
+            {
+                Emitter3DResult& result = results[ base + j ];
+                for( uint32_t c = 0; c < speakers.channels; ++c )
+                {
+                    result.matrix[ c ] = matrix[ c ].f[ j ];
+                }
+                result.doppler = out[0].f[ j ];
+                result.reverbLevel = out[1].f[ j ];
+                result.lpfDirect = out[2].f[ j ];
+            }
+        }
+    }
+}
@@ -702,7 +702,8 @@ void SoundEffectInstanceBase::SetPan( float pan )
 
 void SoundEffectInstanceBase::Apply3D( const AudioListener& listener, const AudioEmitter& emitter, bool rhcoords )
 {
-    if ( !voice )
+    // Virtual instances have no voice while playing, but still need their audibility kept up to date
+    if ( !voice && ( state == STOPPED ) )
         return;
 
     if ( !( mFlags & SoundEffectInstance_Use3D ) )
@@ -719,16 +720,22 @@ void SoundEffectInstanceBase::Apply3D( const AudioListener& listener, const Audi
         dwCalcFlags |= X3DAUDIO_CALCULATE_REDIRECT_TO_LFE;
     }
 
-    auto reverb = mReverbVoice;
-    if ( reverb )
+    if ( mReverbVoice )
     {
         dwCalcFlags |= X3DAUDIO_CALCULATE_LPF_REVERB | X3DAUDIO_CALCULATE_REVERB;
     }
 
-    float matrix[XAUDIO2_MAX_AUDIO_CHANNELS * 8] = {};
     assert( mDSPSettings.SrcChannelCount <= XAUDIO2_MAX_AUDIO_CHANNELS );
     assert( mDSPSettings.DstChannelCount <= 8 );
-    mDSPSettings.pMatrixCoefficients = matrix;
+
+    // Kept so the result can be applied again to a voice acquired later
+    if ( !mMatrix )
+    {
+        mMatrix.reset( new float[ mDSPSettings.SrcChannelCount * 8 ] );
+    }
+
+    memset( mMatrix.get(), 0, sizeof(float) * mDSPSettings.SrcChannelCount * 8 );
+    mDSPSettings.pMatrixCoefficients = mMatrix.get();
 
     assert( engine != 0 );
     if (rhcoords)
@@ -756,14 +763,78 @@ void SoundEffectInstanceBase::Apply3D( const AudioListener& listener, const Audi
 
     mDSPSettings.pMatrixCoefficients = nullptr;
 
+    // The loudest output channel gives the attenuation due to distance and cone
+    size_t count = mDSPSettings.SrcChannelCount * mDSPSettings.DstChannelCount;
+    mAttenuation = ( count > 0 ) ? *std::max_element( mMatrix.get(), mMatrix.get() + count ) : 0.f;
+
+    Reapply3D();
+}
+
+
+void SoundEffectInstanceBase::Apply3D( const Emitter3DResult& result, const Emitter3DSpeakers& speakers )
+{
+    if ( !voice && ( state == STOPPED ) )
+        return;
+
+    if ( !( mFlags & SoundEffectInstance_Use3D ) )
+    {
+        DebugTrace( "ERROR: Apply3D called for an instance created without SoundEffectInstance_Use3D set\n" );
+        throw std::exception( "Apply3D" );
+    }
+
+    assert( mDSPSettings.SrcChannelCount <= XAUDIO2_MAX_AUDIO_CHANNELS );
+    assert( mDSPSettings.DstChannelCount == speakers.channels );
+
+    if ( !mMatrix )
+    {
+        mMatrix.reset( new float[ mDSPSettings.SrcChannelCount * 8 ] );
+    }
+
+    memset( mMatrix.get(), 0, sizeof(float) * mDSPSettings.SrcChannelCount * 8 );
+
+    // Every source channel sits at the emitter, and the LFE gets an equal mix of them when redirecting to it
+    uint32_t srcChannels = mDSPSettings.SrcChannelCount;
+    for( uint32_t d = 0; d < mDSPSettings.DstChannelCount; ++d )
+    {
+        float level = result.matrix[ d ];
+        if ( static_cast<int>( d ) == speakers.lfeChannel )
+        {
+            level = ( mFlags & SoundEffectInstance_UseRedirectLFE ) ? ( level / float( srcChannels ) ) : 0.f;
+        }
+
+        for( uint32_t j = 0; j < srcChannels; ++j )
+        {
+            mMatrix[ d * srcChannels + j ] = level;
+        }
+    }
+
+    mDSPSettings.DopplerFactor = result.doppler;
+    mDSPSettings.ReverbLevel = result.reverbLevel;
+    mDSPSettings.LPFDirectCoefficient = result.lpfDirect;
+    mDSPSettings.LPFReverbCoefficient = 0.75f;
+
+    size_t count = mDSPSettings.SrcChannelCount * mDSPSettings.DstChannelCount;
+    mAttenuation = ( count > 0 ) ? *std::max_element( mMatrix.get(), mMatrix.get() + count ) : 0.f;
+
+    Reapply3D();
+}
+
+
+void SoundEffectInstanceBase::Reapply3D()
+{
+    if ( !voice || !mMatrix )
+        return;
+
     (void)voice->SetFrequencyRatio( mFreqRatio * mDSPSettings.DopplerFactor );
 
     auto direct = mDirectVoice;
     assert( direct != 0 );
-    (void)voice->SetOutputMatrix( direct, mDSPSettings.SrcChannelCount, mDSPSettings.DstChannelCount, matrix );
+    (void)voice->SetOutputMatrix( direct, mDSPSettings.SrcChannelCount, mDSPSettings.DstChannelCount, mMatrix.get() );
 
+    auto reverb = mReverbVoice;
     if ( reverb )
     {
+        float matrix[XAUDIO2_MAX_AUDIO_CHANNELS];
         for ( size_t j = 0; (j < mDSPSettings.SrcChannelCount) && (j < XAUDIO2_MAX_AUDIO_CHANNELS); ++j )
         {
             matrix[j] = mDSPSettings.ReverbLevel;
@@ -15,6 +15,7 @@
 
 #include "Audio.h"
 #include "PlatformHelpers.h"
+#include "Emitter3DBatch.h"
 
 
 namespace DirectX
@@ -80,6 +81,7 @@ namespace DirectX
             mPitch( 0.f ),
             mFreqRatio( 1.f ),
             mPan( 0.f ),
+            mAttenuation( 1.f ),
             mFlags( SoundEffectInstance_Default ),
             mDirectVoice( nullptr ),
             mReverbVoice( nullptr ),
@@ -252,6 +254,25 @@ namespace DirectX
 
         void Apply3D( const AudioListener& listener, const AudioEmitter& emitter, bool rhcoords );
 
+        // Applies a result from CalculateEmitter3DBatch, computed for the engine's speakers
+        void Apply3D( const Emitter3DResult& result, const Emitter3DSpeakers& speakers );
+
+        // Applies the results of the last Apply3D to a newly acquired voice
+        void Reapply3D();
+
+        // How loud the instance is, from its volume and (for 3D instances) distance and cone attenuation
+        float GetAudibility() const
+        {
+            return fabsf( mVolume ) * mAttenuation;
+        }
+
+        // Rate the wave plays at, from the pitch and (once Apply3D has been called) the Doppler shift
+        float GetFrequencyRatio() const
+        {
+            float ratio = XAudio2SemitonesToFrequencyRatio( mPitch * 12.f );
+            return ( mMatrix ) ? ( ratio * mDSPSettings.DopplerFactor ) : ratio;
+        }
+
         SoundState GetState( bool autostop )
         {
             if ( autostop && voice && ( state == PLAYING ) )
@@ -312,6 +333,7 @@ namespace DirectX
                 mFlags = static_cast<SOUND_EFFECT_INSTANCE_FLAGS>( static_cast<int>(mFlags) & ~SoundEffectInstance_UseRedirectLFE );
 
             mDSPSettings.DstChannelCount = engine->GetOutputChannels();
+            mMatrix.reset();
         }
 
         void OnDestroy()
@@ -362,9 +384,25 @@ namespace DirectX
         float                       mPitch;
         float                       mFreqRatio;
         float                       mPan;
+        float                       mAttenuation;
         SOUND_EFFECT_INSTANCE_FLAGS mFlags;
         IXAudio2Voice*              mDirectVoice;
         IXAudio2Voice*              mReverbVoice;
         X3DAUDIO_DSP_SETTINGS       mDSPSettings;
+        std::unique_ptr<float[]>    mMatrix;
    };
+
+
+    // Wave bank entry details needed to stream it from a streaming wave bank
+    struct WaveBankStreamData
+    {
+        HANDLE                      async;          // Unbuffered overlapped handle owned by the wave bank
+        uint32_t                    fileOffset;     // Location of the wave data within the .xwb file
+        uint32_t                    lengthBytes;
+        uint32_t                    loopStart;      // Loop region in samples
+        uint32_t                    loopLength;
+        const uint32_t*             seekTable;      // Cumulative decoded bytes per packet (xWMA only)
+        uint32_t                    seekCount;
+        uint32_t                    tag;
+    };
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 
 #include "pch.h"
 #include "SoundCommon.h"
+#include "VirtualVoiceScheduler.h"
 
 using namespace DirectX;
 
@@ -22,7 +23,7 @@ using namespace DirectX;
 //======================================================================================
 
 // Internal object implementation class.
-class SoundEffectInstance::Impl : public IVoiceNotify
+class SoundEffectInstance::Impl : public IVoiceNotify, public IVirtualVoice
 {
 public:
     Impl( _In_ AudioEngine* engine, _In_ SoundEffect* effect, SOUND_EFFECT_INSTANCE_FLAGS flags ) :
@@ -30,13 +31,33 @@ public:
         mEffect( effect ),
         mWaveBank( nullptr ),
         mIndex( 0 ),
-        mLooped( false )
+        mLooped( false ),
+        mExitingLoop( false ),
+        mPriority( 0 ),
+        mVirtual( false ),
+        mScheduler( nullptr ),
+        mPlayed( 0 ),
+        mSamplesBase( 0 ),
+        mLastTime( 0 ),
+        mPartialSample( 0 ),
+        mCursorLooped( false ),
+        mDuration( 0 ),
+        mLoopBegin( 0 ),
+        mLoopEnd( 0 ),
+        mSampleRate( 0 ),
+        mSeekAlignment( 1 )
     {
         assert( engine != 0 );
-        engine->RegisterNotify( this, false );
+        mScheduler = engine->GetVoiceScheduler();
+        engine->RegisterNotify( this, mScheduler != nullptr );
 
         assert( mEffect != 0 );
         mBase.Initialize( engine, effect->GetFormat(), flags );
+
+        if ( mScheduler )
+        {
+            InitializeCursor( effect->GetFormat() );
+        }
     }
 
     Impl( _In_ AudioEngine* engine, _In_ WaveBank* waveBank, uint32_t index, SOUND_EFFECT_INSTANCE_FLAGS flags ) :
@@ -44,15 +65,35 @@ public:
         mEffect( nullptr ),
         mWaveBank( waveBank ),
         mIndex( index ),
-        mLooped( false )
+        mLooped( false ),
+        mExitingLoop( false ),
+        mPriority( 0 ),
+        mVirtual( false ),
+        mScheduler( nullptr ),
+        mPlayed( 0 ),
+        mSamplesBase( 0 ),
+        mLastTime( 0 ),
+        mPartialSample( 0 ),
+        mCursorLooped( false ),
+        mDuration( 0 ),
+        mLoopBegin( 0 ),
+        mLoopEnd( 0 ),
+        mSampleRate( 0 ),
+        mSeekAlignment( 1 )
     {
         assert( engine != 0 );
-        engine->RegisterNotify( this, false );
+        mScheduler = engine->GetVoiceScheduler();
+        engine->RegisterNotify( this, mScheduler != nullptr );
 
         char buff[64] = {};
         auto wfx = reinterpret_cast<WAVEFORMATEX*>( buff );
         assert( mWaveBank != 0 );
         mBase.Initialize( engine, mWaveBank->GetFormat( index, wfx, sizeof(buff) ), flags );
+
+        if ( mScheduler )
+        {
+            InitializeCursor( wfx );
+        }
     }
 
     virtual ~Impl()
@@ -61,12 +102,15 @@ public:
 
         if ( mBase.engine )
         {
-            mBase.engine->UnregisterNotify( this, false, false );
+            mBase.engine->UnregisterNotify( this, false, mScheduler != nullptr );
             mBase.engine = nullptr;
         }
     }
 
     void Play( bool loop );
+    void Stop( bool immediate );
+    void Pause();
+    void Resume();
 
     // IVoiceNotify
     virtual void __cdecl OnBufferEnd() override
@@ -78,6 +122,7 @@ public:
     virtual void __cdecl OnCriticalError() override
     {
         mBase.OnCriticalError();
+        mVirtual = false;
     }
 
     virtual void __cdecl OnReset() override
@@ -87,13 +132,33 @@ public:
 
     virtual void __cdecl OnUpdate() override
     {
-        // We do not register for update notification
-        assert(false);
+        // Only registered for update notification with AudioEngine_VirtualVoices
+        assert( mScheduler != 0 );
+
+        if ( mVirtual )
+        {
+            if ( mBase.state == PLAYING )
+            {
+                AdvanceCursor();
+            }
+        }
+        else if ( mBase.voice && mBase.GetState( true ) == STOPPED )
+        {
+            // Stopped instances give their voice back, so it can go to something which is playing
+            mBase.DestroyVoice();
+        }
+
+        if ( mBase.state == PLAYING )
+        {
+            mScheduler->Add( this, mPriority, mBase.GetAudibility(), !mVirtual );
+        }
     }
 
     virtual void __cdecl OnDestroyEngine() override
     {
         mBase.OnDestroy();
+        mVirtual = false;
+        mScheduler = nullptr;
     }
 
     virtual void __cdecl OnTrim() override
@@ -106,35 +171,355 @@ public:
         mBase.GatherStatistics(stats);
     }
 
+    // IVirtualVoice
+    virtual bool Realize() override;
+    virtual void Virtualize() override;
+
     SoundEffectInstanceBase         mBase;
     SoundEffect*                    mEffect;
     WaveBank*                       mWaveBank;
     uint32_t                        mIndex;
     bool                            mLooped;
+    bool                            mExitingLoop;       // Stop(false) was called on a looped instance, which now plays on to the end
+    int                             mPriority;
+    bool                            mVirtual;
+    VirtualVoiceScheduler*          mScheduler;
+
+private:
+    void AllocateVoice();
+    void Submit( uint32_t playBegin );
+
+    void InitializeCursor( _In_ const WAVEFORMATEX* wfx );
+    void RebaseCursor( uint64_t played, bool looped );
+    uint64_t GetPlayed() const;
+    uint64_t GetVoiceSamplesPlayed() const;
+    void AdvanceCursor();
+
+    // Play cursor, in samples of the wave played since it was last rebased. With a voice, the voice's own sample
+    // count since then is added on.
+    uint64_t                        mPlayed;
+    uint64_t                        mSamplesBase;
+    double                          mLastTime;          // Scheduler play time the cursor was last moved at
+    double                          mPartialSample;
+    bool                            mCursorLooped;
+
+    uint64_t                        mDuration;
+    uint64_t                        mLoopBegin;
+    uint64_t                        mLoopEnd;
+    uint32_t                        mSampleRate;
+    uint32_t                        mSeekAlignment;     // Zero if playback can only start from the beginning
 };
 
 
 void SoundEffectInstance::Impl::Play( bool loop )
 {
+    if ( mVirtual )
+    {
+        Resume();
+        return;
+    }
+
+    AllocateVoice();
+
     if ( !mBase.voice )
     {
-        if ( mWaveBank )
+        // With AudioEngine_VirtualVoices this means every voice is in use, so the instance starts virtually and
+        // the next Update decides if it is important enough to have one
+        if ( mScheduler && mBase.engine && mBase.engine->IsAudioDevicePresent() && mBase.state == STOPPED )
         {
-            char buff[64] = {};
-            auto wfx = reinterpret_cast<WAVEFORMATEX*>( buff );
-            mBase.AllocateVoice( mWaveBank->GetFormat( mIndex, wfx, sizeof(buff) ) );
+            mLooped = loop;
+            mExitingLoop = false;
+            RebaseCursor( 0, loop );
+            mVirtual = true;
+            mBase.state = PLAYING;
+        }
+        return;
+    }
+
+    if ( !mBase.Play() )
+        return;
+
+    // Submit audio data for STOPPED -> PLAYING state transition
+    mLooped = loop;
+    mExitingLoop = false;
+
+    if ( mScheduler )
+    {
+        RebaseCursor( 0, loop );
+    }
+
+    Submit( 0 );
+}
+
+
+void SoundEffectInstance::Impl::Stop( bool immediate )
+{
+    if ( mVirtual )
+    {
+        if ( immediate || !mLooped || mExitingLoop )
+        {
+            mVirtual = false;
+            mBase.state = STOPPED;
         }
         else
         {
-            assert( mEffect != 0 );
-            mBase.AllocateVoice( mEffect->GetFormat() );
+            // Carry on from the current point in the loop to the end of the wave
+            bool finished;
+            RebaseCursor( VirtualVoiceScheduler::WrapPosition( mPlayed, mDuration, mLoopBegin, mLoopEnd, mCursorLooped, finished ), false );
+            mLooped = false;
+            mExitingLoop = true;
         }
+        return;
     }
 
-    if ( !mBase.Play() )
+    if ( mBase.voice && mLooped && !immediate )
+    {
+        if ( mScheduler )
+        {
+            // Once the voice leaves the loop it plays straight on from where it is now
+            bool finished;
+            RebaseCursor( VirtualVoiceScheduler::WrapPosition( GetPlayed(), mDuration, mLoopBegin, mLoopEnd, mCursorLooped, finished ), false );
+        }
+
+        // Kept even if the voice is later released and reacquired, so the wave is never resubmitted looping
+        mExitingLoop = true;
+    }
+    else if ( immediate )
+    {
+        mExitingLoop = false;
+    }
+
+    mBase.Stop( immediate, mLooped );
+}
+
+
+void SoundEffectInstance::Impl::Pause()
+{
+    if ( mVirtual )
+    {
+        if ( mBase.state == PLAYING )
+        {
+            AdvanceCursor();
+
+            if ( mBase.state == PLAYING )
+                mBase.state = PAUSED;
+        }
         return;
+    }
 
-    // Submit audio data for STOPPED -> PLAYING state transition
+    mBase.Pause();
+}
+
+
+void SoundEffectInstance::Impl::Resume()
+{
+    if ( mVirtual )
+    {
+        if ( mBase.state == PAUSED )
+        {
+            mLastTime = mScheduler->GetPlayTime();
+            mBase.state = PLAYING;
+        }
+        return;
+    }
+
+    mBase.Resume();
+}
+
+
+// Acquires a voice and starts it at the virtual play cursor.
+bool SoundEffectInstance::Impl::Realize()
+{
+    assert( mVirtual && mBase.state == PLAYING );
+
+    bool finished;
+    uint64_t position = VirtualVoiceScheduler::WrapPosition( mPlayed, mDuration, mLoopBegin, mLoopEnd, mCursorLooped, finished );
+    if ( finished )
+    {
+        mVirtual = false;
+        mBase.state = STOPPED;
+        return true;
+    }
+
+    AllocateVoice();
+    if ( !mBase.voice )
+        return false;
+
+    mVirtual = false;
+    mBase.state = STOPPED;
+
+    (void)mBase.Play();
+    mBase.Reapply3D();
+
+    // Playback can only begin on a block boundary, and xWMA only from the start
+    uint64_t playBegin = ( mSeekAlignment > 0 ) ? ( position - ( position % mSeekAlignment ) ) : 0;
+
+    RebaseCursor( playBegin, mLooped && !mExitingLoop );
+    Submit( static_cast<uint32_t>( playBegin ) );
+
+    return true;
+}
+
+
+// Releases the voice, and keeps the play cursor moving without it.
+void SoundEffectInstance::Impl::Virtualize()
+{
+    assert( !mVirtual && mBase.voice != 0 );
+
+    uint64_t played = GetPlayed();
+
+    (void)mBase.voice->Stop( 0 );
+    mBase.DestroyVoice();
+
+    RebaseCursor( played, mCursorLooped && !mExitingLoop );
+    mVirtual = true;
+}
+
+
+void SoundEffectInstance::Impl::AllocateVoice()
+{
+    if ( mBase.voice )
+        return;
+
+    if ( mWaveBank )
+    {
+        char buff[64] = {};
+        auto wfx = reinterpret_cast<WAVEFORMATEX*>( buff );
+        mBase.AllocateVoice( mWaveBank->GetFormat( mIndex, wfx, sizeof(buff) ) );
+    }
+    else
+    {
+        assert( mEffect != 0 );
+        mBase.AllocateVoice( mEffect->GetFormat() );
+    }
+}
+
+
+_Use_decl_annotations_
+void SoundEffectInstance::Impl::InitializeCursor( const WAVEFORMATEX* wfx )
+{
+    XAUDIO2_BUFFER buffer;
+
+#if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+    XAUDIO2_BUFFER_WMA wmaBuffer;
+    if ( mWaveBank )
+    {
+        (void)mWaveBank->FillSubmitBuffer( mIndex, buffer, wmaBuffer );
+    }
+    else
+    {
+        (void)mEffect->FillSubmitBuffer( buffer, wmaBuffer );
+    }
+#else
+    if ( mWaveBank )
+    {
+        mWaveBank->FillSubmitBuffer( mIndex, buffer );
+    }
+    else
+    {
+        mEffect->FillSubmitBuffer( buffer );
+    }
+#endif
+
+    mDuration = ( mWaveBank ) ? mWaveBank->GetSampleDuration( mIndex ) : mEffect->GetSampleDuration();
+
+    // A zero loop length means looping to the end
+    mLoopBegin = buffer.LoopBegin;
+    mLoopEnd = ( buffer.LoopLength > 0 ) ? ( uint64_t( buffer.LoopBegin ) + buffer.LoopLength ) : mDuration;
+
+    mSampleRate = wfx->nSamplesPerSec;
+
+    switch( GetFormatTag( wfx ) )
+    {
+    case WAVE_FORMAT_ADPCM:
+        mSeekAlignment = reinterpret_cast<const ADPCMWAVEFORMAT*>( wfx )->wSamplesPerBlock;
+        break;
+
+#if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+    case WAVE_FORMAT_WMAUDIO2:
+    case WAVE_FORMAT_WMAUDIO3:
+        mSeekAlignment = 0;
+        break;
+#endif
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    case WAVE_FORMAT_XMA2:
+        mSeekAlignment = 128;
+        break;
+#endif
+
+    default:
+        mSeekAlignment = 1;
+        break;
+    }
+
+    RebaseCursor( 0, false );
+}
+
+
+// Restarts the cursor count from the given number of samples played, which with a voice is from the voice's current sample count.
+void SoundEffectInstance::Impl::RebaseCursor( uint64_t played, bool looped )
+{
+    mPlayed = played;
+    mCursorLooped = looped;
+    mSamplesBase = GetVoiceSamplesPlayed();
+    mLastTime = ( mScheduler ) ? mScheduler->GetPlayTime() : 0;
+    mPartialSample = 0;
+}
+
+
+uint64_t SoundEffectInstance::Impl::GetPlayed() const
+{
+    if ( mVirtual || !mBase.voice )
+        return mPlayed;
+
+    return mPlayed + ( GetVoiceSamplesPlayed() - mSamplesBase );
+}
+
+
+uint64_t SoundEffectInstance::Impl::GetVoiceSamplesPlayed() const
+{
+    if ( !mBase.voice )
+        return 0;
+
+    XAUDIO2_VOICE_STATE xstate;
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    mBase.voice->GetState( &xstate, 0 );
+#else
+    mBase.voice->GetState( &xstate );
+#endif
+    return xstate.SamplesPlayed;
+}
+
+
+// Moves a virtual instance's play cursor on by the engine play time since it was last moved, stopping it if it has played out.
+void SoundEffectInstance::Impl::AdvanceCursor()
+{
+    assert( mScheduler != 0 );
+
+    double now = mScheduler->GetPlayTime();
+    double elapsed = now - mLastTime;
+    mLastTime = now;
+
+    // Whole samples go on the cursor, and the fraction left over is carried into the next update
+    double samples = elapsed * double( mSampleRate ) * double( mBase.GetFrequencyRatio() ) + mPartialSample;
+    uint64_t whole = static_cast<uint64_t>( samples );
+    mPartialSample = samples - double( whole );
+    mPlayed += whole;
+
+    bool finished;
+    (void)VirtualVoiceScheduler::WrapPosition( mPlayed, mDuration, mLoopBegin, mLoopEnd, mCursorLooped && !mExitingLoop, finished );
+    if ( finished )
+    {
+        mVirtual = false;
+        mBase.state = STOPPED;
+    }
+}
+
+
+// Submits the whole wave to the voice, starting playback at the given sample.
+void SoundEffectInstance::Impl::Submit( uint32_t playBegin )
+{
     XAUDIO2_BUFFER buffer;
 
 #if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
@@ -166,14 +551,13 @@ void SoundEffectInstance::Impl::Play( bool loop )
 #endif
     
     buffer.Flags = XAUDIO2_END_OF_STREAM;
-    if ( loop )
+    buffer.PlayBegin = playBegin;
+    if ( mLooped && !mExitingLoop )
     {
-        mLooped = true;
         buffer.LoopCount = XAUDIO2_LOOP_INFINITE;
     }
     else
     {
-        mLooped = false;
         buffer.LoopCount = buffer.LoopBegin = buffer.LoopLength = 0;
     }
     buffer.pContext = nullptr;
@@ -272,19 +656,19 @@ void SoundEffectInstance::Play( bool loop )
 
 void SoundEffectInstance::Stop( bool immediate )
 {
-    pImpl->mBase.Stop( immediate, pImpl->mLooped );
+    pImpl->Stop( immediate );
 }
 
 
 void SoundEffectInstance::Pause()
 {
-    pImpl->mBase.Pause();
+    pImpl->Pause();
 }
 
 
 void SoundEffectInstance::Resume()
 {
-    pImpl->mBase.Resume();
+    pImpl->Resume();
 }
 
 
@@ -312,6 +696,139 @@ void SoundEffectInstance::Apply3D( const AudioListener& listener, const AudioEmi
 }
 
 
+#ifdef _DEBUG
+namespace
+{
+    // Compares a batch result with what X3DAudioCalculate gives for the same emitter
+    void CheckEmitter3DResult( AudioEngine* engine, const AudioListener& listener, const AudioEmitterArray& emitters, size_t index,
+                               const Emitter3DResult& result, const Emitter3DSpeakers& speakers, bool rhcoords )
+    {
+        float zsign = rhcoords ? -1.f : 1.f;
+
+        AudioEmitter emitter;
+        emitter.ChannelRadius = 0.f;
+        emitter.Position.x = emitters.positionX[ index ];
+        emitter.Position.y = emitters.positionY[ index ];
+        emitter.Position.z = emitters.positionZ[ index ] * zsign;
+        if ( emitters.velocityX )
+        {
+            emitter.Velocity.x = emitters.velocityX[ index ];
+            emitter.Velocity.y = emitters.velocityY[ index ];
+            emitter.Velocity.z = emitters.velocityZ[ index ] * zsign;
+        }
+        if ( emitters.curveDistanceScalers )
+            emitter.CurveDistanceScaler = emitters.curveDistanceScalers[ index ];
+        if ( emitters.dopplerScalers )
+            emitter.DopplerScaler = emitters.dopplerScalers[ index ];
+
+        X3DAUDIO_LISTENER lhListener;
+        memcpy( &lhListener, &listener, sizeof(X3DAUDIO_LISTENER) );
+        lhListener.OrientFront.z *= zsign;
+        lhListener.OrientTop.z *= zsign;
+        lhListener.Position.z *= zsign;
+        lhListener.Velocity.z *= zsign;
+
+        float matrix[ Emitter3DSpeakers::MAX_CHANNELS ] = {};
+
+        X3DAUDIO_DSP_SETTINGS dsp = {};
+        dsp.SrcChannelCount = 1;
+        dsp.DstChannelCount = speakers.channels;
+        dsp.pMatrixCoefficients = matrix;
+
+        DWORD dwCalcFlags = X3DAUDIO_CALCULATE_MATRIX | X3DAUDIO_CALCULATE_DOPPLER | X3DAUDIO_CALCULATE_LPF_DIRECT | X3DAUDIO_CALCULATE_REVERB;
+        if ( speakers.lfeChannel >= 0 )
+            dwCalcFlags |= X3DAUDIO_CALCULATE_REDIRECT_TO_LFE;
+
+        X3DAudioCalculate( engine->Get3DHandle(), &lhListener, &emitter, dwCalcFlags, &dsp );
+
+        float error = fabsf( dsp.DopplerFactor - result.doppler );
+        error = std::max( error, fabsf( dsp.ReverbLevel - result.reverbLevel ) );
+        error = std::max( error, fabsf( dsp.LPFDirectCoefficient - result.lpfDirect ) );
+        for( uint32_t j = 0; j < speakers.channels; ++j )
+        {
+            error = std::max( error, fabsf( matrix[ j ] - result.matrix[ j ] ) );
+        }
+
+        if ( error > 1e-3f )
+        {
+            DebugTrace( "WARNING: Apply3D for emitter %Iu of an array differs from X3DAudioCalculate by %f\n", index, error );
+        }
+    }
+}
+#endif
+
+
+_Use_decl_annotations_
+void SoundEffectInstance::Apply3D( const AudioListener& listener, const AudioEmitterArray& emitters, SoundEffectInstance* const* instances, bool rhcoords )
+{
+    if ( !emitters.count )
+        return;
+
+    if ( !emitters.positionX || !emitters.positionY || !emitters.positionZ || !instances )
+        throw std::invalid_argument( "AudioEmitterArray" );
+
+    if ( ( emitters.velocityX != nullptr ) != ( emitters.velocityY != nullptr )
+         || ( emitters.velocityX != nullptr ) != ( emitters.velocityZ != nullptr ) )
+        throw std::invalid_argument( "AudioEmitterArray" );
+
+    // The speaker layout comes from the engine the instances were created with
+    AudioEngine* engine = nullptr;
+    for( size_t j = 0; j < emitters.count && !engine; ++j )
+    {
+        if ( instances[ j ] )
+            engine = instances[ j ]->pImpl->mBase.engine;
+    }
+
+    if ( !engine )
+        return;
+
+    Emitter3DSpeakers speakers;
+    InitializeEmitter3DSpeakers( engine->GetChannelMask(), std::min<uint32_t>( engine->GetOutputChannels(), Emitter3DSpeakers::MAX_CHANNELS ), speakers );
+
+    // Worked through a block at a time so the results stay on the stack
+    static const size_t BLOCK_SIZE = 64;
+    Emitter3DResult results[ BLOCK_SIZE ];
+
+    for( size_t base = 0; base < emitters.count; base += BLOCK_SIZE )
+    {
+        size_t count = std::min( BLOCK_SIZE, emitters.count - base );
+
+        CalculateEmitter3DBatch( speakers,
+                                 *reinterpret_cast<const XMFLOAT3*>( &listener.Position ),
+                                 *reinterpret_cast<const XMFLOAT3*>( &listener.Velocity ),
+                                 *reinterpret_cast<const XMFLOAT3*>( &listener.OrientFront ),
+                                 *reinterpret_cast<const XMFLOAT3*>( &listener.OrientTop ),
+                                 count,
+                                 emitters.positionX + base, emitters.positionY + base, emitters.positionZ + base,
+                                 emitters.velocityX ? ( emitters.velocityX + base ) : nullptr,
+                                 emitters.velocityY ? ( emitters.velocityY + base ) : nullptr,
+                                 emitters.velocityZ ? ( emitters.velocityZ + base ) : nullptr,
+                                 emitters.curveDistanceScalers ? ( emitters.curveDistanceScalers + base ) : nullptr,
+                                 emitters.dopplerScalers ? ( emitters.dopplerScalers + base ) : nullptr,
+                                 X3DAUDIO_SPEED_OF_SOUND, rhcoords, results );
+
+#ifdef _DEBUG
+        CheckEmitter3DResult( engine, listener, emitters, base, results[ 0 ], speakers, rhcoords );
+#endif
+
+        for( size_t j = 0; j < count; ++j )
+        {
+            SoundEffectInstance* instance = instances[ base + j ];
+            if ( instance )
+            {
+                instance->pImpl->mBase.Apply3D( results[ j ], speakers );
+            }
+        }
+    }
+}
+
+
+void SoundEffectInstance::SetPriority( int priority )
+{
+    pImpl->mPriority = priority;
+}
+
+
 // Public accessors.
 bool SoundEffectInstance::IsLooped() const
 {
@@ -319,6 +836,12 @@ bool SoundEffectInstance::IsLooped() const
 }
 
 
+bool SoundEffectInstance::IsVirtual() const
+{
+    return pImpl->mVirtual;
+}
+
+
 SoundState SoundEffectInstance::GetState()
 {
     return pImpl->mBase.GetState( true );
@@ -329,6 +852,7 @@ SoundState SoundEffectInstance::GetState()
 void SoundEffectInstance::OnDestroyParent()
 {
     pImpl->mBase.OnDestroy();
+    pImpl->mVirtual = false;
     pImpl->mWaveBank = nullptr;
     pImpl->mEffect = nullptr;
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+//--------------------------------------------------------------------------------------
+// File: SoundStreamCursor.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+
+namespace DirectX
+{
+    // Plans the sequence of sector-aligned reads used to stream a single wave from disk, following the loop
+    // region while looping. This has no platform dependencies so the read pattern can be exercised without
+    // a file or a voice.
+    class SoundStreamCursor
+    {
+    public:
+        struct Chunk
+        {
+            uint64_t    readOffset;     // Sector-aligned file offset to read from
+            uint32_t    readBytes;      // Sector-aligned size of the read
+            uint32_t    skipBytes;      // Bytes at the start of the read which precede the chunk
+            uint32_t    position;       // Offset of the chunk within the wave data
+            uint32_t    length;         // Size of the chunk (always whole units)
+            bool        endOfStream;    // Last chunk of the wave
+        };
+
+        SoundStreamCursor() :
+            mFileOffset( 0 ),
+            mLength( 0 ),
+            mUnit( 1 ),
+            mAlignment( 1 ),
+            mMaxChunk( 1 ),
+            mLoopBegin( 0 ),
+            mLoopEnd( 0 ),
+            mPosition( 0 ),
+            mLooping( false ),
+            mFinished( true )
+        {
+        }
+
+        // unitBytes is the smallest piece of data that can be submitted on its own (a PCM frame, an ADPCM block
+        // or an xWMA packet), and alignment must be a power of two.
+        void Initialize( uint64_t fileOffset, uint32_t lengthBytes, uint32_t unitBytes, uint32_t alignment, uint32_t chunkBytes )
+        {
+            assert( unitBytes > 0 );
+            assert( alignment > 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+
+            mFileOffset = fileOffset;
+            mUnit = unitBytes;
+            mLength = lengthBytes - ( lengthBytes % unitBytes );
+            mAlignment = alignment;
+            mMaxChunk = std::max( chunkBytes - ( chunkBytes % unitBytes ), unitBytes );
+            mLoopBegin = 0;
+            mLoopEnd = mLength;
+            mPosition = 0;
+            mLooping = false;
+            mFinished = ( mLength == 0 );
+        }
+
+        // Loop region in bytes, which is rounded to whole units. An empty region loops the entire wave.
+        void SetLoopRegion( uint32_t beginBytes, uint32_t endBytes )
+        {
+            beginBytes -= beginBytes % mUnit;
+            endBytes = std::min( endBytes - ( endBytes % mUnit ), mLength );
+
+            if ( beginBytes < endBytes )
+            {
+                mLoopBegin = beginBytes;
+                mLoopEnd = endBytes;
+            }
+            else
+            {
+                mLoopBegin = 0;
+                mLoopEnd = mLength;
+            }
+        }
+
+        // Rewinds to the start of the wave.
+        void Reset( bool loop )
+        {
+            mPosition = 0;
+            mLooping = loop;
+            mFinished = ( mLength == 0 );
+        }
+
+        // Turning looping off lets the stream run on past the loop region to the end of the wave.
+        void SetLooping( bool loop ) { mLooping = loop; }
+
+        bool IsLooping() const { return mLooping; }
+        bool IsFinished() const { return mFinished; }
+
+        uint32_t GetPosition() const { return mPosition; }
+
+        // Size of buffer able to hold any read returned by Next.
+        uint32_t GetBufferSize() const
+        {
+            return mMaxChunk + 2 * mAlignment;
+        }
+
+        // Returns the next read, or false once the end of the wave has been reached.
+        bool Next( Chunk& chunk )
+        {
+            if ( mFinished )
+                return false;
+
+            bool wrap = mLooping && ( mPosition < mLoopEnd );
+            uint32_t end = wrap ? mLoopEnd : mLength;
+
+            uint32_t length = std::min( end - mPosition, mMaxChunk );
+
+            uint64_t start = mFileOffset + mPosition;
+            uint64_t alignedStart = start & ~uint64_t( mAlignment - 1 );
+            uint64_t alignedEnd = ( start + length + mAlignment - 1 ) & ~uint64_t( mAlignment - 1 );
+
+            chunk.readOffset = alignedStart;
+            chunk.readBytes = static_cast<uint32_t>( alignedEnd - alignedStart );
+            chunk.skipBytes = static_cast<uint32_t>( start - alignedStart );
+            chunk.position = mPosition;
+            chunk.length = length;
+            chunk.endOfStream = false;
+
+            mPosition += length;
+
+            if ( mPosition >= end )
+            {
+                if ( wrap )
+                {
+                    mPosition = mLoopBegin;
+                }
+                else
+                {
+                    chunk.endOfStream = true;
+                    mFinished = true;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        uint64_t    mFileOffset;
+        uint32_t    mLength;
+        uint32_t    mUnit;
+        uint32_t    mAlignment;
+        uint32_t    mMaxChunk;
+        uint32_t    mLoopBegin;
+        uint32_t    mLoopEnd;
+        uint32_t    mPosition;
+        bool        mLooping;
+        bool        mFinished;
+    };
+}
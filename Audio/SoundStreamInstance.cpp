@@ -0,0 +1,636 @@
+//--------------------------------------------------------------------------------------
+// File: SoundStreamInstance.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "SoundCommon.h"
+#include "SoundStreamCursor.h"
+#include "StreamingIOQueue.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // Number of buffers in the prefetch ring: one playing, one queued behind it, and one being read
+    const size_t MAX_BUFFER_COUNT = 3;
+
+    // Target size of each streaming read
+    const uint32_t STREAM_CHUNK_SIZE = 65536;
+
+    // Unbuffered reads must be aligned to the physical sector size, which is at most 4K
+    const uint32_t SECTOR_ALIGNMENT = 4096;
+
+    // Playback starts silent until the first read arrives, so reads made before then get this much grace
+    const uint64_t STARTUP_LATENCY_MS = 100;
+}
+
+
+//======================================================================================
+// SoundStreamInstance
+//======================================================================================
+
+// Internal object implementation class.
+class SoundStreamInstance::Impl : public IVoiceNotify
+{
+public:
+    Impl( _In_ AudioEngine* engine, _In_ WaveBank* waveBank, uint32_t index, SOUND_EFFECT_INSTANCE_FLAGS flags, const WaveBankStreamData& data ) :
+        mBase(),
+        mWaveBank( waveBank ),
+        mIndex( index ),
+        mLooped( false ),
+        mEndSubmitted( false ),
+        mStarted( false ),
+        mReadError( false ),
+        mAsync( INVALID_HANDLE_VALUE ),
+        mQueue( nullptr ),
+        mSeekTable( nullptr ),
+        mSeekCount( 0 ),
+        mIsWMA( false ),
+        mHead( 0 ),
+        mSubmitted( 0 ),
+        mReading( 0 ),
+        mStarvations( 0 ),
+        mWaveFormat{}
+    {
+        assert( mWaveBank != 0 );
+        auto wfx = mWaveBank->GetFormat( index, reinterpret_cast<WAVEFORMATEX*>( mWaveFormat ), sizeof(mWaveFormat) );
+        if ( !wfx )
+            throw std::exception( "SoundStreamInstance" );
+
+        mAsync = data.async;
+
+        // Express the loop region in bytes of wave data, rounded to the smallest unit which can be submitted
+        uint64_t loopBegin = data.loopStart;
+        uint64_t loopEnd = uint64_t( data.loopStart ) + data.loopLength;
+
+        uint32_t unit = wfx->nBlockAlign;
+
+        switch ( GetFormatTag( wfx ) )
+        {
+        case WAVE_FORMAT_PCM:
+        case WAVE_FORMAT_IEEE_FLOAT:
+            loopBegin *= unit;
+            loopEnd *= unit;
+            break;
+
+        case WAVE_FORMAT_ADPCM:
+            {
+                auto adpcm = reinterpret_cast<const ADPCMWAVEFORMAT*>( wfx );
+                uint32_t samplesPerBlock = adpcm->wSamplesPerBlock;
+                if ( !samplesPerBlock )
+                    throw std::exception( "SoundStreamInstance" );
+
+                loopBegin = ( loopBegin / samplesPerBlock ) * unit;
+                loopEnd = ( ( loopEnd + samplesPerBlock - 1 ) / samplesPerBlock ) * unit;
+            }
+            break;
+
+#if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+        case WAVE_FORMAT_WMAUDIO2:
+        case WAVE_FORMAT_WMAUDIO3:
+            // Each xWMA buffer must carry the decoded sizes of the packets it holds, so the seek table is required
+            if ( !data.seekTable || !data.seekCount || ( data.lengthBytes / unit ) > data.seekCount )
+            {
+                DebugTrace( "ERROR: SoundStreamInstance requires a seek table for xWMA streaming\n" );
+                throw std::exception( "SoundStreamInstance" );
+            }
+
+            mSeekTable = data.seekTable;
+            mSeekCount = data.seekCount;
+            mIsWMA = true;
+
+            if ( data.loopLength > 0 )
+            {
+                // xWMA decodes to 16-bit PCM
+                uint64_t frameBytes = uint64_t( wfx->nChannels ) * 2;
+                auto last = mSeekTable + mSeekCount;
+
+                auto begin = std::upper_bound( mSeekTable, last, static_cast<uint32_t>( std::min<uint64_t>( loopBegin * frameBytes, UINT32_MAX ) ) );
+                auto end = std::lower_bound( mSeekTable, last, static_cast<uint32_t>( std::min<uint64_t>( loopEnd * frameBytes, UINT32_MAX ) ) );
+
+                loopBegin = uint64_t( begin - mSeekTable ) * unit;
+                loopEnd = uint64_t( std::min<size_t>( size_t( end - mSeekTable ) + 1, mSeekCount ) ) * unit;
+            }
+            break;
+#endif
+
+        default:
+            DebugTrace( "ERROR: SoundStreamInstance does not support streaming format tag %u\n", GetFormatTag( wfx ) );
+            throw std::exception( "SoundStreamInstance" );
+        }
+
+        if ( !unit || mAsync == INVALID_HANDLE_VALUE )
+            throw std::exception( "SoundStreamInstance" );
+
+        mCursor.Initialize( data.fileOffset, data.lengthBytes, unit, SECTOR_ALIGNMENT, STREAM_CHUNK_SIZE );
+
+        if ( data.loopLength > 0 )
+        {
+            mCursor.SetLoopRegion( static_cast<uint32_t>( std::min<uint64_t>( loopBegin, UINT32_MAX ) ),
+                                   static_cast<uint32_t>( std::min<uint64_t>( loopEnd, UINT32_MAX ) ) );
+        }
+
+        size_t bufferSize = ( size_t( mCursor.GetBufferSize() ) + SECTOR_ALIGNMENT - 1 ) & ~size_t( SECTOR_ALIGNMENT - 1 );
+
+        for ( size_t j = 0; j < MAX_BUFFER_COUNT; ++j )
+        {
+            auto& buffer = mBuffers[ j ];
+
+            buffer.data.reset( static_cast<uint8_t*>( _aligned_malloc( bufferSize, SECTOR_ALIGNMENT ) ) );
+            if ( !buffer.data )
+                throw std::bad_alloc();
+
+            memset( &buffer.read, 0, sizeof(StreamingRead) );
+            buffer.read.dest = buffer.data.get();
+
+            memset( &buffer.chunk, 0, sizeof(SoundStreamCursor::Chunk) );
+        }
+
+        assert( engine != 0 );
+        mQueue = engine->GetStreamingQueue();
+
+        engine->RegisterNotify( this, true );
+
+        mBase.Initialize( engine, wfx, flags );
+    }
+
+    virtual ~Impl()
+    {
+        mBase.DestroyVoice();
+
+        CancelReads();
+
+        if ( mStarvations > 0 )
+        {
+            DebugTrace( "WARNING: SoundStreamInstance ran out of data %Iu times, audio glitches likely\n", mStarvations );
+        }
+
+        if ( mBase.engine )
+        {
+            mBase.engine->UnregisterNotify( this, false, true );
+            mBase.engine = nullptr;
+        }
+    }
+
+    void Play( bool loop );
+
+    void Stop( bool immediate );
+
+    void OnDestroyParent();
+
+    // IVoiceNotify
+    virtual void __cdecl OnBufferEnd() override
+    {
+        // Finished buffers are reclaimed from the voice state during OnUpdate
+    }
+
+    virtual void __cdecl OnCriticalError() override
+    {
+        mBase.OnCriticalError();
+        CancelReads();
+    }
+
+    virtual void __cdecl OnReset() override
+    {
+        mBase.OnReset();
+    }
+
+    virtual void __cdecl OnUpdate() override;
+
+    virtual void __cdecl OnDestroyEngine() override
+    {
+        mBase.OnDestroy();
+        CancelReads();
+        mQueue = nullptr;
+    }
+
+    virtual void __cdecl OnTrim() override
+    {
+        mBase.OnTrim();
+    }
+
+    virtual void __cdecl GatherStatistics( AudioStatistics& stats ) const override
+    {
+        mBase.GatherStatistics(stats);
+    }
+
+    SoundEffectInstanceBase         mBase;
+    WaveBank*                       mWaveBank;
+    uint32_t                        mIndex;
+    bool                            mLooped;
+    bool                            mEndSubmitted;
+    bool                            mStarted;
+    bool                            mReadError;
+
+private:
+    struct StreamBuffer
+    {
+        std::unique_ptr<uint8_t, aligned_deleter>   data;
+        StreamingRead                               read;
+        SoundStreamCursor::Chunk                    chunk;
+        std::vector<uint32_t>                       seekTable;
+    };
+
+    // The ring holds mSubmitted buffers queued on the voice starting at mHead, followed by mReading buffers
+    // with reads in flight. Buffers are read, submitted, and played back strictly in ring order.
+    StreamBuffer& BufferAt( size_t offset ) { return mBuffers[ ( mHead + offset ) % MAX_BUFFER_COUNT ]; }
+    const StreamBuffer& BufferAt( size_t offset ) const { return mBuffers[ ( mHead + offset ) % MAX_BUFFER_COUNT ]; }
+
+    uint64_t GetDeadline() const;
+    void IssueReads();
+    bool CompleteRead( StreamBuffer& buffer );
+    void SubmitBuffer( StreamBuffer& buffer );
+    void CancelReads();
+
+    HANDLE                          mAsync;
+    StreamingIOQueue*               mQueue;
+    const uint32_t*                 mSeekTable;
+    uint32_t                        mSeekCount;
+    bool                            mIsWMA;
+    SoundStreamCursor               mCursor;
+    StreamBuffer                    mBuffers[ MAX_BUFFER_COUNT ];
+    size_t                          mHead;
+    size_t                          mSubmitted;
+    size_t                          mReading;
+    size_t                          mStarvations;
+    char                            mWaveFormat[64];
+};
+
+
+void SoundStreamInstance::Impl::Play( bool loop )
+{
+    if ( !mWaveBank )
+    {
+        DebugTrace( "ERROR: SoundStreamInstance cannot play once its WaveBank has been destroyed\n" );
+        throw std::exception( "SoundStreamInstance::Play" );
+    }
+
+    if ( !mBase.voice )
+    {
+        mBase.AllocateVoice( reinterpret_cast<const WAVEFORMATEX*>( mWaveFormat ) );
+    }
+
+    if ( mBase.state == STOPPED )
+    {
+        // Restart from the beginning, discarding anything read ahead for the previous playback
+        CancelReads();
+
+        mLooped = loop;
+        mEndSubmitted = false;
+        mStarted = false;
+        mReadError = false;
+        mCursor.Reset( loop );
+
+        IssueReads();
+    }
+
+    // The voice starts empty and picks up the first buffer on the next update, so Play never waits on disk
+    (void)mBase.Play();
+}
+
+
+void SoundStreamInstance::Impl::Stop( bool immediate )
+{
+    bool exitLoop = !immediate && mLooped;
+
+    mBase.Stop( immediate, mLooped );
+
+    if ( immediate )
+    {
+        CancelReads();
+    }
+    else if ( exitLoop )
+    {
+        // Loops are handled by the read schedule rather than XAudio2, so play on through to the end
+        mCursor.SetLooping( false );
+    }
+}
+
+
+void SoundStreamInstance::Impl::OnDestroyParent()
+{
+    // The wave bank owns the file handle, so no reads may be in flight once it is gone
+    mBase.DestroyVoice();
+    CancelReads();
+
+    mSubmitted = 0;
+    mAsync = INVALID_HANDLE_VALUE;
+    mSeekTable = nullptr;
+    mSeekCount = 0;
+    mWaveBank = nullptr;
+}
+
+
+void SoundStreamInstance::Impl::OnUpdate()
+{
+    // XAudio2 finishes buffers in submission order, so anything no longer queued on the voice is free again
+    size_t queued = static_cast<size_t>( mBase.GetPendingBufferCount() );
+    while ( mSubmitted > queued )
+    {
+        mHead = ( mHead + 1 ) % MAX_BUFFER_COUNT;
+        --mSubmitted;
+    }
+
+    if ( !mBase.voice || mBase.state == STOPPED || mAsync == INVALID_HANDLE_VALUE || !mQueue )
+        return;
+
+    if ( !queued && mStarted && !mEndSubmitted && mBase.state == PLAYING )
+    {
+        // Playback caught up with the reads
+        ++mStarvations;
+    }
+
+    while ( mReading > 0 )
+    {
+        auto& buffer = BufferAt( mSubmitted );
+        if ( !CompleteRead( buffer ) )
+        {
+            if ( mReadError )
+            {
+                // This runs inside AudioEngine::Update, so stop rather than throw
+                Stop( true );
+                return;
+            }
+            break;
+        }
+
+        SubmitBuffer( buffer );
+
+        ++mSubmitted;
+        --mReading;
+    }
+
+    IssueReads();
+}
+
+
+void SoundStreamInstance::Impl::IssueReads()
+{
+    while ( ( mSubmitted + mReading ) < MAX_BUFFER_COUNT && !mCursor.IsFinished() )
+    {
+        auto& buffer = BufferAt( mSubmitted + mReading );
+
+        if ( !mCursor.Next( buffer.chunk ) )
+            break;
+
+        if ( mIsWMA )
+        {
+            // Rebase the cumulative decoded sizes so they are relative to the start of this buffer
+            assert( mSeekTable != 0 );
+
+            uint32_t unit = reinterpret_cast<const WAVEFORMATEX*>( mWaveFormat )->nBlockAlign;
+            uint32_t first = buffer.chunk.position / unit;
+            uint32_t count = buffer.chunk.length / unit;
+            assert( ( first + count ) <= mSeekCount );
+
+            uint32_t base = ( first > 0 ) ? mSeekTable[ first - 1 ] : 0;
+
+            buffer.seekTable.resize( count );
+            for ( uint32_t j = 0; j < count; ++j )
+            {
+                buffer.seekTable[ j ] = mSeekTable[ first + j ] - base;
+            }
+        }
+
+        // The shared queue orders this against every other stream's reads, issuing it by the end of the update
+        mQueue->Submit( mAsync, buffer.chunk.readOffset, buffer.chunk.readBytes, GetDeadline(), this, &buffer.read );
+
+        ++mReading;
+    }
+}
+
+
+// Time at which the next buffer to be read will be needed, assuming everything queued ahead of it plays out.
+uint64_t SoundStreamInstance::Impl::GetDeadline() const
+{
+    // The buffer at the head is already partly played, so it is not counted
+    uint64_t bytes = 0;
+    for ( size_t j = 1; j < ( mSubmitted + mReading ); ++j )
+    {
+        bytes += BufferAt( j ).chunk.length;
+    }
+
+    uint64_t deadline = GetTickCount64();
+
+    auto wfx = reinterpret_cast<const WAVEFORMATEX*>( mWaveFormat );
+    if ( wfx->nAvgBytesPerSec > 0 )
+    {
+        deadline += ( bytes * 1000 ) / wfx->nAvgBytesPerSec;
+    }
+
+    if ( !mStarted )
+    {
+        deadline += STARTUP_LATENCY_MS;
+    }
+
+    return deadline;
+}
+
+
+// Returns true once the read into the buffer has finished, or false with mReadError set if it failed.
+bool SoundStreamInstance::Impl::CompleteRead( StreamBuffer& buffer )
+{
+    if ( buffer.read.pending )
+        return false;
+
+    if ( FAILED( buffer.read.result ) )
+    {
+        DebugTrace( "ERROR: SoundStreamInstance failed (%08X) to read %u bytes at offset %I64u\n",
+                    buffer.read.result, buffer.chunk.readBytes, buffer.chunk.readOffset );
+        mReadError = true;
+        return false;
+    }
+
+    if ( buffer.read.bytesRead < ( buffer.chunk.skipBytes + buffer.chunk.length ) )
+    {
+        DebugTrace( "ERROR: SoundStreamInstance hit the end of the file, wave bank is truncated\n" );
+        mReadError = true;
+        return false;
+    }
+
+    return true;
+}
+
+
+void SoundStreamInstance::Impl::SubmitBuffer( StreamBuffer& buffer )
+{
+    XAUDIO2_BUFFER xbuffer = {};
+    xbuffer.AudioBytes = buffer.chunk.length;
+    xbuffer.pAudioData = buffer.data.get() + buffer.chunk.skipBytes;
+    xbuffer.pContext = this;
+
+    mStarted = true;
+
+    if ( buffer.chunk.endOfStream )
+    {
+        xbuffer.Flags = XAUDIO2_END_OF_STREAM;
+        mEndSubmitted = true;
+    }
+
+    HRESULT hr;
+#if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+    if ( mIsWMA )
+    {
+        XAUDIO2_BUFFER_WMA wmaBuffer = {};
+        wmaBuffer.pDecodedPacketCumulativeBytes = buffer.seekTable.data();
+        wmaBuffer.PacketCount = static_cast<UINT32>( buffer.seekTable.size() );
+
+        hr = mBase.voice->SubmitSourceBuffer( &xbuffer, &wmaBuffer );
+    }
+    else
+#endif
+    {
+        hr = mBase.voice->SubmitSourceBuffer( &xbuffer, nullptr );
+    }
+
+    if ( FAILED(hr) )
+    {
+#ifdef _DEBUG
+        DebugTrace( "ERROR: SoundStreamInstance failed (%08X) when submitting buffer:\n", hr );
+
+        auto wfx = reinterpret_cast<const WAVEFORMATEX*>( mWaveFormat );
+        DebugTrace( "\tFormat Tag %u, %u channels, %u-bit, %u Hz, %u bytes [%u offset]\n", wfx->wFormatTag,
+                    wfx->nChannels, wfx->wBitsPerSample, wfx->nSamplesPerSec, buffer.chunk.length, buffer.chunk.position );
+#endif
+        throw std::exception( "SubmitSourceBuffer" );
+    }
+}
+
+
+// Abandons any reads queued or in flight; buffers already submitted to the voice are reclaimed as usual.
+void SoundStreamInstance::Impl::CancelReads()
+{
+    if ( mReading > 0 && mQueue )
+    {
+        mQueue->Cancel( this );
+    }
+
+    mReading = 0;
+}
+
+
+
+//--------------------------------------------------------------------------------------
+// SoundStreamInstance
+//--------------------------------------------------------------------------------------
+
+// Private constructors
+_Use_decl_annotations_
+SoundStreamInstance::SoundStreamInstance( AudioEngine* engine, WaveBank* waveBank, int index, SOUND_EFFECT_INSTANCE_FLAGS flags, const WaveBankStreamData& data ) :
+    pImpl( new Impl( engine, waveBank, index, flags, data ) )
+{
+}
+
+
+// Move constructor.
+SoundStreamInstance::SoundStreamInstance(SoundStreamInstance&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+SoundStreamInstance& SoundStreamInstance::operator= (SoundStreamInstance&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+SoundStreamInstance::~SoundStreamInstance()
+{
+    if( pImpl )
+    {
+        if ( pImpl->mWaveBank )
+        {
+            pImpl->mWaveBank->UnregisterInstance( this );
+            pImpl->mWaveBank = nullptr;
+        }
+    }
+}
+
+
+// Public methods.
+void SoundStreamInstance::Play( bool loop )
+{
+    pImpl->Play( loop );
+}
+
+
+void SoundStreamInstance::Stop( bool immediate )
+{
+    pImpl->Stop( immediate );
+}
+
+
+void SoundStreamInstance::Pause()
+{
+    pImpl->mBase.Pause();
+}
+
+
+void SoundStreamInstance::Resume()
+{
+    pImpl->mBase.Resume();
+}
+
+
+void SoundStreamInstance::SetVolume( float volume )
+{
+    pImpl->mBase.SetVolume( volume );
+}
+
+
+void SoundStreamInstance::SetPitch( float pitch )
+{
+    pImpl->mBase.SetPitch( pitch );
+}
+
+
+void SoundStreamInstance::SetPan( float pan )
+{
+    pImpl->mBase.SetPan( pan );
+}
+
+
+void SoundStreamInstance::Apply3D( const AudioListener& listener, const AudioEmitter& emitter, bool rhcoords )
+{
+    pImpl->mBase.Apply3D( listener, emitter, rhcoords );
+}
+
+
+// Public accessors.
+bool SoundStreamInstance::IsLooped() const
+{
+    return pImpl->mLooped;
+}
+
+
+SoundState SoundStreamInstance::GetState()
+{
+    // The voice is empty until the first read completes, so only stop automatically once the end was submitted
+    return pImpl->mBase.GetState( pImpl->mEndSubmitted );
+}
+
+
+bool SoundStreamInstance::HasReadError() const
+{
+    return pImpl->mReadError;
+}
+
+
+// Notifications.
+void SoundStreamInstance::OnDestroyParent()
+{
+    pImpl->OnDestroyParent();
+}
@@ -0,0 +1,181 @@
+//--------------------------------------------------------------------------------------
+// File: StreamReadScheduler.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Decides the order in which queued streaming reads are issued. Requests which are close to their deadline
+    // go first, everything else is swept through in file offset order, and neighbouring requests in the same file
+    // are merged into a single read. This has no platform dependencies; the caller performs the actual I/O.
+    class StreamReadScheduler
+    {
+    public:
+        struct Request
+        {
+            uintptr_t   file;       // Requests only merge with others in the same file
+            uint64_t    offset;
+            uint32_t    bytes;
+            uint64_t    deadline;   // Time by which the data is needed, in the caller's clock
+            void*       owner;
+            void*       context;    // Caller data for the request, null once abandoned
+        };
+
+        struct Read
+        {
+            uintptr_t               file;
+            uint64_t                offset;
+            uint32_t                bytes;
+            std::vector<Request>    requests;   // In ascending offset order
+        };
+
+        StreamReadScheduler( uint32_t maxOutstandingBytes, uint32_t maxReadBytes, uint64_t urgentWindow ) :
+            mMaxOutstanding( maxOutstandingBytes ),
+            mMaxRead( maxReadBytes ),
+            mUrgentWindow( urgentWindow ),
+            mOutstanding( 0 ),
+            mDeadlineMisses( 0 ),
+            mSweepFile( 0 ),
+            mSweepOffset( 0 )
+        {
+        }
+
+        void Submit( const Request& request )
+        {
+            assert( request.bytes > 0 );
+
+            auto it = std::upper_bound( mPending.begin(), mPending.end(), request, OffsetOrder );
+            mPending.insert( it, request );
+        }
+
+        // Removes every request from the owner which has not been issued yet.
+        void Cancel( void* owner )
+        {
+            mPending.erase( std::remove_if( mPending.begin(), mPending.end(),
+                                            [owner]( const Request& r ) { return r.owner == owner; } ),
+                            mPending.end() );
+        }
+
+        // Chooses the next read to issue, or returns false if nothing is queued or the byte budget is used up.
+        // A read larger than the budget can still be issued when nothing else is outstanding.
+        bool Next( uint64_t now, Read& read )
+        {
+            read.requests.clear();
+
+            if ( mPending.empty() )
+                return false;
+
+            // Starving requests go first, most urgent first
+            size_t lead = mPending.size();
+            uint64_t earliest = UINT64_MAX;
+            for ( size_t j = 0; j < mPending.size(); ++j )
+            {
+                uint64_t deadline = mPending[ j ].deadline;
+                if ( deadline <= ( now + mUrgentWindow ) && deadline < earliest )
+                {
+                    lead = j;
+                    earliest = deadline;
+                }
+            }
+
+            if ( lead == mPending.size() )
+            {
+                // Otherwise continue sweeping forward from the end of the last read, wrapping around at the end
+                Request key = {};
+                key.file = mSweepFile;
+                key.offset = mSweepOffset;
+
+                lead = static_cast<size_t>( std::lower_bound( mPending.begin(), mPending.end(), key, OffsetOrder ) - mPending.begin() );
+                if ( lead == mPending.size() )
+                    lead = 0;
+            }
+
+            const Request& first = mPending[ lead ];
+            if ( mOutstanding > 0 && ( uint64_t( mOutstanding ) + first.bytes ) > mMaxOutstanding )
+                return false;
+
+            // Merge following requests from the same file which overlap or abut the read
+            uint64_t end = first.offset + first.bytes;
+            size_t last = lead + 1;
+            for ( ; last < mPending.size(); ++last )
+            {
+                const Request& next = mPending[ last ];
+                if ( next.file != first.file || next.offset > end )
+                    break;
+
+                uint64_t newEnd = std::max( end, next.offset + next.bytes );
+                if ( ( newEnd - first.offset ) > mMaxRead
+                     || ( mOutstanding + ( newEnd - first.offset ) ) > std::max<uint64_t>( mMaxOutstanding, first.bytes ) )
+                    break;
+
+                end = newEnd;
+            }
+
+            read.file = first.file;
+            read.offset = first.offset;
+            read.bytes = static_cast<uint32_t>( end - first.offset );
+            read.requests.assign( mPending.begin() + lead, mPending.begin() + last );
+
+            mPending.erase( mPending.begin() + lead, mPending.begin() + last );
+
+            mOutstanding += read.bytes;
+            mSweepFile = read.file;
+            mSweepOffset = end;
+
+            return true;
+        }
+
+        // Releases the budget held by an issued read, and counts any requests which were late.
+        void Complete( const Read& read, uint64_t now )
+        {
+            assert( mOutstanding >= read.bytes );
+            mOutstanding -= read.bytes;
+
+            for ( auto it = read.requests.cbegin(); it != read.requests.cend(); ++it )
+            {
+                if ( it->context && now > it->deadline )
+                    ++mDeadlineMisses;
+            }
+        }
+
+        size_t GetQueueDepth() const { return mPending.size(); }
+        size_t GetDeadlineMisses() const { return mDeadlineMisses; }
+        uint32_t GetOutstandingBytes() const { return mOutstanding; }
+
+    private:
+        static bool OffsetOrder( const Request& a, const Request& b )
+        {
+            if ( a.file != b.file )
+                return a.file < b.file;
+
+            return a.offset < b.offset;
+        }
+
+        uint32_t                mMaxOutstanding;
+        uint32_t                mMaxRead;
+        uint64_t                mUrgentWindow;
+        uint32_t                mOutstanding;
+        size_t                  mDeadlineMisses;
+        uintptr_t               mSweepFile;
+        uint64_t                mSweepOffset;
+        std::vector<Request>    mPending;
+    };
+}
@@ -0,0 +1,259 @@
+//--------------------------------------------------------------------------------------
+// File: StreamingIOQueue.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "StreamingIOQueue.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // Total bytes of reads in flight at once across every stream
+    const uint32_t MAX_OUTSTANDING_BYTES = 1024 * 1024;
+
+    // Largest read made by merging neighbouring requests
+    const uint32_t MAX_READ_BYTES = 256 * 1024;
+
+    // Requests due within this many milliseconds are issued ahead of the offset-ordered sweep
+    const uint64_t URGENT_WINDOW_MS = 200;
+
+    // Staging buffers are used with unbuffered handles, so must be sector-aligned
+    const size_t STAGING_ALIGNMENT = 4096;
+}
+
+
+StreamingIOQueue::StreamingIOQueue() :
+    mScheduler( MAX_OUTSTANDING_BYTES, MAX_READ_BYTES, URGENT_WINDOW_MS )
+{
+}
+
+
+StreamingIOQueue::~StreamingIOQueue()
+{
+    // Every owner should have cancelled by now, but never leave the kernel writing into freed memory
+    for( auto it = mInFlight.begin(); it != mInFlight.end(); ++it )
+    {
+        auto& op = **it;
+        auto file = reinterpret_cast<HANDLE>( op.read.file );
+
+        (void)CancelIoEx( file, &op.request );
+
+        DWORD bytes;
+        (void)GetOverlappedResult( file, &op.request, &bytes, TRUE );
+    }
+}
+
+
+_Use_decl_annotations_
+void StreamingIOQueue::Submit( HANDLE file, uint64_t offset, uint32_t bytes, uint64_t deadline, void* owner, StreamingRead* read )
+{
+    assert( file != INVALID_HANDLE_VALUE && read != 0 && read->dest != 0 );
+
+    if ( !bytes )
+        throw std::invalid_argument( "StreamingIOQueue::Submit" );
+
+    read->bytesRead = 0;
+    read->result = S_OK;
+    read->pending = true;
+
+    StreamReadScheduler::Request request;
+    request.file = reinterpret_cast<uintptr_t>( file );
+    request.offset = offset;
+    request.bytes = bytes;
+    request.deadline = deadline;
+    request.owner = owner;
+    request.context = read;
+
+    mScheduler.Submit( request );
+}
+
+
+_Use_decl_annotations_
+void StreamingIOQueue::Cancel( void* owner )
+{
+    mScheduler.Cancel( owner );
+
+    for( auto it = mInFlight.begin(); it != mInFlight.end(); )
+    {
+        auto& op = **it;
+
+        bool owned = false;
+        for( auto rit = op.read.requests.begin(); rit != op.read.requests.end(); ++rit )
+        {
+            if ( rit->owner == owner )
+            {
+                rit->owner = nullptr;
+                rit->context = nullptr;
+                owned = true;
+            }
+        }
+
+        if ( owned && IsDirect( op ) )
+        {
+            // The read targets the owner's own buffer, so it has to be stopped before returning
+            auto file = reinterpret_cast<HANDLE>( op.read.file );
+
+            (void)CancelIoEx( file, &op.request );
+
+            DWORD bytes = 0;
+            (void)GetOverlappedResult( file, &op.request, &bytes, TRUE );
+
+            mScheduler.Complete( op.read, GetTickCount64() );
+            mFree.splice( mFree.end(), mInFlight, it++ );
+        }
+        else
+        {
+            // Merged reads land in a staging buffer, and the abandoned part is simply not copied out
+            ++it;
+        }
+    }
+}
+
+
+void StreamingIOQueue::ProcessCompletions()
+{
+    for( auto it = mInFlight.begin(); it != mInFlight.end(); )
+    {
+        auto& op = **it;
+        auto file = reinterpret_cast<HANDLE>( op.read.file );
+
+        DWORD bytes = 0;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+        BOOL result = GetOverlappedResultEx( file, &op.request, &bytes, 0, FALSE );
+#else
+        if ( !HasOverlappedIoCompleted( &op.request ) )
+        {
+            ++it;
+            continue;
+        }
+
+        BOOL result = GetOverlappedResult( file, &op.request, &bytes, FALSE );
+#endif
+
+        if ( !result )
+        {
+            DWORD error = GetLastError();
+            if ( error == ERROR_IO_INCOMPLETE || error == WAIT_TIMEOUT )
+            {
+                ++it;
+                continue;
+            }
+
+            Finish( op, HRESULT_FROM_WIN32( error ), 0 );
+        }
+        else
+        {
+            Finish( op, S_OK, bytes );
+        }
+
+        mFree.splice( mFree.end(), mInFlight, it++ );
+    }
+}
+
+
+void StreamingIOQueue::IssueReads()
+{
+    for(;;)
+    {
+        std::unique_ptr<InFlight> op;
+        if ( !mFree.empty() )
+        {
+            op = std::move( mFree.front() );
+            mFree.pop_front();
+        }
+        else
+        {
+            op.reset( new InFlight );
+            op->event.reset( CreateEventEx( nullptr, nullptr, CREATE_EVENT_MANUAL_RESET, EVENT_MODIFY_STATE | SYNCHRONIZE ) );
+            if ( !op->event )
+                throw std::exception( "CreateEvent" );
+        }
+
+        if ( !mScheduler.Next( GetTickCount64(), op->read ) )
+        {
+            mFree.emplace_front( std::move( op ) );
+            break;
+        }
+
+        uint8_t* dest;
+        if ( IsDirect( *op ) )
+        {
+            dest = reinterpret_cast<StreamingRead*>( op->read.requests[0].context )->dest;
+        }
+        else
+        {
+            if ( !op->staging )
+            {
+                op->staging.reset( static_cast<uint8_t*>( _aligned_malloc( MAX_READ_BYTES, STAGING_ALIGNMENT ) ) );
+                if ( !op->staging )
+                    throw std::bad_alloc();
+            }
+
+            assert( op->read.bytes <= MAX_READ_BYTES );
+            dest = op->staging.get();
+        }
+
+        auto file = reinterpret_cast<HANDLE>( op->read.file );
+
+        memset( &op->request, 0, sizeof(OVERLAPPED) );
+        op->request.Offset = static_cast<DWORD>( op->read.offset );
+        op->request.OffsetHigh = static_cast<DWORD>( op->read.offset >> 32 );
+        op->request.hEvent = op->event.get();
+
+        if ( !ReadFile( file, dest, op->read.bytes, nullptr, &op->request ) )
+        {
+            DWORD error = GetLastError();
+            if ( error != ERROR_IO_PENDING )
+            {
+                DebugTrace( "ERROR: StreamingIOQueue failed (%08X) to read %u bytes at offset %I64u\n",
+                            HRESULT_FROM_WIN32( error ), op->read.bytes, op->read.offset );
+
+                Finish( *op, HRESULT_FROM_WIN32( error ), 0 );
+                mFree.emplace_back( std::move( op ) );
+                continue;
+            }
+        }
+
+        mInFlight.emplace_back( std::move( op ) );
+    }
+}
+
+
+// Hands the results of a finished read back to its requests, and releases its share of the budget.
+_Use_decl_annotations_
+void StreamingIOQueue::Finish( InFlight& op, HRESULT hr, uint32_t bytesRead )
+{
+    bool direct = IsDirect( op );
+
+    for( auto it = op.read.requests.begin(); it != op.read.requests.end(); ++it )
+    {
+        auto read = reinterpret_cast<StreamingRead*>( it->context );
+        if ( !read )
+            continue;
+
+        uint32_t start = static_cast<uint32_t>( it->offset - op.read.offset );
+        uint32_t count = ( bytesRead > start ) ? std::min( bytesRead - start, it->bytes ) : 0;
+
+        if ( !direct && count > 0 )
+        {
+            memcpy( read->dest, op.staging.get() + start, count );
+        }
+
+        read->bytesRead = count;
+        read->result = hr;
+        read->pending = false;
+    }
+
+    mScheduler.Complete( op.read, GetTickCount64() );
+}
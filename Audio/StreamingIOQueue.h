@@ -0,0 +1,86 @@
+//--------------------------------------------------------------------------------------
+// File: StreamingIOQueue.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "PlatformHelpers.h"
+#include "StreamReadScheduler.h"
+
+#include <list>
+#include <memory>
+
+
+namespace DirectX
+{
+    // A read queued with the StreamingIOQueue. The requester owns it, and must keep it (and the destination)
+    // alive until the read is no longer pending or has been cancelled.
+    struct StreamingRead
+    {
+        uint8_t*    dest;           // Must be sector-aligned for unbuffered files
+        uint32_t    bytesRead;
+        HRESULT     result;
+        bool        pending;
+    };
+
+
+    // Overlapped I/O service shared by all the streaming voices of an AudioEngine, so reads are issued in one
+    // coordinated order within a bounded number of bytes in flight. All methods are called on the thread which
+    // calls AudioEngine::Update.
+    class StreamingIOQueue
+    {
+    public:
+        StreamingIOQueue();
+
+        StreamingIOQueue(StreamingIOQueue const&) = delete;
+        StreamingIOQueue& operator= (StreamingIOQueue const&) = delete;
+
+        ~StreamingIOQueue();
+
+        // Queues a sector-aligned read. The deadline is the GetTickCount64 time by which the data is needed.
+        void Submit( _In_ HANDLE file, uint64_t offset, uint32_t bytes, uint64_t deadline, _In_ void* owner, _Inout_ StreamingRead* read );
+
+        // Abandons every read for the owner, waiting for any which are already in flight to its buffers.
+        void Cancel( _In_ void* owner );
+
+        // Marks completed reads as no longer pending.
+        void ProcessCompletions();
+
+        // Issues queued reads, up to the outstanding byte budget.
+        void IssueReads();
+
+        size_t GetQueueDepth() const { return mScheduler.GetQueueDepth(); }
+        size_t GetDeadlineMisses() const { return mScheduler.GetDeadlineMisses(); }
+
+    private:
+        struct InFlight
+        {
+            OVERLAPPED                                  request;
+            ScopedHandle                                event;
+            std::unique_ptr<uint8_t, aligned_deleter>   staging;    // Only used when several requests are merged
+            StreamReadScheduler::Read                   read;
+        };
+
+        bool IsDirect( const InFlight& op ) const
+        {
+            return op.read.requests.size() == 1
+                   && op.read.requests[0].offset == op.read.offset
+                   && op.read.requests[0].bytes == op.read.bytes;
+        }
+
+        void Finish( _Inout_ InFlight& op, HRESULT hr, uint32_t bytesRead );
+
+        StreamReadScheduler                         mScheduler;
+        std::list<std::unique_ptr<InFlight>>        mInFlight;
+        std::list<std::unique_ptr<InFlight>>        mFree;
+    };
+}
@@ -0,0 +1,163 @@
+//--------------------------------------------------------------------------------------
+// File: VirtualVoiceScheduler.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+
+namespace DirectX
+{
+    // A playing sound which can give up its source voice and carry on virtually.
+    class IVirtualVoice
+    {
+    public:
+        virtual ~IVirtualVoice() {}
+
+        // Acquires a source voice and resumes playback at the virtual play cursor. Returns false if no voice was available.
+        virtual bool Realize() = 0;
+
+        // Releases the source voice, keeping the play cursor moving without it.
+        virtual void Virtualize() = 0;
+    };
+
+
+    // Decides which playing sounds are backed by one of a limited number of source voices. Each update every playing
+    // sound is added with its priority and audibility, and the most important ones within the budget are made real.
+    // This has no platform dependencies, so the scheduling can be driven by mock voices.
+    class VirtualVoiceScheduler
+    {
+    public:
+        VirtualVoiceScheduler() :
+            mRealCount( 0 ),
+            mVirtualCount( 0 ),
+            mPlayTime( 0 )
+        {
+        }
+
+        VirtualVoiceScheduler(VirtualVoiceScheduler const&) = delete;
+        VirtualVoiceScheduler& operator= (VirtualVoiceScheduler const&) = delete;
+
+        void Add( IVirtualVoice* voice, int priority, float audibility, bool real )
+        {
+            assert( voice != 0 );
+
+            Candidate candidate;
+            candidate.voice = voice;
+            candidate.priority = priority;
+            // Real voices are favoured a little, so sounds of about the same loudness don't trade places every update
+            candidate.audibility = real ? ( audibility * 1.25f ) : audibility;
+            candidate.real = real;
+            mCandidates.push_back( candidate );
+
+            if ( real )
+                ++mRealCount;
+        }
+
+        // Moves the play clock on by the given number of seconds. The engine only counts time while it is running,
+        // so virtual sounds stay put while it is suspended just as real ones do.
+        void AdvanceClock( double seconds )
+        {
+            assert( seconds >= 0 );
+            mPlayTime += seconds;
+        }
+
+        // Seconds the engine has spent running, which virtual sounds measure their progress against.
+        double GetPlayTime() const { return mPlayTime; }
+
+        // Number of sounds added so far this update which currently have a source voice.
+        size_t GetRealCount() const { return mRealCount; }
+
+        // Number of sounds left playing without a source voice by the last Schedule.
+        size_t GetVirtualCount() const { return mVirtualCount; }
+
+        // Makes the budget's worth of most important sounds added since the last call real, and the rest virtual.
+        // Sounds are virtualized before any are realized, so the voices they free can be reused straight away.
+        void Schedule( size_t budget )
+        {
+            size_t keep = std::min( budget, mCandidates.size() );
+
+            if ( keep < mCandidates.size() )
+            {
+                std::nth_element( mCandidates.begin(), mCandidates.begin() + keep, mCandidates.end(), MoreImportant );
+            }
+
+            mVirtualCount = mCandidates.size() - keep;
+
+            for( size_t j = keep; j < mCandidates.size(); ++j )
+            {
+                if ( mCandidates[ j ].real )
+                {
+                    mCandidates[ j ].voice->Virtualize();
+                }
+            }
+
+            for( size_t j = 0; j < keep; ++j )
+            {
+                if ( !mCandidates[ j ].real && !mCandidates[ j ].voice->Realize() )
+                {
+                    ++mVirtualCount;
+                }
+            }
+
+            mCandidates.clear();
+            mRealCount = 0;
+        }
+
+        // Position within a wave after playing for the given number of samples from its start, following the loop
+        // region [loopBegin, loopEnd) if looped. Sets finished if a sound which is not looped has played out.
+        static uint64_t WrapPosition( uint64_t played, uint64_t duration, uint64_t loopBegin, uint64_t loopEnd, bool looped, bool& finished )
+        {
+            finished = false;
+
+            if ( looped && loopBegin < loopEnd && played >= loopEnd )
+            {
+                played = loopBegin + ( played - loopBegin ) % ( loopEnd - loopBegin );
+            }
+            else if ( played >= duration )
+            {
+                finished = true;
+                played = duration;
+            }
+
+            return played;
+        }
+
+    private:
+        struct Candidate
+        {
+            IVirtualVoice*  voice;
+            int             priority;
+            float           audibility;
+            bool            real;
+        };
+
+        static bool MoreImportant( const Candidate& a, const Candidate& b )
+        {
+            if ( a.priority != b.priority )
+                return a.priority > b.priority;
+
+            return a.audibility > b.audibility;
+        }
+
+        size_t                  mRealCount;
+        size_t                  mVirtualCount;
+        double                  mPlayTime;
+        std::vector<Candidate>  mCandidates;
+    };
+}
@@ -0,0 +1,336 @@
+//--------------------------------------------------------------------------------------
+// File: VoicePool.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Tracks the source voices used for one-shot sounds: those playing, and those kept stopped for reuse by a later
+    // one-shot with the same format key. Voices live on intrusive lists in a fixed table of format slots, and their
+    // nodes come from storage reserved up front (see Reserve), so acquiring and releasing a voice takes constant time
+    // and allocates nothing. Node storage is shared by all formats, as how a title's one-shots split between formats
+    // is not known in advance. If no capacity was reserved (AudioEngine's default of unlimited one-shots), nodes are
+    // added in blocks as needed, so the pool grows to the most voices ever in use at once and no further. The only
+    // thing asked of TVoice is DestroyVoice, so this has no platform dependencies.
+    template<typename TVoice>
+    class VoicePool
+    {
+    private:
+        struct Format;
+
+    public:
+        // Format keys beyond this many are not reused: their voices are destroyed once they stop.
+        static const size_t MAX_FORMATS = 64;
+
+        struct Node
+        {
+            TVoice*         voice;
+            unsigned int    key;        // Zero if the voice is destroyed rather than reused
+            Format*         format;
+            Node*           prev;
+            Node*           next;
+        };
+
+        VoicePool() :
+            mActive( nullptr ),
+            mFreeNodes( nullptr ),
+            mActiveCount( 0 ),
+            mIdleCount( 0 ),
+            mNodeCount( 0 )
+        {
+        }
+
+        VoicePool(VoicePool const&) = delete;
+        VoicePool& operator= (VoicePool const&) = delete;
+
+        // Makes sure nodes for at least this many voices are allocated.
+        void Reserve( size_t capacity )
+        {
+            if ( capacity > mNodeCount )
+            {
+                AllocateBlock( capacity - mNodeCount );
+            }
+        }
+
+        // Takes an idle voice with the given format key and makes it active, or returns null if there is none.
+        TVoice* Acquire( unsigned int key )
+        {
+            assert( key != 0 );
+
+            size_t slot = FindSlot( key );
+            if ( slot == MAX_FORMATS || mFormats[ slot ].key != key || !mFormats[ slot ].idle )
+                return nullptr;
+
+            Format* format = &mFormats[ slot ];
+
+            Node* node = format->idle;
+            format->idle = node->next;
+            --format->idleCount;
+            --mIdleCount;
+
+            LinkActive( node );
+            return node->voice;
+        }
+
+        // Tracks a newly created voice as active.
+        void Add( unsigned int key, TVoice* voice )
+        {
+            assert( voice != 0 );
+
+            Format* format = &mUnkeyed;
+
+            size_t slot = key ? FindSlot( key ) : MAX_FORMATS;
+            if ( slot != MAX_FORMATS )
+            {
+                format = &mFormats[ slot ];
+                format->key = key;
+            }
+            else
+            {
+                // Not reusable, or the format table is full
+                key = 0;
+            }
+
+            Node* node = AllocateNode();
+            node->voice = voice;
+            node->key = key;
+            node->format = format;
+
+            LinkActive( node );
+        }
+
+        // Called once an active voice has stopped. It is kept idle for reuse if it has a format key, and is
+        // destroyed otherwise. Returns the next active node, so this can be used while walking the active list.
+        Node* Release( Node* node )
+        {
+            assert( node != 0 );
+
+            Node* next = node->next;
+
+            if ( node->prev )
+                node->prev->next = next;
+            else
+                mActive = next;
+
+            if ( next )
+                next->prev = node->prev;
+
+            --mActiveCount;
+
+            Format* format = node->format;
+            assert( format->activeCount > 0 );
+            --format->activeCount;
+
+            if ( node->key )
+            {
+                // Most recently used first, as it is the most likely to still be warm
+                node->prev = nullptr;
+                node->next = format->idle;
+                format->idle = node;
+                ++format->idleCount;
+                ++mIdleCount;
+            }
+            else
+            {
+                node->voice->DestroyVoice();
+                FreeNode( node );
+            }
+
+            return next;
+        }
+
+        // Destroys every idle voice.
+        void DestroyIdle()
+        {
+            for( size_t j = 0; j < MAX_FORMATS; ++j )
+            {
+                Format& format = mFormats[ j ];
+                for( Node* node = format.idle; node; )
+                {
+                    Node* next = node->next;
+                    node->voice->DestroyVoice();
+                    FreeNode( node );
+                    node = next;
+                }
+
+                format.idle = nullptr;
+                format.idleCount = 0;
+            }
+
+            mIdleCount = 0;
+        }
+
+        // Destroys every voice, active or idle.
+        void DestroyAll()
+        {
+            DestroyIdle();
+
+            for( Node* node = mActive; node; )
+            {
+                Node* next = node->next;
+                node->voice->DestroyVoice();
+                FreeNode( node );
+                node = next;
+            }
+
+            mActive = nullptr;
+            mActiveCount = 0;
+
+            for( size_t j = 0; j < MAX_FORMATS; ++j )
+            {
+                mFormats[ j ].activeCount = 0;
+            }
+
+            mUnkeyed.activeCount = 0;
+        }
+
+        Node* GetFirstActive() const { return mActive; }
+
+        size_t GetActiveCount() const { return mActiveCount; }
+        size_t GetIdleCount() const { return mIdleCount; }
+
+        // Most voices of the format which have been active at once.
+        size_t GetHighWater( unsigned int key ) const
+        {
+            if ( !key )
+                return mUnkeyed.highWater;
+
+            size_t slot = FindSlot( key );
+            return ( slot != MAX_FORMATS && mFormats[ slot ].key == key ) ? mFormats[ slot ].highWater : 0;
+        }
+
+        bool IsActive( const TVoice* voice ) const
+        {
+            for( const Node* node = mActive; node; node = node->next )
+            {
+                if ( node->voice == voice )
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool IsIdle( const TVoice* voice ) const
+        {
+            for( size_t j = 0; j < MAX_FORMATS; ++j )
+            {
+                for( const Node* node = mFormats[ j ].idle; node; node = node->next )
+                {
+                    if ( node->voice == voice )
+                        return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        static const size_t NODE_BLOCK_SIZE = 32;
+
+        struct Format
+        {
+            Format() : key( 0 ), idle( nullptr ), idleCount( 0 ), activeCount( 0 ), highWater( 0 ) {}
+
+            unsigned int    key;        // Zero if the slot is unused
+            Node*           idle;
+            size_t          idleCount;
+            size_t          activeCount;
+            size_t          highWater;
+        };
+
+        // Open addressing with linear probing. Returns the slot holding the key, else the unused slot where it
+        // would go, else MAX_FORMATS if the table is full. Slots are never freed, as a title only uses a few formats.
+        size_t FindSlot( unsigned int key ) const
+        {
+            assert( key != 0 );
+
+            size_t start = ( key * 2654435761u ) % MAX_FORMATS;
+            for( size_t j = 0; j < MAX_FORMATS; ++j )
+            {
+                size_t slot = ( start + j ) % MAX_FORMATS;
+
+                if ( mFormats[ slot ].key == key || !mFormats[ slot ].key )
+                    return slot;
+            }
+
+            return MAX_FORMATS;
+        }
+
+        void LinkActive( Node* node )
+        {
+            node->prev = nullptr;
+            node->next = mActive;
+            if ( mActive )
+                mActive->prev = node;
+            mActive = node;
+
+            ++mActiveCount;
+
+            Format* format = node->format;
+            ++format->activeCount;
+            format->highWater = std::max( format->highWater, format->activeCount );
+        }
+
+        void AllocateBlock( size_t count )
+        {
+            // Nodes are never returned to the heap
+            std::unique_ptr<Node[]> storage( new Node[ count ] );
+            mBlocks.emplace_back( std::move( storage ) );
+            mNodeCount += count;
+
+            Node* block = mBlocks.back().get();
+            for( size_t j = 0; j < count; ++j )
+            {
+                FreeNode( &block[ j ] );
+            }
+        }
+
+        Node* AllocateNode()
+        {
+            if ( !mFreeNodes )
+            {
+                AllocateBlock( NODE_BLOCK_SIZE );
+            }
+
+            Node* node = mFreeNodes;
+            mFreeNodes = node->next;
+            return node;
+        }
+
+        void FreeNode( Node* node )
+        {
+            node->voice = nullptr;
+            node->format = nullptr;
+            node->prev = nullptr;
+            node->next = mFreeNodes;
+            mFreeNodes = node;
+        }
+
+        Node*                                   mActive;
+        Node*                                   mFreeNodes;
+        size_t                                  mActiveCount;
+        size_t                                  mIdleCount;
+        size_t                                  mNodeCount;
+        Format                                  mFormats[ MAX_FORMATS ];
+        Format                                  mUnkeyed;
+        std::vector<std::unique_ptr<Node[]>>    mBlocks;
+    };
+}
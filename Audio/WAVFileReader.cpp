@@ -109,6 +109,18 @@ static_assert( sizeof(RIFFDLSSample) == 20, "structure size mismatch");
 static_assert( sizeof(MIDILoop) == 24, "structure size mismatch");
 static_assert( sizeof(RIFFMIDISample) == 36, "structure size mismatch");
 
+// The first chunk with each tag used by the loader, found with a single walk of the RIFF form
+struct ChunkIndex
+{
+    const RIFFChunkHeader*  riff;
+    const RIFFChunk*        fmt;
+    const RIFFChunk*        data;
+    const RIFFChunk*        dls;
+    const RIFFChunk*        midi;
+    const RIFFChunk*        dpds;
+    const RIFFChunk*        seek;
+};
+
 };
 
 
@@ -136,16 +148,30 @@ static const RIFFChunk* FindChunk( _In_reads_bytes_(sizeBytes) const uint8_t* da
 
 
 //--------------------------------------------------------------------------------------
-static HRESULT WaveFindFormatAndData( _In_reads_bytes_(wavDataSize) const uint8_t* wavData, _In_ size_t wavDataSize,
-                                      _Outptr_ const WAVEFORMATEX** pwfx, _Outptr_ const uint8_t** pdata, _Out_ uint32_t* dataSize,
-                                      _Out_ bool& dpds, _Out_ bool& seek )
+static const RIFFChunk** IndexSlot( _Inout_ ChunkIndex& index, _In_ uint32_t tag )
 {
-    if ( !wavData || !pwfx )
-        return E_POINTER;
+    switch( tag )
+    {
+    case FOURCC_FORMAT_TAG:     return &index.fmt;
+    case FOURCC_DATA_TAG:       return &index.data;
+    case FOURCC_DLS_SAMPLE:     return &index.dls;
+    case FOURCC_MIDI_SAMPLE:    return &index.midi;
+    case FOURCC_XWMA_DPDS:      return &index.dpds;
+    case FOURCC_XMA_SEEK:       return &index.seek;
+    default:                    return nullptr;
+    }
+}
 
-    dpds = seek = false;
 
-    if (wavDataSize < (sizeof(RIFFChunk)*2 + sizeof(uint32_t) + sizeof(WAVEFORMAT) ) )
+//--------------------------------------------------------------------------------------
+static HRESULT IndexChunks( _In_reads_bytes_(wavDataSize) const uint8_t* wavData, _In_ size_t wavDataSize, _Out_ ChunkIndex& index )
+{
+    memset( &index, 0, sizeof(index) );
+
+    if ( !wavData )
+        return E_POINTER;
+
+    if (wavDataSize < ( sizeof(RIFFChunk) + sizeof(uint32_t) ) )
     {
         return E_FAIL;
     }
@@ -165,20 +191,56 @@ static HRESULT WaveFindFormatAndData( _In_reads_bytes_(wavDataSize) const uint8_
         return E_FAIL;
     }
 
-    // Locate 'fmt '
     auto ptr = reinterpret_cast<const uint8_t*>( riffHeader ) + sizeof(RIFFChunkHeader);
     if ( ( ptr + sizeof(RIFFChunk) ) > wavEnd )
     {
         return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
     }
 
-    auto fmtChunk = FindChunk( ptr, riffHeader->size, FOURCC_FORMAT_TAG );
+    index.riff = riffHeader;
+
+    // Walk the form's chunks once, which is bounded by both the form size and the end of the data
+    size_t remaining = std::min<size_t>( riffHeader->size - sizeof(uint32_t), size_t( wavEnd - ptr ) );
+
+    while ( remaining > sizeof(RIFFChunk) )
+    {
+        auto header = reinterpret_cast<const RIFFChunk*>( ptr );
+
+        auto slot = IndexSlot( index, header->tag );
+        if ( slot && !*slot )
+        {
+            // A chunk which runs past the end is still noted, so it is reported by the lookup that needs it
+            *slot = header;
+        }
+
+        if ( header->size >= ( remaining - sizeof(RIFFChunk) ) )
+            break;
+
+        ptr += header->size + sizeof(RIFFChunk);
+        remaining -= header->size + sizeof(RIFFChunk);
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+static HRESULT WaveFindFormat( _In_ const ChunkIndex& index, _In_ const uint8_t* wavEnd,
+                               _Outptr_ const WAVEFORMATEX** pwfx, _Out_ bool& dpds, _Out_ bool& seek )
+{
+    if ( !pwfx )
+        return E_POINTER;
+
+    dpds = seek = false;
+
+    // Locate 'fmt '
+    auto fmtChunk = index.fmt;
     if ( !fmtChunk || fmtChunk->size < sizeof(PCMWAVEFORMAT) )
     {
         return E_FAIL;
     }
 
-    ptr = reinterpret_cast<const uint8_t*>( fmtChunk ) + sizeof( RIFFChunk );
+    auto ptr = reinterpret_cast<const uint8_t*>( fmtChunk ) + sizeof( RIFFChunk );
     if ( ptr + fmtChunk->size > wavEnd )
     {
         return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
@@ -274,26 +336,31 @@ static HRESULT WaveFindFormatAndData( _In_reads_bytes_(wavDataSize) const uint8_
         }
     }
 
-    // Locate 'data'
-    ptr = reinterpret_cast<const uint8_t*>( riffHeader ) + sizeof(RIFFChunkHeader);
-    if ( ( ptr + sizeof(RIFFChunk) ) > wavEnd )
-    {
-        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
-    }
+    *pwfx = reinterpret_cast<const WAVEFORMATEX*>( wf );
+    return S_OK;
+}
+
 
-    auto dataChunk = FindChunk( ptr, riffChunk->size, FOURCC_DATA_TAG );
+//--------------------------------------------------------------------------------------
+static HRESULT WaveFindData( _In_ const ChunkIndex& index, _In_ const uint8_t* wavEnd,
+                             _Outptr_ const uint8_t** pdata, _Out_ uint32_t* dataSize )
+{
+    if ( !pdata || !dataSize )
+        return E_POINTER;
+
+    // Locate 'data'
+    auto dataChunk = index.data;
     if ( !dataChunk || !dataChunk->size )
     {
         return HRESULT_FROM_WIN32( ERROR_INVALID_DATA );
     }
 
-    ptr = reinterpret_cast<const uint8_t*>( dataChunk ) + sizeof( RIFFChunk );
+    auto ptr = reinterpret_cast<const uint8_t*>( dataChunk ) + sizeof( RIFFChunk );
     if ( ptr + dataChunk->size > wavEnd )
     {
         return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
     }
 
-    *pwfx = reinterpret_cast<const WAVEFORMATEX*>( wf );
     *pdata = ptr;
     *dataSize = dataChunk->size;
     return S_OK;
@@ -301,107 +368,103 @@ static HRESULT WaveFindFormatAndData( _In_reads_bytes_(wavDataSize) const uint8_
 
 
 //--------------------------------------------------------------------------------------
-static HRESULT WaveFindLoopInfo( _In_reads_bytes_(wavDataSize) const uint8_t* wavData, _In_ size_t wavDataSize,
-                                 _Out_ uint32_t* pLoopStart, _Out_ uint32_t* pLoopLength )
+static bool FindDLSLoop( _In_ const RIFFChunk* dlsChunk, _Out_ uint32_t* pLoopStart, _Out_ uint32_t* pLoopLength )
 {
-    if ( !wavData || !pLoopStart || !pLoopLength )
-        return E_POINTER;
+    auto ptr = reinterpret_cast<const uint8_t*>( dlsChunk ) + sizeof( RIFFChunk );
 
-    if (wavDataSize < ( sizeof(RIFFChunk) + sizeof(uint32_t) ) )
+    if ( dlsChunk->size >= sizeof(RIFFDLSSample) )
     {
-        return E_FAIL;
+        auto dlsSample = reinterpret_cast<const RIFFDLSSample*>( ptr );
+
+        if ( dlsChunk->size >= ( uint64_t( dlsSample->size ) + uint64_t( dlsSample->loopCount ) * sizeof(DLSLoop) ) )
+        {
+            auto loops = reinterpret_cast<const DLSLoop*>( ptr + dlsSample->size );
+            for( uint32_t j = 0; j < dlsSample->loopCount; ++j )
+            {
+                if ( ( loops[j].loopType == DLSLoop::LOOP_TYPE_FORWARD || loops[j].loopType == DLSLoop::LOOP_TYPE_RELEASE ) )
+                {
+                    // Return 'forward' loop
+                    *pLoopStart = loops[j].loopStart;
+                    *pLoopLength = loops[j].loopLength;
+                    return true;
+                }
+            }
+        }
     }
 
-    *pLoopStart = 0;
-    *pLoopLength = 0;
+    return false;
+}
 
-    const uint8_t* wavEnd = wavData + wavDataSize;
 
-    // Locate RIFF 'WAVE'
-    auto riffChunk = FindChunk( wavData, wavDataSize, FOURCC_RIFF_TAG );
-    if ( !riffChunk || riffChunk->size < 4 )
+//--------------------------------------------------------------------------------------
+static bool FindMIDILoop( _In_ const RIFFChunk* midiChunk, _Out_ uint32_t* pLoopStart, _Out_ uint32_t* pLoopLength )
+{
+    auto ptr = reinterpret_cast<const uint8_t*>( midiChunk ) + sizeof( RIFFChunk );
+
+    if ( midiChunk->size >= sizeof(RIFFMIDISample) )
     {
-        return E_FAIL;
+        auto midiSample = reinterpret_cast<const RIFFMIDISample*>( ptr );
+
+        if ( midiChunk->size >= ( sizeof(RIFFMIDISample) + uint64_t( midiSample->loopCount ) * sizeof(MIDILoop) ) )
+        {
+            auto loops = reinterpret_cast<const MIDILoop*>( ptr + sizeof(RIFFMIDISample) );
+            for( uint32_t j = 0; j < midiSample->loopCount; ++j )
+            {
+                if ( loops[j].type == MIDILoop::LOOP_TYPE_FORWARD )
+                {
+                    // Return 'forward' loop
+                    *pLoopStart = loops[j].start;
+                    *pLoopLength = loops[j].end + loops[j].start + 1;
+                    return true;
+                }
+            }
+        }
     }
 
-    auto riffHeader = reinterpret_cast<const RIFFChunkHeader*>( riffChunk );
-    if ( riffHeader->riff == FOURCC_XWMA_FILE_TAG )
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------
+static HRESULT WaveFindLoopInfo( _In_ const ChunkIndex& index, _In_ const uint8_t* wavEnd,
+                                 _Out_ uint32_t* pLoopStart, _Out_ uint32_t* pLoopLength )
+{
+    if ( !pLoopStart || !pLoopLength )
+        return E_POINTER;
+
+    *pLoopStart = 0;
+    *pLoopLength = 0;
+
+    if ( index.riff->riff == FOURCC_XWMA_FILE_TAG )
     {
         // xWMA files do not contain loop information
         return S_OK;
     }
 
-    if ( riffHeader->riff != FOURCC_WAVE_FILE_TAG )
-    {
-        return E_FAIL;
-    }
-
     // Locate 'wsmp' (DLS Chunk)
-    auto ptr = reinterpret_cast<const uint8_t*>( riffHeader ) + sizeof(RIFFChunkHeader);
-    if ( ( ptr + sizeof(RIFFChunk) ) > wavEnd )
+    if ( index.dls )
     {
-        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
-    }
-
-    auto dlsChunk = FindChunk( ptr, riffChunk->size, FOURCC_DLS_SAMPLE );
-    if ( dlsChunk )
-    {
-        ptr = reinterpret_cast<const uint8_t*>( dlsChunk ) + sizeof( RIFFChunk );
-        if ( ptr + dlsChunk->size > wavEnd )
+        auto ptr = reinterpret_cast<const uint8_t*>( index.dls ) + sizeof( RIFFChunk );
+        if ( ptr + index.dls->size > wavEnd )
         {
             return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
         }
 
-        if ( dlsChunk->size >= sizeof(RIFFDLSSample) )
-        {
-            auto dlsSample = reinterpret_cast<const RIFFDLSSample*>( ptr );
-
-            if ( dlsChunk->size >= ( dlsSample->size + dlsSample->loopCount * sizeof(DLSLoop) ) )
-            {
-                auto loops = reinterpret_cast<const DLSLoop*>( ptr + dlsSample->size );
-                for( uint32_t j = 0; j < dlsSample->loopCount; ++j )
-                {
-                    if ( ( loops[j].loopType == DLSLoop::LOOP_TYPE_FORWARD || loops[j].loopType == DLSLoop::LOOP_TYPE_RELEASE ) )
-                    {
-                        // Return 'forward' loop
-                        *pLoopStart = loops[j].loopStart;
-                        *pLoopLength = loops[j].loopLength;
-                        return S_OK;
-                    }
-                }
-            }
-        }
+        if ( FindDLSLoop( index.dls, pLoopStart, pLoopLength ) )
+            return S_OK;
     }
 
     // Locate 'smpl' (Sample Chunk)
-    auto midiChunk = FindChunk( ptr, riffChunk->size, FOURCC_MIDI_SAMPLE );
-    if ( midiChunk )
+    if ( index.midi )
     {
-        ptr = reinterpret_cast<const uint8_t*>( midiChunk ) + sizeof( RIFFChunk );
-        if ( ptr + midiChunk->size > wavEnd )
+        auto ptr = reinterpret_cast<const uint8_t*>( index.midi ) + sizeof( RIFFChunk );
+        if ( ptr + index.midi->size > wavEnd )
         {
             return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
         }
 
-        if ( midiChunk->size >= sizeof(RIFFMIDISample) )
-        {
-            auto midiSample = reinterpret_cast<const RIFFMIDISample*>( ptr );
-
-            if ( midiChunk->size >= ( sizeof(RIFFMIDISample) + midiSample->loopCount * sizeof(MIDILoop) ) )
-            {
-                auto loops = reinterpret_cast<const MIDILoop*>( ptr + sizeof(RIFFMIDISample) );
-                for( uint32_t j = 0; j < midiSample->loopCount; ++j )
-                {
-                    if ( loops[j].type == MIDILoop::LOOP_TYPE_FORWARD )
-                    {
-                        // Return 'forward' loop
-                        *pLoopStart = loops[j].start;
-                        *pLoopLength = loops[j].end + loops[j].start + 1;
-                        return S_OK;
-                    }
-                }
-            }
-        }
+        if ( FindMIDILoop( index.midi, pLoopStart, pLoopLength ) )
+            return S_OK;
     }
 
     return S_OK;
@@ -409,46 +472,18 @@ static HRESULT WaveFindLoopInfo( _In_reads_bytes_(wavDataSize) const uint8_t* wa
 
 
 //--------------------------------------------------------------------------------------
-static HRESULT WaveFindTable( _In_reads_bytes_(wavDataSize) const uint8_t* wavData, _In_ size_t wavDataSize, _In_ uint32_t tag,
+static HRESULT WaveFindTable( _In_opt_ const RIFFChunk* tableChunk, _In_ const uint8_t* wavEnd,
                               _Outptr_result_maybenull_ const uint32_t** pData, _Out_ uint32_t* dataCount )
 {
-    if ( !wavData || !pData || !dataCount )
+    if ( !pData || !dataCount )
         return E_POINTER;
 
-    if (wavDataSize < ( sizeof(RIFFChunk) + sizeof(uint32_t) ) )
-    {
-        return E_FAIL;
-    }
-
     *pData = nullptr;
     *dataCount = 0;
 
-    const uint8_t* wavEnd = wavData + wavDataSize;
-
-    // Locate RIFF 'WAVE'
-    auto riffChunk = FindChunk( wavData, wavDataSize, FOURCC_RIFF_TAG );
-    if ( !riffChunk || riffChunk->size < 4 )
-    {
-        return E_FAIL;
-    }
-
-    auto riffHeader = reinterpret_cast<const RIFFChunkHeader*>( riffChunk );
-    if ( riffHeader->riff != FOURCC_WAVE_FILE_TAG && riffHeader->riff != FOURCC_XWMA_FILE_TAG )
-    {
-        return E_FAIL;
-    }
-
-    // Locate tag
-    auto ptr = reinterpret_cast<const uint8_t*>( riffHeader ) + sizeof(RIFFChunkHeader);
-    if ( ( ptr + sizeof(RIFFChunk) ) > wavEnd )
-    {
-        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
-    }
-
-    auto tableChunk = FindChunk( ptr, riffChunk->size, tag );
     if ( tableChunk )
     {
-        ptr = reinterpret_cast<const uint8_t*>( tableChunk ) + sizeof( RIFFChunk );
+        auto ptr = reinterpret_cast<const uint8_t*>( tableChunk ) + sizeof( RIFFChunk );
         if ( ptr + tableChunk->size > wavEnd )
         {
             return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
@@ -468,11 +503,82 @@ static HRESULT WaveFindTable( _In_reads_bytes_(wavDataSize) const uint8_t* wavDa
 
 
 //--------------------------------------------------------------------------------------
-static HRESULT LoadAudioFromFile( _In_z_ const wchar_t* szFileName, _Inout_ std::unique_ptr<uint8_t[]>& wavData, _Out_ DWORD* bytesRead )
+static HRESULT WaveParse( _In_reads_bytes_(wavDataSize) const uint8_t* wavData, _In_ size_t wavDataSize, _In_ bool findData,
+                          _Out_ WAVData& result )
+{
+    ChunkIndex index;
+    HRESULT hr = IndexChunks( wavData, wavDataSize, index );
+    if ( FAILED(hr) )
+        return hr;
+
+    const uint8_t* wavEnd = wavData + wavDataSize;
+
+    bool dpds, seek;
+    hr = WaveFindFormat( index, wavEnd, &result.wfx, dpds, seek );
+    if ( FAILED(hr) )
+        return hr;
+
+    if ( findData )
+    {
+        hr = WaveFindData( index, wavEnd, &result.startAudio, &result.audioBytes );
+        if ( FAILED(hr) )
+            return hr;
+    }
+
+    hr = WaveFindLoopInfo( index, wavEnd, &result.loopStart, &result.loopLength );
+    if ( FAILED(hr) )
+        return hr;
+
+    if ( dpds )
+    {
+        hr = WaveFindTable( index.dpds, wavEnd, &result.seek, &result.seekCount );
+        if ( FAILED(hr) )
+            return hr;
+    }
+    else if ( seek )
+    {
+        hr = WaveFindTable( index.seek, wavEnd, &result.seek, &result.seekCount );
+        if ( FAILED(hr) )
+            return hr;
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+static HRESULT ReadFileAt( _In_ HANDLE hFile, _In_ uint64_t offset, _Out_writes_bytes_(bytes) void* dest, _In_ DWORD bytes )
+{
+    OVERLAPPED request = {};
+    request.Offset = static_cast<DWORD>( offset );
+    request.OffsetHigh = static_cast<DWORD>( offset >> 32 );
+
+    DWORD bytesRead = 0;
+    if ( !ReadFile( hFile, dest, bytes, &bytesRead, &request ) )
+    {
+        return HRESULT_FROM_WIN32( GetLastError() );
+    }
+
+    return ( bytesRead < bytes ) ? HRESULT_FROM_WIN32( ERROR_HANDLE_EOF ) : S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Reads the chunks used by the loader from a .wav file into a minimal RIFF image, reading just the header of every
+// other chunk (such as large 'LIST' or 'bext' metadata) to skip over it. The scan stops as soon as the format,
+// audio data, loop and seek chunks have all been found. The 'data' chunk goes last in the image, and is only
+// included if readAudio is set; its location in the file is returned either way.
+static HRESULT ScanAudioFile( _In_z_ const wchar_t* szFileName, _In_ bool readAudio,
+                              _Inout_ std::unique_ptr<uint8_t[]>& wavData, _Out_ DWORD* imageSize,
+                              _Out_ uint64_t* audioOffset, _Out_ uint32_t* audioBytes )
 {
     if ( !szFileName )
         return E_INVALIDARG;
 
+    *imageSize = 0;
+    *audioOffset = 0;
+    *audioBytes = 0;
+
     // open the file
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
     ScopedHandle hFile( safe_handle( CreateFile2( szFileName,
@@ -514,25 +620,187 @@ static HRESULT LoadAudioFromFile( _In_z_ const wchar_t* szFileName, _Inout_ std:
         return E_FAIL;
     }
 
-    // create enough space for the file data
-    wavData.reset( new (std::nothrow) uint8_t[ fileInfo.EndOfFile.LowPart ] );
+    const uint64_t fileSize = fileInfo.EndOfFile.LowPart;
+
+    // Locate RIFF 'WAVE'
+    RIFFChunkHeader riffHeader;
+    uint64_t pos = 0;
+    for(;;)
+    {
+        if ( ( pos + sizeof(RIFFChunkHeader) ) > fileSize )
+        {
+            return E_FAIL;
+        }
+
+        HRESULT hr = ReadFileAt( hFile.get(), pos, &riffHeader, sizeof(RIFFChunkHeader) );
+        if ( FAILED(hr) )
+            return hr;
+
+        if ( riffHeader.tag == FOURCC_RIFF_TAG )
+            break;
+
+        pos += sizeof(RIFFChunk) + riffHeader.size;
+    }
+
+    if ( riffHeader.size < 4 || ( riffHeader.riff != FOURCC_WAVE_FILE_TAG && riffHeader.riff != FOURCC_XWMA_FILE_TAG ) )
+    {
+        return E_FAIL;
+    }
+
+    const uint64_t end = std::min( pos + sizeof(RIFFChunk) + riffHeader.size, fileSize );
+    pos += sizeof(RIFFChunkHeader);
+
+    std::vector<uint8_t> image( sizeof(RIFFChunkHeader) );
+    memcpy( image.data(), &riffHeader, sizeof(RIFFChunkHeader) );
+
+    // Only the presence of each chunk is tracked while scanning, as the image moves while it grows
+    static const RIFFChunk s_found = {};
+    ChunkIndex found = {};
+    RIFFChunk dataChunk = {};
+    uint64_t dataOffset = 0;
+
+    // xWMA files do not contain loop information
+    bool loopFound = ( riffHeader.riff == FOURCC_XWMA_FILE_TAG );
+    uint32_t tableTag = 0;
+
+    while ( end > ( pos + sizeof(RIFFChunk) ) )
+    {
+        RIFFChunk header;
+        HRESULT hr = ReadFileAt( hFile.get(), pos, &header, sizeof(RIFFChunk) );
+        if ( FAILED(hr) )
+            return hr;
+
+        const uint64_t payload = pos + sizeof(RIFFChunk);
+
+        auto slot = IndexSlot( found, header.tag );
+        if ( slot && !*slot )
+        {
+            if ( header.tag == FOURCC_DATA_TAG )
+            {
+                *slot = &s_found;
+                dataChunk = header;
+                dataOffset = payload;
+            }
+            else if ( ( payload + header.size ) > fileSize )
+            {
+                // A truncated format is an error, but any other truncated chunk is left out
+                if ( header.tag == FOURCC_FORMAT_TAG )
+                {
+                    return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+                }
+
+                // The chunk runs to the end of the file, so there is nothing after it
+                break;
+            }
+            else
+            {
+                *slot = &s_found;
+
+                size_t chunkStart = image.size();
+                image.resize( chunkStart + sizeof(RIFFChunk) + header.size );
+                memcpy( &image[ chunkStart ], &header, sizeof(RIFFChunk) );
+
+                if ( header.size > 0 )
+                {
+                    hr = ReadFileAt( hFile.get(), payload, &image[ chunkStart + sizeof(RIFFChunk) ], header.size );
+                    if ( FAILED(hr) )
+                        return hr;
+                }
+
+                auto chunk = reinterpret_cast<const RIFFChunk*>( &image[ chunkStart ] );
+                uint32_t loopStart, loopLength;
+
+                switch( header.tag )
+                {
+                case FOURCC_FORMAT_TAG:
+                    {
+                        // Validating the format now fails early for unsupported files, and says which seek table is needed
+                        ChunkIndex index;
+                        hr = IndexChunks( image.data(), image.size(), index );
+                        if ( FAILED(hr) )
+                            return hr;
+
+                        const WAVEFORMATEX* wfx;
+                        bool dpds, seek;
+                        hr = WaveFindFormat( index, image.data() + image.size(), &wfx, dpds, seek );
+                        if ( FAILED(hr) )
+                            return hr;
+
+                        tableTag = dpds ? FOURCC_XWMA_DPDS : ( seek ? FOURCC_XMA_SEEK : 0 );
+                    }
+                    break;
+
+                case FOURCC_DLS_SAMPLE:
+                    // 'wsmp' takes precedence over 'smpl' wherever it appears, so only a forward loop in 'wsmp' ends the search
+                    if ( FindDLSLoop( chunk, &loopStart, &loopLength ) )
+                        loopFound = true;
+                    break;
+                }
+            }
+        }
+
+        bool tableFound = !tableTag || ( tableTag == FOURCC_XWMA_DPDS && found.dpds ) || ( tableTag == FOURCC_XMA_SEEK && found.seek );
+        if ( found.fmt && found.data && loopFound && tableFound )
+            break;
+
+        if ( header.size >= ( end - payload ) )
+            break;
+
+        pos = payload + header.size;
+    }
+
+    if ( !found.fmt )
+    {
+        return E_FAIL;
+    }
+
+    if ( !found.data || !dataChunk.size )
+    {
+        return HRESULT_FROM_WIN32( ERROR_INVALID_DATA );
+    }
+
+    if ( ( dataOffset + dataChunk.size ) > fileSize )
+    {
+        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+    }
+
+    uint64_t totalSize = image.size();
+    if ( readAudio )
+    {
+        totalSize += sizeof(RIFFChunk) + dataChunk.size;
+    }
+
+    if ( totalSize > UINT32_MAX )
+    {
+        return E_FAIL;
+    }
+
+    // create enough space for the chunks
+    wavData.reset( new (std::nothrow) uint8_t[ static_cast<size_t>( totalSize ) ] );
     if (!wavData)
     {
         return E_OUTOFMEMORY;
     }
 
-    // read the data in
-    if (!ReadFile( hFile.get(),
-                   wavData.get(),
-                   fileInfo.EndOfFile.LowPart,
-                   bytesRead,
-                   nullptr
-                   ))
+    memcpy( wavData.get(), image.data(), image.size() );
+
+    if ( readAudio )
     {
-        return HRESULT_FROM_WIN32( GetLastError() );
+        memcpy( wavData.get() + image.size(), &dataChunk, sizeof(RIFFChunk) );
+
+        HRESULT hr = ReadFileAt( hFile.get(), dataOffset, wavData.get() + image.size() + sizeof(RIFFChunk), dataChunk.size );
+        if ( FAILED(hr) )
+            return hr;
     }
 
-    return (*bytesRead < fileInfo.EndOfFile.LowPart) ? E_FAIL : S_OK;
+    // The form now only holds the chunks which were kept
+    reinterpret_cast<RIFFChunkHeader*>( wavData.get() )->size = static_cast<uint32_t>( totalSize - sizeof(RIFFChunk) );
+
+    *imageSize = static_cast<DWORD>( totalSize );
+    *audioOffset = dataOffset;
+    *audioBytes = dataChunk.size;
+
+    return S_OK;
 }
 
 
@@ -557,8 +825,17 @@ HRESULT DirectX::LoadWAVAudioInMemory( const uint8_t* wavData,
         return E_FAIL;
     }
 
+    ChunkIndex index;
+    HRESULT hr = IndexChunks( wavData, wavDataSize, index );
+    if ( FAILED(hr) )
+        return hr;
+
     bool dpds, seek;
-    HRESULT hr = WaveFindFormatAndData( wavData, wavDataSize, wfx, startAudio, audioBytes, dpds, seek );
+    hr = WaveFindFormat( index, wavData + wavDataSize, wfx, dpds, seek );
+    if ( FAILED(hr) )
+        return hr;
+
+    hr = WaveFindData( index, wavData + wavDataSize, startAudio, audioBytes );
     if ( FAILED(hr) )
         return hr;
 
@@ -582,14 +859,25 @@ HRESULT DirectX::LoadWAVAudioFromFile( const wchar_t* szFileName,
     *audioBytes = 0;
 
     DWORD bytesRead = 0;
-    HRESULT hr = LoadAudioFromFile( szFileName, wavData, &bytesRead );
+    uint64_t audioOffset;
+    uint32_t audioLength;
+    HRESULT hr = ScanAudioFile( szFileName, true, wavData, &bytesRead, &audioOffset, &audioLength );
     if ( FAILED(hr) )
     {
         return hr;
     }
 
+    ChunkIndex index;
+    hr = IndexChunks( wavData.get(), bytesRead, index );
+    if ( FAILED(hr) )
+        return hr;
+
     bool dpds, seek;
-    hr = WaveFindFormatAndData( wavData.get(), bytesRead, wfx, startAudio, audioBytes, dpds, seek );
+    hr = WaveFindFormat( index, wavData.get() + bytesRead, wfx, dpds, seek );
+    if ( FAILED(hr) )
+        return hr;
+
+    hr = WaveFindData( index, wavData.get() + bytesRead, startAudio, audioBytes );
     if ( FAILED(hr) )
         return hr;
 
@@ -612,29 +900,7 @@ HRESULT DirectX::LoadWAVAudioInMemoryEx( const uint8_t* wavData, size_t wavDataS
         return E_FAIL;
     }
 
-    bool dpds, seek;
-    HRESULT hr = WaveFindFormatAndData( wavData, wavDataSize, &result.wfx, &result.startAudio, &result.audioBytes, dpds, seek );
-    if ( FAILED(hr) )
-        return hr;
-
-    hr = WaveFindLoopInfo( wavData, wavDataSize, &result.loopStart, &result.loopLength );
-    if ( FAILED(hr) )
-        return hr;
-
-    if ( dpds )
-    {
-        hr = WaveFindTable( wavData, wavDataSize, FOURCC_XWMA_DPDS, &result.seek, &result.seekCount );
-        if ( FAILED(hr) )
-            return hr;
-    }
-    else if ( seek )
-    {
-        hr = WaveFindTable( wavData, wavDataSize, FOURCC_XMA_SEEK, &result.seek, &result.seekCount );
-        if ( FAILED(hr) )
-            return hr;
-    }
-
-    return S_OK;
+    return WaveParse( wavData, wavDataSize, true, result );
 }
 
 
@@ -648,34 +914,42 @@ HRESULT DirectX::LoadWAVAudioFromFileEx( const wchar_t* szFileName, std::unique_
     memset( &result, 0, sizeof(result) );
 
     DWORD bytesRead = 0;
-    HRESULT hr = LoadAudioFromFile( szFileName, wavData, &bytesRead );
+    uint64_t audioOffset;
+    uint32_t audioBytes;
+    HRESULT hr = ScanAudioFile( szFileName, true, wavData, &bytesRead, &audioOffset, &audioBytes );
     if ( FAILED(hr) )
     {
         return hr;
     }
 
-    bool dpds, seek;
-    hr = WaveFindFormatAndData( wavData.get(), bytesRead, &result.wfx, &result.startAudio, &result.audioBytes, dpds, seek );
+    return WaveParse( wavData.get(), bytesRead, true, result );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::LoadWAVInfoFromFile( const wchar_t* szFileName, std::unique_ptr<uint8_t[]>& wavData, DirectX::WAVData& result, uint64_t* audioOffset )
+{
+    if ( !szFileName || !audioOffset )
+        return E_INVALIDARG;
+
+    memset( &result, 0, sizeof(result) );
+    *audioOffset = 0;
+
+    DWORD bytesRead = 0;
+    uint64_t offset;
+    uint32_t audioBytes;
+    HRESULT hr = ScanAudioFile( szFileName, false, wavData, &bytesRead, &offset, &audioBytes );
     if ( FAILED(hr) )
+    {
         return hr;
+    }
 
-    hr = WaveFindLoopInfo( wavData.get(), bytesRead, &result.loopStart, &result.loopLength );
+    hr = WaveParse( wavData.get(), bytesRead, false, result );
     if ( FAILED(hr) )
         return hr;
 
-    if ( dpds )
-    {
-        hr = WaveFindTable( wavData.get(), bytesRead, FOURCC_XWMA_DPDS, &result.seek, &result.seekCount );
-        if ( FAILED(hr) )
-            return hr;
-    }
-    else if ( seek )
-    {
-        hr = WaveFindTable( wavData.get(), bytesRead, FOURCC_XMA_SEEK, &result.seek, &result.seekCount );
-        if ( FAILED(hr) )
-            return hr;
-    }
-
+    result.audioBytes = audioBytes;
+    *audioOffset = offset;
     return S_OK;
 }
-
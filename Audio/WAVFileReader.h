@@ -52,4 +52,10 @@ namespace DirectX
     HRESULT LoadWAVAudioFromFileEx( _In_z_ const wchar_t* szFileName, 
                                     _Inout_ std::unique_ptr<uint8_t[]>& wavData,
                                     _Out_ WAVData& result );
+
+    HRESULT LoadWAVInfoFromFile( _In_z_ const wchar_t* szFileName,
+                                 _Inout_ std::unique_ptr<uint8_t[]>& wavData,
+                                 _Out_ WAVData& result,
+                                 _Out_ uint64_t* audioOffset );
+        // Reads everything but the audio data, so result.startAudio is null; the audio is result.audioBytes at audioOffset in the file
 }
\ No newline at end of file
@@ -55,6 +55,19 @@ public:
             mInstances.clear();
         }
 
+        if ( !mStreamInstances.empty() )
+        {
+            DebugTrace( "WARNING: Destroying WaveBank \"%hs\" with %Iu outstanding SoundStreamInstances\n", mReader.BankName(), mStreamInstances.size() );
+
+            for( auto it = mStreamInstances.begin(); it != mStreamInstances.end(); ++it )
+            {
+                assert( *it != 0 );
+                (*it)->OnDestroyParent();
+            }
+
+            mStreamInstances.clear();
+        }
+
         if ( mOneShots > 0 )
         {
             DebugTrace( "WARNING: Destroying WaveBank \"%hs\" with %u outstanding one shot effects\n", mReader.BankName(), mOneShots );
@@ -67,10 +80,12 @@ public:
         }
     }
 
-    HRESULT Initialize( _In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName );
+    HRESULT Initialize( _In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName, WAVE_BANK_FLAGS flags );
 
     void Play( int index, float volume, float pitch, float pan );
 
+    bool GetStreamData( uint32_t index, WaveBankStreamData& data ) const;
+
     // IVoiceNotify
     virtual void __cdecl OnBufferEnd() override
     {
@@ -121,6 +136,7 @@ public:
 
     AudioEngine*                        mEngine;
     std::list<SoundEffectInstance*>     mInstances;
+    std::list<SoundStreamInstance*>     mStreamInstances;
     WaveBankReader                      mReader;
     uint32_t                            mOneShots;
     bool                                mPrepared;
@@ -129,12 +145,12 @@ public:
 
 
 _Use_decl_annotations_
-HRESULT WaveBank::Impl::Initialize( AudioEngine* engine, const wchar_t* wbFileName )
+HRESULT WaveBank::Impl::Initialize( AudioEngine* engine, const wchar_t* wbFileName, WAVE_BANK_FLAGS flags )
 {
     if ( !engine || !wbFileName )
         return E_INVALIDARG;
 
-    HRESULT hr = mReader.Open( wbFileName );
+    HRESULT hr = mReader.Open( wbFileName, ( flags & WaveBank_MemoryMapped ) != 0 );
     if ( FAILED(hr) )
         return hr;
 
@@ -246,16 +262,43 @@ void WaveBank::Impl::Play( int index, float volume, float pitch, float pan )
 }
 
 
+// Gathers what a SoundStreamInstance needs to read an entry straight from the file.
+bool WaveBank::Impl::GetStreamData( uint32_t index, WaveBankStreamData& data ) const
+{
+    memset( &data, 0, sizeof(WaveBankStreamData) );
+
+    if ( index >= mReader.Count() || !mStreaming )
+        return false;
+
+    data.async = mReader.GetAsyncHandle();
+
+    HRESULT hr = mReader.GetWaveDataOffset( index, data.fileOffset, data.lengthBytes );
+    if ( FAILED(hr) )
+        return false;
+
+    WaveBankReader::Metadata metadata;
+    hr = mReader.GetMetadata( index, metadata );
+    if ( FAILED(hr) )
+        return false;
+
+    data.loopStart = metadata.loopStart;
+    data.loopLength = metadata.loopLength;
+
+    hr = mReader.GetSeekTable( index, &data.seekTable, data.seekCount, data.tag );
+    return SUCCEEDED(hr);
+}
+
+
 //--------------------------------------------------------------------------------------
 // WaveBank
 //--------------------------------------------------------------------------------------
 
 // Public constructors.
 _Use_decl_annotations_
-WaveBank::WaveBank( AudioEngine* engine, const wchar_t* wbFileName )
+WaveBank::WaveBank( AudioEngine* engine, const wchar_t* wbFileName, WAVE_BANK_FLAGS flags )
   : pImpl(new Impl(engine) )
 {
-    HRESULT hr = pImpl->Initialize( engine, wbFileName );
+    HRESULT hr = pImpl->Initialize( engine, wbFileName, flags );
     if ( FAILED(hr) )
     {
         DebugTrace( "ERROR: WaveBank failed (%08X) to intialize from .xwb file \"%ls\"\n", hr, wbFileName );
@@ -333,7 +376,7 @@ std::unique_ptr<SoundEffectInstance> WaveBank::CreateInstance( int index, SOUND_
 
     if ( pImpl->mStreaming )
     {
-        DebugTrace( "ERROR: SoundEffectInstances can only be created from an in-memory wave bank\n");
+        DebugTrace( "ERROR: SoundEffectInstances can only be created from an in-memory wave bank, use CreateStreamInstance instead\n");
         throw std::exception( "WaveBank::CreateInstance" );
     }
 
@@ -369,6 +412,77 @@ std::unique_ptr<SoundEffectInstance> WaveBank::CreateInstance( _In_z_ const char
 }
 
 
+std::unique_ptr<SoundStreamInstance> WaveBank::CreateStreamInstance( int index, SOUND_EFFECT_INSTANCE_FLAGS flags )
+{
+    auto& wb = pImpl->mReader;
+
+    if ( !pImpl->mStreaming )
+    {
+        DebugTrace( "ERROR: SoundStreamInstances can only be created from a streaming wave bank\n");
+        throw std::exception( "WaveBank::CreateStreamInstance" );
+    }
+
+    if ( index < 0 || uint32_t(index) >= wb.Count() )
+    {
+        // We don't throw an exception here as titles often simply ignore missing assets rather than fail
+        return std::unique_ptr<SoundStreamInstance>();
+    }
+
+    if ( !pImpl->mPrepared )
+    {
+        wb.WaitOnPrepare();
+        pImpl->mPrepared = true;
+    }
+
+    WaveBankStreamData data;
+    if ( !pImpl->GetStreamData( index, data ) )
+        throw std::exception( "WaveBank::CreateStreamInstance" );
+
+    auto effect = new SoundStreamInstance( pImpl->mEngine, this, index, flags, data );
+    assert( effect != 0 );
+    pImpl->mStreamInstances.emplace_back( effect );
+    return std::unique_ptr<SoundStreamInstance>( effect );
+}
+
+
+std::unique_ptr<SoundStreamInstance> WaveBank::CreateStreamInstance( _In_z_ const char* name, SOUND_EFFECT_INSTANCE_FLAGS flags )
+{
+    int index = static_cast<int>( pImpl->mReader.Find( name ) );
+    if ( index == -1 )
+    {
+        // We don't throw an exception here as titles often simply ignore missing assets rather than fail
+        return std::unique_ptr<SoundStreamInstance>();
+    }
+
+    return CreateStreamInstance( index, flags );
+}
+
+
+void WaveBank::Prefetch( int index )
+{
+    if ( pImpl->mStreaming || index < 0 || uint32_t(index) >= pImpl->mReader.Count() )
+        return;
+
+    HRESULT hr = pImpl->mReader.PrefetchWaveData( index );
+    if ( FAILED(hr) )
+    {
+        // Only a hint, so a failure just means the wave is paged in when it plays
+        DebugTrace( "WARNING: WaveBank failed (%08X) to prefetch wave data for index %d\n", hr, index );
+    }
+}
+
+
+_Use_decl_annotations_
+void WaveBank::Prefetch( const char* name )
+{
+    int index = static_cast<int>( pImpl->mReader.Find( name ) );
+    if ( index == -1 )
+        return;
+
+    Prefetch( index );
+}
+
+
 void WaveBank::UnregisterInstance( _In_ SoundEffectInstance* instance )
 {
     auto it = std::find( pImpl->mInstances.begin(), pImpl->mInstances.end(), instance );
@@ -379,6 +493,16 @@ void WaveBank::UnregisterInstance( _In_ SoundEffectInstance* instance )
 }
 
 
+void WaveBank::UnregisterInstance( _In_ SoundStreamInstance* instance )
+{
+    auto it = std::find( pImpl->mStreamInstances.begin(), pImpl->mStreamInstances.end(), instance );
+    if ( it == pImpl->mStreamInstances.end() )
+        return;
+
+    pImpl->mStreamInstances.erase( it );
+}
+
+
 // Public accessors.
 bool WaveBank::IsPrepared() const
 {
@@ -395,7 +519,7 @@ bool WaveBank::IsPrepared() const
 
 bool WaveBank::IsInUse() const
 {
-    return ( pImpl->mOneShots > 0 ) || !pImpl->mInstances.empty();
+    return ( pImpl->mOneShots > 0 ) || !pImpl->mInstances.empty() || !pImpl->mStreamInstances.empty();
 }
 
 
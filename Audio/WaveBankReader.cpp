@@ -431,7 +431,10 @@ class WaveBankReader::Impl
 public:
     Impl() :
         m_async( INVALID_HANDLE_VALUE ),
-        m_prepared(false)
+        m_prepared(false),
+        m_mappedView(nullptr),
+        m_mappedWaveData(nullptr),
+        m_prefetchWork(nullptr)
 #if defined(_XBOX_ONE) && defined(_TITLE)
         , m_xmaMemory(nullptr)
 #endif
@@ -443,21 +446,27 @@ public:
 
     ~Impl() { Close(); }
 
-    HRESULT Open( _In_z_ const wchar_t* szFileName );
+    HRESULT Open( _In_z_ const wchar_t* szFileName, bool memoryMapped );
     void Close();
 
     HRESULT GetFormat( _In_ uint32_t index, _Out_writes_bytes_(maxsize) WAVEFORMATEX* pFormat, _In_ size_t maxsize ) const;
 
     HRESULT GetWaveData( _In_ uint32_t index, _Outptr_ const uint8_t** pData, _Out_ uint32_t& dataSize ) const;
 
+    HRESULT GetWaveDataOffset( _In_ uint32_t index, _Out_ uint32_t& fileOffset, _Out_ uint32_t& dataSize ) const;
+
     HRESULT GetSeekTable( _In_ uint32_t index, _Out_ const uint32_t** pData, _Out_ uint32_t& dataCount, _Out_ uint32_t& tag ) const;
 
     HRESULT GetMetadata( _In_ uint32_t index, _Out_ Metadata& metadata ) const;
 
+    HRESULT PrefetchWaveData( _In_ uint32_t index ) const;
+
     bool UpdatePrepared();
 
     void Clear()
     {
+        CancelPrefetch();
+
         memset( &m_header, 0, sizeof(HEADER) );
         memset( &m_data, 0, sizeof(BANKDATA ) );
 
@@ -466,6 +475,13 @@ public:
         m_seekData.reset();
         m_waveData.reset();
 
+        if ( m_mappedView )
+        {
+            UnmapViewOfFile( m_mappedView );
+            m_mappedView = nullptr;
+        }
+        m_mappedWaveData = nullptr;
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
         if ( m_xmaMemory )
         {
@@ -485,10 +501,23 @@ public:
     std::map<std::string, uint32_t>     m_names;
 
 private:
+    void CancelPrefetch();
+
+    static void CALLBACK PrefetchCallback( PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK );
+
     std::unique_ptr<uint8_t[]>          m_entries;
     std::unique_ptr<uint8_t[]>          m_seekData;
     std::unique_ptr<uint8_t[]>          m_waveData;
 
+    // Read-only view of the whole file, and the wave data segment within it, for memory mapped in-memory banks
+    void*                               m_mappedView;
+    const uint8_t*                      m_mappedWaveData;
+
+    // Wave data waiting to be paged in by the thread pool, where PrefetchVirtualMemory isn't available
+    mutable std::mutex                  m_prefetchMutex;
+    mutable std::vector<std::pair<const uint8_t*, uint32_t>> m_prefetchQueue;
+    mutable PTP_WORK                    m_prefetchWork;
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
 public:
     void*                               m_xmaMemory;
@@ -497,7 +526,7 @@ public:
 
 
 _Use_decl_annotations_
-HRESULT WaveBankReader::Impl::Open( const wchar_t* szFileName )
+HRESULT WaveBankReader::Impl::Open( const wchar_t* szFileName, bool memoryMapped )
 {
     Close();
     Clear();
@@ -845,8 +874,8 @@ HRESULT WaveBankReader::Impl::Open( const wchar_t* szFileName )
         // If in-memory, kick off read of wave data
         void *dest;
 
-#if defined(_XBOX_ONE) && defined(_TITLE)
         bool xma = false;
+#if defined(_XBOX_ONE) && defined(_TITLE)
         if ( m_data.dwFlags & BANKDATA::FLAGS_COMPACT )
         {
             if ( m_data.CompactFormat.wFormatTag == MINIWAVEFORMAT::TAG_XMA )
@@ -867,6 +896,7 @@ HRESULT WaveBankReader::Impl::Open( const wchar_t* szFileName )
 
         if ( xma )
         {
+            // XMA data has to live in memory the APU can read, so it is always copied
             HRESULT hr = ApuAlloc( &m_xmaMemory, nullptr, waveLen, SHAPE_XMA_INPUT_BUFFER_ALIGNMENT );
             if ( FAILED(hr) )
             {
@@ -878,6 +908,52 @@ HRESULT WaveBankReader::Impl::Open( const wchar_t* szFileName )
         }
         else
 #endif // _XBOX_ONE && _TITLE
+        if ( memoryMapped && !xma )
+        {
+            // Map the file read-only and use the wave data in place. Nothing is read until it is touched, and the
+            // pages are shared with any other process which maps the same bank.
+            FILE_STANDARD_INFO fileInfo;
+            if ( !GetFileInformationByHandleEx( hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo) ) )
+            {
+                return HRESULT_FROM_WIN32( GetLastError() );
+            }
+
+            uint64_t waveOffset = m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
+            if ( ( waveOffset + waveLen ) > uint64_t( fileInfo.EndOfFile.QuadPart ) )
+            {
+                return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+            }
+
+#if defined(WINAPI_FAMILY) && (WINAPI_FAMILY != WINAPI_FAMILY_DESKTOP_APP) && !(defined(_XBOX_ONE) && defined(_TITLE))
+            ScopedHandle hMapping( CreateFileMappingFromApp( hFile.get(), nullptr, PAGE_READONLY, 0, nullptr ) );
+#else
+            ScopedHandle hMapping( CreateFileMappingW( hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr ) );
+#endif
+            if ( !hMapping )
+            {
+                return HRESULT_FROM_WIN32( GetLastError() );
+            }
+
+            // Views must start on the allocation granularity, so map from the start of the file
+#if defined(WINAPI_FAMILY) && (WINAPI_FAMILY != WINAPI_FAMILY_DESKTOP_APP) && !(defined(_XBOX_ONE) && defined(_TITLE))
+            m_mappedView = MapViewOfFileFromApp( hMapping.get(), FILE_MAP_READ, 0, 0 );
+#else
+            m_mappedView = MapViewOfFile( hMapping.get(), FILE_MAP_READ, 0, 0, 0 );
+#endif
+            if ( !m_mappedView )
+            {
+                return HRESULT_FROM_WIN32( GetLastError() );
+            }
+
+            m_mappedWaveData = reinterpret_cast<const uint8_t*>( m_mappedView ) + waveOffset;
+
+            // Keep the file open so it can't be opened for writing while the view is in use
+            memset( &m_request, 0, sizeof(OVERLAPPED) );
+            m_async = hFile.release();
+            m_prepared = true;
+            return S_OK;
+        }
+        else
         {
             m_waveData.reset( new (std::nothrow) uint8_t[ waveLen ] );
             if ( !m_waveData )
@@ -911,6 +987,9 @@ HRESULT WaveBankReader::Impl::Open( const wchar_t* szFileName )
 
 void WaveBankReader::Impl::Close()
 {
+    // Prefetches touch the mapped view, so they have to be finished with before it is unmapped
+    CancelPrefetch();
+
     if ( m_async != INVALID_HANDLE_VALUE )
     {
         if ( m_request.hEvent != 0 )
@@ -930,6 +1009,13 @@ void WaveBankReader::Impl::Close()
     }
     m_event.reset();
 
+    if ( m_mappedView )
+    {
+        UnmapViewOfFile( m_mappedView );
+        m_mappedView = nullptr;
+    }
+    m_mappedWaveData = nullptr;
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
     if ( m_xmaMemory )
     {
@@ -1093,6 +1179,9 @@ HRESULT WaveBankReader::Impl::GetWaveData( uint32_t index, const uint8_t** pData
     const uint8_t* waveData = m_waveData.get();
 #endif
 
+    if ( m_mappedWaveData )
+        waveData = m_mappedWaveData;
+
     if ( !waveData )
         return E_FAIL;
 
@@ -1138,6 +1227,42 @@ HRESULT WaveBankReader::Impl::GetWaveData( uint32_t index, const uint8_t** pData
 }
 
 
+_Use_decl_annotations_
+HRESULT WaveBankReader::Impl::GetWaveDataOffset( uint32_t index, uint32_t& fileOffset, uint32_t& dataSize ) const
+{
+    if ( index >= m_data.dwEntryCount || !m_entries )
+    {
+        return E_FAIL;
+    }
+
+    DWORD dwOffset, dwLength;
+    if ( m_data.dwFlags & BANKDATA::FLAGS_COMPACT )
+    {
+        auto& entry = reinterpret_cast<const ENTRYCOMPACT*>( m_entries.get() )[ index ];
+
+        entry.ComputeLocations( dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>( m_entries.get() ) );
+    }
+    else
+    {
+        auto& entry = reinterpret_cast<const ENTRY*>( m_entries.get() )[ index ];
+
+        dwOffset = entry.PlayRegion.dwOffset;
+        dwLength = entry.PlayRegion.dwLength;
+    }
+
+    if ( ( uint64_t( dwOffset ) + dwLength ) > m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength )
+    {
+        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+    }
+
+    // Location of the wave data within the .xwb file itself, for streaming reads
+    fileOffset = m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset + dwOffset;
+    dataSize = dwLength;
+
+    return S_OK;
+}
+
+
 _Use_decl_annotations_
 HRESULT WaveBankReader::Impl::GetSeekTable( uint32_t index, const uint32_t** pData, uint32_t& dataCount, uint32_t& tag ) const
 {
@@ -1219,6 +1344,97 @@ HRESULT WaveBankReader::Impl::GetMetadata( uint32_t index, Metadata& metadata )
 }
 
 
+_Use_decl_annotations_
+HRESULT WaveBankReader::Impl::PrefetchWaveData( uint32_t index ) const
+{
+    // Wave data that was read in is already resident
+    if ( !m_mappedWaveData )
+        return S_FALSE;
+
+    const uint8_t* data = nullptr;
+    uint32_t dataSize = 0;
+    HRESULT hr = GetWaveData( index, &data, dataSize );
+    if ( FAILED(hr) )
+        return hr;
+
+    if ( !dataSize )
+        return S_FALSE;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) && (!defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP))
+    // Asks the memory manager to bring the pages in with large reads, without blocking on them
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t*>( data );
+    range.NumberOfBytes = dataSize;
+
+    if ( !PrefetchVirtualMemory( GetCurrentProcess(), 1, &range, 0 ) )
+    {
+        return HRESULT_FROM_WIN32( GetLastError() );
+    }
+#else
+    // Faulting the pages in would block the caller, so it is left to a thread pool thread
+    std::lock_guard<std::mutex> lock( m_prefetchMutex );
+
+    if ( !m_prefetchWork )
+    {
+        m_prefetchWork = CreateThreadpoolWork( PrefetchCallback, const_cast<Impl*>( this ), nullptr );
+        if ( !m_prefetchWork )
+            return HRESULT_FROM_WIN32( GetLastError() );
+    }
+
+    m_prefetchQueue.push_back( std::make_pair( data, dataSize ) );
+    SubmitThreadpoolWork( m_prefetchWork );
+#endif
+
+    return S_OK;
+}
+
+
+// Touches one byte per page of the oldest queued prefetch, which faults the pages in on a thread pool thread.
+void CALLBACK WaveBankReader::Impl::PrefetchCallback( PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK )
+{
+    auto impl = reinterpret_cast<Impl*>( context );
+    assert( impl != 0 );
+
+    const uint8_t* data;
+    uint32_t dataSize;
+    {
+        std::lock_guard<std::mutex> lock( impl->m_prefetchMutex );
+
+        // Each submission takes one range, but one cancelled by CancelPrefetch leaves the queue empty
+        if ( impl->m_prefetchQueue.empty() )
+            return;
+
+        data = impl->m_prefetchQueue.front().first;
+        dataSize = impl->m_prefetchQueue.front().second;
+        impl->m_prefetchQueue.erase( impl->m_prefetchQueue.begin() );
+    }
+
+    const size_t pageSize = 4096;
+
+    uint8_t sum = 0;
+    for( size_t j = 0; j < dataSize; j += pageSize )
+    {
+        sum += *static_cast<const volatile uint8_t*>( &data[ j ] );
+    }
+    sum += *static_cast<const volatile uint8_t*>( &data[ dataSize - 1 ] );
+    (void)sum;
+}
+
+
+// Drops any prefetches which have not started, and waits for those which have.
+void WaveBankReader::Impl::CancelPrefetch()
+{
+    if ( !m_prefetchWork )
+        return;
+
+    WaitForThreadpoolWorkCallbacks( m_prefetchWork, TRUE );
+    CloseThreadpoolWork( m_prefetchWork );
+    m_prefetchWork = nullptr;
+
+    m_prefetchQueue.clear();
+}
+
+
 bool WaveBankReader::Impl::UpdatePrepared()
 {
     if ( m_prepared )
@@ -1262,9 +1478,9 @@ WaveBankReader::~WaveBankReader()
 
 
 _Use_decl_annotations_
-HRESULT WaveBankReader::Open( const wchar_t* szFileName )
+HRESULT WaveBankReader::Open( const wchar_t* szFileName, bool memoryMapped )
 {
-    return pImpl->Open( szFileName );
+    return pImpl->Open( szFileName, memoryMapped );
 }
 
 
@@ -1356,6 +1572,13 @@ HRESULT WaveBankReader::GetWaveData( uint32_t index, const uint8_t** pData, uint
 }
 
 
+_Use_decl_annotations_
+HRESULT WaveBankReader::GetWaveDataOffset( uint32_t index, uint32_t& fileOffset, uint32_t& dataSize ) const
+{
+    return pImpl->GetWaveDataOffset( index, fileOffset, dataSize );
+}
+
+
 _Use_decl_annotations_
 HRESULT WaveBankReader::GetSeekTable( uint32_t index, const uint32_t** pData, uint32_t& dataCount, uint32_t& tag ) const
 {
@@ -1370,6 +1593,19 @@ HRESULT WaveBankReader::GetMetadata( uint32_t index, Metadata& metadata ) const
 }
 
 
+_Use_decl_annotations_
+HRESULT WaveBankReader::PrefetchWaveData( uint32_t index ) const
+{
+    return pImpl->PrefetchWaveData( index );
+}
+
+
+bool WaveBankReader::IsMemoryMapped() const
+{
+    return ( pImpl->m_mappedWaveData != nullptr );
+}
+
+
 HANDLE WaveBankReader::GetAsyncHandle() const
 {
     return ( pImpl->m_data.dwFlags & BANKDATA::TYPE_STREAMING ) ? pImpl->m_async : INVALID_HANDLE_VALUE;
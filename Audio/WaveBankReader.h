@@ -38,7 +38,8 @@ namespace DirectX
 
         ~WaveBankReader();
 
-        HRESULT Open( _In_z_ const wchar_t* szFileName );
+        HRESULT Open( _In_z_ const wchar_t* szFileName, bool memoryMapped = false );
+            // If memoryMapped, the wave data of an in-memory bank is used in place from a read-only view of the file
 
         uint32_t Find( _In_z_ const char* name ) const;
 
@@ -62,8 +63,16 @@ namespace DirectX
 
         HRESULT GetWaveData( _In_ uint32_t index, _Outptr_ const uint8_t** pData, _Out_ uint32_t& dataSize ) const;
 
+        HRESULT GetWaveDataOffset( _In_ uint32_t index, _Out_ uint32_t& fileOffset, _Out_ uint32_t& dataSize ) const;
+            // Returns the location of the wave data within the file (used to stream from streaming wave banks)
+
         HRESULT GetSeekTable( _In_ uint32_t index, _Out_ const uint32_t** pData, _Out_ uint32_t& dataCount, _Out_ uint32_t& tag ) const;
 
+        bool IsMemoryMapped() const;
+
+        HRESULT PrefetchWaveData( _In_ uint32_t index ) const;
+            // Starts paging in the wave data of a memory mapped bank (returns S_FALSE if the data is already in memory)
+
         HANDLE GetAsyncHandle() const;
 
         struct Metadata
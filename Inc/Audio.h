@@ -66,6 +66,10 @@
 namespace DirectX
 {
     class SoundEffectInstance;
+    class SoundStreamInstance;
+    class StreamingIOQueue;
+    struct WaveBankStreamData;
+    class VirtualVoiceScheduler;
 
     //----------------------------------------------------------------------------------
     struct AudioStatistics
@@ -78,6 +82,9 @@ namespace DirectX
         size_t  allocatedVoicesOneShot; // Number of XAudio2 voices allocated for one-shot sounds
         size_t  allocatedVoicesIdle;    // Number of XAudio2 voices allocated for one-shot sounds but not currently in use
         size_t  audioBytes;             // Total wave data (in bytes) in SoundEffects and in-memory WaveBanks
+        size_t  streamingQueueDepth;    // Number of streaming reads waiting to be issued
+        size_t  streamingDeadlineMisses;// Number of streaming reads which completed after their data was needed
+        size_t  virtualInstances;       // Number of sound effect instances playing without an XAudio2 voice (see AudioEngine_VirtualVoices)
 #if defined(_XBOX_ONE) && defined(_TITLE)
         size_t  xmaAudioBytes;          // Total wave data (in bytes) in SoundEffects and in-memory WaveBanks allocated with ApuAlloc
 #endif
@@ -119,6 +126,7 @@ namespace DirectX
         AudioEngine_EnvironmentalReverb = 0x1,
         AudioEngine_ReverbUseFilters    = 0x2,
         AudioEngine_UseMasteringLimiter = 0x4,
+        AudioEngine_VirtualVoices       = 0x8,
 
         AudioEngine_Debug               = 0x10000,
         AudioEngine_ThrowOnNoAudioHW    = 0x20000,
@@ -140,6 +148,14 @@ namespace DirectX
 
     inline SOUND_EFFECT_INSTANCE_FLAGS operator|(SOUND_EFFECT_INSTANCE_FLAGS a, SOUND_EFFECT_INSTANCE_FLAGS b) { return static_cast<SOUND_EFFECT_INSTANCE_FLAGS>( static_cast<int>(a) | static_cast<int>(b) ); }
 
+    enum WAVE_BANK_FLAGS
+    {
+        WaveBank_Default                = 0x0,
+
+        WaveBank_MemoryMapped           = 0x1,
+            // In-memory banks use the wave data in place from a read-only view of the file rather than reading it in
+    };
+
     enum AUDIO_ENGINE_REVERB
     {
         Reverb_Off,
@@ -247,6 +263,7 @@ namespace DirectX
         void __cdecl SetMaxVoicePool( size_t maxOneShots, size_t maxInstances );
             // Maximum number of voices to allocate for one-shots and instances
             // Note: one-shots over this limit are ignored; too many instance voices throws an exception
+            // unless AudioEngine_VirtualVoices is set, in which case only the most important instances get voices
 
         void __cdecl TrimVoicePool();
             // Releases any currently unused voices
@@ -260,6 +277,12 @@ namespace DirectX
         void __cdecl RegisterNotify( _In_ IVoiceNotify* notify, bool usesUpdate );
         void __cdecl UnregisterNotify( _In_ IVoiceNotify* notify, bool usesOneShots, bool usesUpdate );
 
+        StreamingIOQueue* __cdecl GetStreamingQueue();
+            // Shared I/O queue for SoundStreamInstances, serviced during Update
+
+        VirtualVoiceScheduler* __cdecl GetVoiceScheduler();
+            // Assigns voices to SoundEffectInstances during Update (null unless AudioEngine_VirtualVoices is set)
+
         // XAudio2 interface access
         IXAudio2* __cdecl GetInterface() const;
         IXAudio2MasteringVoice* __cdecl GetMasterVoice() const;
@@ -287,7 +310,7 @@ namespace DirectX
     class WaveBank
     {
     public:
-        WaveBank( _In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName );
+        WaveBank( _In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName, WAVE_BANK_FLAGS flags = WaveBank_Default );
 
         WaveBank(WaveBank&& moveFrom);
         WaveBank& operator= (WaveBank&& moveFrom);
@@ -306,6 +329,14 @@ namespace DirectX
         std::unique_ptr<SoundEffectInstance> __cdecl CreateInstance( int index, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default );
         std::unique_ptr<SoundEffectInstance> __cdecl CreateInstance( _In_z_ const char* name, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default );
 
+        std::unique_ptr<SoundStreamInstance> __cdecl CreateStreamInstance( int index, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default );
+        std::unique_ptr<SoundStreamInstance> __cdecl CreateStreamInstance( _In_z_ const char* name, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default );
+            // Streaming wave banks only; the wave is read from disk in chunks while it plays
+
+        void __cdecl Prefetch( int index );
+        void __cdecl Prefetch( _In_z_ const char* name );
+            // Starts paging in a wave which is about to play (only has an effect for WaveBank_MemoryMapped banks)
+
         bool __cdecl IsPrepared() const;
         bool __cdecl IsInUse() const;
         bool __cdecl IsStreamingBank() const;
@@ -337,8 +368,10 @@ namespace DirectX
 
         // Private interface
         void __cdecl UnregisterInstance( _In_ SoundEffectInstance* instance );
+        void __cdecl UnregisterInstance( _In_ SoundStreamInstance* instance );
 
         friend class SoundEffectInstance;
+        friend class SoundStreamInstance;
     };
 
 
@@ -583,6 +616,24 @@ namespace DirectX
     };
 
 
+    //----------------------------------------------------------------------------------
+    // Emitters for SoundEffectInstance::Apply3D in bulk, in structure-of-arrays form with count elements per array.
+    // These are treated as omnidirectional point sources with the default curves. Velocities (all three or none),
+    // curve distance scalers, and doppler scalers may be null.
+    struct AudioEmitterArray
+    {
+        size_t          count;
+        const float*    positionX;
+        const float*    positionY;
+        const float*    positionZ;
+        const float*    velocityX;
+        const float*    velocityY;
+        const float*    velocityZ;
+        const float*    curveDistanceScalers;
+        const float*    dopplerScalers;
+    };
+
+
     //----------------------------------------------------------------------------------
     class SoundEffectInstance
     {
@@ -606,8 +657,18 @@ namespace DirectX
 
         void __cdecl Apply3D( const AudioListener& listener, const AudioEmitter& emitter, bool rhcoords = true );
 
+        static void __cdecl Apply3D( const AudioListener& listener, const AudioEmitterArray& emitters,
+                                     _In_reads_opt_(emitters.count) SoundEffectInstance* const* instances, bool rhcoords = true );
+            // Positions instances[i] at emitter i; null instances are skipped. All of a source's channels sit at the emitter
+
+        void __cdecl SetPriority( int priority );
+            // With AudioEngine_VirtualVoices, higher priority instances get voices first, then the most audible
+
         bool __cdecl IsLooped() const;
 
+        bool __cdecl IsVirtual() const;
+            // Returns true if playing (or paused) without a voice
+
         SoundState __cdecl GetState();
 
         // Notifications.
@@ -628,6 +689,54 @@ namespace DirectX
     };
 
 
+    //----------------------------------------------------------------------------------
+    class SoundStreamInstance
+    {
+    public:
+        SoundStreamInstance(SoundStreamInstance&& moveFrom);
+        SoundStreamInstance& operator= (SoundStreamInstance&& moveFrom);
+
+        SoundStreamInstance(SoundStreamInstance const&) = delete;
+        SoundStreamInstance& operator= (SoundStreamInstance const&) = delete;
+
+        virtual ~SoundStreamInstance();
+
+        void __cdecl Play( bool loop = false );
+        void __cdecl Stop( bool immediate = true );
+        void __cdecl Pause();
+        void __cdecl Resume();
+
+        void __cdecl SetVolume( float volume );
+        void __cdecl SetPitch( float pitch );
+        void __cdecl SetPan( float pan );
+
+        void __cdecl Apply3D( const AudioListener& listener, const AudioEmitter& emitter, bool rhcoords = true );
+
+        bool __cdecl IsLooped() const;
+
+        SoundState __cdecl GetState();
+            // Note that data is read ahead of playback during AudioEngine::Update
+
+        bool __cdecl HasReadError() const;
+            // True if playback was stopped because wave data could not be read (cleared by the next Play)
+
+        // Notifications.
+        void __cdecl OnDestroyParent();
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+
+        // Private constructors
+        SoundStreamInstance( _In_ AudioEngine* engine, _In_ WaveBank* effect, int index, SOUND_EFFECT_INSTANCE_FLAGS flags,
+                             const WaveBankStreamData& data );
+
+        friend std::unique_ptr<SoundStreamInstance> __cdecl WaveBank::CreateStreamInstance( int, SOUND_EFFECT_INSTANCE_FLAGS );
+    };
+
+
     //----------------------------------------------------------------------------------
     class DynamicSoundEffectInstance
     {
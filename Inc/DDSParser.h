@@ -0,0 +1,1232 @@
+//--------------------------------------------------------------------------------------
+// File: DDSParser.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+
+// Validates DDS files and computes the layout of their subresources. This only depends on the C++ standard library, so
+// content pipelines can check textures on any platform without a Direct3D device. DDSTextureLoader uses the same code,
+// so a file accepted here is one CreateDDSTextureFromMemory accepts (as far as the file itself goes; the device may
+// still not support the format). Format, Dimension and AlphaMode have the values of DXGI_FORMAT,
+// D3D11_RESOURCE_DIMENSION and DDS_ALPHA_MODE.
+//
+// GetTextureLayout bounds checks every read against the buffer size, so it can be fuzzed directly. Defining
+// DDSPARSER_FUZZ_ENTRY_POINT before including this header in one translation unit adds a libFuzzer entry point, e.g.
+//     echo '#include "DDSParser.h"' | clang++ -x c++ -DDDSPARSER_FUZZ_ENTRY_POINT -fsanitize=fuzzer,address -IInc -
+namespace DirectX
+{
+    namespace DDSParser
+    {
+        enum Format : uint32_t
+        {
+            FORMAT_UNKNOWN                      = 0,
+            FORMAT_R32G32B32A32_TYPELESS        = 1,
+            FORMAT_R32G32B32A32_FLOAT           = 2,
+            FORMAT_R32G32B32A32_UINT            = 3,
+            FORMAT_R32G32B32A32_SINT            = 4,
+            FORMAT_R32G32B32_TYPELESS           = 5,
+            FORMAT_R32G32B32_FLOAT              = 6,
+            FORMAT_R32G32B32_UINT               = 7,
+            FORMAT_R32G32B32_SINT               = 8,
+            FORMAT_R16G16B16A16_TYPELESS        = 9,
+            FORMAT_R16G16B16A16_FLOAT           = 10,
+            FORMAT_R16G16B16A16_UNORM           = 11,
+            FORMAT_R16G16B16A16_UINT            = 12,
+            FORMAT_R16G16B16A16_SNORM           = 13,
+            FORMAT_R16G16B16A16_SINT            = 14,
+            FORMAT_R32G32_TYPELESS              = 15,
+            FORMAT_R32G32_FLOAT                 = 16,
+            FORMAT_R32G32_UINT                  = 17,
+            FORMAT_R32G32_SINT                  = 18,
+            FORMAT_R32G8X24_TYPELESS            = 19,
+            FORMAT_D32_FLOAT_S8X24_UINT         = 20,
+            FORMAT_R32_FLOAT_X8X24_TYPELESS     = 21,
+            FORMAT_X32_TYPELESS_G8X24_UINT      = 22,
+            FORMAT_R10G10B10A2_TYPELESS         = 23,
+            FORMAT_R10G10B10A2_UNORM            = 24,
+            FORMAT_R10G10B10A2_UINT             = 25,
+            FORMAT_R11G11B10_FLOAT              = 26,
+            FORMAT_R8G8B8A8_TYPELESS            = 27,
+            FORMAT_R8G8B8A8_UNORM               = 28,
+            FORMAT_R8G8B8A8_UNORM_SRGB          = 29,
+            FORMAT_R8G8B8A8_UINT                = 30,
+            FORMAT_R8G8B8A8_SNORM               = 31,
+            FORMAT_R8G8B8A8_SINT                = 32,
+            FORMAT_R16G16_TYPELESS              = 33,
+            FORMAT_R16G16_FLOAT                 = 34,
+            FORMAT_R16G16_UNORM                 = 35,
+            FORMAT_R16G16_UINT                  = 36,
+            FORMAT_R16G16_SNORM                 = 37,
+            FORMAT_R16G16_SINT                  = 38,
+            FORMAT_R32_TYPELESS                 = 39,
+            FORMAT_D32_FLOAT                    = 40,
+            FORMAT_R32_FLOAT                    = 41,
+            FORMAT_R32_UINT                     = 42,
+            FORMAT_R32_SINT                     = 43,
+            FORMAT_R24G8_TYPELESS               = 44,
+            FORMAT_D24_UNORM_S8_UINT            = 45,
+            FORMAT_R24_UNORM_X8_TYPELESS        = 46,
+            FORMAT_X24_TYPELESS_G8_UINT         = 47,
+            FORMAT_R8G8_TYPELESS                = 48,
+            FORMAT_R8G8_UNORM                   = 49,
+            FORMAT_R8G8_UINT                    = 50,
+            FORMAT_R8G8_SNORM                   = 51,
+            FORMAT_R8G8_SINT                    = 52,
+            FORMAT_R16_TYPELESS                 = 53,
+            FORMAT_R16_FLOAT                    = 54,
+            FORMAT_D16_UNORM                    = 55,
+            FORMAT_R16_UNORM                    = 56,
+            FORMAT_R16_UINT                     = 57,
+            FORMAT_R16_SNORM                    = 58,
+            FORMAT_R16_SINT                     = 59,
+            FORMAT_R8_TYPELESS                  = 60,
+            FORMAT_R8_UNORM                     = 61,
+            FORMAT_R8_UINT                      = 62,
+            FORMAT_R8_SNORM                     = 63,
+            FORMAT_R8_SINT                      = 64,
+            FORMAT_A8_UNORM                     = 65,
+            FORMAT_R1_UNORM                     = 66,
+            FORMAT_R9G9B9E5_SHAREDEXP           = 67,
+            FORMAT_R8G8_B8G8_UNORM              = 68,
+            FORMAT_G8R8_G8B8_UNORM              = 69,
+            FORMAT_BC1_TYPELESS                 = 70,
+            FORMAT_BC1_UNORM                    = 71,
+            FORMAT_BC1_UNORM_SRGB               = 72,
+            FORMAT_BC2_TYPELESS                 = 73,
+            FORMAT_BC2_UNORM                    = 74,
+            FORMAT_BC2_UNORM_SRGB               = 75,
+            FORMAT_BC3_TYPELESS                 = 76,
+            FORMAT_BC3_UNORM                    = 77,
+            FORMAT_BC3_UNORM_SRGB               = 78,
+            FORMAT_BC4_TYPELESS                 = 79,
+            FORMAT_BC4_UNORM                    = 80,
+            FORMAT_BC4_SNORM                    = 81,
+            FORMAT_BC5_TYPELESS                 = 82,
+            FORMAT_BC5_UNORM                    = 83,
+            FORMAT_BC5_SNORM                    = 84,
+            FORMAT_B5G6R5_UNORM                 = 85,
+            FORMAT_B5G5R5A1_UNORM               = 86,
+            FORMAT_B8G8R8A8_UNORM               = 87,
+            FORMAT_B8G8R8X8_UNORM               = 88,
+            FORMAT_R10G10B10_XR_BIAS_A2_UNORM   = 89,
+            FORMAT_B8G8R8A8_TYPELESS            = 90,
+            FORMAT_B8G8R8A8_UNORM_SRGB          = 91,
+            FORMAT_B8G8R8X8_TYPELESS            = 92,
+            FORMAT_B8G8R8X8_UNORM_SRGB          = 93,
+            FORMAT_BC6H_TYPELESS                = 94,
+            FORMAT_BC6H_UF16                    = 95,
+            FORMAT_BC6H_SF16                    = 96,
+            FORMAT_BC7_TYPELESS                 = 97,
+            FORMAT_BC7_UNORM                    = 98,
+            FORMAT_BC7_UNORM_SRGB               = 99,
+            FORMAT_AYUV                         = 100,
+            FORMAT_Y410                         = 101,
+            FORMAT_Y416                         = 102,
+            FORMAT_NV12                         = 103,
+            FORMAT_P010                         = 104,
+            FORMAT_P016                         = 105,
+            FORMAT_420_OPAQUE                   = 106,
+            FORMAT_YUY2                         = 107,
+            FORMAT_Y210                         = 108,
+            FORMAT_Y216                         = 109,
+            FORMAT_NV11                         = 110,
+            FORMAT_AI44                         = 111,
+            FORMAT_IA44                         = 112,
+            FORMAT_P8                           = 113,
+            FORMAT_A8P8                         = 114,
+            FORMAT_B4G4R4A4_UNORM               = 115,
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+            FORMAT_R10G10B10_7E3_A2_FLOAT       = 116,
+            FORMAT_R10G10B10_6E4_A2_FLOAT       = 117,
+            FORMAT_D16_UNORM_S8_UINT            = 118,
+            FORMAT_R16_UNORM_X8_TYPELESS        = 119,
+            FORMAT_X16_TYPELESS_G8_UINT         = 120,
+            FORMAT_R10G10B10_SNORM_A2_UNORM     = 189,
+            FORMAT_R4G4_UNORM                   = 190,
+#endif
+        };
+
+        enum Dimension : uint32_t
+        {
+            DIMENSION_UNKNOWN   = 0,
+            DIMENSION_TEXTURE1D = 2,
+            DIMENSION_TEXTURE2D = 3,
+            DIMENSION_TEXTURE3D = 4,
+        };
+
+        enum AlphaMode : uint32_t
+        {
+            ALPHA_MODE_UNKNOWN       = 0,
+            ALPHA_MODE_STRAIGHT      = 1,
+            ALPHA_MODE_PREMULTIPLIED = 2,
+            ALPHA_MODE_OPAQUE        = 3,
+            ALPHA_MODE_CUSTOM        = 4,
+        };
+
+        // DDSTextureLoader reports these as E_INVALIDARG, E_FAIL, and the Win32 errors ERROR_INVALID_DATA,
+        // ERROR_NOT_SUPPORTED, ERROR_HANDLE_EOF and ERROR_INSUFFICIENT_BUFFER respectively.
+        enum Result
+        {
+            RESULT_OK = 0,
+            RESULT_INVALID_ARG,
+            RESULT_NOT_DDS,                 // Missing magic number, or header sizes are wrong
+            RESULT_INVALID_DATA,
+            RESULT_NOT_SUPPORTED,
+            RESULT_END_OF_FILE,
+            RESULT_INSUFFICIENT_BUFFER,
+        };
+
+
+        // File format
+        const uint32_t c_Magic = 0x20534444; // "DDS "
+
+        enum FourCC : uint32_t
+        {
+            FOURCC_DXT1 = 'D' | ('X' << 8) | ('T' << 16) | (uint32_t('1') << 24),
+            FOURCC_DXT2 = 'D' | ('X' << 8) | ('T' << 16) | (uint32_t('2') << 24),
+            FOURCC_DXT3 = 'D' | ('X' << 8) | ('T' << 16) | (uint32_t('3') << 24),
+            FOURCC_DXT4 = 'D' | ('X' << 8) | ('T' << 16) | (uint32_t('4') << 24),
+            FOURCC_DXT5 = 'D' | ('X' << 8) | ('T' << 16) | (uint32_t('5') << 24),
+            FOURCC_ATI1 = 'A' | ('T' << 8) | ('I' << 16) | (uint32_t('1') << 24),
+            FOURCC_ATI2 = 'A' | ('T' << 8) | ('I' << 16) | (uint32_t('2') << 24),
+            FOURCC_BC4U = 'B' | ('C' << 8) | ('4' << 16) | (uint32_t('U') << 24),
+            FOURCC_BC4S = 'B' | ('C' << 8) | ('4' << 16) | (uint32_t('S') << 24),
+            FOURCC_BC5U = 'B' | ('C' << 8) | ('5' << 16) | (uint32_t('U') << 24),
+            FOURCC_BC5S = 'B' | ('C' << 8) | ('5' << 16) | (uint32_t('S') << 24),
+            FOURCC_RGBG = 'R' | ('G' << 8) | ('B' << 16) | (uint32_t('G') << 24),
+            FOURCC_GRGB = 'G' | ('R' << 8) | ('G' << 16) | (uint32_t('B') << 24),
+            FOURCC_YUY2 = 'Y' | ('U' << 8) | ('Y' << 16) | (uint32_t('2') << 24),
+            FOURCC_DX10 = 'D' | ('X' << 8) | ('1' << 16) | (uint32_t('0') << 24),
+        };
+
+        // PixelFormat::flags
+        const uint32_t c_PixelFourCC    = 0x00000004;
+        const uint32_t c_PixelRGB       = 0x00000040;
+        const uint32_t c_PixelLuminance = 0x00020000;
+        const uint32_t c_PixelAlpha     = 0x00000002;
+        const uint32_t c_PixelBumpDuDv  = 0x00080000;
+
+        // Header::flags
+        const uint32_t c_HeaderHeight   = 0x00000002;
+        const uint32_t c_HeaderVolume   = 0x00800000;
+
+        // Header::caps2
+        const uint32_t c_Cubemap        = 0x00000200;
+        const uint32_t c_CubemapAllFaces = 0x0000FE00;
+
+        // HeaderDXT10::miscFlag and miscFlags2
+        const uint32_t c_MiscTextureCube = 0x4;
+        const uint32_t c_MiscFlags2AlphaModeMask = 0x7;
+
+        struct PixelFormat
+        {
+            uint32_t size;
+            uint32_t flags;
+            uint32_t fourCC;
+            uint32_t RGBBitCount;
+            uint32_t RBitMask;
+            uint32_t GBitMask;
+            uint32_t BBitMask;
+            uint32_t ABitMask;
+        };
+
+        struct Header
+        {
+            uint32_t size;
+            uint32_t flags;
+            uint32_t height;
+            uint32_t width;
+            uint32_t pitchOrLinearSize;
+            uint32_t depth;
+            uint32_t mipMapCount;
+            uint32_t reserved1[11];
+            PixelFormat ddspf;
+            uint32_t caps;
+            uint32_t caps2;
+            uint32_t caps3;
+            uint32_t caps4;
+            uint32_t reserved2;
+        };
+
+        struct HeaderDXT10
+        {
+            uint32_t dxgiFormat;
+            uint32_t resourceDimension;
+            uint32_t miscFlag;
+            uint32_t arraySize;
+            uint32_t miscFlags2;
+        };
+
+        static_assert(sizeof(PixelFormat) == 32, "DDS pixel format size mismatch");
+        static_assert(sizeof(Header) == 124, "DDS header size mismatch");
+        static_assert(sizeof(HeaderDXT10) == 20, "DDS DX10 extended header size mismatch");
+
+
+        // Direct3D 11 hardware requirements. For security purposes, DDS file metadata larger than these is not trusted.
+        const uint32_t c_MaxMipLevels = 15;
+        const uint32_t c_MaxTexture1DArraySize = 2048;
+        const uint32_t c_MaxTexture1DWidth = 16384;
+        const uint32_t c_MaxTexture2DArraySize = 2048;
+        const uint32_t c_MaxTexture2DSize = 16384;
+        const uint32_t c_MaxTextureCubeSize = 16384;
+        const uint32_t c_MaxTexture3DSize = 2048;
+
+
+        struct TextureDesc
+        {
+            Dimension dimension;
+            Format format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t depth;
+            uint32_t mipLevels;
+            uint32_t arraySize;         // Counts individual faces for cubemaps
+            bool isCubeMap;
+            AlphaMode alphaMode;
+        };
+
+        // Location of one subresource within the DDS data
+        struct SubresourceLayout
+        {
+            size_t offset;              // Bytes from the start of the DDS data (including the magic number and headers)
+            size_t rowPitch;
+            size_t slicePitch;
+            size_t numRows;
+            uint32_t width;
+            uint32_t height;
+            uint32_t depth;
+        };
+
+
+        // Returns the bits per pixel of a format, or 0 if DDS files in that format are not supported.
+        inline size_t BitsPerPixel(Format fmt)
+        {
+            switch (fmt)
+            {
+            case FORMAT_R32G32B32A32_TYPELESS:
+            case FORMAT_R32G32B32A32_FLOAT:
+            case FORMAT_R32G32B32A32_UINT:
+            case FORMAT_R32G32B32A32_SINT:
+                return 128;
+
+            case FORMAT_R32G32B32_TYPELESS:
+            case FORMAT_R32G32B32_FLOAT:
+            case FORMAT_R32G32B32_UINT:
+            case FORMAT_R32G32B32_SINT:
+                return 96;
+
+            case FORMAT_R16G16B16A16_TYPELESS:
+            case FORMAT_R16G16B16A16_FLOAT:
+            case FORMAT_R16G16B16A16_UNORM:
+            case FORMAT_R16G16B16A16_UINT:
+            case FORMAT_R16G16B16A16_SNORM:
+            case FORMAT_R16G16B16A16_SINT:
+            case FORMAT_R32G32_TYPELESS:
+            case FORMAT_R32G32_FLOAT:
+            case FORMAT_R32G32_UINT:
+            case FORMAT_R32G32_SINT:
+            case FORMAT_R32G8X24_TYPELESS:
+            case FORMAT_D32_FLOAT_S8X24_UINT:
+            case FORMAT_R32_FLOAT_X8X24_TYPELESS:
+            case FORMAT_X32_TYPELESS_G8X24_UINT:
+            case FORMAT_Y416:
+            case FORMAT_Y210:
+            case FORMAT_Y216:
+                return 64;
+
+            case FORMAT_R10G10B10A2_TYPELESS:
+            case FORMAT_R10G10B10A2_UNORM:
+            case FORMAT_R10G10B10A2_UINT:
+            case FORMAT_R11G11B10_FLOAT:
+            case FORMAT_R8G8B8A8_TYPELESS:
+            case FORMAT_R8G8B8A8_UNORM:
+            case FORMAT_R8G8B8A8_UNORM_SRGB:
+            case FORMAT_R8G8B8A8_UINT:
+            case FORMAT_R8G8B8A8_SNORM:
+            case FORMAT_R8G8B8A8_SINT:
+            case FORMAT_R16G16_TYPELESS:
+            case FORMAT_R16G16_FLOAT:
+            case FORMAT_R16G16_UNORM:
+            case FORMAT_R16G16_UINT:
+            case FORMAT_R16G16_SNORM:
+            case FORMAT_R16G16_SINT:
+            case FORMAT_R32_TYPELESS:
+            case FORMAT_D32_FLOAT:
+            case FORMAT_R32_FLOAT:
+            case FORMAT_R32_UINT:
+            case FORMAT_R32_SINT:
+            case FORMAT_R24G8_TYPELESS:
+            case FORMAT_D24_UNORM_S8_UINT:
+            case FORMAT_R24_UNORM_X8_TYPELESS:
+            case FORMAT_X24_TYPELESS_G8_UINT:
+            case FORMAT_R9G9B9E5_SHAREDEXP:
+            case FORMAT_R8G8_B8G8_UNORM:
+            case FORMAT_G8R8_G8B8_UNORM:
+            case FORMAT_B8G8R8A8_UNORM:
+            case FORMAT_B8G8R8X8_UNORM:
+            case FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+            case FORMAT_B8G8R8A8_TYPELESS:
+            case FORMAT_B8G8R8A8_UNORM_SRGB:
+            case FORMAT_B8G8R8X8_TYPELESS:
+            case FORMAT_B8G8R8X8_UNORM_SRGB:
+            case FORMAT_AYUV:
+            case FORMAT_Y410:
+            case FORMAT_YUY2:
+                return 32;
+
+            case FORMAT_P010:
+            case FORMAT_P016:
+                return 24;
+
+            case FORMAT_R8G8_TYPELESS:
+            case FORMAT_R8G8_UNORM:
+            case FORMAT_R8G8_UINT:
+            case FORMAT_R8G8_SNORM:
+            case FORMAT_R8G8_SINT:
+            case FORMAT_R16_TYPELESS:
+            case FORMAT_R16_FLOAT:
+            case FORMAT_D16_UNORM:
+            case FORMAT_R16_UNORM:
+            case FORMAT_R16_UINT:
+            case FORMAT_R16_SNORM:
+            case FORMAT_R16_SINT:
+            case FORMAT_B5G6R5_UNORM:
+            case FORMAT_B5G5R5A1_UNORM:
+            case FORMAT_A8P8:
+            case FORMAT_B4G4R4A4_UNORM:
+                return 16;
+
+            case FORMAT_NV12:
+            case FORMAT_420_OPAQUE:
+            case FORMAT_NV11:
+                return 12;
+
+            case FORMAT_R8_TYPELESS:
+            case FORMAT_R8_UNORM:
+            case FORMAT_R8_UINT:
+            case FORMAT_R8_SNORM:
+            case FORMAT_R8_SINT:
+            case FORMAT_A8_UNORM:
+            case FORMAT_AI44:
+            case FORMAT_IA44:
+            case FORMAT_P8:
+                return 8;
+
+            case FORMAT_R1_UNORM:
+                return 1;
+
+            case FORMAT_BC1_TYPELESS:
+            case FORMAT_BC1_UNORM:
+            case FORMAT_BC1_UNORM_SRGB:
+            case FORMAT_BC4_TYPELESS:
+            case FORMAT_BC4_UNORM:
+            case FORMAT_BC4_SNORM:
+                return 4;
+
+            case FORMAT_BC2_TYPELESS:
+            case FORMAT_BC2_UNORM:
+            case FORMAT_BC2_UNORM_SRGB:
+            case FORMAT_BC3_TYPELESS:
+            case FORMAT_BC3_UNORM:
+            case FORMAT_BC3_UNORM_SRGB:
+            case FORMAT_BC5_TYPELESS:
+            case FORMAT_BC5_UNORM:
+            case FORMAT_BC5_SNORM:
+            case FORMAT_BC6H_TYPELESS:
+            case FORMAT_BC6H_UF16:
+            case FORMAT_BC6H_SF16:
+            case FORMAT_BC7_TYPELESS:
+            case FORMAT_BC7_UNORM:
+            case FORMAT_BC7_UNORM_SRGB:
+                return 8;
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+
+            case FORMAT_R10G10B10_7E3_A2_FLOAT:
+            case FORMAT_R10G10B10_6E4_A2_FLOAT:
+            case FORMAT_R10G10B10_SNORM_A2_UNORM:
+                return 32;
+
+            case FORMAT_D16_UNORM_S8_UINT:
+            case FORMAT_R16_UNORM_X8_TYPELESS:
+            case FORMAT_X16_TYPELESS_G8_UINT:
+                return 24;
+
+            case FORMAT_R4G4_UNORM:
+                return 8;
+
+#endif // _XBOX_ONE && _TITLE
+
+            default:
+                return 0;
+            }
+        }
+
+
+        // Returns the size of one 2D surface of a format, and its row pitch and number of rows (of blocks, for block
+        // compressed formats).
+        inline void GetSurfaceInfo(size_t width, size_t height, Format fmt,
+                                   size_t* outNumBytes, size_t* outRowBytes, size_t* outNumRows)
+        {
+            size_t numBytes = 0;
+            size_t rowBytes = 0;
+            size_t numRows = 0;
+
+            bool bc = false;
+            bool packed = false;
+            bool planar = false;
+            size_t bpe = 0;
+            switch (fmt)
+            {
+            case FORMAT_BC1_TYPELESS:
+            case FORMAT_BC1_UNORM:
+            case FORMAT_BC1_UNORM_SRGB:
+            case FORMAT_BC4_TYPELESS:
+            case FORMAT_BC4_UNORM:
+            case FORMAT_BC4_SNORM:
+                bc = true;
+                bpe = 8;
+                break;
+
+            case FORMAT_BC2_TYPELESS:
+            case FORMAT_BC2_UNORM:
+            case FORMAT_BC2_UNORM_SRGB:
+            case FORMAT_BC3_TYPELESS:
+            case FORMAT_BC3_UNORM:
+            case FORMAT_BC3_UNORM_SRGB:
+            case FORMAT_BC5_TYPELESS:
+            case FORMAT_BC5_UNORM:
+            case FORMAT_BC5_SNORM:
+            case FORMAT_BC6H_TYPELESS:
+            case FORMAT_BC6H_UF16:
+            case FORMAT_BC6H_SF16:
+            case FORMAT_BC7_TYPELESS:
+            case FORMAT_BC7_UNORM:
+            case FORMAT_BC7_UNORM_SRGB:
+                bc = true;
+                bpe = 16;
+                break;
+
+            case FORMAT_R8G8_B8G8_UNORM:
+            case FORMAT_G8R8_G8B8_UNORM:
+            case FORMAT_YUY2:
+                packed = true;
+                bpe = 4;
+                break;
+
+            case FORMAT_Y210:
+            case FORMAT_Y216:
+                packed = true;
+                bpe = 8;
+                break;
+
+            case FORMAT_NV12:
+            case FORMAT_420_OPAQUE:
+                planar = true;
+                bpe = 2;
+                break;
+
+            case FORMAT_P010:
+            case FORMAT_P016:
+                planar = true;
+                bpe = 4;
+                break;
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+
+            case FORMAT_D16_UNORM_S8_UINT:
+            case FORMAT_R16_UNORM_X8_TYPELESS:
+            case FORMAT_X16_TYPELESS_G8_UINT:
+                planar = true;
+                bpe = 4;
+                break;
+
+#endif
+
+            default:
+                break;
+            }
+
+            if (bc)
+            {
+                size_t numBlocksWide = 0;
+                if (width > 0)
+                {
+                    numBlocksWide = std::max<size_t>(1, (width + 3) / 4);
+                }
+                size_t numBlocksHigh = 0;
+                if (height > 0)
+                {
+                    numBlocksHigh = std::max<size_t>(1, (height + 3) / 4);
+                }
+                rowBytes = numBlocksWide * bpe;
+                numRows = numBlocksHigh;
+                numBytes = rowBytes * numBlocksHigh;
+            }
+            else if (packed)
+            {
+                rowBytes = ((width + 1) >> 1) * bpe;
+                numRows = height;
+                numBytes = rowBytes * height;
+            }
+            else if (fmt == FORMAT_NV11)
+            {
+                rowBytes = ((width + 3) >> 2) * 4;
+                numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+                numBytes = rowBytes * numRows;
+            }
+            else if (planar)
+            {
+                rowBytes = ((width + 1) >> 1) * bpe;
+                numBytes = (rowBytes * height) + ((rowBytes * height + 1) >> 1);
+                numRows = height + ((height + 1) >> 1);
+            }
+            else
+            {
+                size_t bpp = BitsPerPixel(fmt);
+                rowBytes = (width * bpp + 7) / 8; // round up to nearest byte
+                numRows = height;
+                numBytes = rowBytes * height;
+            }
+
+            if (outNumBytes)
+            {
+                *outNumBytes = numBytes;
+            }
+            if (outRowBytes)
+            {
+                *outRowBytes = rowBytes;
+            }
+            if (outNumRows)
+            {
+                *outNumRows = numRows;
+            }
+        }
+
+
+        // Maps the pixel format of a legacy (non-DX10) header to a format, or FORMAT_UNKNOWN if there is none.
+        inline Format GetFormat(const PixelFormat& ddpf)
+        {
+            auto isBitMask = [&ddpf](uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+            {
+                return ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a;
+            };
+
+            if (ddpf.flags & c_PixelRGB)
+            {
+                // Note that sRGB formats are written using the "DX10" extended header
+
+                switch (ddpf.RGBBitCount)
+                {
+                case 32:
+                    if (isBitMask(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                    {
+                        return FORMAT_R8G8B8A8_UNORM;
+                    }
+
+                    if (isBitMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
+                    {
+                        return FORMAT_B8G8R8A8_UNORM;
+                    }
+
+                    if (isBitMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
+                    {
+                        return FORMAT_B8G8R8X8_UNORM;
+                    }
+
+                    // No DXGI format maps to isBitMask(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+
+                    // Note that many common DDS reader/writers (including D3DX) swap the
+                    // the RED/BLUE masks for 10:10:10:2 formats. We assume
+                    // below that the 'backwards' header mask is being used since it is most
+                    // likely written by D3DX. The more robust solution is to use the 'DX10'
+                    // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+
+                    // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+                    if (isBitMask(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
+                    {
+                        return FORMAT_R10G10B10A2_UNORM;
+                    }
+
+                    // No DXGI format maps to isBitMask(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+                    if (isBitMask(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+                    {
+                        return FORMAT_R16G16_UNORM;
+                    }
+
+                    if (isBitMask(0xffffffff, 0x00000000, 0x00000000, 0x00000000))
+                    {
+                        // Only 32-bit color channel format in D3D9 was R32F
+                        return FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
+                    }
+                    break;
+
+                case 24:
+                    // No 24bpp DXGI formats aka D3DFMT_R8G8B8
+                    break;
+
+                case 16:
+                    if (isBitMask(0x7c00, 0x03e0, 0x001f, 0x8000))
+                    {
+                        return FORMAT_B5G5R5A1_UNORM;
+                    }
+                    if (isBitMask(0xf800, 0x07e0, 0x001f, 0x0000))
+                    {
+                        return FORMAT_B5G6R5_UNORM;
+                    }
+
+                    // No DXGI format maps to isBitMask(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+                    if (isBitMask(0x0f00, 0x00f0, 0x000f, 0xf000))
+                    {
+                        return FORMAT_B4G4R4A4_UNORM;
+                    }
+
+                    // No DXGI format maps to isBitMask(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+                    // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+                    break;
+                }
+            }
+            else if (ddpf.flags & c_PixelLuminance)
+            {
+                if (8 == ddpf.RGBBitCount)
+                {
+                    if (isBitMask(0x000000ff, 0x00000000, 0x00000000, 0x00000000))
+                    {
+                        return FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+                    }
+
+                    // No DXGI format maps to isBitMask(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+
+                    if (isBitMask(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
+                    {
+                        return FORMAT_R8G8_UNORM; // Some DDS writers assume the bitcount should be 8 instead of 16
+                    }
+                }
+
+                if (16 == ddpf.RGBBitCount)
+                {
+                    if (isBitMask(0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
+                    {
+                        return FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+                    }
+                    if (isBitMask(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
+                    {
+                        return FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+                    }
+                }
+            }
+            else if (ddpf.flags & c_PixelAlpha)
+            {
+                if (8 == ddpf.RGBBitCount)
+                {
+                    return FORMAT_A8_UNORM;
+                }
+            }
+            else if (ddpf.flags & c_PixelBumpDuDv)
+            {
+                if (16 == ddpf.RGBBitCount)
+                {
+                    if (isBitMask(0x00ff, 0xff00, 0x0000, 0x0000))
+                    {
+                        return FORMAT_R8G8_SNORM; // D3DX10/11 writes this out as DX10 extension
+                    }
+                }
+
+                if (32 == ddpf.RGBBitCount)
+                {
+                    if (isBitMask(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                    {
+                        return FORMAT_R8G8B8A8_SNORM; // D3DX10/11 writes this out as DX10 extension
+                    }
+                    if (isBitMask(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+                    {
+                        return FORMAT_R16G16_SNORM; // D3DX10/11 writes this out as DX10 extension
+                    }
+
+                    // No DXGI format maps to isBitMask(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000) aka D3DFMT_A2W10V10U10
+                }
+            }
+            else if (ddpf.flags & c_PixelFourCC)
+            {
+                switch (ddpf.fourCC)
+                {
+                case FOURCC_DXT1:
+                    return FORMAT_BC1_UNORM;
+
+                case FOURCC_DXT3:
+                    return FORMAT_BC2_UNORM;
+
+                case FOURCC_DXT5:
+                    return FORMAT_BC3_UNORM;
+
+                // While pre-multiplied alpha isn't directly supported by the DXGI formats,
+                // they are basically the same as these BC formats so they can be mapped
+                case FOURCC_DXT2:
+                    return FORMAT_BC2_UNORM;
+
+                case FOURCC_DXT4:
+                    return FORMAT_BC3_UNORM;
+
+                case FOURCC_ATI1:
+                case FOURCC_BC4U:
+                    return FORMAT_BC4_UNORM;
+
+                case FOURCC_BC4S:
+                    return FORMAT_BC4_SNORM;
+
+                case FOURCC_ATI2:
+                case FOURCC_BC5U:
+                    return FORMAT_BC5_UNORM;
+
+                case FOURCC_BC5S:
+                    return FORMAT_BC5_SNORM;
+
+                // BC6H and BC7 are written using the "DX10" extended header
+
+                case FOURCC_RGBG:
+                    return FORMAT_R8G8_B8G8_UNORM;
+
+                case FOURCC_GRGB:
+                    return FORMAT_G8R8_G8B8_UNORM;
+
+                case FOURCC_YUY2:
+                    return FORMAT_YUY2;
+
+                // Check for D3DFORMAT enums being set here
+                case 36: // D3DFMT_A16B16G16R16
+                    return FORMAT_R16G16B16A16_UNORM;
+
+                case 110: // D3DFMT_Q16W16V16U16
+                    return FORMAT_R16G16B16A16_SNORM;
+
+                case 111: // D3DFMT_R16F
+                    return FORMAT_R16_FLOAT;
+
+                case 112: // D3DFMT_G16R16F
+                    return FORMAT_R16G16_FLOAT;
+
+                case 113: // D3DFMT_A16B16G16R16F
+                    return FORMAT_R16G16B16A16_FLOAT;
+
+                case 114: // D3DFMT_R32F
+                    return FORMAT_R32_FLOAT;
+
+                case 115: // D3DFMT_G32R32F
+                    return FORMAT_R32G32_FLOAT;
+
+                case 116: // D3DFMT_A32B32G32R32F
+                    return FORMAT_R32G32B32A32_FLOAT;
+
+                default:
+                    break;
+                }
+            }
+
+            return FORMAT_UNKNOWN;
+        }
+
+
+        // Returns the alpha mode of a header. d3d10ext is the DX10 extended header following it, if there is one.
+        inline AlphaMode GetAlphaMode(const Header& header, const HeaderDXT10* d3d10ext)
+        {
+            if (header.ddspf.flags & c_PixelFourCC)
+            {
+                if (FOURCC_DX10 == header.ddspf.fourCC)
+                {
+                    if (d3d10ext)
+                    {
+                        auto mode = static_cast<AlphaMode>(d3d10ext->miscFlags2 & c_MiscFlags2AlphaModeMask);
+                        switch (mode)
+                        {
+                        case ALPHA_MODE_STRAIGHT:
+                        case ALPHA_MODE_PREMULTIPLIED:
+                        case ALPHA_MODE_OPAQUE:
+                        case ALPHA_MODE_CUSTOM:
+                            return mode;
+
+                        default:
+                            break;
+                        }
+                    }
+                }
+                else if ((FOURCC_DXT2 == header.ddspf.fourCC)
+                    || (FOURCC_DXT4 == header.ddspf.fourCC))
+                {
+                    return ALPHA_MODE_PREMULTIPLIED;
+                }
+            }
+
+            return ALPHA_MODE_UNKNOWN;
+        }
+
+
+        // Decodes the texture description from a DDS header and its DX10 extended header (which must be given if
+        // the header has the "DX10" FourCC), and rejects anything larger than the Direct3D hardware requirements.
+        inline Result DecodeHeader(const Header& header, const HeaderDXT10* d3d10ext, TextureDesc* desc)
+        {
+            if (!desc)
+            {
+                return RESULT_INVALID_ARG;
+            }
+
+            memset(desc, 0, sizeof(TextureDesc));
+
+            desc->width = header.width;
+            desc->height = header.height;
+            desc->depth = header.depth;
+            desc->arraySize = 1;
+
+            desc->mipLevels = header.mipMapCount;
+            if (0 == desc->mipLevels)
+            {
+                desc->mipLevels = 1;
+            }
+
+            if ((header.ddspf.flags & c_PixelFourCC) &&
+                (FOURCC_DX10 == header.ddspf.fourCC))
+            {
+                if (!d3d10ext)
+                {
+                    return RESULT_INVALID_ARG;
+                }
+
+                desc->arraySize = d3d10ext->arraySize;
+                if (desc->arraySize == 0)
+                {
+                    return RESULT_INVALID_DATA;
+                }
+
+                auto format = static_cast<Format>(d3d10ext->dxgiFormat);
+
+                switch (format)
+                {
+                case FORMAT_AI44:
+                case FORMAT_IA44:
+                case FORMAT_P8:
+                case FORMAT_A8P8:
+                    return RESULT_NOT_SUPPORTED;
+
+                default:
+                    if (BitsPerPixel(format) == 0)
+                    {
+                        return RESULT_NOT_SUPPORTED;
+                    }
+                }
+
+                desc->format = format;
+
+                switch (d3d10ext->resourceDimension)
+                {
+                case DIMENSION_TEXTURE1D:
+                    // D3DX writes 1D textures with a fixed Height of 1
+                    if ((header.flags & c_HeaderHeight) && desc->height != 1)
+                    {
+                        return RESULT_INVALID_DATA;
+                    }
+                    desc->height = desc->depth = 1;
+                    break;
+
+                case DIMENSION_TEXTURE2D:
+                    if (d3d10ext->miscFlag & c_MiscTextureCube)
+                    {
+                        if (desc->arraySize > UINT32_MAX / 6)
+                        {
+                            return RESULT_NOT_SUPPORTED;
+                        }
+
+                        desc->arraySize *= 6;
+                        desc->isCubeMap = true;
+                    }
+                    desc->depth = 1;
+                    break;
+
+                case DIMENSION_TEXTURE3D:
+                    if (!(header.flags & c_HeaderVolume))
+                    {
+                        return RESULT_INVALID_DATA;
+                    }
+
+                    if (desc->arraySize > 1)
+                    {
+                        return RESULT_NOT_SUPPORTED;
+                    }
+                    break;
+
+                default:
+                    return RESULT_NOT_SUPPORTED;
+                }
+
+                desc->dimension = static_cast<Dimension>(d3d10ext->resourceDimension);
+            }
+            else
+            {
+                desc->format = GetFormat(header.ddspf);
+
+                if (desc->format == FORMAT_UNKNOWN)
+                {
+                    return RESULT_NOT_SUPPORTED;
+                }
+
+                if (header.flags & c_HeaderVolume)
+                {
+                    desc->dimension = DIMENSION_TEXTURE3D;
+                }
+                else
+                {
+                    if (header.caps2 & c_Cubemap)
+                    {
+                        // We require all six faces to be defined
+                        if ((header.caps2 & c_CubemapAllFaces) != c_CubemapAllFaces)
+                        {
+                            return RESULT_NOT_SUPPORTED;
+                        }
+
+                        desc->arraySize = 6;
+                        desc->isCubeMap = true;
+                    }
+
+                    desc->depth = 1;
+                    desc->dimension = DIMENSION_TEXTURE2D;
+
+                    // Note there's no way for a legacy Direct3D 9 DDS to express a '1D' texture
+                }
+            }
+
+            // Bound sizes (for security purposes we don't trust DDS file metadata larger than the Direct3D hardware requirements)
+            if (desc->mipLevels > c_MaxMipLevels)
+            {
+                return RESULT_NOT_SUPPORTED;
+            }
+
+            switch (desc->dimension)
+            {
+            case DIMENSION_TEXTURE1D:
+                if ((desc->arraySize > c_MaxTexture1DArraySize) ||
+                    (desc->width > c_MaxTexture1DWidth))
+                {
+                    return RESULT_NOT_SUPPORTED;
+                }
+                break;
+
+            case DIMENSION_TEXTURE2D:
+                if (desc->isCubeMap)
+                {
+                    // This is the right bound because we set arraySize to (NumCubes*6) above
+                    if ((desc->arraySize > c_MaxTexture2DArraySize) ||
+                        (desc->width > c_MaxTextureCubeSize) ||
+                        (desc->height > c_MaxTextureCubeSize))
+                    {
+                        return RESULT_NOT_SUPPORTED;
+                    }
+                }
+                else if ((desc->arraySize > c_MaxTexture2DArraySize) ||
+                    (desc->width > c_MaxTexture2DSize) ||
+                    (desc->height > c_MaxTexture2DSize))
+                {
+                    return RESULT_NOT_SUPPORTED;
+                }
+                break;
+
+            case DIMENSION_TEXTURE3D:
+                if ((desc->arraySize > 1) ||
+                    (desc->width > c_MaxTexture3DSize) ||
+                    (desc->height > c_MaxTexture3DSize) ||
+                    (desc->depth > c_MaxTexture3DSize))
+                {
+                    return RESULT_NOT_SUPPORTED;
+                }
+                break;
+
+            default:
+                return RESULT_NOT_SUPPORTED;
+            }
+
+            desc->alphaMode = GetAlphaMode(header, d3d10ext);
+
+            return RESULT_OK;
+        }
+
+
+        // Checks that ddsData starts with a valid DDS header, and returns the offset of the first subresource.
+        // The headers are copied out, so ddsData does not need to be aligned.
+        inline Result ReadHeader(const uint8_t* ddsData, size_t ddsDataSize,
+                                 Header* header, HeaderDXT10* d3d10ext, bool* hasD3D10Ext, size_t* dataOffset)
+        {
+            if (!ddsData || !header || !d3d10ext || !hasD3D10Ext || !dataOffset)
+            {
+                return RESULT_INVALID_ARG;
+            }
+
+            *hasD3D10Ext = false;
+            *dataOffset = 0;
+
+            if (ddsDataSize < (sizeof(uint32_t) + sizeof(Header)))
+            {
+                return RESULT_NOT_DDS;
+            }
+
+            uint32_t magic;
+            memcpy(&magic, ddsData, sizeof(uint32_t));
+            if (magic != c_Magic)
+            {
+                return RESULT_NOT_DDS;
+            }
+
+            memcpy(header, ddsData + sizeof(uint32_t), sizeof(Header));
+
+            // Verify header to validate DDS file
+            if (header->size != sizeof(Header) ||
+                header->ddspf.size != sizeof(PixelFormat))
+            {
+                return RESULT_NOT_DDS;
+            }
+
+            size_t offset = sizeof(uint32_t) + sizeof(Header);
+
+            // Check for DX10 extension
+            if ((header->ddspf.flags & c_PixelFourCC) &&
+                (FOURCC_DX10 == header->ddspf.fourCC))
+            {
+                // Must be long enough for both headers and magic value
+                if (ddsDataSize < (offset + sizeof(HeaderDXT10)))
+                {
+                    return RESULT_NOT_DDS;
+                }
+
+                memcpy(d3d10ext, ddsData + offset, sizeof(HeaderDXT10));
+                *hasD3D10Ext = true;
+
+                offset += sizeof(HeaderDXT10);
+            }
+
+            *dataOffset = offset;
+
+            return RESULT_OK;
+        }
+
+
+        // Validates a DDS file in memory, applying the same checks as CreateDDSTextureFromMemory. If layouts is given,
+        // it receives one entry per subresource in D3D11CalcSubresource order (all mips of array slice 0, then slice 1,
+        // ...), so it must hold at least desc.mipLevels * desc.arraySize entries.
+        inline Result GetTextureLayout(const uint8_t* ddsData, size_t ddsDataSize, TextureDesc* desc,
+                                       SubresourceLayout* layouts = nullptr, size_t maxLayouts = 0)
+        {
+            if (desc)
+            {
+                memset(desc, 0, sizeof(TextureDesc));
+            }
+
+            if (!ddsData || !desc)
+            {
+                return RESULT_INVALID_ARG;
+            }
+
+            Header header;
+            HeaderDXT10 d3d10ext;
+            bool hasD3D10Ext;
+            size_t offset;
+
+            Result result = ReadHeader(ddsData, ddsDataSize, &header, &d3d10ext, &hasD3D10Ext, &offset);
+            if (result != RESULT_OK)
+            {
+                return result;
+            }
+
+            TextureDesc decoded;
+            result = DecodeHeader(header, hasD3D10Ext ? &d3d10ext : nullptr, &decoded);
+            if (result != RESULT_OK)
+            {
+                return result;
+            }
+
+            if (layouts && maxLayouts < size_t(decoded.mipLevels) * decoded.arraySize)
+            {
+                return RESULT_INSUFFICIENT_BUFFER;
+            }
+
+            // Walk the subresources in file order, making sure every one of them is present
+            size_t index = 0;
+            for (size_t j = 0; j < decoded.arraySize; j++)
+            {
+                size_t w = decoded.width;
+                size_t h = decoded.height;
+                size_t d = decoded.depth;
+                for (size_t i = 0; i < decoded.mipLevels; i++)
+                {
+                    size_t numBytes = 0;
+                    size_t rowBytes = 0;
+                    size_t numRows = 0;
+                    GetSurfaceInfo(w, h, decoded.format, &numBytes, &rowBytes, &numRows);
+
+                    if (!numBytes || d > (ddsDataSize - offset) / numBytes)
+                    {
+                        return RESULT_END_OF_FILE;
+                    }
+
+                    if (layouts)
+                    {
+                        auto& layout = layouts[index];
+                        layout.offset = offset;
+                        layout.rowPitch = rowBytes;
+                        layout.slicePitch = numBytes;
+                        layout.numRows = numRows;
+                        layout.width = static_cast<uint32_t>(w);
+                        layout.height = static_cast<uint32_t>(h);
+                        layout.depth = static_cast<uint32_t>(d);
+                    }
+
+                    ++index;
+                    offset += numBytes * d;
+
+                    w = std::max<size_t>(w >> 1, 1);
+                    h = std::max<size_t>(h >> 1, 1);
+                    d = std::max<size_t>(d >> 1, 1);
+                }
+            }
+
+            *desc = decoded;
+
+            return RESULT_OK;
+        }
+    }
+}
+
+
+#ifdef DDSPARSER_FUZZ_ENTRY_POINT
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    using namespace DirectX::DDSParser;
+
+    TextureDesc desc;
+    if (GetTextureLayout(data, size, &desc) == RESULT_OK)
+    {
+        size_t count = size_t(desc.mipLevels) * desc.arraySize;
+
+        SubresourceLayout* layouts = new SubresourceLayout[count];
+        GetTextureLayout(data, size, &desc, layouts, count);
+        delete[] layouts;
+    }
+
+    return 0;
+}
+#endif
@@ -28,6 +28,8 @@
 
 #include <stdint.h>
 
+#include "DDSParser.h"
+
 
 namespace DirectX
 {
@@ -155,4 +157,32 @@ namespace DirectX
         _Outptr_opt_ ID3D11Resource** texture,
         _Outptr_opt_ ID3D11ShaderResourceView** textureView,
         _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr);
-}
\ No newline at end of file
+
+    // Device-independent description of a DDS file
+    struct DDS_TEXTURE_DESC
+    {
+        D3D11_RESOURCE_DIMENSION dimension;
+        DXGI_FORMAT format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        uint32_t mipLevels;
+        uint32_t arraySize;         // Counts individual faces for cubemaps
+        bool isCubeMap;
+        DDS_ALPHA_MODE alphaMode;
+    };
+
+    // Location of one subresource within the DDS data
+    typedef DDSParser::SubresourceLayout DDS_SUBRESOURCE_LAYOUT;
+
+    // Validates a DDS file in memory without needing a device, applying the same checks as CreateDDSTextureFromMemory.
+    // If layouts is provided, it receives one entry per subresource in D3D11CalcSubresource order (all mips of array
+    // slice 0, then slice 1, ...), so it must hold at least desc.mipLevels * desc.arraySize entries. This wraps
+    // DDSParser::GetTextureLayout, which can also be used where Direct3D is not available.
+    HRESULT __cdecl GetDDSTextureLayout(
+        _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+        _In_ size_t ddsDataSize,
+        _Out_ DDS_TEXTURE_DESC* desc,
+        _Out_writes_opt_(maxLayouts) DDS_SUBRESOURCE_LAYOUT* layouts = nullptr,
+        _In_ size_t maxLayouts = 0);
+}
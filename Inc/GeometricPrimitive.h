@@ -63,6 +63,24 @@ namespace DirectX
         static void __cdecl CreateIcosahedron   (std::vector<VertexType>& vertices, std::vector<uint16_t>& indices, float size = 1, bool rhcoords = true);
         static void __cdecl CreateTeapot        (std::vector<VertexType>& vertices, std::vector<uint16_t>& indices, float size = 1, size_t tessellation = 8, bool rhcoords = true);
 
+        // 32-bit index versions, for tessellations with more than 65535 vertices.
+        static void __cdecl CreateCube          (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateBox           (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, const XMFLOAT3& size, bool rhcoords = true, bool invertn = false);
+        static void __cdecl CreateSphere        (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, size_t tessellation = 16, bool rhcoords = true, bool invertn = false);
+        static void __cdecl CreateGeoSphere     (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, size_t tessellation = 3, bool rhcoords = true);
+        static void __cdecl CreateCylinder      (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float height = 1, float diameter = 1, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateCone          (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateTorus         (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateTetrahedron   (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateOctahedron    (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateDodecahedron  (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateIcosahedron   (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateTeapot        (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, size_t tessellation = 8, bool rhcoords = true);
+
+        // Tessellates bicubic bezier patches, given as 16 control points each (row by row), in parallel for large patch sets.
+        static void __cdecl CreateBezierPatches (std::vector<VertexType>& vertices, std::vector<uint16_t>& indices, _In_reads_(patchCount * 16) const XMFLOAT3* controlPoints, size_t patchCount, size_t tessellation = 8, bool rhcoords = true);
+        static void __cdecl CreateBezierPatches (std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, _In_reads_(patchCount * 16) const XMFLOAT3* controlPoints, size_t patchCount, size_t tessellation = 8, bool rhcoords = true);
+
         // Draw the primitive.
         void XM_CALLCONV Draw(FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection, FXMVECTOR color = Colors::White, _In_opt_ ID3D11ShaderResourceView* texture = nullptr, bool wireframe = false,
                               _In_opt_ std::function<void __cdecl()> setCustomState = nullptr ) const;
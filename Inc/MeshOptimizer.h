@@ -0,0 +1,806 @@
+//--------------------------------------------------------------------------------------
+// File: MeshOptimizer.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+// Reorders indexed triangle lists for the post-transform vertex cache (Sander, Nehab and Barczak's "Tipsify"), and
+// optionally for less overdraw, then reorders vertices for fetch locality. This only depends on the C++ standard
+// library, so it can be used by offline asset builds on any platform as well as at load time. SimplifyFaces reduces
+// the triangle count for levels of detail, leaving the vertices as they are.
+//
+// Each call works on one range of an index buffer, so to keep submesh boundaries call OptimizeFaces or SimplifyFaces
+// once for the index range of each ModelMeshPart (startIndex, indexCount). OptimizeVertices then works on the whole
+// index buffer of a vertex buffer, which is only valid if every part drawing from that vertex buffer uses the same vertexOffset.
+namespace DirectX
+{
+    namespace MeshOptimizer
+    {
+        // Size of the FIFO cache which is optimized for and simulated, if not given. Most hardware since D3D10 has
+        // a larger or non-FIFO cache, but an ordering that is good for this size is good for those too.
+        const size_t c_DefaultCacheSize = 16;
+
+        const uint32_t c_Unused = uint32_t(-1);
+
+        namespace Internal
+        {
+            template<typename TIndex>
+            inline void ValidateIndices(const TIndex* indices, size_t nFaces, size_t nVerts)
+            {
+                if (!indices && nFaces)
+                    throw std::invalid_argument("indices");
+
+                if (nVerts >= c_Unused)
+                    throw std::out_of_range("Too many vertices");
+
+                for (size_t j = 0; j < nFaces * 3; ++j)
+                {
+                    if (size_t(indices[j]) >= nVerts)
+                        throw std::out_of_range("Index not in vertices list");
+                }
+            }
+
+
+            // The triangles using each vertex, in compressed rows.
+            struct Adjacency
+            {
+                template<typename TIndex>
+                Adjacency(const TIndex* indices, size_t nFaces, size_t nVerts) :
+                    offsets(nVerts + 1, 0),
+                    faces(nFaces * 3)
+                {
+                    for (size_t j = 0; j < nFaces * 3; ++j)
+                    {
+                        ++offsets[indices[j] + 1];
+                    }
+
+                    for (size_t v = 0; v < nVerts; ++v)
+                    {
+                        offsets[v + 1] += offsets[v];
+                    }
+
+                    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                    for (size_t j = 0; j < nFaces * 3; ++j)
+                    {
+                        faces[fill[indices[j]]++] = static_cast<uint32_t>(j / 3);
+                    }
+                }
+
+                uint32_t Count(size_t v) const { return offsets[v + 1] - offsets[v]; }
+
+                std::vector<uint32_t> offsets;
+                std::vector<uint32_t> faces;
+            };
+
+
+            // Tipsify. Writes the new face order to faceRemap, and the faces where each cluster starts (each point
+            // where the fan ran into a dead end and had to restart elsewhere) to clusters.
+            template<typename TIndex>
+            inline void Tipsify(const TIndex* indices, size_t nFaces, size_t nVerts, size_t cacheSize,
+                                uint32_t* faceRemap, std::vector<uint32_t>* clusters)
+            {
+                Adjacency adjacency(indices, nFaces, nVerts);
+
+                std::vector<uint32_t> liveCount(nVerts);
+                for (size_t v = 0; v < nVerts; ++v)
+                {
+                    liveCount[v] = adjacency.Count(v);
+                }
+
+                std::vector<size_t> cacheTime(nVerts, 0);
+                std::vector<bool> emitted(nFaces, false);
+                std::vector<uint32_t> deadEnd;
+                std::vector<uint32_t> candidates;
+
+                deadEnd.reserve(nFaces * 3);
+                candidates.reserve(64);
+
+                size_t time = cacheSize + 1;
+                size_t cursor = 0;
+                size_t outFace = 0;
+                bool newCluster = true;
+
+                // Next vertex with triangles left, taken from the dead-end stack of recently used vertices,
+                // and failing that from the next vertex in input order.
+                auto skipDeadEnd = [&]() -> size_t
+                {
+                    while (!deadEnd.empty())
+                    {
+                        uint32_t v = deadEnd.back();
+                        deadEnd.pop_back();
+                        if (liveCount[v] > 0)
+                            return v;
+                    }
+
+                    while (cursor < nVerts)
+                    {
+                        if (liveCount[cursor] > 0)
+                            return cursor;
+                        ++cursor;
+                    }
+
+                    return c_Unused;
+                };
+
+                size_t fan = skipDeadEnd();
+                while (fan != c_Unused)
+                {
+                    if (newCluster && clusters)
+                        clusters->push_back(static_cast<uint32_t>(outFace));
+
+                    candidates.clear();
+
+                    for (uint32_t k = adjacency.offsets[fan]; k < adjacency.offsets[fan + 1]; ++k)
+                    {
+                        uint32_t face = adjacency.faces[k];
+                        if (emitted[face])
+                            continue;
+
+                        emitted[face] = true;
+                        faceRemap[outFace++] = face;
+
+                        for (size_t c = 0; c < 3; ++c)
+                        {
+                            TIndex v = indices[face * 3 + c];
+
+                            deadEnd.push_back(v);
+                            candidates.push_back(v);
+                            --liveCount[v];
+
+                            if (time - cacheTime[v] > cacheSize)
+                            {
+                                cacheTime[v] = time;
+                                ++time;
+                            }
+                        }
+                    }
+
+                    // Prefer the candidate which has been in the cache longest, as long as fanning around
+                    // it would not push it out of the cache
+                    size_t next = c_Unused;
+                    size_t best = 0;
+                    for (auto it = candidates.cbegin(); it != candidates.cend(); ++it)
+                    {
+                        uint32_t v = *it;
+                        if (!liveCount[v])
+                            continue;
+
+                        size_t priority = 0;
+                        if (time - cacheTime[v] + 2 * liveCount[v] <= cacheSize)
+                            priority = time - cacheTime[v];
+
+                        if (next == c_Unused || priority > best)
+                        {
+                            best = priority;
+                            next = v;
+                        }
+                    }
+
+                    newCluster = (next == c_Unused);
+                    fan = newCluster ? skipDeadEnd() : next;
+                }
+            }
+        }
+
+
+        // Simulates a FIFO post-transform vertex cache, returning the average cache miss ratio (transformed vertices
+        // per triangle: 0.5 is ideal for large regular meshes, and 3 is the worst case) and the average transform
+        // to vertex ratio (transformed vertices per vertex used: 1 is ideal).
+        template<typename TIndex>
+        inline void ComputeVertexCacheMissRate(const TIndex* indices, size_t nFaces, size_t nVerts, size_t cacheSize,
+                                               float& acmr, float& atvr)
+        {
+            Internal::ValidateIndices(indices, nFaces, nVerts);
+
+            acmr = atvr = 0.f;
+
+            if (!nFaces || !cacheSize)
+                return;
+
+            // The miss count at which each vertex was last loaded; it is in the cache until cacheSize more misses
+            std::vector<size_t> loadedAt(nVerts, size_t(-1));
+
+            size_t misses = 0;
+            size_t used = 0;
+
+            for (size_t j = 0; j < nFaces * 3; ++j)
+            {
+                TIndex v = indices[j];
+
+                if (loadedAt[v] == size_t(-1))
+                {
+                    ++used;
+                }
+                else if (misses - loadedAt[v] < cacheSize)
+                {
+                    continue;
+                }
+
+                loadedAt[v] = misses;
+                ++misses;
+            }
+
+            acmr = float(misses) / float(nFaces);
+            atvr = float(misses) / float(used);
+        }
+
+
+        // Computes an order of the faces for the vertex cache. faceRemap[newFace] receives the original face index.
+        template<typename TIndex>
+        inline void OptimizeFaces(const TIndex* indices, size_t nFaces, size_t nVerts, uint32_t* faceRemap,
+                                  size_t cacheSize = c_DefaultCacheSize)
+        {
+            Internal::ValidateIndices(indices, nFaces, nVerts);
+
+            if (!faceRemap && nFaces)
+                throw std::invalid_argument("faceRemap");
+
+            Internal::Tipsify(indices, nFaces, nVerts, cacheSize, faceRemap, nullptr);
+        }
+
+
+        // As OptimizeFaces, then sorts the clusters of faces found along the way so that those facing outwards from the
+        // middle of the mesh come first, which reduces overdraw from most viewpoints without losing much cache
+        // efficiency. Positions are the first three floats of each vertex, which is positionStride bytes long.
+        template<typename TIndex>
+        inline void OptimizeFaces(const TIndex* indices, size_t nFaces, const float* positions, size_t positionStride,
+                                  size_t nVerts, uint32_t* faceRemap, size_t cacheSize = c_DefaultCacheSize)
+        {
+            Internal::ValidateIndices(indices, nFaces, nVerts);
+
+            if (!faceRemap && nFaces)
+                throw std::invalid_argument("faceRemap");
+
+            if (!positions && nVerts)
+                throw std::invalid_argument("positions");
+
+            if (positionStride < sizeof(float) * 3)
+                throw std::invalid_argument("positionStride");
+
+            std::vector<uint32_t> order(nFaces);
+            std::vector<uint32_t> clusters;
+            Internal::Tipsify(indices, nFaces, nVerts, cacheSize, order.data(), &clusters);
+            clusters.push_back(static_cast<uint32_t>(nFaces));
+
+            auto position = [&](size_t v) -> const float*
+            {
+                return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * positionStride);
+            };
+
+            // Area weighted centroid and normal of each cluster, and the centroid of the whole mesh
+            struct Cluster
+            {
+                uint32_t start;
+                uint32_t end;
+                float sortKey;
+                float centroid[3];
+                float normal[3];
+            };
+
+            std::vector<Cluster> clusterInfo(clusters.size() - 1);
+            double meshCentroid[3] = {};
+            double meshArea = 0;
+
+            for (size_t c = 0; c + 1 < clusters.size(); ++c)
+            {
+                Cluster& cluster = clusterInfo[c];
+                cluster.start = clusters[c];
+                cluster.end = clusters[c + 1];
+
+                double centroid[3] = {};
+                double normal[3] = {};
+                double area = 0;
+
+                for (uint32_t f = cluster.start; f < cluster.end; ++f)
+                {
+                    const TIndex* face = &indices[order[f] * 3];
+                    const float* p0 = position(face[0]);
+                    const float* p1 = position(face[1]);
+                    const float* p2 = position(face[2]);
+
+                    double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                    double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                    double n[3] = { e1[1] * e2[2] - e1[2] * e2[1],
+                                    e1[2] * e2[0] - e1[0] * e2[2],
+                                    e1[0] * e2[1] - e1[1] * e2[0] };
+                    double a = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        centroid[k] += a * (p0[k] + p1[k] + p2[k]) / 3.0;
+                        normal[k] += n[k];
+                    }
+
+                    area += a;
+                }
+
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    meshCentroid[k] += centroid[k];
+                    cluster.centroid[k] = (area > 0) ? float(centroid[k] / area) : 0.f;
+                    cluster.normal[k] = float(normal[k]);
+                }
+
+                meshArea += area;
+            }
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                meshCentroid[k] = (meshArea > 0) ? (meshCentroid[k] / meshArea) : 0;
+            }
+
+            for (auto it = clusterInfo.begin(); it != clusterInfo.end(); ++it)
+            {
+                double length = sqrt(double(it->normal[0]) * it->normal[0] + double(it->normal[1]) * it->normal[1] + double(it->normal[2]) * it->normal[2]);
+                double dot = 0;
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    dot += (it->centroid[k] - meshCentroid[k]) * it->normal[k];
+                }
+
+                it->sortKey = (length > 0) ? float(dot / length) : 0.f;
+            }
+
+            std::stable_sort(clusterInfo.begin(), clusterInfo.end(), [](const Cluster& a, const Cluster& b)
+            {
+                return a.sortKey > b.sortKey;
+            });
+
+            size_t outFace = 0;
+            for (auto it = clusterInfo.cbegin(); it != clusterInfo.cend(); ++it)
+            {
+                for (uint32_t f = it->start; f < it->end; ++f)
+                {
+                    faceRemap[outFace++] = order[f];
+                }
+            }
+        }
+
+
+        // Writes the faces of indices to indicesOut in the order given by faceRemap. These must not overlap.
+        template<typename TIndex>
+        inline void ReorderIndices(const TIndex* indices, size_t nFaces, const uint32_t* faceRemap, TIndex* indicesOut)
+        {
+            for (size_t j = 0; j < nFaces; ++j)
+            {
+                uint32_t face = faceRemap[j];
+                if (face >= nFaces)
+                    throw std::out_of_range("Face not in face list");
+
+                indicesOut[j * 3 + 0] = indices[face * 3 + 0];
+                indicesOut[j * 3 + 1] = indices[face * 3 + 1];
+                indicesOut[j * 3 + 2] = indices[face * 3 + 2];
+            }
+        }
+
+
+        // Computes an order of the vertices in which they are first used by the (already optimized) faces, so
+        // vertex fetches walk through memory. vertexRemap[newVertex] receives the original vertex index; vertices
+        // which no face uses go at the end, in their original order.
+        template<typename TIndex>
+        inline void OptimizeVertices(const TIndex* indices, size_t nFaces, size_t nVerts, uint32_t* vertexRemap)
+        {
+            Internal::ValidateIndices(indices, nFaces, nVerts);
+
+            if (!vertexRemap && nVerts)
+                throw std::invalid_argument("vertexRemap");
+
+            std::vector<bool> placed(nVerts, false);
+            size_t outVertex = 0;
+
+            for (size_t j = 0; j < nFaces * 3; ++j)
+            {
+                TIndex v = indices[j];
+                if (!placed[v])
+                {
+                    placed[v] = true;
+                    vertexRemap[outVertex++] = static_cast<uint32_t>(v);
+                }
+            }
+
+            for (size_t v = 0; v < nVerts; ++v)
+            {
+                if (!placed[v])
+                    vertexRemap[outVertex++] = static_cast<uint32_t>(v);
+            }
+        }
+
+
+        // Rewrites indices in place to refer to the vertices as reordered by vertexRemap.
+        template<typename TIndex>
+        inline void FinalizeIndices(TIndex* indices, size_t nFaces, const uint32_t* vertexRemap, size_t nVerts)
+        {
+            std::vector<uint32_t> newIndex(nVerts, c_Unused);
+            for (size_t j = 0; j < nVerts; ++j)
+            {
+                if (vertexRemap[j] >= nVerts || newIndex[vertexRemap[j]] != c_Unused)
+                    throw std::invalid_argument("vertexRemap is not a permutation");
+
+                newIndex[vertexRemap[j]] = static_cast<uint32_t>(j);
+            }
+
+            for (size_t j = 0; j < nFaces * 3; ++j)
+            {
+                if (size_t(indices[j]) >= nVerts)
+                    throw std::out_of_range("Index not in vertices list");
+
+                indices[j] = static_cast<TIndex>(newIndex[indices[j]]);
+            }
+        }
+
+
+        // Reorders vertices in place, each of which is stride bytes long, as given by vertexRemap.
+        inline void FinalizeVertices(void* vertices, size_t stride, size_t nVerts, const uint32_t* vertexRemap)
+        {
+            std::vector<uint8_t> original(static_cast<uint8_t*>(vertices), static_cast<uint8_t*>(vertices) + stride * nVerts);
+
+            for (size_t j = 0; j < nVerts; ++j)
+            {
+                if (vertexRemap[j] >= nVerts)
+                    throw std::out_of_range("vertexRemap");
+
+                memcpy(static_cast<uint8_t*>(vertices) + j * stride, &original[vertexRemap[j] * stride], stride);
+            }
+        }
+
+
+        // Simplifies a triangle list by collapsing edges in order of quadric error (Garland and Heckbert), until no more
+        // than targetFaces remain or every remaining collapse would move the surface by more than about maxError. Each
+        // vertex only ever collapses onto one of its neighbors, so the faces left use the original vertices, with their
+        // normals, texture coordinates and other attributes unchanged, and the vertex buffer can be shared. Vertices on
+        // an edge which doesn't have exactly two faces are never removed; that covers open borders, seams where vertices
+        // are split for their normals or texture coordinates, and the boundary of each submesh if called per part.
+        // Positions are as for OptimizeFaces. Returns the number of faces written to indicesOut, which may be indices.
+        template<typename TIndex>
+        inline size_t SimplifyFaces(const TIndex* indices, size_t nFaces, const float* positions, size_t positionStride,
+                                    size_t nVerts, size_t targetFaces, float maxError, TIndex* indicesOut)
+        {
+            Internal::ValidateIndices(indices, nFaces, nVerts);
+
+            if (!indicesOut && nFaces)
+                throw std::invalid_argument("indicesOut");
+
+            if (!positions && nVerts)
+                throw std::invalid_argument("positions");
+
+            if (positionStride < sizeof(float) * 3)
+                throw std::invalid_argument("positionStride");
+
+            std::vector<uint32_t> tris(indices, indices + nFaces * 3);
+
+            if (targetFaces >= nFaces)
+            {
+                std::copy(tris.begin(), tris.end(), indicesOut);
+                return nFaces;
+            }
+
+            std::vector<double> points(nVerts * 3);
+            for (size_t v = 0; v < nVerts; ++v)
+            {
+                auto p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * positionStride);
+                points[v * 3] = p[0];
+                points[v * 3 + 1] = p[1];
+                points[v * 3 + 2] = p[2];
+            }
+
+            // Sum of squared distances to the planes of the faces around each vertex, as the upper triangle of a 4x4
+            struct Quadric
+            {
+                double m[10];
+
+                void Add(const Quadric& q)
+                {
+                    for (size_t j = 0; j < 10; ++j)
+                        m[j] += q.m[j];
+                }
+
+                double Evaluate(const double* p) const
+                {
+                    double x = p[0], y = p[1], z = p[2];
+                    return m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x
+                                        + m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y
+                                                       + m[7] * z * z + 2 * m[8] * z
+                                                                          + m[9];
+                }
+            };
+
+            std::vector<Quadric> quadrics(nVerts, Quadric{});
+            std::vector<std::vector<uint32_t>> vertexFaces(nVerts);
+
+            auto faceNormal = [&](uint32_t a, uint32_t b, uint32_t c, double* n)
+            {
+                const double* pa = &points[a * 3];
+                const double* pb = &points[b * 3];
+                const double* pc = &points[c * 3];
+                double e1[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+                double e2[3] = { pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2] };
+                n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+                n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+                n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+            };
+
+            for (size_t f = 0; f < nFaces; ++f)
+            {
+                const uint32_t* t = &tris[f * 3];
+
+                double n[3];
+                faceNormal(t[0], t[1], t[2], n);
+                double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                // Degenerate faces have no plane, but still count for the topology
+                if (len > 0)
+                {
+                    double a = n[0] / len, b = n[1] / len, c = n[2] / len;
+                    double d = -(a * points[t[0] * 3] + b * points[t[0] * 3 + 1] + c * points[t[0] * 3 + 2]);
+
+                    Quadric q = { { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d } };
+                    for (size_t k = 0; k < 3; ++k)
+                        quadrics[t[k]].Add(q);
+                }
+
+                for (size_t k = 0; k < 3; ++k)
+                    vertexFaces[t[k]].push_back(static_cast<uint32_t>(f));
+            }
+
+            // Lock the vertices of every edge which isn't shared by exactly two faces
+            std::vector<uint8_t> locked(nVerts, 0);
+            {
+                std::vector<uint64_t> edges;
+                edges.reserve(nFaces * 3);
+                for (size_t f = 0; f < nFaces; ++f)
+                {
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        uint64_t a = tris[f * 3 + k];
+                        uint64_t b = tris[f * 3 + (k + 1) % 3];
+                        edges.push_back(a < b ? ((a << 32) | b) : ((b << 32) | a));
+                    }
+                }
+
+                std::sort(edges.begin(), edges.end());
+
+                for (size_t j = 0; j < edges.size(); )
+                {
+                    size_t k = j + 1;
+                    while (k < edges.size() && edges[k] == edges[j])
+                        ++k;
+
+                    if (k - j != 2)
+                    {
+                        locked[uint32_t(edges[j] >> 32)] = 1;
+                        locked[uint32_t(edges[j])] = 1;
+                    }
+
+                    j = k;
+                }
+            }
+
+            // Candidate collapses of 'from' onto 'to', cheapest first. Candidates are never updated in place; instead
+            // each vertex has a version which changes when it does, and stale candidates are skipped when popped.
+            // Shorter edges go first among those with about the same error, or flat areas would all collapse onto
+            // whichever vertex came first, and its ever growing fan would make each later collapse slower.
+            struct Collapse
+            {
+                double cost;
+                double error;
+                uint32_t from;
+                uint32_t to;
+                uint32_t fromVersion;
+                uint32_t toVersion;
+
+                bool operator< (const Collapse& other) const { return cost > other.cost; }
+            };
+
+            std::vector<Collapse> heap;
+            std::vector<uint32_t> versions(nVerts, 0);
+            std::vector<uint8_t> removed(nVerts, 0);
+            std::vector<uint8_t> faceAlive(nFaces, 1);
+
+            auto push = [&](uint32_t from, uint32_t to)
+            {
+                if (locked[from])
+                    return;
+
+                Quadric q = quadrics[from];
+                q.Add(quadrics[to]);
+
+                const double* pf = &points[from * 3];
+                const double* pt = &points[to * 3];
+                double lengthSq = (pt[0] - pf[0]) * (pt[0] - pf[0]) + (pt[1] - pf[1]) * (pt[1] - pf[1])
+                                  + (pt[2] - pf[2]) * (pt[2] - pf[2]);
+
+                double error = q.Evaluate(pt);
+                Collapse c = { error + lengthSq * 1e-6, error, from, to, versions[from], versions[to] };
+                heap.push_back(c);
+                std::push_heap(heap.begin(), heap.end());
+            };
+
+            for (size_t f = 0; f < nFaces; ++f)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    uint32_t a = tris[f * 3 + k];
+                    uint32_t b = tris[f * 3 + (k + 1) % 3];
+                    if (a < b)
+                    {
+                        push(a, b);
+                        push(b, a);
+                    }
+                }
+            }
+
+            auto neighbors = [&](uint32_t v, std::vector<uint32_t>& result)
+            {
+                result.clear();
+                for (uint32_t f : vertexFaces[v])
+                {
+                    if (!faceAlive[f])
+                        continue;
+
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        if (tris[f * 3 + k] != v)
+                            result.push_back(tris[f * 3 + k]);
+                    }
+                }
+
+                std::sort(result.begin(), result.end());
+                result.erase(std::unique(result.begin(), result.end()), result.end());
+            };
+
+            double maxCost = double(maxError) * double(maxError);
+            size_t liveFaces = nFaces;
+            std::vector<uint32_t> fromRing;
+            std::vector<uint32_t> toRing;
+
+            while (liveFaces > targetFaces && !heap.empty())
+            {
+                std::pop_heap(heap.begin(), heap.end());
+                Collapse c = heap.back();
+                heap.pop_back();
+
+                if (c.error > maxCost || removed[c.from] || removed[c.to]
+                    || versions[c.from] != c.fromVersion || versions[c.to] != c.toVersion)
+                    continue;
+
+                // Link condition: the edge's two faces must be the only ones the collapse removes, or the surface
+                // would pinch or fold over itself
+                size_t sharedFaces = 0;
+                for (uint32_t f : vertexFaces[c.from])
+                {
+                    if (faceAlive[f]
+                        && (tris[f * 3] == c.to || tris[f * 3 + 1] == c.to || tris[f * 3 + 2] == c.to))
+                        ++sharedFaces;
+                }
+
+                if (sharedFaces != 2)
+                    continue;
+
+                neighbors(c.from, fromRing);
+                neighbors(c.to, toRing);
+
+                size_t common = 0;
+                for (size_t i = 0, j = 0; i < fromRing.size() && j < toRing.size(); )
+                {
+                    if (fromRing[i] < toRing[j])
+                        ++i;
+                    else if (toRing[j] < fromRing[i])
+                        ++j;
+                    else
+                    {
+                        ++common;
+                        ++i;
+                        ++j;
+                    }
+                }
+
+                if (common != 2)
+                    continue;
+
+                // Reject collapses which would flip any of the faces that stay
+                bool flips = false;
+                for (uint32_t f : vertexFaces[c.from])
+                {
+                    if (!faceAlive[f])
+                        continue;
+
+                    const uint32_t* t = &tris[f * 3];
+                    if (t[0] == c.to || t[1] == c.to || t[2] == c.to)
+                        continue;
+
+                    uint32_t moved[3] = { t[0], t[1], t[2] };
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        if (moved[k] == c.from)
+                            moved[k] = c.to;
+                    }
+
+                    double before[3], after[3];
+                    faceNormal(t[0], t[1], t[2], before);
+                    faceNormal(moved[0], moved[1], moved[2], after);
+
+                    if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0)
+                    {
+                        flips = true;
+                        break;
+                    }
+                }
+
+                if (flips)
+                    continue;
+
+                for (uint32_t f : vertexFaces[c.from])
+                {
+                    if (!faceAlive[f])
+                        continue;
+
+                    uint32_t* t = &tris[f * 3];
+                    if (t[0] == c.to || t[1] == c.to || t[2] == c.to)
+                    {
+                        faceAlive[f] = 0;
+                        --liveFaces;
+                    }
+                    else
+                    {
+                        for (size_t k = 0; k < 3; ++k)
+                        {
+                            if (t[k] == c.from)
+                                t[k] = c.to;
+                        }
+
+                        vertexFaces[c.to].push_back(f);
+                    }
+                }
+
+                removed[c.from] = 1;
+                vertexFaces[c.from].clear();
+                quadrics[c.to].Add(quadrics[c.from]);
+                ++versions[c.to];
+
+                auto& toFaces = vertexFaces[c.to];
+                toFaces.erase(std::remove_if(toFaces.begin(), toFaces.end(),
+                                             [&](uint32_t f) { return !faceAlive[f]; }), toFaces.end());
+
+                neighbors(c.to, toRing);
+                for (uint32_t w : toRing)
+                {
+                    push(c.to, w);
+                    push(w, c.to);
+                }
+            }
+
+            size_t count = 0;
+            for (size_t f = 0; f < nFaces; ++f)
+            {
+                if (!faceAlive[f])
+                    continue;
+
+                for (size_t k = 0; k < 3; ++k)
+                    indicesOut[count * 3 + k] = static_cast<TIndex>(tris[f * 3 + k]);
+
+                ++count;
+            }
+
+            return count;
+        }
+    }
+}
@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 
+#include <float.h>
 #include <stdint.h>
 
 #include <wrl\client.h>
@@ -89,15 +90,83 @@ namespace DirectX
         std::wstring                name;
         bool                        ccw;
         bool                        pmalpha;
+        std::vector<uint32_t>       boneInfluences;
+
+        // Levels of detail from most to least detailed, each with the same parts as meshParts drawing fewer triangles
+        // from the same vertices. lods[j] is used once the mesh covers less than lodScreenSizes[j] of the viewport height.
+        std::vector<ModelMeshPart::Collection>  lods;
+        std::vector<float>                      lodScreenSizes;
 
         typedef std::vector<std::shared_ptr<ModelMesh>> Collection;
 
         // Setup states for drawing mesh
         void __cdecl PrepareForRendering( _In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, bool alpha = false, bool wireframe = false ) const;
 
-        // Draw the mesh
+        // Draw the mesh (lod is 0 for meshParts, or j + 1 for lods[j])
         void XM_CALLCONV Draw( _In_ ID3D11DeviceContext* deviceContext, FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
-                               bool alpha = false, _In_opt_ std::function<void __cdecl()> setCustomState = nullptr ) const;
+                               bool alpha = false, _In_opt_ std::function<void __cdecl()> setCustomState = nullptr, size_t lod = 0 ) const;
+
+        // Fraction of the viewport height covered by the bounding sphere
+        float XM_CALLCONV ComputeScreenSize( FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection ) const;
+
+        // Least detailed level whose screen size is still larger than the given one, as a lod for Draw
+        size_t __cdecl SelectLOD( float screenSize ) const;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // Each bone has a parent, a rest pose transform relative to that parent, and an inverse bind pose
+    class ModelBone
+    {
+    public:
+        ModelBone();
+
+        static const uint32_t c_Invalid = uint32_t(-1);
+
+        uint32_t                    parentIndex;
+        XMFLOAT4X4                  transform;
+        XMFLOAT4X4                  invBindPose;
+        std::wstring                name;
+
+        typedef std::vector<ModelBone> Collection;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // An animation clip holds keyframes for some or all of a model's bones
+    class AnimationClip
+    {
+    public:
+        AnimationClip();
+        virtual ~AnimationClip();
+
+        // Each animated bone has one channel covering keys [firstKey, firstKey + keyCount) sorted by time
+        struct Channel
+        {
+            uint32_t    boneIndex;
+            uint32_t    firstKey;
+            uint32_t    keyCount;
+        };
+
+        std::wstring                name;
+        float                       startTime;
+        float                       endTime;
+        std::vector<Channel>        channels;
+
+        // Keyframes are stored as parallel arrays indexed by key
+        std::vector<float>          keyTimes;
+        std::vector<XMFLOAT3>       keyScales;
+        std::vector<XMFLOAT4>       keyRotations;
+        std::vector<XMFLOAT3>       keyTranslations;
+
+        typedef std::vector<std::shared_ptr<AnimationClip>> Collection;
+
+        // Sample the clip into bone transforms relative to parent (bones without a channel are left as-is)
+        void __cdecl Evaluate( float time, bool loop, size_t nbones, _Inout_updates_(nbones) XMMATRIX* localTransforms ) const;
+
+        // Sample the clip for 'count' instances at once, writing 'nbones' transforms per instance
+        void __cdecl Evaluate( size_t count, _In_reads_(count) const float* times, bool loop,
+                               size_t nbones, _Inout_updates_(count * nbones) XMMATRIX* localTransforms ) const;
     };
 
 
@@ -108,8 +177,13 @@ namespace DirectX
     public:
         virtual ~Model();
 
-        ModelMesh::Collection   meshes;
-        std::wstring            name;
+        ModelMesh::Collection       meshes;
+        ModelBone::Collection       bones;
+        AnimationClip::Collection   animations;
+        std::wstring                name;
+
+        // Chooses the lod Draw uses for each mesh that has levels of detail, given its screen size (defaults to ModelMesh::SelectLOD)
+        std::function<size_t __cdecl(const ModelMesh& mesh, float screenSize)> lodSelector;
 
         // Draw all the meshes in the model
         void XM_CALLCONV Draw( _In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
@@ -121,6 +195,29 @@ namespace DirectX
         // Update all effects used by the model
         void __cdecl UpdateEffects( _In_ std::function<void __cdecl(IEffect*)> setEffect );
 
+        // Copy the rest pose of each bone (relative to parent)
+        void __cdecl CopyBoneTransformsTo( size_t nbones, _Out_writes_(nbones) XMMATRIX* localTransforms ) const;
+
+        // Convert bone transforms relative to parent into model space transforms (in-place is allowed)
+        void __cdecl CopyAbsoluteBoneTransforms( size_t nbones, _In_reads_(nbones) const XMMATRIX* localTransforms,
+                                                 _Out_writes_(nbones) XMMATRIX* absoluteTransforms ) const;
+
+        // Evaluate a clip for 'count' instances, writing mesh.boneInfluences.size() skinning transforms per instance
+        // suitable for IEffectSkinning::SetBoneTransforms. 'localTransforms' is working space of bones.size() matrices
+        // per instance, provided by the caller so that one model can be evaluated from several threads at once.
+        void __cdecl EvaluateAnimation( const AnimationClip& clip, const ModelMesh& mesh,
+                                        size_t count, _In_reads_(count) const float* times, bool loop,
+                                        _Out_writes_(count * bones.size()) XMMATRIX* localTransforms,
+                                        _Out_writes_(count * mesh.boneInfluences.size()) XMMATRIX* boneTransforms ) const;
+
+        // Replace the levels of detail of every mesh by simplifying its triangle list parts, keeping triangleRatios[j] of
+        // the original triangles for level j unless that moves the surface by more than maxError. The vertex buffers
+        // are read back through the device context, and each level gets new index buffers. Parts copy the effect and
+        // input layout of the originals, so call this again after ModifyEffect.
+        void __cdecl GenerateLODs( _In_ ID3D11DeviceContext* deviceContext, size_t nlevels,
+                                   _In_reads_(nlevels) const float* triangleRatios, _In_reads_(nlevels) const float* screenSizes,
+                                   float maxError = FLT_MAX );
+
         // Loads a model from a Visual Studio Starter Kit .CMO file
         static std::unique_ptr<Model> __cdecl CreateFromCMO( _In_ ID3D11Device* d3dDevice, _In_reads_bytes_(dataSize) const uint8_t* meshData, size_t dataSize,
                                                              _In_ IEffectFactory& fxFactory, bool ccw = true, bool pmalpha = false );
@@ -133,6 +230,10 @@ namespace DirectX
         static std::unique_ptr<Model> __cdecl CreateFromSDKMESH( _In_ ID3D11Device* d3dDevice, _In_z_ const wchar_t* szFileName,
                                                                  _In_ IEffectFactory& fxFactory, bool ccw = false, bool pmalpha = false );
 
+        // Loads a clip from a DirectX SDK .SDKMESH_ANIM file into animations, matching its frames to bones by name
+        std::shared_ptr<AnimationClip> __cdecl LoadSDKMESHAnimation( _In_reads_bytes_(dataSize) const uint8_t* animData, _In_ size_t dataSize );
+        std::shared_ptr<AnimationClip> __cdecl LoadSDKMESHAnimation( _In_z_ const wchar_t* szFileName );
+
         // Loads a model from a .VBO file
         static std::unique_ptr<Model> __cdecl CreateFromVBO( _In_ ID3D11Device* d3dDevice, _In_reads_bytes_(dataSize) const uint8_t* meshData, _In_ size_t dataSize,
                                                              _In_opt_ std::shared_ptr<IEffect> ieffect = nullptr, bool ccw = false, bool pmalpha = false );
@@ -140,6 +241,6 @@ namespace DirectX
                                                              _In_opt_ std::shared_ptr<IEffect> ieffect = nullptr, bool ccw = false, bool pmalpha = false );
 
     private:
-        std::set<IEffect*>  mEffectCache;
+        std::set<IEffect*>              mEffectCache;
     };
  }
\ No newline at end of file
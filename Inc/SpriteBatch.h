@@ -24,6 +24,8 @@
 #include <functional>
 #include <memory>
 
+#include <stdint.h>
+
 
 namespace DirectX
 {
@@ -84,6 +86,54 @@ namespace DirectX
         // Set viewport for sprite transformation
         void __cdecl SetViewport( const D3D11_VIEWPORT& viewPort );
 
+        // Records sprites (typically on a worker thread) to be drawn by a SpriteBatch. Recording takes no locks,
+        // so each recorder must only be used by one thread at a time, including the thread calling Submit.
+        class Recorder
+        {
+        public:
+            explicit Recorder(uint32_t order = 0);
+            Recorder(Recorder&& moveFrom);
+            Recorder& operator= (Recorder&& moveFrom);
+
+            Recorder(Recorder const&) = delete;
+            Recorder& operator= (Recorder const&) = delete;
+
+            virtual ~Recorder();
+
+            // Same overloads as SpriteBatch::Draw.
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            // Discard any recorded sprites (storage is kept for reuse).
+            void __cdecl Clear();
+
+            size_t __cdecl GetCount() const;
+
+            // Recorders are merged in ascending order, so the result does not depend on which thread ran which recorder.
+            uint32_t __cdecl GetOrder() const;
+            void __cdecl SetOrder(uint32_t order);
+
+        private:
+            friend class SpriteBatch;
+
+            class Impl;
+
+            std::unique_ptr<Impl> pImpl;
+        };
+
+        // Take the sprites of a recorder, leaving it empty, to be merged into this batch at End. Directly drawn sprites
+        // come first, followed by those of each submission in ascending recorder order (ties in submission order).
+        // The recorder can be reused, moved or destroyed as soon as this returns.
+        void __cdecl Submit(Recorder& recorder);
+
     private:
         // Private implementation.
         class Impl;
@@ -15,9 +15,19 @@
 
 #include "SpriteBatch.h"
 
+#include <vector>
+
 
 namespace DirectX
 {
+    enum TextAlignment
+    {
+        TextAlignment_Left,
+        TextAlignment_Center,
+        TextAlignment_Right,
+    };
+
+
     class SpriteFont
     {
     public:
@@ -45,20 +55,40 @@ namespace DirectX
         RECT __cdecl MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position) const;
         RECT XM_CALLCONV MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position) const;
 
+        // UTF-8 overloads; codepoints outside the Basic Multilingual Plane are supported by both encodings.
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+
+        XMVECTOR XM_CALLCONV MeasureString(_In_z_ char const* text) const;
+
+        RECT __cdecl MeasureDrawBounds(_In_z_ char const* text, XMFLOAT2 const& position) const;
+        RECT XM_CALLCONV MeasureDrawBounds(_In_z_ char const* text, FXMVECTOR position) const;
+
         // Spacing properties
         float __cdecl GetLineSpacing() const;
         void __cdecl SetLineSpacing(float spacing);
 
-        // Font properties
+        // Font properties (the Codepoint versions take any Unicode codepoint, including those above U+FFFF)
         wchar_t __cdecl GetDefaultCharacter() const;
+        uint32_t __cdecl GetDefaultCodepoint() const;
         void __cdecl SetDefaultCharacter(wchar_t character);
+        void __cdecl SetDefaultCodepoint(uint32_t codepoint);
 
         bool __cdecl ContainsCharacter(wchar_t character) const;
+        bool __cdecl ContainsCodepoint(uint32_t codepoint) const;
 
         // Custom layout/rendering
         Glyph const* __cdecl FindGlyph(wchar_t character) const;
+        Glyph const* __cdecl FindGlyphByCodepoint(uint32_t codepoint) const;
         void __cdecl GetSpriteSheet( ID3D11ShaderResourceView** texture ) const;
 
+        // Optional cache of string layouts for text drawn every frame (0 disables it, which is the default).
+        // With the cache enabled, DrawString and MeasureString must not be called concurrently on one SpriteFont.
+        void __cdecl SetLayoutCacheSize(size_t maxEntries);
+        size_t __cdecl GetLayoutCacheSize() const;
+
         // Describes a single character glyph.
         struct Glyph
         {
@@ -69,6 +99,60 @@ namespace DirectX
             float XAdvance;
         };
 
+        // Word-wrapped paragraph layout. Reuse the same TextLayout when the text changes (e.g. appending to a
+        // chat or console log) and LayoutText only recomputes the lines from the first changed character onward.
+        class TextLayout
+        {
+        public:
+            TextLayout();
+
+            struct Line
+            {
+                size_t firstGlyph;
+                size_t glyphCount;
+                size_t textStart;   // Codepoint index of the first character on the line
+                size_t textEnd;     // Codepoint index one past the last character on the line
+                float width;
+                float x;            // Alignment offset
+                float y;
+            };
+
+            struct PlacedGlyph
+            {
+                Glyph const* glyph;
+                float x;            // Relative to the start of the line
+                size_t textIndex;
+            };
+
+            std::vector<Line> lines;
+            std::vector<PlacedGlyph> glyphs;
+            XMFLOAT2 size;
+
+            void __cdecl Clear();
+
+        private:
+            friend class SpriteFont;
+
+            // The text of the last LayoutText call, kept decoded so an edit is only decoded from the change onward:
+            // its code units, and each codepoint with the code unit it starts at and its glyph (null for line breaks).
+            std::vector<uint32_t> mSource;
+            std::vector<uint32_t> mText;
+            std::vector<uint32_t> mTextOffsets;
+            std::vector<Glyph const*> mTextGlyphs;
+            size_t mCharSize;
+            void const* mFont;
+            Glyph const* mDefaultGlyph;
+            float mMaxWidth;
+            float mLineSpacing;
+            TextAlignment mAlignment;
+        };
+
+        // Lays out text, breaking lines at whitespace to fit within maxWidth (no wrapping if maxWidth <= 0).
+        void __cdecl LayoutText(_In_z_ wchar_t const* text, float maxWidth, TextAlignment alignment, TextLayout& layout) const;
+        void __cdecl LayoutText(_In_z_ char const* text, float maxWidth, TextAlignment alignment, TextLayout& layout) const;
+
+        void XM_CALLCONV DrawLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, GXMVECTOR scale = g_XMOne, float layerDepth = 0) const;
+
 
     private:
         // Private implementation.
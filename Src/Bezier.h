@@ -52,11 +52,46 @@ namespace Bezier
     }
 
 
+    // Returns the four cubic bezier basis weights at the specified time, so that a curve can be evaluated
+    // with CubicEvaluate. This is worth doing when the same time is used for several curves.
+    inline DirectX::XMVECTOR XM_CALLCONV CubicBasis(float t)
+    {
+        float s = 1 - t;
+
+        return DirectX::XMVectorSet(s * s * s,
+                                    3 * t * s * s,
+                                    3 * t * t * s,
+                                    t * t * t);
+    }
+
+
+    // Returns the weights which give the tangent of a cubic bezier curve at the specified time, matching CubicTangent.
+    inline DirectX::XMVECTOR XM_CALLCONV CubicTangentBasis(float t)
+    {
+        return DirectX::XMVectorSet(-1 + 2 * t - t * t,
+                                    1 - 4 * t + 3 * t * t,
+                                    2 * t - 3 * t * t,
+                                    t * t);
+    }
+
+
+    // Evaluates a cubic curve with the weights from CubicBasis or CubicTangentBasis.
+    inline DirectX::XMVECTOR XM_CALLCONV CubicEvaluate(DirectX::FXMVECTOR p1, DirectX::FXMVECTOR p2, DirectX::FXMVECTOR p3, DirectX::GXMVECTOR p4, DirectX::HXMVECTOR basis)
+    {
+        using namespace DirectX;
+
+        XMVECTOR result = XMVectorMultiply(p1, XMVectorSplatX(basis));
+        result = XMVectorMultiplyAdd(p2, XMVectorSplatY(basis), result);
+        result = XMVectorMultiplyAdd(p3, XMVectorSplatZ(basis), result);
+        return XMVectorMultiplyAdd(p4, XMVectorSplatW(basis), result);
+    }
+
+
     // Creates vertices for a patch that is tessellated at the specified level.
     // Calls the specified outputVertex function for each generated vertex,
     // passing the position, normal, and texture coordinate as parameters.
     template<typename TOutputFunc>
-    void CreatePatchVertices(_In_reads_(16) DirectX::XMVECTOR patch[16], size_t tessellation, bool isMirrored, TOutputFunc outputVertex)
+    void CreatePatchVertices(_In_reads_(16) const DirectX::XMVECTOR patch[16], size_t tessellation, bool isMirrored, TOutputFunc outputVertex)
     {
         using namespace DirectX;
 
@@ -64,31 +99,37 @@ namespace Bezier
         {
             float u = (float)i / tessellation;
 
+            XMVECTOR uBasis = CubicBasis(u);
+            XMVECTOR uTangentBasis = CubicTangentBasis(u);
+
+            // Perform four horizontal bezier interpolations between the control
+            // points of this patch. These only depend on u, so are done once per row.
+            XMVECTOR p1 = CubicEvaluate(patch[0],  patch[1],  patch[2],  patch[3],  uBasis);
+            XMVECTOR p2 = CubicEvaluate(patch[4],  patch[5],  patch[6],  patch[7],  uBasis);
+            XMVECTOR p3 = CubicEvaluate(patch[8],  patch[9],  patch[10], patch[11], uBasis);
+            XMVECTOR p4 = CubicEvaluate(patch[12], patch[13], patch[14], patch[15], uBasis);
+
+            // Likewise the horizontal tangents of each row of control points. Interpolating these
+            // vertically gives the same tangent as taking the horizontal tangent of the four
+            // vertical interpolations at v.
+            XMVECTOR r1 = CubicEvaluate(patch[0],  patch[1],  patch[2],  patch[3],  uTangentBasis);
+            XMVECTOR r2 = CubicEvaluate(patch[4],  patch[5],  patch[6],  patch[7],  uTangentBasis);
+            XMVECTOR r3 = CubicEvaluate(patch[8],  patch[9],  patch[10], patch[11], uTangentBasis);
+            XMVECTOR r4 = CubicEvaluate(patch[12], patch[13], patch[14], patch[15], uTangentBasis);
+
             for (size_t j = 0; j <= tessellation; j++)
             {
                 float v = (float)j / tessellation;
 
-                // Perform four horizontal bezier interpolations
-                // between the control points of this patch.
-                XMVECTOR p1 = CubicInterpolate(patch[0],  patch[1],  patch[2],  patch[3],  u);
-                XMVECTOR p2 = CubicInterpolate(patch[4],  patch[5],  patch[6],  patch[7],  u);
-                XMVECTOR p3 = CubicInterpolate(patch[8],  patch[9],  patch[10], patch[11], u);
-                XMVECTOR p4 = CubicInterpolate(patch[12], patch[13], patch[14], patch[15], u);
+                XMVECTOR vBasis = CubicBasis(v);
 
                 // Perform a vertical interpolation between the results of the
                 // previous horizontal interpolations, to compute the position.
-                XMVECTOR position = CubicInterpolate(p1, p2, p3, p4, v);
-
-                // Perform another four bezier interpolations between the control
-                // points, but this time vertically rather than horizontally.
-                XMVECTOR q1 = CubicInterpolate(patch[0], patch[4], patch[8],  patch[12], v);
-                XMVECTOR q2 = CubicInterpolate(patch[1], patch[5], patch[9],  patch[13], v);
-                XMVECTOR q3 = CubicInterpolate(patch[2], patch[6], patch[10], patch[14], v);
-                XMVECTOR q4 = CubicInterpolate(patch[3], patch[7], patch[11], patch[15], v);
+                XMVECTOR position = CubicEvaluate(p1, p2, p3, p4, vBasis);
 
                 // Compute vertical and horizontal tangent vectors.
-                XMVECTOR tangent1 = CubicTangent(p1, p2, p3, p4, v);
-                XMVECTOR tangent2 = CubicTangent(q1, q2, q3, q4, u);
+                XMVECTOR tangent1 = CubicEvaluate(p1, p2, p3, p4, CubicTangentBasis(v));
+                XMVECTOR tangent2 = CubicEvaluate(r1, r2, r3, r4, vBasis);
 
                 // Cross the two tangent vectors to compute the normal.
                 XMVECTOR normal = XMVector3Cross(tangent1, tangent2);
@@ -15,25 +15,32 @@
 
 #include "BinaryReader.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#endif
+
 using namespace DirectX;
 
 
-// Constructor reads from the filesystem.
+// Constructor maps the file into memory, falling back to reading it in if that fails.
 BinaryReader::BinaryReader(_In_z_ wchar_t const* fileName) :
     mPos(nullptr),
     mEnd(nullptr)
 {
     size_t dataSize;
 
-    HRESULT hr = ReadEntireFile(fileName, mOwnedData, &dataSize);
+    HRESULT hr = LoadEntireFile(fileName, mMappedData, mOwnedData, &mPos, &dataSize);
     if ( FAILED(hr) )
     {
         DebugTrace( "BinaryReader failed (%08X) to load '%ls'\n", hr, fileName );
         throw std::exception( "BinaryReader" );
     }
 
-    mPos = mOwnedData.get();
-    mEnd = mOwnedData.get() + dataSize;
+    mEnd = mPos + dataSize;
 }
 
 
@@ -90,3 +97,132 @@ HRESULT BinaryReader::ReadEntireFile(_In_z_ wchar_t const* fileName, _Inout_ std
     
     return S_OK;
 }
+
+
+// Maps a file read-only into memory.
+HRESULT BinaryReader::MapEntireFile(_In_z_ wchar_t const* fileName, _Inout_ ScopedMappedView& data, _Out_ size_t* dataSize)
+{
+    data.reset();
+    *dataSize = 0;
+
+#ifdef _WIN32
+    // Open the file.
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile(safe_handle(CreateFile2(fileName, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)));
+#endif
+
+    if (!hFile)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    // Get the file size.
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+#ifndef _WIN64
+    // File is too big for a 32-bit address space, so reject the mapping.
+    if (fileInfo.EndOfFile.HighPart > 0)
+        return E_FAIL;
+#endif
+
+    if (!fileInfo.EndOfFile.QuadPart)
+        return E_FAIL;
+
+    // Map a read-only view of the whole file. The view keeps the mapping alive once the handles are closed.
+#if defined(WINAPI_FAMILY) && (WINAPI_FAMILY != WINAPI_FAMILY_DESKTOP_APP) && !(defined(_XBOX_ONE) && defined(_TITLE))
+    ScopedHandle hMapping(CreateFileMappingFromApp(hFile.get(), nullptr, PAGE_READONLY, 0, nullptr));
+#else
+    ScopedHandle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+#endif
+
+    if (!hMapping)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+#if defined(WINAPI_FAMILY) && (WINAPI_FAMILY != WINAPI_FAMILY_DESKTOP_APP) && !(defined(_XBOX_ONE) && defined(_TITLE))
+    void* view = MapViewOfFileFromApp(hMapping.get(), FILE_MAP_READ, 0, 0);
+#else
+    void* view = MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0);
+#endif
+
+    if (!view)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    size_t size = static_cast<size_t>(fileInfo.EndOfFile.QuadPart);
+#else
+    // POSIX systems take a multibyte path in the current locale.
+    size_t length = wcstombs(nullptr, fileName, 0);
+    if (length == size_t(-1))
+        return E_INVALIDARG;
+
+    std::string path(length, '\0');
+    wcstombs(&path[0], fileName, length + 1);
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return E_FAIL;
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0 || uint64_t(fileInfo.st_size) > SIZE_MAX)
+    {
+        close(fd);
+        return E_FAIL;
+    }
+
+    size_t size = static_cast<size_t>(fileInfo.st_size);
+
+    // The mapping stays valid after the descriptor is closed.
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (view == MAP_FAILED)
+        return E_FAIL;
+#endif
+
+    data = ScopedMappedView(static_cast<uint8_t const*>(view), unmap_deleter(size));
+    *dataSize = size;
+
+    return S_OK;
+}
+
+
+// Releases a view created by MapEntireFile.
+void BinaryReader::unmap_deleter::operator()(uint8_t const* p) const
+{
+    if (!p)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(p);
+#else
+    munmap(const_cast<uint8_t*>(p), size);
+#endif
+}
+
+
+// Maps a file into memory, falling back to reading it in if that fails (for example an empty file).
+HRESULT BinaryReader::LoadEntireFile(_In_z_ wchar_t const* fileName, _Inout_ ScopedMappedView& mappedData, _Inout_ std::unique_ptr<uint8_t[]>& ownedData, _Outptr_result_bytebuffer_(*dataSize) uint8_t const** data, _Out_ size_t* dataSize)
+{
+    if (!data || !dataSize)
+        return E_INVALIDARG;
+
+    *data = nullptr;
+    *dataSize = 0;
+
+    HRESULT hr = MapEntireFile(fileName, mappedData, dataSize);
+    if ( SUCCEEDED(hr) )
+    {
+        *data = mappedData.get();
+        return S_OK;
+    }
+
+    hr = ReadEntireFile(fileName, ownedData, dataSize);
+    if ( FAILED(hr) )
+        return hr;
+
+    *data = ownedData.get();
+    return S_OK;
+}
@@ -23,7 +23,7 @@
 
 namespace DirectX
 {
-    // Helper for reading binary data, either from the filesystem a memory buffer.
+    // Helper for reading binary data, either from the filesystem (memory mapped where possible) or a memory buffer.
     class BinaryReader
     {
     public:
@@ -65,11 +65,33 @@ namespace DirectX
         static HRESULT ReadEntireFile(_In_z_ wchar_t const* fileName, _Inout_ std::unique_ptr<uint8_t[]>& data, _Out_ size_t* dataSize);
 
 
+        // Read-only view of a file mapped into memory.
+        struct unmap_deleter
+        {
+            explicit unmap_deleter(size_t viewSize = 0) : size(viewSize) {}
+
+            void operator()(uint8_t const* p) const;
+
+            size_t size;
+        };
+
+        typedef std::unique_ptr<uint8_t const, unmap_deleter> ScopedMappedView;
+
+        // Lower level helper maps a file read-only into memory, so it can be parsed straight from the page cache
+        // without copying. Fails for empty files, which cannot be mapped.
+        static HRESULT MapEntireFile(_In_z_ wchar_t const* fileName, _Inout_ ScopedMappedView& data, _Out_ size_t* dataSize);
+
+        // Lower level helper maps a file into memory, falling back to reading it in if that fails. On success data
+        // points into whichever of mappedData or ownedData holds the contents.
+        static HRESULT LoadEntireFile(_In_z_ wchar_t const* fileName, _Inout_ ScopedMappedView& mappedData, _Inout_ std::unique_ptr<uint8_t[]>& ownedData, _Outptr_result_bytebuffer_(*dataSize) uint8_t const** data, _Out_ size_t* dataSize);
+
+
     private:
         // The data currently being read.
         uint8_t const* mPos;
         uint8_t const* mEnd;
 
+        ScopedMappedView mMappedData;
         std::unique_ptr<uint8_t[]> mOwnedData;
     };
 }
@@ -35,6 +35,21 @@ static_assert(static_cast<int>(DDS_DIMENSION_TEXTURE2D) == static_cast<int>(D3D1
 static_assert(static_cast<int>(DDS_DIMENSION_TEXTURE3D) == static_cast<int>(D3D11_RESOURCE_DIMENSION_TEXTURE3D), "dds mismatch");
 static_assert(static_cast<int>(DDS_RESOURCE_MISC_TEXTURECUBE) == static_cast<int>(D3D11_RESOURCE_MISC_TEXTURECUBE), "dds mismatch");
 
+static_assert(static_cast<int>(DDSParser::DIMENSION_TEXTURE1D) == static_cast<int>(D3D11_RESOURCE_DIMENSION_TEXTURE1D), "DDSParser mismatch");
+static_assert(static_cast<int>(DDSParser::DIMENSION_TEXTURE2D) == static_cast<int>(D3D11_RESOURCE_DIMENSION_TEXTURE2D), "DDSParser mismatch");
+static_assert(static_cast<int>(DDSParser::DIMENSION_TEXTURE3D) == static_cast<int>(D3D11_RESOURCE_DIMENSION_TEXTURE3D), "DDSParser mismatch");
+static_assert(static_cast<int>(DDSParser::c_MiscTextureCube) == static_cast<int>(D3D11_RESOURCE_MISC_TEXTURECUBE), "DDSParser mismatch");
+static_assert(static_cast<int>(DDSParser::FORMAT_BC7_UNORM_SRGB) == static_cast<int>(DXGI_FORMAT_BC7_UNORM_SRGB), "DDSParser mismatch");
+static_assert(static_cast<int>(DDSParser::FORMAT_B4G4R4A4_UNORM) == static_cast<int>(DXGI_FORMAT_B4G4R4A4_UNORM), "DDSParser mismatch");
+static_assert(static_cast<int>(DDSParser::ALPHA_MODE_CUSTOM) == static_cast<int>(DDS_ALPHA_MODE_CUSTOM), "DDSParser mismatch");
+static_assert(DDSParser::c_MaxMipLevels == D3D11_REQ_MIP_LEVELS, "DDSParser mismatch");
+static_assert(DDSParser::c_MaxTexture1DArraySize == D3D11_REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION, "DDSParser mismatch");
+static_assert(DDSParser::c_MaxTexture1DWidth == D3D11_REQ_TEXTURE1D_U_DIMENSION, "DDSParser mismatch");
+static_assert(DDSParser::c_MaxTexture2DArraySize == D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION, "DDSParser mismatch");
+static_assert(DDSParser::c_MaxTexture2DSize == D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION, "DDSParser mismatch");
+static_assert(DDSParser::c_MaxTextureCubeSize == D3D11_REQ_TEXTURECUBE_DIMENSION, "DDSParser mismatch");
+static_assert(DDSParser::c_MaxTexture3DSize == D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION, "DDSParser mismatch");
+
 namespace
 {
     //--------------------------------------------------------------------------------------
@@ -386,172 +401,19 @@ namespace
         _Outptr_opt_ ID3D11Resource** texture,
         _Outptr_opt_ ID3D11ShaderResourceView** textureView)
     {
-        HRESULT hr = S_OK;
-
-        UINT width = header->width;
-        UINT height = header->height;
-        UINT depth = header->depth;
-
         uint32_t resDim = D3D11_RESOURCE_DIMENSION_UNKNOWN;
-        UINT arraySize = 1;
+        UINT width = 0;
+        UINT height = 0;
+        UINT depth = 0;
+        size_t mipCount = 0;
+        UINT arraySize = 0;
         DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
         bool isCubeMap = false;
 
-        size_t mipCount = header->mipMapCount;
-        if (0 == mipCount)
+        HRESULT hr = DecodeDDSHeader(header, &resDim, &width, &height, &depth, &mipCount, &arraySize, &format, &isCubeMap);
+        if (FAILED(hr))
         {
-            mipCount = 1;
-        }
-
-        if ((header->ddspf.flags & DDS_FOURCC) &&
-            (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
-        {
-            auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>((const char*)header + sizeof(DDS_HEADER));
-
-            arraySize = d3d10ext->arraySize;
-            if (arraySize == 0)
-            {
-                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
-            }
-
-            switch (d3d10ext->dxgiFormat)
-            {
-            case DXGI_FORMAT_AI44:
-            case DXGI_FORMAT_IA44:
-            case DXGI_FORMAT_P8:
-            case DXGI_FORMAT_A8P8:
-                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-
-            default:
-                if (BitsPerPixel(d3d10ext->dxgiFormat) == 0)
-                {
-                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-                }
-            }
-
-            format = d3d10ext->dxgiFormat;
-
-            switch (d3d10ext->resourceDimension)
-            {
-            case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
-                // D3DX writes 1D textures with a fixed Height of 1
-                if ((header->flags & DDS_HEIGHT) && height != 1)
-                {
-                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
-                }
-                height = depth = 1;
-                break;
-
-            case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
-                if (d3d10ext->miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE)
-                {
-                    arraySize *= 6;
-                    isCubeMap = true;
-                }
-                depth = 1;
-                break;
-
-            case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
-                if (!(header->flags & DDS_HEADER_FLAGS_VOLUME))
-                {
-                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
-                }
-
-                if (arraySize > 1)
-                {
-                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-                }
-                break;
-
-            default:
-                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-            }
-
-            resDim = d3d10ext->resourceDimension;
-        }
-        else
-        {
-            format = GetDXGIFormat(header->ddspf);
-
-            if (format == DXGI_FORMAT_UNKNOWN)
-            {
-                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-            }
-
-            if (header->flags & DDS_HEADER_FLAGS_VOLUME)
-            {
-                resDim = D3D11_RESOURCE_DIMENSION_TEXTURE3D;
-            }
-            else
-            {
-                if (header->caps2 & DDS_CUBEMAP)
-                {
-                    // We require all six faces to be defined
-                    if ((header->caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
-                    {
-                        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-                    }
-
-                    arraySize = 6;
-                    isCubeMap = true;
-                }
-
-                depth = 1;
-                resDim = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
-
-                // Note there's no way for a legacy Direct3D 9 DDS to express a '1D' texture
-            }
-
-            assert(BitsPerPixel(format) != 0);
-        }
-
-        // Bound sizes (for security purposes we don't trust DDS file metadata larger than the Direct3D hardware requirements)
-        if (mipCount > D3D11_REQ_MIP_LEVELS)
-        {
-            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-        }
-
-        switch (resDim)
-        {
-        case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
-            if ((arraySize > D3D11_REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION) ||
-                (width > D3D11_REQ_TEXTURE1D_U_DIMENSION))
-            {
-                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-            }
-            break;
-
-        case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
-            if (isCubeMap)
-            {
-                // This is the right bound because we set arraySize to (NumCubes*6) above
-                if ((arraySize > D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
-                    (width > D3D11_REQ_TEXTURECUBE_DIMENSION) ||
-                    (height > D3D11_REQ_TEXTURECUBE_DIMENSION))
-                {
-                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-                }
-            }
-            else if ((arraySize > D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
-                (width > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION) ||
-                (height > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION))
-            {
-                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-            }
-            break;
-
-        case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
-            if ((arraySize > 1) ||
-                (width > D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
-                (height > D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
-                (depth > D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION))
-            {
-                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-            }
-            break;
-
-        default:
-            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            return hr;
         }
 
         bool autogen = false;
@@ -869,45 +731,19 @@ HRESULT DirectX::CreateDDSTextureFromMemoryEx(ID3D11Device* d3dDevice,
     }
 
     // Validate DDS file in memory
-    if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
-    {
-        return E_FAIL;
-    }
-
-    uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
-    if (dwMagicNumber != DDS_MAGIC)
-    {
-        return E_FAIL;
-    }
-
-    auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
-
-    // Verify header to validate DDS file
-    if (header->size != sizeof(DDS_HEADER) ||
-        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
-    {
-        return E_FAIL;
-    }
-
-    // Check for DX10 extension
+    DDSParser::Header parsedHeader;
+    DDSParser::HeaderDXT10 parsedExt;
     bool bDXT10Header = false;
-    if ((header->ddspf.flags & DDS_FOURCC) &&
-        (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+    size_t offset = 0;
+    HRESULT hr = ToHRESULT(DDSParser::ReadHeader(ddsData, ddsDataSize, &parsedHeader, &parsedExt, &bDXT10Header, &offset));
+    if (FAILED(hr))
     {
-        // Must be long enough for both headers and magic value
-        if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
-        {
-            return E_FAIL;
-        }
-
-        bDXT10Header = true;
+        return hr;
     }
 
-    ptrdiff_t offset = sizeof(uint32_t)
-        + sizeof(DDS_HEADER)
-        + (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
+    auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
 
-    HRESULT hr = CreateTextureFromDDS(d3dDevice, nullptr,
+    hr = CreateTextureFromDDS(d3dDevice, nullptr,
 #if defined(_XBOX_ONE) && defined(_TITLE)
         nullptr, nullptr,
 #endif
@@ -972,45 +808,19 @@ _Use_decl_annotations_
     }
 
     // Validate DDS file in memory
-    if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
-    {
-        return E_FAIL;
-    }
-
-    uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
-    if (dwMagicNumber != DDS_MAGIC)
-    {
-        return E_FAIL;
-    }
-
-    auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
-
-    // Verify header to validate DDS file
-    if (header->size != sizeof(DDS_HEADER) ||
-        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
-    {
-        return E_FAIL;
-    }
-
-    // Check for DX10 extension
+    DDSParser::Header parsedHeader;
+    DDSParser::HeaderDXT10 parsedExt;
     bool bDXT10Header = false;
-    if ((header->ddspf.flags & DDS_FOURCC) &&
-        (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+    size_t offset = 0;
+    HRESULT hr = ToHRESULT(DDSParser::ReadHeader(ddsData, ddsDataSize, &parsedHeader, &parsedExt, &bDXT10Header, &offset));
+    if (FAILED(hr))
     {
-        // Must be long enough for both headers and magic value
-        if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
-        {
-            return E_FAIL;
-        }
-
-        bDXT10Header = true;
+        return hr;
     }
 
-    ptrdiff_t offset = sizeof(uint32_t)
-        + sizeof(DDS_HEADER)
-        + (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
+    auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
 
-    HRESULT hr = CreateTextureFromDDS(d3dDevice, d3dContext,
+    hr = CreateTextureFromDDS(d3dDevice, d3dContext,
 #if defined(_XBOX_ONE) && defined(_TITLE)
         d3dDevice, d3dContext,
 #endif
@@ -1106,6 +916,7 @@ HRESULT DirectX::CreateDDSTextureFromFileEx(ID3D11Device* d3dDevice,
 
     std::unique_ptr<uint8_t[]> ddsData;
     HRESULT hr = LoadTextureDataFromFile(fileName,
+        maxsize,
         ddsData,
         &header,
         &bitData,
@@ -1240,6 +1051,7 @@ _Use_decl_annotations_
 
     std::unique_ptr<uint8_t[]> ddsData;
     HRESULT hr = LoadTextureDataFromFile(fileName,
+        maxsize,
         ddsData,
         &header,
         &bitData,
@@ -1330,3 +1142,42 @@ _Use_decl_annotations_
 
     return hr;
 }
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GetDDSTextureLayout(const uint8_t* ddsData,
+    size_t ddsDataSize,
+    DDS_TEXTURE_DESC* desc,
+    DDS_SUBRESOURCE_LAYOUT* layouts,
+    size_t maxLayouts)
+{
+    if (desc)
+    {
+        memset(desc, 0, sizeof(DDS_TEXTURE_DESC));
+    }
+
+    if (!ddsData || !desc)
+    {
+        return E_INVALIDARG;
+    }
+
+    DDSParser::TextureDesc parsed;
+    HRESULT hr = ToHRESULT(DDSParser::GetTextureLayout(ddsData, ddsDataSize, &parsed, layouts, maxLayouts));
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    desc->dimension = static_cast<D3D11_RESOURCE_DIMENSION>(parsed.dimension);
+    desc->format = static_cast<DXGI_FORMAT>(parsed.format);
+    desc->width = parsed.width;
+    desc->height = parsed.height;
+    desc->depth = parsed.depth;
+    desc->mipLevels = parsed.mipLevels;
+    desc->arraySize = parsed.arraySize;
+    desc->isCubeMap = parsed.isCubeMap;
+    desc->alphaMode = static_cast<DDS_ALPHA_MODE>(parsed.alphaMode);
+
+    return S_OK;
+}
@@ -387,6 +387,16 @@ void GeometricPrimitive::CreateCube(
     ComputeBox(vertices, indices, XMFLOAT3(size, size, size), rhcoords, false);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCube(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeBox(vertices, indices, XMFLOAT3(size, size, size), rhcoords, false);
+}
+
 
 // Creates a box primitive.
 _Use_decl_annotations_
@@ -418,6 +428,17 @@ void GeometricPrimitive::CreateBox(
     ComputeBox(vertices, indices, size, rhcoords, invertn);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateBox(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    const XMFLOAT3& size,
+    bool rhcoords,
+    bool invertn)
+{
+    ComputeBox(vertices, indices, size, rhcoords, invertn);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Sphere
@@ -454,6 +475,18 @@ void GeometricPrimitive::CreateSphere(
     ComputeSphere(vertices, indices, diameter, tessellation, rhcoords, invertn);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateSphere(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    size_t tessellation,
+    bool rhcoords,
+    bool invertn)
+{
+    ComputeSphere(vertices, indices, diameter, tessellation, rhcoords, invertn);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Geodesic sphere
@@ -487,6 +520,16 @@ void GeometricPrimitive::CreateGeoSphere(
     ComputeGeoSphere(vertices, indices, diameter, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateGeoSphere(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    size_t tessellation, bool rhcoords)
+{
+    ComputeGeoSphere(vertices, indices, diameter, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Cylinder / Cone
@@ -524,6 +567,18 @@ void GeometricPrimitive::CreateCylinder(
     ComputeCylinder(vertices, indices, height, diameter, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCylinder(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float height,
+    float diameter,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeCylinder(vertices, indices, height, diameter, tessellation, rhcoords);
+}
+
 
 // Creates a cone primitive.
 _Use_decl_annotations_
@@ -557,6 +612,18 @@ void GeometricPrimitive::CreateCone(
     ComputeCone(vertices, indices, diameter, height, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCone(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    float height,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeCone(vertices, indices, diameter, height, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Torus
@@ -593,6 +660,18 @@ void GeometricPrimitive::CreateTorus(
     ComputeTorus(vertices, indices, diameter, thickness, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTorus(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    float thickness,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeTorus(vertices, indices, diameter, thickness, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Tetrahedron
@@ -625,6 +704,16 @@ void GeometricPrimitive::CreateTetrahedron(
     ComputeTetrahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTetrahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeTetrahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Octahedron
@@ -657,6 +746,16 @@ void GeometricPrimitive::CreateOctahedron(
     ComputeOctahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateOctahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeOctahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Dodecahedron
@@ -689,6 +788,16 @@ void GeometricPrimitive::CreateDodecahedron(
     ComputeDodecahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateDodecahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeDodecahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Icosahedron
@@ -721,6 +830,16 @@ void GeometricPrimitive::CreateIcosahedron(
     ComputeIcosahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateIcosahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeIcosahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Teapot
@@ -755,6 +874,46 @@ void GeometricPrimitive::CreateTeapot(
     ComputeTeapot(vertices, indices, size, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTeapot(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeTeapot(vertices, indices, size, tessellation, rhcoords);
+}
+
+
+//--------------------------------------------------------------------------------------
+// Bezier patches
+//--------------------------------------------------------------------------------------
+
+_Use_decl_annotations_
+void GeometricPrimitive::CreateBezierPatches(
+    std::vector<VertexType>& vertices,
+    std::vector<uint16_t>& indices,
+    const XMFLOAT3* controlPoints,
+    size_t patchCount,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeBezierPatches(vertices, indices, controlPoints, patchCount, tessellation, rhcoords);
+}
+
+_Use_decl_annotations_
+void GeometricPrimitive::CreateBezierPatches(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    const XMFLOAT3* controlPoints,
+    size_t patchCount,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeBezierPatches(vertices, indices, controlPoints, patchCount, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Custom
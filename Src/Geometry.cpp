@@ -23,24 +23,29 @@ namespace
     const float SQRT3 = 1.73205080756887729352f;
     const float SQRT6 = 2.44948974278317809820f;
 
-    inline void CheckIndexOverflow(size_t value)
+    // Each generator works out its vertex count up front, so the index range is checked once rather than per index.
+    template<typename TIndex>
+    inline void CheckVertexCount(uint64_t vertexCount)
     {
-        // Use >=, not > comparison, because some D3D level 9_x hardware does not support 0xFFFF index values.
-        if (value >= USHRT_MAX)
+        // The largest index value is reserved, because some D3D level 9_x hardware does not support 0xFFFF index values
+        // and 0xFFFFFFFF is the strip cut value.
+        if (vertexCount > TIndex(-1))
             throw std::exception("Index value out of range: cannot tesselate primitive so finely");
     }
 
 
     // Collection types used when generating the geometry.
-    inline void index_push_back(IndexCollection& indices, size_t value)
+    template<typename TIndex>
+    inline void index_push_back(std::vector<TIndex>& indices, size_t value)
     {
-        CheckIndexOverflow(value);
-        indices.push_back((uint16_t)value);
+        assert(value < TIndex(-1));
+        indices.push_back(static_cast<TIndex>(value));
     }
 
 
     // Helper for flipping winding of geometric primitives for LH vs. RH coords
-    inline void ReverseWinding(IndexCollection& indices, VertexCollection& vertices)
+    template<typename TIndex>
+    inline void ReverseWinding(std::vector<TIndex>& indices, VertexCollection& vertices)
     {
         assert((indices.size() % 3) == 0);
         for (auto it = indices.begin(); it != indices.end(); it += 3)
@@ -71,7 +76,8 @@ namespace
 //--------------------------------------------------------------------------------------
 // Cube (aka a Hexahedron) or Box
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeBox(VertexCollection& vertices, IndexCollection& indices, const XMFLOAT3& size, bool rhcoords, bool invertn)
+template<typename TIndex>
+void DirectX::ComputeBox(VertexCollection& vertices, std::vector<TIndex>& indices, const XMFLOAT3& size, bool rhcoords, bool invertn)
 {
     vertices.clear();
     indices.clear();
@@ -79,6 +85,9 @@ void DirectX::ComputeBox(VertexCollection& vertices, IndexCollection& indices, c
     // A box has six faces, each one pointing in a different direction.
     const int FaceCount = 6;
 
+    vertices.reserve(FaceCount * 4);
+    indices.reserve(FaceCount * 6);
+
     static const XMVECTORF32 faceNormals[FaceCount] =
     {
         { { {  0,  0,  1, 0 } } },
@@ -140,7 +149,8 @@ void DirectX::ComputeBox(VertexCollection& vertices, IndexCollection& indices, c
 //--------------------------------------------------------------------------------------
 // Sphere
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn)
+template<typename TIndex>
+void DirectX::ComputeSphere(VertexCollection& vertices, std::vector<TIndex>& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn)
 {
     vertices.clear();
     indices.clear();
@@ -151,6 +161,11 @@ void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices
     size_t verticalSegments = tessellation;
     size_t horizontalSegments = tessellation * 2;
 
+    CheckVertexCount<TIndex>(uint64_t(verticalSegments + 1) * (horizontalSegments + 1));
+
+    vertices.reserve((verticalSegments + 1) * (horizontalSegments + 1));
+    indices.reserve(verticalSegments * (horizontalSegments + 1) * 6);
+
     float radius = diameter / 2;
 
     // Create rings of vertices at progressively higher latitudes.
@@ -215,26 +230,96 @@ void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices
 //--------------------------------------------------------------------------------------
 // Geodesic sphere
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords)
+namespace
+{
+    // Key: an undirected edge, so (a,b) is the same as (b,a)
+    // Value: the index of the vertex which lies midway between the edge's two vertices
+    // This is used to avoid duplicating vertices when subdividing triangles along edges. It is a flat open-addressed
+    // table sized up front for the number of edges, so lookups neither allocate nor chase pointers.
+    class EdgeSubdivisionMap
+    {
+    public:
+        explicit EdgeSubdivisionMap(size_t edgeCount)
+        {
+            // Keep the load factor at or below one half so probe sequences stay short
+            size_t capacity = 16;
+            while (capacity < edgeCount * 2)
+                capacity <<= 1;
+
+            mEntries.resize(capacity);
+            mMask = capacity - 1;
+
+            Clear();
+        }
+
+        void Clear()
+        {
+            Entry empty = { c_Empty, 0 };
+            std::fill(mEntries.begin(), mEntries.end(), empty);
+        }
+
+        // Returns true and sets midpoint if the edge has been subdivided before; otherwise records midpoint for it.
+        bool FindOrInsert(uint32_t a, uint32_t b, uint32_t& midpoint)
+        {
+            // The larger of the two goes first, so the key is the same either way round
+            uint64_t key = (a > b) ? ((uint64_t(a) << 32) | b) : ((uint64_t(b) << 32) | a);
+
+            // Fibonacci hashing spreads the keys of neighboring vertices across the table
+            size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mMask;
+
+            for (;;)
+            {
+                Entry& entry = mEntries[slot];
+
+                if (entry.key == key)
+                {
+                    midpoint = entry.midpoint;
+                    return true;
+                }
+
+                if (entry.key == c_Empty)
+                {
+                    entry.key = key;
+                    entry.midpoint = midpoint;
+                    return false;
+                }
+
+                slot = (slot + 1) & mMask;
+            }
+        }
+
+    private:
+        // Not a valid key, as an edge never joins a vertex to itself
+        static const uint64_t c_Empty = uint64_t(-1);
+
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t midpoint;
+        };
+
+        std::vector<Entry> mEntries;
+        size_t mMask;
+    };
+}
+
+template<typename TIndex>
+void DirectX::ComputeGeoSphere(VertexCollection& vertices, std::vector<TIndex>& indices, float diameter, size_t tessellation, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
 
-    // An undirected edge between two vertices, represented by a pair of indexes into a vertex array.
-    // Becuse this edge is undirected, (a,b) is the same as (b,a).
-    typedef std::pair<uint16_t, uint16_t> UndirectedEdge;
+    // Each subdivision splits every triangle into four. Starting from an octahedron, after n subdivisions there are
+    // 8 * 4^n faces, 12 * 4^n edges and (by Euler's formula) 4 * 4^n + 2 vertices. The seam fixups below then add at
+    // most one vertex for each of the 2^(n+1) + 1 vertices on the prime meridian, and three for each pole.
+    if (tessellation > 15)
+        throw std::exception("Index value out of range: cannot tesselate primitive so finely");
 
-    // Makes an undirected edge. Rather than overloading comparison operators to give us the (a,b)==(b,a) property,
-    // we'll just ensure that the larger of the two goes first. This'll simplify things greatly.
-    auto makeUndirectedEdge = [](uint16_t a, uint16_t b)
-    {
-        return std::make_pair(std::max(a, b), std::min(a, b));
-    };
+    const uint64_t faceCount = uint64_t(8) << (2 * tessellation);
+    const uint64_t subdividedVertexCount = (uint64_t(4) << (2 * tessellation)) + 2;
+    const uint64_t maxVertexCount = subdividedVertexCount + (uint64_t(2) << tessellation) + 1 + 6;
 
-    // Key: an edge
-    // Value: the index of the vertex which lies midway between the two vertices pointed to by the key value
-    // This map is used to avoid duplicating vertices when subdividing triangles along edges.
-    typedef std::map<UndirectedEdge, uint16_t> EdgeSubdivisionMap;
+    CheckVertexCount<TIndex>(maxVertexCount);
 
 
     static const XMFLOAT3 OctahedronVertices[] =
@@ -263,63 +348,52 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
 
     // Start with an octahedron; copy the data into the vertex/index collection.
 
-    std::vector<XMFLOAT3> vertexPositions(std::begin(OctahedronVertices), std::end(OctahedronVertices));
+    std::vector<XMFLOAT3> vertexPositions;
+    vertexPositions.reserve(static_cast<size_t>(subdividedVertexCount));
+    vertexPositions.insert(vertexPositions.end(), std::begin(OctahedronVertices), std::end(OctahedronVertices));
 
     indices.insert(indices.begin(), std::begin(OctahedronIndices), std::end(OctahedronIndices));
 
+    // Sized for the edges of the last level to be subdivided, and reused for the levels before it.
+    EdgeSubdivisionMap subdividedEdges((tessellation > 0) ? static_cast<size_t>(uint64_t(12) << (2 * (tessellation - 1))) : 0);
+
     // We know these values by looking at the above index list for the octahedron. Despite the subdivisions that are
     // about to go on, these values aren't ever going to change because the vertices don't move around in the array.
     // We'll need these values later on to fix the singularities that show up at the poles.
-    const uint16_t northPoleIndex = 0;
-    const uint16_t southPoleIndex = 5;
+    const size_t northPoleIndex = 0;
+    const size_t southPoleIndex = 5;
 
     for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
     {
         assert(indices.size() % 3 == 0); // sanity
 
         // We use this to keep track of which edges have already been subdivided.
-        EdgeSubdivisionMap subdividedEdges;
-
-        // The new index collection after subdivision.
-        IndexCollection newIndices;
+        subdividedEdges.Clear();
 
         const size_t triangleCount = indices.size() / 3;
+
+        // The new index collection after subdivision.
+        std::vector<TIndex> newIndices;
+        newIndices.reserve(triangleCount * 12);
         for (size_t iTriangle = 0; iTriangle < triangleCount; ++iTriangle)
         {
             // For each edge on this triangle, create a new vertex in the middle of that edge.
             // The winding order of the triangles we output are the same as the winding order of the inputs.
 
             // Indices of the vertices making up this triangle
-            uint16_t iv0 = indices[iTriangle * 3 + 0];
-            uint16_t iv1 = indices[iTriangle * 3 + 1];
-            uint16_t iv2 = indices[iTriangle * 3 + 2];
-
-            // Get the new vertices
-            XMFLOAT3 v01; // vertex on the midpoint of v0 and v1
-            XMFLOAT3 v12; // ditto v1 and v2
-            XMFLOAT3 v20; // ditto v2 and v0
-            uint16_t iv01; // index of v01
-            uint16_t iv12; // index of v12
-            uint16_t iv20; // index of v20
-
-            // Function that, when given the index of two vertices, creates a new vertex at the midpoint of those vertices.
-            auto divideEdge = [&](uint16_t i0, uint16_t i1, XMFLOAT3& outVertex, uint16_t& outIndex)
-            {
-                const UndirectedEdge edge = makeUndirectedEdge(i0, i1);
+            TIndex iv0 = indices[iTriangle * 3 + 0];
+            TIndex iv1 = indices[iTriangle * 3 + 1];
+            TIndex iv2 = indices[iTriangle * 3 + 2];
 
-                // Check to see if we've already generated this vertex
-                auto it = subdividedEdges.find(edge);
-                if (it != subdividedEdges.end())
-                {
-                    // We've already generated this vertex before
-                    outIndex = it->second; // the index of this vertex
-                    outVertex = vertexPositions[outIndex]; // and the vertex itself
-                }
-                else
+            // Function that, when given the index of two vertices, returns the index of the vertex at their midpoint,
+            // creating it if this edge hasn't been subdivided before.
+            auto divideEdge = [&](TIndex i0, TIndex i1) -> TIndex
+            {
+                auto outIndex = static_cast<uint32_t>(vertexPositions.size());
+                if (!subdividedEdges.FindOrInsert(i0, i1, outIndex))
                 {
                     // Haven't generated this vertex before: so add it now
-
-                    // outVertex = (vertices[i0] + vertices[i1]) / 2
+                    XMFLOAT3 outVertex;
                     XMStoreFloat3(
                         &outVertex,
                         XMVectorScale(
@@ -328,19 +402,16 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
                         )
                     );
 
-                    outIndex = static_cast<uint16_t>(vertexPositions.size());
-                    CheckIndexOverflow(outIndex);
                     vertexPositions.push_back(outVertex);
-
-                    // Now add it to the map.
-                    subdividedEdges.insert(std::make_pair(edge, outIndex));
                 }
+
+                return static_cast<TIndex>(outIndex);
             };
 
             // Add/get new vertices and their indices
-            divideEdge(iv0, iv1, v01, iv01);
-            divideEdge(iv1, iv2, v12, iv12);
-            divideEdge(iv0, iv2, v20, iv20);
+            TIndex iv01 = divideEdge(iv0, iv1); // index of the vertex on the midpoint of v0 and v1
+            TIndex iv12 = divideEdge(iv1, iv2); // ditto v1 and v2
+            TIndex iv20 = divideEdge(iv0, iv2); // ditto v2 and v0
 
             // Add the new indices. We have four new triangles from our original one:
             //        v0
@@ -350,7 +421,7 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
             //     /b\c/d\
             // v2 o---o---o v1
             //       v12
-            const uint16_t indicesToAdd[] =
+            const TIndex indicesToAdd[] =
             {
                  iv0, iv01, iv20, // a
                 iv20, iv12,  iv2, // b
@@ -363,8 +434,11 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
         indices = std::move(newIndices);
     }
 
+    assert(vertexPositions.size() == subdividedVertexCount);
+    assert(indices.size() == faceCount * 3);
+
     // Now that we've completed subdivision, fill in the final vertex collection
-    vertices.reserve(vertexPositions.size());
+    vertices.reserve(static_cast<size_t>(maxVertexCount));
     for (auto it = vertexPositions.begin(); it != vertexPositions.end(); ++it)
     {
         auto vertexValue = *it;
@@ -396,7 +470,13 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
     // completed sphere. If you imagine the vertices along that edge, they circumscribe a semicircular arc starting at
     // y=1 and ending at y=-1, and sweeping across the range of z=0 to z=1. x stays zero. It's along this edge that we
     // need to duplicate our vertices - and provide the correct texture coordinates.
-    size_t preFixupVertexCount = vertices.size();
+    //
+    // The duplicates are made first, then the triangles are fixed in a single pass over the index buffer. Within a
+    // triangle the corners are handled in ascending vertex order, because a corner that has already moved to its
+    // duplicate changes the texture coordinate the later corners are compared against.
+    const size_t preFixupVertexCount = vertices.size();
+
+    std::vector<TIndex> meridianCopies(preFixupVertexCount, 0); // zero if the vertex is not on the prime meridian
     for (size_t i = 0; i < preFixupVertexCount; ++i)
     {
         // This vertex is on the prime meridian if position.x and texcoord.u are both zero (allowing for small epsilon).
@@ -407,55 +487,44 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
 
         if (isOnPrimeMeridian)
         {
-            size_t newIndex = vertices.size(); // the index of this vertex that we're about to add
-            CheckIndexOverflow(newIndex);
-
             // copy this vertex, correct the texture coordinate, and add the vertex
+            meridianCopies[i] = static_cast<TIndex>(vertices.size());
+
             VertexPositionNormalTexture v = vertices[i];
             v.textureCoordinate.x = 1.0f;
             vertices.push_back(v);
+        }
+    }
 
-            // Now find all the triangles which contain this vertex and update them if necessary
-            for (size_t j = 0; j < indices.size(); j += 3)
-            {
-                uint16_t* triIndex0 = &indices[j + 0];
-                uint16_t* triIndex1 = &indices[j + 1];
-                uint16_t* triIndex2 = &indices[j + 2];
+    for (size_t j = 0; j < indices.size(); j += 3)
+    {
+        TIndex* tri = &indices[j];
 
-                if (*triIndex0 == i)
-                {
-                    // nothing; just keep going
-                }
-                else if (*triIndex1 == i)
-                {
-                    std::swap(triIndex0, triIndex1); // swap the pointers (not the values)
-                }
-                else if (*triIndex2 == i)
-                {
-                    std::swap(triIndex0, triIndex2); // swap the pointers (not the values)
-                }
-                else
-                {
-                    // this triangle doesn't use the vertex we're interested in
-                    continue;
-                }
+        // Sort the corners by vertex index
+        size_t order[3] = { 0, 1, 2 };
+        if (tri[order[1]] < tri[order[0]]) std::swap(order[0], order[1]);
+        if (tri[order[2]] < tri[order[1]]) std::swap(order[1], order[2]);
+        if (tri[order[1]] < tri[order[0]]) std::swap(order[0], order[1]);
 
-                // If we got to this point then triIndex0 is the pointer to the index to the vertex we're looking at
-                assert(*triIndex0 == i);
-                assert(*triIndex1 != i && *triIndex2 != i); // assume no degenerate triangles
+        for (size_t k = 0; k < 3; ++k)
+        {
+            size_t corner = order[k];
+            TIndex copy = meridianCopies[tri[corner]];
+            if (!copy)
+                continue;
 
-                const VertexPositionNormalTexture& v0 = vertices[*triIndex0];
-                const VertexPositionNormalTexture& v1 = vertices[*triIndex1];
-                const VertexPositionNormalTexture& v2 = vertices[*triIndex2];
+            assert(tri[(corner + 1) % 3] != tri[corner] && tri[(corner + 2) % 3] != tri[corner]); // assume no degenerate triangles
 
-                // check the other two vertices to see if we might need to fix this triangle
+            const VertexPositionNormalTexture& v0 = vertices[tri[corner]];
+            const VertexPositionNormalTexture& v1 = vertices[tri[(corner + 1) % 3]];
+            const VertexPositionNormalTexture& v2 = vertices[tri[(corner + 2) % 3]];
 
-                if (abs(v0.textureCoordinate.x - v1.textureCoordinate.x) > 0.5f ||
-                    abs(v0.textureCoordinate.x - v2.textureCoordinate.x) > 0.5f)
-                {
-                    // yep; replace the specified index to point to the new, corrected vertex
-                    *triIndex0 = static_cast<uint16_t>(newIndex);
-                }
+            // check the other two vertices to see if we might need to fix this triangle
+            if (abs(v0.textureCoordinate.x - v1.textureCoordinate.x) > 0.5f ||
+                abs(v0.textureCoordinate.x - v2.textureCoordinate.x) > 0.5f)
+            {
+                // yep; replace the specified index to point to the new, corrected vertex
+                tri[corner] = copy;
             }
         }
     }
@@ -475,9 +544,9 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
             // These pointers point to the three indices which make up this triangle. pPoleIndex is the pointer to the
             // entry in the index array which represents the pole index, and the other two pointers point to the other
             // two indices making up this triangle.
-            uint16_t* pPoleIndex;
-            uint16_t* pOtherIndex0;
-            uint16_t* pOtherIndex1;
+            TIndex* pPoleIndex;
+            TIndex* pOtherIndex0;
+            TIndex* pOtherIndex1;
             if (indices[i + 0] == poleIndex)
             {
                 pPoleIndex = &indices[i + 0];
@@ -516,9 +585,7 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
             }
             else
             {
-                CheckIndexOverflow(vertices.size());
-
-                *pPoleIndex = static_cast<uint16_t>(vertices.size());
+                *pPoleIndex = static_cast<TIndex>(vertices.size());
                 vertices.push_back(newPoleVertex);
             }
         }
@@ -527,6 +594,8 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
     fixPole(northPoleIndex);
     fixPole(southPoleIndex);
 
+    assert(vertices.size() <= maxVertexCount);
+
     // Build RH above
     if (!rhcoords)
         ReverseWinding(indices, vertices);
@@ -563,7 +632,8 @@ namespace
 
 
     // Helper creates a triangle fan to close the end of a cylinder / cone
-    void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
+    template<typename TIndex>
+    void CreateCylinderCap(VertexCollection& vertices, std::vector<TIndex>& indices, size_t tessellation, float height, float radius, bool isTop)
     {
         // Create cap indices.
         for (size_t i = 0; i < tessellation - 2; i++)
@@ -606,7 +676,8 @@ namespace
     }
 }
 
-void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeCylinder(VertexCollection& vertices, std::vector<TIndex>& indices, float height, float diameter, size_t tessellation, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -614,6 +685,12 @@ void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indic
     if (tessellation < 3)
         throw std::out_of_range("tesselation parameter out of range");
 
+    // Two vertices per side segment (the seam is duplicated), plus a fan for each cap.
+    CheckVertexCount<TIndex>(uint64_t(tessellation + 1) * 2 + uint64_t(tessellation) * 2);
+
+    vertices.reserve((tessellation + 1) * 2 + tessellation * 2);
+    indices.reserve((tessellation + 1) * 6 + (tessellation - 2) * 6);
+
     height /= 2;
 
     XMVECTOR topOffset = g_XMIdentityR1 * height;
@@ -655,7 +732,8 @@ void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indic
 
 
 // Creates a cone primitive.
-void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeCone(VertexCollection& vertices, std::vector<TIndex>& indices, float diameter, float height, size_t tessellation, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -663,6 +741,12 @@ void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices,
     if (tessellation < 3)
         throw std::out_of_range("tesselation parameter out of range");
 
+    // Two vertices per side segment (the seam is duplicated), plus a fan for the bottom cap.
+    CheckVertexCount<TIndex>(uint64_t(tessellation + 1) * 2 + tessellation);
+
+    vertices.reserve((tessellation + 1) * 2 + tessellation);
+    indices.reserve((tessellation + 1) * 3 + (tessellation - 2) * 3);
+
     height /= 2;
 
     XMVECTOR topOffset = g_XMIdentityR1 * height;
@@ -707,7 +791,8 @@ void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices,
 //--------------------------------------------------------------------------------------
 // Torus
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeTorus(VertexCollection& vertices, std::vector<TIndex>& indices, float diameter, float thickness, size_t tessellation, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -717,6 +802,11 @@ void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices,
 
     size_t stride = tessellation + 1;
 
+    CheckVertexCount<TIndex>(uint64_t(stride) * stride);
+
+    vertices.reserve(stride * stride);
+    indices.reserve(stride * stride * 6);
+
     // First we loop around the main ring of the torus.
     for (size_t i = 0; i <= tessellation; i++)
     {
@@ -771,7 +861,8 @@ void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices,
 //--------------------------------------------------------------------------------------
 // Tetrahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeTetrahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeTetrahedron(VertexCollection& vertices, std::vector<TIndex>& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -792,6 +883,9 @@ void DirectX::ComputeTetrahedron(VertexCollection& vertices, IndexCollection& in
         1, 3, 2,
     };
 
+    vertices.reserve(4 * 3);
+    indices.reserve(4 * 3);
+
     for (size_t j = 0; j < _countof(faces); j += 3)
     {
         uint32_t v0 = faces[j];
@@ -830,7 +924,8 @@ void DirectX::ComputeTetrahedron(VertexCollection& vertices, IndexCollection& in
 //--------------------------------------------------------------------------------------
 // Octahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeOctahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeOctahedron(VertexCollection& vertices, std::vector<TIndex>& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -857,6 +952,9 @@ void DirectX::ComputeOctahedron(VertexCollection& vertices, IndexCollection& ind
         5, 0, 3
     };
 
+    vertices.reserve(8 * 3);
+    indices.reserve(8 * 3);
+
     for (size_t j = 0; j < _countof(faces); j += 3)
     {
         uint32_t v0 = faces[j];
@@ -895,7 +993,8 @@ void DirectX::ComputeOctahedron(VertexCollection& vertices, IndexCollection& ind
 //--------------------------------------------------------------------------------------
 // Dodecahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeDodecahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeDodecahedron(VertexCollection& vertices, std::vector<TIndex>& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -970,6 +1069,9 @@ void DirectX::ComputeDodecahedron(VertexCollection& vertices, IndexCollection& i
     };
 
     size_t t = 0;
+    vertices.reserve(12 * 5);
+    indices.reserve(12 * 3 * 3);
+
     for (size_t j = 0; j < _countof(faces); j += 5, ++t)
     {
         uint32_t v0 = faces[j];
@@ -1025,7 +1127,8 @@ void DirectX::ComputeDodecahedron(VertexCollection& vertices, IndexCollection& i
 //--------------------------------------------------------------------------------------
 // Icosahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeIcosahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeIcosahedron(VertexCollection& vertices, std::vector<TIndex>& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -1073,6 +1176,9 @@ void DirectX::ComputeIcosahedron(VertexCollection& vertices, IndexCollection& in
         11, 7, 5
     };
 
+    vertices.reserve(20 * 3);
+    indices.reserve(20 * 3);
+
     for (size_t j = 0; j < _countof(faces); j += 3)
     {
         uint32_t v0 = faces[j];
@@ -1109,43 +1215,180 @@ void DirectX::ComputeIcosahedron(VertexCollection& vertices, IndexCollection& in
 
 
 //--------------------------------------------------------------------------------------
-// Teapot
+// Bezier patches
 //--------------------------------------------------------------------------------------
-
-// Include the teapot control point data.
 namespace
 {
-#include "TeapotData.inc"
+    // Patch sets with fewer vertices than this are tessellated on the calling thread,
+    // as handing them to the thread pool costs more than it saves.
+    const size_t c_ParallelPatchVertices = 16384;
 
-    // Tessellates the specified bezier patch.
-    void XM_CALLCONV TessellatePatch(VertexCollection& vertices, IndexCollection& indices, TeapotPatch const& patch, size_t tessellation, FXMVECTOR scale, bool isMirrored)
+    struct ParallelForContext
     {
-        // Look up the 16 control points for this patch.
-        XMVECTOR controlPoints[16];
+        const std::function<void(size_t)>* item;
+        LONG count;
+        volatile LONG next;
 
-        for (int i = 0; i < 16; i++)
+        void Run()
         {
-            controlPoints[i] = TeapotControlPoints[patch.indices[i]] * scale;
+            for (;;)
+            {
+                LONG i = InterlockedIncrement(&next) - 1;
+                if (i >= count)
+                    break;
+
+                (*item)(static_cast<size_t>(i));
+            }
         }
+    };
 
-        // Create the index data.
-        size_t vbase = vertices.size();
-        Bezier::CreatePatchIndices(tessellation, isMirrored, [&](size_t index)
+    void CALLBACK ParallelForCallback(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK)
+    {
+        reinterpret_cast<ParallelForContext*>(context)->Run();
+    }
+
+
+    // Calls item for each value in [0, count), sharing the work between the calling thread and the system
+    // thread pool. The items must be independent of each other, and must not throw.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& item)
+    {
+        if (count > LONG_MAX)
+            throw std::out_of_range("ParallelFor count");
+
+        ParallelForContext context = { &item, static_cast<LONG>(count), 0 };
+
+        SYSTEM_INFO info = {};
+        GetNativeSystemInfo(&info);
+
+        size_t helpers = std::min<size_t>(count, info.dwNumberOfProcessors);
+        helpers = (helpers > 0) ? (helpers - 1) : 0;
+
+        // If the work object can't be created, the calling thread just does all of the work itself
+        PTP_WORK work = (helpers > 0) ? CreateThreadpoolWork(ParallelForCallback, &context, nullptr) : nullptr;
+        if (work)
         {
-            index_push_back(indices, vbase + index);
-        });
+            for (size_t j = 0; j < helpers; ++j)
+            {
+                SubmitThreadpoolWork(work);
+            }
+        }
+
+        context.Run();
 
-        // Create the vertex data.
-        Bezier::CreatePatchVertices(controlPoints, tessellation, isMirrored, [&](FXMVECTOR position, FXMVECTOR normal, FXMVECTOR textureCoordinate)
+        if (work)
         {
-            vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
-        });
+            WaitForThreadpoolWorkCallbacks(work, FALSE);
+            CloseThreadpoolWork(work);
+        }
+    }
+
+
+    // Tessellates each patch into its own range of the vertex and index buffers, which are sized up front so
+    // that large patch sets can be done in parallel. loadPatch(patchIndex, controlPoints) fills in the 16
+    // control points of a patch, and returns true if it is mirrored.
+    template<typename TIndex, typename TLoadPatch>
+    void TessellatePatches(VertexCollection& vertices, std::vector<TIndex>& indices, size_t patchCount, size_t tessellation, TLoadPatch loadPatch)
+    {
+        const uint64_t patchVertexCount = uint64_t(tessellation + 1) * (tessellation + 1);
+        const uint64_t patchIndexCount = uint64_t(tessellation) * tessellation * 6;
+
+        CheckVertexCount<TIndex>(patchCount * patchVertexCount);
+
+        if (patchCount * patchIndexCount > SIZE_MAX / sizeof(TIndex))
+            throw std::exception("Index value out of range: cannot tesselate primitive so finely");
+
+        vertices.resize(static_cast<size_t>(patchCount * patchVertexCount));
+        indices.resize(static_cast<size_t>(patchCount * patchIndexCount));
+
+        std::function<void(size_t)> tessellatePatch = [&](size_t patchIndex)
+        {
+            XMVECTOR controlPoints[16];
+            bool isMirrored = loadPatch(patchIndex, controlPoints);
+
+            // Create the index data.
+            size_t vbase = patchIndex * static_cast<size_t>(patchVertexCount);
+            TIndex* outIndex = &indices[patchIndex * static_cast<size_t>(patchIndexCount)];
+            Bezier::CreatePatchIndices(tessellation, isMirrored, [&](size_t index)
+            {
+                *outIndex++ = static_cast<TIndex>(vbase + index);
+            });
+
+            // Create the vertex data.
+            VertexPositionNormalTexture* outVertex = &vertices[vbase];
+            Bezier::CreatePatchVertices(controlPoints, tessellation, isMirrored, [&](FXMVECTOR position, FXMVECTOR normal, FXMVECTOR textureCoordinate)
+            {
+                *outVertex++ = VertexPositionNormalTexture(position, normal, textureCoordinate);
+            });
+        };
+
+        if (patchCount * patchVertexCount < c_ParallelPatchVertices)
+        {
+            for (size_t j = 0; j < patchCount; ++j)
+            {
+                tessellatePatch(j);
+            }
+        }
+        else
+        {
+            ParallelFor(patchCount, tessellatePatch);
+        }
     }
 }
 
+
+// Creates bicubic bezier patches, each with 16 control points given row by row.
+template<typename TIndex>
+void DirectX::ComputeBezierPatches(VertexCollection& vertices, std::vector<TIndex>& indices, const XMFLOAT3* controlPoints, size_t patchCount, size_t tessellation, bool rhcoords)
+{
+    vertices.clear();
+    indices.clear();
+
+    if (!controlPoints || !patchCount)
+        throw std::exception("Requires control points for at least one patch");
+
+    if (tessellation < 1)
+        throw std::out_of_range("tesselation parameter out of range");
+
+    TessellatePatches(vertices, indices, patchCount, tessellation, [=](size_t patchIndex, XMVECTOR* patch) -> bool
+    {
+        const XMFLOAT3* points = &controlPoints[patchIndex * 16];
+
+        for (int i = 0; i < 16; i++)
+        {
+            patch[i] = XMLoadFloat3(&points[i]);
+        }
+
+        return false;
+    });
+
+    // Built RH above
+    if (!rhcoords)
+        ReverseWinding(indices, vertices);
+}
+
+
+//--------------------------------------------------------------------------------------
+// Teapot
+//--------------------------------------------------------------------------------------
+
+// Include the teapot control point data.
+namespace
+{
+#include "TeapotData.inc"
+
+    // One tessellation of a teapot patch, which may be mirrored.
+    struct TeapotPatchInstance
+    {
+        TeapotPatch const* patch;
+        XMFLOAT3 scale;
+        bool isMirrored;
+    };
+}
+
         
 // Creates a teapot primitive.
-void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection& indices, float size, size_t tessellation, bool rhcoords)
+template<typename TIndex>
+void DirectX::ComputeTeapot(VertexCollection& vertices, std::vector<TIndex>& indices, float size, size_t tessellation, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -1153,11 +1396,13 @@ void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection& indices
     if (tessellation < 1)
         throw std::out_of_range("tesselation parameter out of range");
 
-    XMVECTOR scaleVector = XMVectorReplicate(size);
+    XMFLOAT3 scale(size, size, size);
+    XMFLOAT3 scaleNegateX(-size, size, size);
+    XMFLOAT3 scaleNegateZ(size, size, -size);
+    XMFLOAT3 scaleNegateXZ(-size, size, -size);
 
-    XMVECTOR scaleNegateX = scaleVector * g_XMNegateX;
-    XMVECTOR scaleNegateZ = scaleVector * g_XMNegateZ;
-    XMVECTOR scaleNegateXZ = scaleVector * g_XMNegateX * g_XMNegateZ;
+    std::vector<TeapotPatchInstance> instances;
+    instances.reserve(_countof(TeapotPatches) * 4);
 
     for (int i = 0; i < sizeof(TeapotPatches) / sizeof(TeapotPatches[0]); i++)
     {
@@ -1165,20 +1410,60 @@ void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection& indices
 
         // Because the teapot is symmetrical from left to right, we only store
         // data for one side, then tessellate each patch twice, mirroring in X.
-        TessellatePatch(vertices, indices, patch, tessellation, scaleVector, false);
-        TessellatePatch(vertices, indices, patch, tessellation, scaleNegateX, true);
+        TeapotPatchInstance a = { &patch, scale, false };
+        TeapotPatchInstance b = { &patch, scaleNegateX, true };
+        instances.push_back(a);
+        instances.push_back(b);
 
         if (patch.mirrorZ)
         {
             // Some parts of the teapot (the body, lid, and rim, but not the
             // handle or spout) are also symmetrical from front to back, so
             // we tessellate them four times, mirroring in Z as well as X.
-            TessellatePatch(vertices, indices, patch, tessellation, scaleNegateZ, true);
-            TessellatePatch(vertices, indices, patch, tessellation, scaleNegateXZ, false);
+            TeapotPatchInstance c = { &patch, scaleNegateZ, true };
+            TeapotPatchInstance d = { &patch, scaleNegateXZ, false };
+            instances.push_back(c);
+            instances.push_back(d);
         }
     }
 
+    TessellatePatches(vertices, indices, instances.size(), tessellation, [&](size_t patchIndex, XMVECTOR* controlPoints) -> bool
+    {
+        auto& instance = instances[patchIndex];
+
+        // Look up the 16 control points for this patch.
+        XMVECTOR scaleVector = XMLoadFloat3(&instance.scale);
+
+        for (int i = 0; i < 16; i++)
+        {
+            controlPoints[i] = TeapotControlPoints[instance.patch->indices[i]] * scaleVector;
+        }
+
+        return instance.isMirrored;
+    });
+
     // Built RH above
     if (!rhcoords)
         ReverseWinding(indices, vertices);
-}
\ No newline at end of file
+}
+
+
+//--------------------------------------------------------------------------------------
+// The generators are provided for both 16-bit and 32-bit indices.
+//--------------------------------------------------------------------------------------
+#define INSTANTIATE_GEOMETRY(TIndex) \
+    template void DirectX::ComputeBox<TIndex>(VertexCollection&, std::vector<TIndex>&, const XMFLOAT3&, bool, bool); \
+    template void DirectX::ComputeSphere<TIndex>(VertexCollection&, std::vector<TIndex>&, float, size_t, bool, bool); \
+    template void DirectX::ComputeGeoSphere<TIndex>(VertexCollection&, std::vector<TIndex>&, float, size_t, bool); \
+    template void DirectX::ComputeCylinder<TIndex>(VertexCollection&, std::vector<TIndex>&, float, float, size_t, bool); \
+    template void DirectX::ComputeCone<TIndex>(VertexCollection&, std::vector<TIndex>&, float, float, size_t, bool); \
+    template void DirectX::ComputeTorus<TIndex>(VertexCollection&, std::vector<TIndex>&, float, float, size_t, bool); \
+    template void DirectX::ComputeTetrahedron<TIndex>(VertexCollection&, std::vector<TIndex>&, float, bool); \
+    template void DirectX::ComputeOctahedron<TIndex>(VertexCollection&, std::vector<TIndex>&, float, bool); \
+    template void DirectX::ComputeDodecahedron<TIndex>(VertexCollection&, std::vector<TIndex>&, float, bool); \
+    template void DirectX::ComputeIcosahedron<TIndex>(VertexCollection&, std::vector<TIndex>&, float, bool); \
+    template void DirectX::ComputeTeapot<TIndex>(VertexCollection&, std::vector<TIndex>&, float, size_t, bool); \
+    template void DirectX::ComputeBezierPatches<TIndex>(VertexCollection&, std::vector<TIndex>&, const XMFLOAT3*, size_t, size_t, bool);
+
+INSTANTIATE_GEOMETRY(uint16_t)
+INSTANTIATE_GEOMETRY(uint32_t)
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "DDS.h"
+#include "DDSParser.h"
 #include "DDSTextureLoader.h"
 
 
@@ -24,170 +25,16 @@ namespace DirectX
 
     namespace LoaderHelpers
     {
+        static_assert(sizeof(DDS_PIXELFORMAT) == sizeof(DDSParser::PixelFormat), "DDS pixel format mismatch");
+        static_assert(sizeof(DDS_HEADER) == sizeof(DDSParser::Header), "DDS header mismatch");
+        static_assert(sizeof(DDS_HEADER_DXT10) == sizeof(DDSParser::HeaderDXT10), "DDS DX10 extended header mismatch");
+
         //--------------------------------------------------------------------------------------
         // Return the BPP for a particular format
         //--------------------------------------------------------------------------------------
         inline size_t BitsPerPixel(_In_ DXGI_FORMAT fmt)
         {
-            switch (fmt)
-            {
-            case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-            case DXGI_FORMAT_R32G32B32A32_FLOAT:
-            case DXGI_FORMAT_R32G32B32A32_UINT:
-            case DXGI_FORMAT_R32G32B32A32_SINT:
-                return 128;
-
-            case DXGI_FORMAT_R32G32B32_TYPELESS:
-            case DXGI_FORMAT_R32G32B32_FLOAT:
-            case DXGI_FORMAT_R32G32B32_UINT:
-            case DXGI_FORMAT_R32G32B32_SINT:
-                return 96;
-
-            case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-            case DXGI_FORMAT_R16G16B16A16_FLOAT:
-            case DXGI_FORMAT_R16G16B16A16_UNORM:
-            case DXGI_FORMAT_R16G16B16A16_UINT:
-            case DXGI_FORMAT_R16G16B16A16_SNORM:
-            case DXGI_FORMAT_R16G16B16A16_SINT:
-            case DXGI_FORMAT_R32G32_TYPELESS:
-            case DXGI_FORMAT_R32G32_FLOAT:
-            case DXGI_FORMAT_R32G32_UINT:
-            case DXGI_FORMAT_R32G32_SINT:
-            case DXGI_FORMAT_R32G8X24_TYPELESS:
-            case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-            case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-            case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-            case DXGI_FORMAT_Y416:
-            case DXGI_FORMAT_Y210:
-            case DXGI_FORMAT_Y216:
-                return 64;
-
-            case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-            case DXGI_FORMAT_R10G10B10A2_UNORM:
-            case DXGI_FORMAT_R10G10B10A2_UINT:
-            case DXGI_FORMAT_R11G11B10_FLOAT:
-            case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-            case DXGI_FORMAT_R8G8B8A8_UNORM:
-            case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-            case DXGI_FORMAT_R8G8B8A8_UINT:
-            case DXGI_FORMAT_R8G8B8A8_SNORM:
-            case DXGI_FORMAT_R8G8B8A8_SINT:
-            case DXGI_FORMAT_R16G16_TYPELESS:
-            case DXGI_FORMAT_R16G16_FLOAT:
-            case DXGI_FORMAT_R16G16_UNORM:
-            case DXGI_FORMAT_R16G16_UINT:
-            case DXGI_FORMAT_R16G16_SNORM:
-            case DXGI_FORMAT_R16G16_SINT:
-            case DXGI_FORMAT_R32_TYPELESS:
-            case DXGI_FORMAT_D32_FLOAT:
-            case DXGI_FORMAT_R32_FLOAT:
-            case DXGI_FORMAT_R32_UINT:
-            case DXGI_FORMAT_R32_SINT:
-            case DXGI_FORMAT_R24G8_TYPELESS:
-            case DXGI_FORMAT_D24_UNORM_S8_UINT:
-            case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-            case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-            case DXGI_FORMAT_R8G8_B8G8_UNORM:
-            case DXGI_FORMAT_G8R8_G8B8_UNORM:
-            case DXGI_FORMAT_B8G8R8A8_UNORM:
-            case DXGI_FORMAT_B8G8R8X8_UNORM:
-            case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-            case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-            case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-            case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-            case DXGI_FORMAT_AYUV:
-            case DXGI_FORMAT_Y410:
-            case DXGI_FORMAT_YUY2:
-                return 32;
-
-            case DXGI_FORMAT_P010:
-            case DXGI_FORMAT_P016:
-                return 24;
-
-            case DXGI_FORMAT_R8G8_TYPELESS:
-            case DXGI_FORMAT_R8G8_UNORM:
-            case DXGI_FORMAT_R8G8_UINT:
-            case DXGI_FORMAT_R8G8_SNORM:
-            case DXGI_FORMAT_R8G8_SINT:
-            case DXGI_FORMAT_R16_TYPELESS:
-            case DXGI_FORMAT_R16_FLOAT:
-            case DXGI_FORMAT_D16_UNORM:
-            case DXGI_FORMAT_R16_UNORM:
-            case DXGI_FORMAT_R16_UINT:
-            case DXGI_FORMAT_R16_SNORM:
-            case DXGI_FORMAT_R16_SINT:
-            case DXGI_FORMAT_B5G6R5_UNORM:
-            case DXGI_FORMAT_B5G5R5A1_UNORM:
-            case DXGI_FORMAT_A8P8:
-            case DXGI_FORMAT_B4G4R4A4_UNORM:
-                return 16;
-
-            case DXGI_FORMAT_NV12:
-            case DXGI_FORMAT_420_OPAQUE:
-            case DXGI_FORMAT_NV11:
-                return 12;
-
-            case DXGI_FORMAT_R8_TYPELESS:
-            case DXGI_FORMAT_R8_UNORM:
-            case DXGI_FORMAT_R8_UINT:
-            case DXGI_FORMAT_R8_SNORM:
-            case DXGI_FORMAT_R8_SINT:
-            case DXGI_FORMAT_A8_UNORM:
-            case DXGI_FORMAT_AI44:
-            case DXGI_FORMAT_IA44:
-            case DXGI_FORMAT_P8:
-                return 8;
-
-            case DXGI_FORMAT_R1_UNORM:
-                return 1;
-
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-                return 4;
-
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                return 8;
-
-#if defined(_XBOX_ONE) && defined(_TITLE)
-
-            case DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT:
-            case DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT:
-            case DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM:
-                return 32;
-
-            case DXGI_FORMAT_D16_UNORM_S8_UINT:
-            case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-                return 24;
-
-            case DXGI_FORMAT_R4G4_UNORM:
-                return 8;
-
-#endif // _XBOX_ONE && _TITLE
-
-            default:
-                return 0;
-            }
+            return DDSParser::BitsPerPixel(static_cast<DDSParser::Format>(fmt));
         }
 
         //--------------------------------------------------------------------------------------
@@ -411,414 +258,331 @@ namespace DirectX
             _Out_opt_ size_t* outRowBytes,
             _Out_opt_ size_t* outNumRows)
         {
-            size_t numBytes = 0;
-            size_t rowBytes = 0;
-            size_t numRows = 0;
-
-            bool bc = false;
-            bool packed = false;
-            bool planar = false;
-            size_t bpe = 0;
-            switch (fmt)
-            {
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-                bc = true;
-                bpe = 8;
-                break;
-
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                bc = true;
-                bpe = 16;
-                break;
-
-            case DXGI_FORMAT_R8G8_B8G8_UNORM:
-            case DXGI_FORMAT_G8R8_G8B8_UNORM:
-            case DXGI_FORMAT_YUY2:
-                packed = true;
-                bpe = 4;
-                break;
-
-            case DXGI_FORMAT_Y210:
-            case DXGI_FORMAT_Y216:
-                packed = true;
-                bpe = 8;
-                break;
-
-            case DXGI_FORMAT_NV12:
-            case DXGI_FORMAT_420_OPAQUE:
-                planar = true;
-                bpe = 2;
-                break;
-
-            case DXGI_FORMAT_P010:
-            case DXGI_FORMAT_P016:
-                planar = true;
-                bpe = 4;
-                break;
-
-#if defined(_XBOX_ONE) && defined(_TITLE)
-
-            case DXGI_FORMAT_D16_UNORM_S8_UINT:
-            case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-                planar = true;
-                bpe = 4;
-                break;
+            DDSParser::GetSurfaceInfo(width, height, static_cast<DDSParser::Format>(fmt), outNumBytes, outRowBytes, outNumRows);
+        }
 
-#endif
+        //--------------------------------------------------------------------------------------
+        inline DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf)
+        {
+            return static_cast<DXGI_FORMAT>(DDSParser::GetFormat(reinterpret_cast<const DDSParser::PixelFormat&>(ddpf)));
+        }
 
-            default:
-                break;
-            }
+        //--------------------------------------------------------------------------------------
+        inline DirectX::DDS_ALPHA_MODE GetAlphaMode(_In_ const DDS_HEADER* header)
+        {
+            auto hdr = reinterpret_cast<const DDSParser::Header*>(header);
+            auto d3d10ext = reinterpret_cast<const DDSParser::HeaderDXT10*>((const char*)header + sizeof(DDS_HEADER));
 
-            if (bc)
-            {
-                size_t numBlocksWide = 0;
-                if (width > 0)
-                {
-                    numBlocksWide = std::max<size_t>(1, (width + 3) / 4);
-                }
-                size_t numBlocksHigh = 0;
-                if (height > 0)
-                {
-                    numBlocksHigh = std::max<size_t>(1, (height + 3) / 4);
-                }
-                rowBytes = numBlocksWide * bpe;
-                numRows = numBlocksHigh;
-                numBytes = rowBytes * numBlocksHigh;
-            }
-            else if (packed)
-            {
-                rowBytes = ((width + 1) >> 1) * bpe;
-                numRows = height;
-                numBytes = rowBytes * height;
-            }
-            else if (fmt == DXGI_FORMAT_NV11)
-            {
-                rowBytes = ((width + 3) >> 2) * 4;
-                numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
-                numBytes = rowBytes * numRows;
-            }
-            else if (planar)
-            {
-                rowBytes = ((width + 1) >> 1) * bpe;
-                numBytes = (rowBytes * height) + ((rowBytes * height + 1) >> 1);
-                numRows = height + ((height + 1) >> 1);
-            }
-            else
-            {
-                size_t bpp = BitsPerPixel(fmt);
-                rowBytes = (width * bpp + 7) / 8; // round up to nearest byte
-                numRows = height;
-                numBytes = rowBytes * height;
-            }
+            return static_cast<DDS_ALPHA_MODE>(DDSParser::GetAlphaMode(*hdr, d3d10ext));
+        }
 
-            if (outNumBytes)
-            {
-                *outNumBytes = numBytes;
-            }
-            if (outRowBytes)
-            {
-                *outRowBytes = rowBytes;
-            }
-            if (outNumRows)
+        //--------------------------------------------------------------------------------------
+        inline HRESULT ToHRESULT(DDSParser::Result result)
+        {
+            switch (result)
             {
-                *outNumRows = numRows;
+            case DDSParser::RESULT_OK:                  return S_OK;
+            case DDSParser::RESULT_INVALID_ARG:         return E_INVALIDARG;
+            case DDSParser::RESULT_INVALID_DATA:        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            case DDSParser::RESULT_NOT_SUPPORTED:       return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            case DDSParser::RESULT_END_OF_FILE:         return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            case DDSParser::RESULT_INSUFFICIENT_BUFFER: return HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER);
+            default:                                    return E_FAIL;
             }
         }
 
         //--------------------------------------------------------------------------------------
-#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
-
-        inline DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf)
+        // Decodes the texture description from a DDS header (followed by its DX10 extension, if
+        // any), and rejects anything larger than the Direct3D hardware requirements. For cubemaps
+        // the arraySize counts individual faces.
+        //--------------------------------------------------------------------------------------
+        inline HRESULT DecodeDDSHeader(_In_ const DDS_HEADER* header,
+            _Out_ uint32_t* resDim,
+            _Out_ UINT* width,
+            _Out_ UINT* height,
+            _Out_ UINT* depth,
+            _Out_ size_t* mipCount,
+            _Out_ UINT* arraySize,
+            _Out_ DXGI_FORMAT* format,
+            _Out_ bool* isCubeMap)
         {
-            if (ddpf.flags & DDS_RGB)
+            if (!header || !resDim || !width || !height || !depth || !mipCount || !arraySize || !format || !isCubeMap)
             {
-                // Note that sRGB formats are written using the "DX10" extended header
-
-                switch (ddpf.RGBBitCount)
-                {
-                case 32:
-                    if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
-                    {
-                        return DXGI_FORMAT_R8G8B8A8_UNORM;
-                    }
-
-                    if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
-                    {
-                        return DXGI_FORMAT_B8G8R8A8_UNORM;
-                    }
-
-                    if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
-                    {
-                        return DXGI_FORMAT_B8G8R8X8_UNORM;
-                    }
-
-                    // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+                return E_POINTER;
+            }
 
-                    // Note that many common DDS reader/writers (including D3DX) swap the
-                    // the RED/BLUE masks for 10:10:10:2 formats. We assume
-                    // below that the 'backwards' header mask is being used since it is most
-                    // likely written by D3DX. The more robust solution is to use the 'DX10'
-                    // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+            auto hdr = reinterpret_cast<const DDSParser::Header*>(header);
+            auto d3d10ext = reinterpret_cast<const DDSParser::HeaderDXT10*>((const char*)header + sizeof(DDS_HEADER));
 
-                    // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
-                    if (ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
-                    {
-                        return DXGI_FORMAT_R10G10B10A2_UNORM;
-                    }
+            DDSParser::TextureDesc desc;
+            auto result = DDSParser::DecodeHeader(*hdr, d3d10ext, &desc);
 
-                    // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+            *resDim = desc.dimension;
+            *width = desc.width;
+            *height = desc.height;
+            *depth = desc.depth;
+            *mipCount = desc.mipLevels;
+            *arraySize = desc.arraySize;
+            *format = static_cast<DXGI_FORMAT>(desc.format);
+            *isCubeMap = desc.isCubeMap;
 
-                    if (ISBITMASK(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R16G16_UNORM;
-                    }
+            return ToHRESULT(result);
+        }
 
-                    if (ISBITMASK(0xffffffff, 0x00000000, 0x00000000, 0x00000000))
-                    {
-                        // Only 32-bit color channel format in D3D9 was R32F
-                        return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
-                    }
-                    break;
+        //--------------------------------------------------------------------------------------
+        // Loads a DDS file, reading only the mip levels that survive the maxsize cap. The header is
+        // read first to compute the subresource layout, then each array slice's remaining mips are read
+        // straight into place, so skipped mips cost neither I/O nor memory. On return the header copy
+        // describes the reduced texture (smaller top level, fewer mips) and bitData holds just its data.
+        //--------------------------------------------------------------------------------------
+        inline HRESULT LoadTextureDataFromFile(_In_z_ const wchar_t* fileName,
+            size_t maxsize,
+            std::unique_ptr<uint8_t[]>& ddsData,
+            const DDS_HEADER** header,
+            const uint8_t** bitData,
+            size_t* bitSize
+        )
+        {
+            if (!header || !bitData || !bitSize)
+            {
+                return E_POINTER;
+            }
 
-                case 24:
-                    // No 24bpp DXGI formats aka D3DFMT_R8G8B8
-                    break;
+            // open the file
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+            ScopedHandle hFile(safe_handle(CreateFile2(fileName,
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                OPEN_EXISTING,
+                nullptr)));
+#else
+            ScopedHandle hFile(safe_handle(CreateFileW(fileName,
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL,
+                nullptr)));
+#endif
 
-                case 16:
-                    if (ISBITMASK(0x7c00, 0x03e0, 0x001f, 0x8000))
-                    {
-                        return DXGI_FORMAT_B5G5R5A1_UNORM;
-                    }
-                    if (ISBITMASK(0xf800, 0x07e0, 0x001f, 0x0000))
-                    {
-                        return DXGI_FORMAT_B5G6R5_UNORM;
-                    }
+            if (!hFile)
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
 
-                    // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+            // Get the file size
+            FILE_STANDARD_INFO fileInfo;
+            if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
 
-                    if (ISBITMASK(0x0f00, 0x00f0, 0x000f, 0xf000))
-                    {
-                        return DXGI_FORMAT_B4G4R4A4_UNORM;
-                    }
+            // File is too big for 32-bit allocation, so reject read
+            if (fileInfo.EndOfFile.HighPart > 0)
+            {
+                return E_FAIL;
+            }
 
-                    // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+            const size_t fileSize = fileInfo.EndOfFile.LowPart;
 
-                    // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
-                    break;
-                }
+            // Need at least enough data to fill the header and magic number to be a valid DDS
+            if (fileSize < (sizeof(DDS_HEADER) + sizeof(uint32_t)))
+            {
+                return E_FAIL;
             }
-            else if (ddpf.flags & DDS_LUMINANCE)
+
+            auto readAt = [&](size_t offset, _Out_writes_bytes_(size) uint8_t* dest, size_t size) -> HRESULT
             {
-                if (8 == ddpf.RGBBitCount)
+                LARGE_INTEGER position;
+                position.QuadPart = static_cast<LONGLONG>(offset);
+                if (!SetFilePointerEx(hFile.get(), position, nullptr, FILE_BEGIN))
                 {
-                    if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-
-                    // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
-
-                    if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
-                    {
-                        return DXGI_FORMAT_R8G8_UNORM; // Some DDS writers assume the bitcount should be 8 instead of 16
-                    }
+                    return HRESULT_FROM_WIN32(GetLastError());
                 }
 
-                if (16 == ddpf.RGBBitCount)
+                DWORD bytesRead = 0;
+                if (!ReadFile(hFile.get(), dest, static_cast<DWORD>(size), &bytesRead, nullptr))
                 {
-                    if (ISBITMASK(0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-                    if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
-                    {
-                        return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
+                    return HRESULT_FROM_WIN32(GetLastError());
                 }
-            }
-            else if (ddpf.flags & DDS_ALPHA)
+
+                return (bytesRead < size) ? E_FAIL : S_OK;
+            };
+
+            // Read the magic number and headers
+            uint8_t headerData[sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)] = {};
+            size_t headerSize = std::min(sizeof(headerData), fileSize);
+
+            HRESULT hr = readAt(0, headerData, headerSize);
+            if (FAILED(hr))
             {
-                if (8 == ddpf.RGBBitCount)
-                {
-                    return DXGI_FORMAT_A8_UNORM;
-                }
+                return hr;
             }
-            else if (ddpf.flags & DDS_BUMPDUDV)
+
+            // DDS files always start with the same magic number ("DDS ")
+            uint32_t dwMagicNumber = *reinterpret_cast<const uint32_t*>(headerData);
+            if (dwMagicNumber != DDS_MAGIC)
             {
-                if (16 == ddpf.RGBBitCount)
-                {
-                    if (ISBITMASK(0x00ff, 0xff00, 0x0000, 0x0000))
-                    {
-                        return DXGI_FORMAT_R8G8_SNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-                }
+                return E_FAIL;
+            }
 
-                if (32 == ddpf.RGBBitCount)
-                {
-                    if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
-                    {
-                        return DXGI_FORMAT_R8G8B8A8_SNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-                    if (ISBITMASK(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R16G16_SNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
+            auto hdr = reinterpret_cast<const DDS_HEADER*>(headerData + sizeof(uint32_t));
 
-                    // No DXGI format maps to ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000) aka D3DFMT_A2W10V10U10
-                }
+            // Verify header to validate DDS file
+            if (hdr->size != sizeof(DDS_HEADER) ||
+                hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+            {
+                return E_FAIL;
             }
-            else if (ddpf.flags & DDS_FOURCC)
+
+            // Check for DX10 extension
+            bool bDXT10Header = false;
+            if ((hdr->ddspf.flags & DDS_FOURCC) &&
+                (MAKEFOURCC('D', 'X', '1', '0') == hdr->ddspf.fourCC))
             {
-                if (MAKEFOURCC('D', 'X', 'T', '1') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC1_UNORM;
-                }
-                if (MAKEFOURCC('D', 'X', 'T', '3') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC2_UNORM;
-                }
-                if (MAKEFOURCC('D', 'X', 'T', '5') == ddpf.fourCC)
+                // Must be long enough for both headers and magic value
+                if (fileSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
                 {
-                    return DXGI_FORMAT_BC3_UNORM;
+                    return E_FAIL;
                 }
 
-                // While pre-multiplied alpha isn't directly supported by the DXGI formats,
-                // they are basically the same as these BC formats so they can be mapped
-                if (MAKEFOURCC('D', 'X', 'T', '2') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC2_UNORM;
-                }
-                if (MAKEFOURCC('D', 'X', 'T', '4') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC3_UNORM;
-                }
+                bDXT10Header = true;
+            }
 
-                if (MAKEFOURCC('A', 'T', 'I', '1') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC4_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '4', 'U') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC4_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '4', 'S') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC4_SNORM;
-                }
+            const size_t offset = sizeof(uint32_t) + sizeof(DDS_HEADER)
+                + (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
 
-                if (MAKEFOURCC('A', 'T', 'I', '2') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC5_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '5', 'U') == ddpf.fourCC)
+            // Work out how many top mips the size cap removes, using the same rules as the texture
+            // creation. Anything unusual leaves skipMip at zero, and the whole file is loaded so the
+            // texture creation reports the error.
+            size_t skipMip = 0;
+            uint64_t skipBytes = 0;
+            uint64_t chainBytes = 0;
+            size_t arraySize = 1;
+
+            if (maxsize && hdr->mipMapCount > 1)
+            {
+                uint32_t resDim = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+                UINT width = 0;
+                UINT height = 0;
+                UINT depth = 0;
+                size_t mipCount = 0;
+                UINT items = 0;
+                DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+                bool isCubeMap = false;
+
+                if (FAILED(DecodeDDSHeader(hdr, &resDim, &width, &height, &depth, &mipCount, &items, &format, &isCubeMap)))
                 {
-                    return DXGI_FORMAT_BC5_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '5', 'S') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC5_SNORM;
+                    mipCount = 0;
                 }
 
-                // BC6H and BC7 are written using the "DX10" extended header
+                arraySize = items;
 
-                if (MAKEFOURCC('R', 'G', 'B', 'G') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_R8G8_B8G8_UNORM;
-                }
-                if (MAKEFOURCC('G', 'R', 'G', 'B') == ddpf.fourCC)
+                if (mipCount > 1 && width && height && depth)
                 {
-                    return DXGI_FORMAT_G8R8_G8B8_UNORM;
-                }
+                    size_t w = width;
+                    size_t h = height;
+                    size_t d = depth;
+                    bool keptAny = false;
 
-                if (MAKEFOURCC('Y', 'U', 'Y', '2') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_YUY2;
+                    for (size_t i = 0; i < mipCount; i++)
+                    {
+                        size_t numBytes = 0;
+                        GetSurfaceInfo(w, h, format, &numBytes, nullptr, nullptr);
+
+                        uint64_t mipBytes = uint64_t(numBytes) * d;
+
+                        if (!keptAny && (w > maxsize || h > maxsize || d > maxsize))
+                        {
+                            ++skipMip;
+                            skipBytes += mipBytes;
+                        }
+                        else
+                        {
+                            keptAny = true;
+                        }
+
+                        chainBytes += mipBytes;
+
+                        w = std::max<size_t>(w >> 1, 1);
+                        h = std::max<size_t>(h >> 1, 1);
+                        d = std::max<size_t>(d >> 1, 1);
+                    }
+
+                    if (!keptAny)
+                    {
+                        skipMip = 0;
+                    }
                 }
+            }
 
-                // Check for D3DFORMAT enums being set here
-                switch (ddpf.fourCC)
+            if (!skipMip)
+            {
+                // Nothing to skip, so read the whole file
+                ddsData.reset(new (std::nothrow) uint8_t[fileSize]);
+                if (!ddsData)
                 {
-                case 36: // D3DFMT_A16B16G16R16
-                    return DXGI_FORMAT_R16G16B16A16_UNORM;
+                    return E_OUTOFMEMORY;
+                }
 
-                case 110: // D3DFMT_Q16W16V16U16
-                    return DXGI_FORMAT_R16G16B16A16_SNORM;
+                memcpy(ddsData.get(), headerData, headerSize);
 
-                case 111: // D3DFMT_R16F
-                    return DXGI_FORMAT_R16_FLOAT;
+                if (fileSize > headerSize)
+                {
+                    hr = readAt(headerSize, ddsData.get() + headerSize, fileSize - headerSize);
+                    if (FAILED(hr))
+                    {
+                        return hr;
+                    }
+                }
 
-                case 112: // D3DFMT_G16R16F
-                    return DXGI_FORMAT_R16G16_FLOAT;
+                *header = reinterpret_cast<const DDS_HEADER*>(ddsData.get() + sizeof(uint32_t));
+                *bitData = ddsData.get() + offset;
+                *bitSize = fileSize - offset;
 
-                case 113: // D3DFMT_A16B16G16R16F
-                    return DXGI_FORMAT_R16G16B16A16_FLOAT;
+                return S_OK;
+            }
 
-                case 114: // D3DFMT_R32F
-                    return DXGI_FORMAT_R32_FLOAT;
+            if (offset + chainBytes * arraySize > fileSize)
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
 
-                case 115: // D3DFMT_G32R32F
-                    return DXGI_FORMAT_R32G32_FLOAT;
+            const size_t keptBytes = static_cast<size_t>(chainBytes - skipBytes);
 
-                case 116: // D3DFMT_A32B32G32R32F
-                    return DXGI_FORMAT_R32G32B32A32_FLOAT;
-                }
+            ddsData.reset(new (std::nothrow) uint8_t[offset + keptBytes * arraySize]);
+            if (!ddsData)
+            {
+                return E_OUTOFMEMORY;
             }
 
-            return DXGI_FORMAT_UNKNOWN;
-        }
+            memcpy(ddsData.get(), headerData, offset);
 
-#undef ISBITMASK
+            // Adjust the header copy to describe the reduced mip chain
+            auto newHeader = reinterpret_cast<DDS_HEADER*>(ddsData.get() + sizeof(uint32_t));
+            newHeader->width = std::max<uint32_t>(newHeader->width >> skipMip, 1);
+            newHeader->height = std::max<uint32_t>(newHeader->height >> skipMip, 1);
+            newHeader->depth = std::max<uint32_t>(newHeader->depth >> skipMip, 1);
+            newHeader->mipMapCount -= static_cast<uint32_t>(skipMip);
 
-        //--------------------------------------------------------------------------------------
-        inline DirectX::DDS_ALPHA_MODE GetAlphaMode(_In_ const DDS_HEADER* header)
-        {
-            if (header->ddspf.flags & DDS_FOURCC)
+            // Each array slice is a full mip chain; read the tail of each one
+            uint8_t* dest = ddsData.get() + offset;
+            for (size_t item = 0; item < arraySize; ++item)
             {
-                if (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC)
+                hr = readAt(offset + static_cast<size_t>(chainBytes * item + skipBytes), dest, keptBytes);
+                if (FAILED(hr))
                 {
-                    auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>((const char*)header + sizeof(DDS_HEADER));
-                    auto mode = static_cast<DDS_ALPHA_MODE>(d3d10ext->miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK);
-                    switch (mode)
-                    {
-                    case DDS_ALPHA_MODE_STRAIGHT:
-                    case DDS_ALPHA_MODE_PREMULTIPLIED:
-                    case DDS_ALPHA_MODE_OPAQUE:
-                    case DDS_ALPHA_MODE_CUSTOM:
-                        return mode;
-
-                    default:
-                        break;
-                    }
-                }
-                else if ((MAKEFOURCC('D', 'X', 'T', '2') == header->ddspf.fourCC)
-                    || (MAKEFOURCC('D', 'X', 'T', '4') == header->ddspf.fourCC))
-                {
-                    return DDS_ALPHA_MODE_PREMULTIPLIED;
+                    return hr;
                 }
+
+                dest += keptBytes;
             }
 
-            return DDS_ALPHA_MODE_UNKNOWN;
+            *header = newHeader;
+            *bitData = ddsData.get() + offset;
+            *bitSize = keptBytes * arraySize;
+
+            return S_OK;
         }
 
         //--------------------------------------------------------------------------------------
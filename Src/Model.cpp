@@ -17,9 +17,11 @@
 #include "CommonStates.h"
 #include "DirectXHelpers.h"
 #include "Effects.h"
+#include "MeshOptimizer.h"
 #include "PlatformHelpers.h"
 
 using namespace DirectX;
+using Microsoft::WRL::ComPtr;
 
 #ifndef _CPPRTTI 
 #error Model requires RTTI
@@ -205,11 +207,15 @@ void XM_CALLCONV ModelMesh::Draw(
     CXMMATRIX view,
     CXMMATRIX projection,
     bool alpha,
-    std::function<void()> setCustomState) const
+    std::function<void()> setCustomState,
+    size_t lod) const
 {
     assert(deviceContext != 0);
+    assert(lod <= lods.size());
+
+    auto& parts = (lod > 0) ? lods[lod - 1] : meshParts;
 
-    for (auto it = meshParts.cbegin(); it != meshParts.cend(); ++it)
+    for (auto it = parts.cbegin(); it != parts.cend(); ++it)
     {
         auto part = (*it).get();
         assert(part != 0);
@@ -231,6 +237,158 @@ void XM_CALLCONV ModelMesh::Draw(
 }
 
 
+float XM_CALLCONV ModelMesh::ComputeScreenSize(FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection) const
+{
+    BoundingSphere sphere;
+    boundingSphere.Transform(sphere, XMMatrixMultiply(world, view));
+
+    // Projected radius over clip w, which is the view depth for a perspective projection and 1 for orthographic
+    XMVECTOR clip = XMVector3Transform(XMLoadFloat3(&sphere.Center), projection);
+    float w = XMVectorGetW(clip);
+    if (w <= FLT_EPSILON)
+        return FLT_MAX;
+
+    return sphere.Radius * fabsf(XMVectorGetY(projection.r[1])) / w;
+}
+
+
+size_t ModelMesh::SelectLOD(float screenSize) const
+{
+    size_t lod = 0;
+    while (lod < lods.size() && lod < lodScreenSizes.size() && screenSize < lodScreenSizes[lod])
+    {
+        ++lod;
+    }
+
+    return lod;
+}
+
+
+//--------------------------------------------------------------------------------------
+// ModelBone
+//--------------------------------------------------------------------------------------
+
+ModelBone::ModelBone() :
+    parentIndex(c_Invalid)
+{
+    XMStoreFloat4x4(&transform, XMMatrixIdentity());
+    XMStoreFloat4x4(&invBindPose, XMMatrixIdentity());
+}
+
+
+//--------------------------------------------------------------------------------------
+// AnimationClip
+//--------------------------------------------------------------------------------------
+
+namespace
+{
+    // Maps an instance time into the clip's [startTime, endTime] range.
+    inline float WrapClipTime(float time, float startTime, float endTime, bool loop)
+    {
+        float duration = endTime - startTime;
+        if (duration <= 0.f)
+            return startTime;
+
+        if (loop)
+        {
+            float t = fmodf(time - startTime, duration);
+            if (t < 0.f)
+                t += duration;
+            return startTime + t;
+        }
+
+        return std::min(std::max(time, startTime), endTime);
+    }
+
+
+    // Samples a single channel, interpolating scale and translation linearly and rotation spherically.
+    inline XMMATRIX SampleChannel(const AnimationClip& clip, const AnimationClip::Channel& channel, float time)
+    {
+        assert(channel.keyCount > 0);
+
+        const float* times = clip.keyTimes.data() + channel.firstKey;
+        size_t last = channel.keyCount - 1;
+
+        size_t k0, k1;
+        float lerp;
+        if (time <= times[0])
+        {
+            k0 = k1 = 0;
+            lerp = 0.f;
+        }
+        else if (time >= times[last])
+        {
+            k0 = k1 = last;
+            lerp = 0.f;
+        }
+        else
+        {
+            k1 = size_t(std::upper_bound(times, times + channel.keyCount, time) - times);
+            k0 = k1 - 1;
+
+            float span = times[k1] - times[k0];
+            lerp = (span > 0.f) ? (time - times[k0]) / span : 0.f;
+        }
+
+        k0 += channel.firstKey;
+        k1 += channel.firstKey;
+
+        XMVECTOR scale = XMLoadFloat3(&clip.keyScales[k0]);
+        XMVECTOR rotation = XMLoadFloat4(&clip.keyRotations[k0]);
+        XMVECTOR translation = XMLoadFloat3(&clip.keyTranslations[k0]);
+
+        if (k0 != k1)
+        {
+            scale = XMVectorLerp(scale, XMLoadFloat3(&clip.keyScales[k1]), lerp);
+            rotation = XMQuaternionSlerp(rotation, XMLoadFloat4(&clip.keyRotations[k1]), lerp);
+            translation = XMVectorLerp(translation, XMLoadFloat3(&clip.keyTranslations[k1]), lerp);
+        }
+
+        return XMMatrixAffineTransformation(scale, g_XMZero, rotation, translation);
+    }
+}
+
+
+AnimationClip::AnimationClip() :
+    startTime(0.f),
+    endTime(0.f)
+{
+}
+
+
+AnimationClip::~AnimationClip()
+{
+}
+
+
+_Use_decl_annotations_
+void AnimationClip::Evaluate(float time, bool loop, size_t nbones, XMMATRIX* localTransforms) const
+{
+    Evaluate(1, &time, loop, nbones, localTransforms);
+}
+
+
+_Use_decl_annotations_
+void AnimationClip::Evaluate(size_t count, const float* times, bool loop, size_t nbones, XMMATRIX* localTransforms) const
+{
+    assert(times != 0 && localTransforms != 0);
+
+    // Channel-major order keeps each bone's keyframe arrays hot in cache across all instances.
+    for (auto it = channels.cbegin(); it != channels.cend(); ++it)
+    {
+        if (it->boneIndex >= nbones || !it->keyCount)
+            continue;
+
+        XMMATRIX* dest = localTransforms + it->boneIndex;
+        for (size_t j = 0; j < count; ++j, dest += nbones)
+        {
+            float t = WrapClipTime(times[j], startTime, endTime, loop);
+            *dest = SampleChannel(*this, *it, t);
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------
 // Model
 //--------------------------------------------------------------------------------------
@@ -251,6 +409,16 @@ void XM_CALLCONV Model::Draw(
 {
     assert(deviceContext != 0);
 
+    auto selectLOD = [&](const ModelMesh& mesh) -> size_t
+    {
+        if (mesh.lods.empty())
+            return 0;
+
+        float screenSize = mesh.ComputeScreenSize(world, view, projection);
+        size_t lod = lodSelector ? lodSelector(mesh, screenSize) : mesh.SelectLOD(screenSize);
+        return std::min(lod, mesh.lods.size());
+    };
+
     // Draw opaque parts
     for (auto it = meshes.cbegin(); it != meshes.cend(); ++it)
     {
@@ -259,7 +427,7 @@ void XM_CALLCONV Model::Draw(
 
         mesh->PrepareForRendering(deviceContext, states, false, wireframe);
 
-        mesh->Draw(deviceContext, world, view, projection, false, setCustomState);
+        mesh->Draw(deviceContext, world, view, projection, false, setCustomState, selectLOD(*mesh));
     }
 
     // Draw alpha parts
@@ -270,7 +438,7 @@ void XM_CALLCONV Model::Draw(
 
         mesh->PrepareForRendering(deviceContext, states, true, wireframe);
 
-        mesh->Draw(deviceContext, world, view, projection, true, setCustomState);
+        mesh->Draw(deviceContext, world, view, projection, true, setCustomState, selectLOD(*mesh));
     }
 }
 
@@ -300,3 +468,278 @@ void Model::UpdateEffects(_In_ std::function<void(IEffect*)> setEffect)
         setEffect(*it);
     }
 }
+
+
+_Use_decl_annotations_
+void Model::CopyBoneTransformsTo(size_t nbones, XMMATRIX* localTransforms) const
+{
+    if (nbones < bones.size())
+        throw std::out_of_range("Bone transforms array too small");
+
+    assert(localTransforms != 0);
+
+    for (size_t j = 0; j < bones.size(); ++j)
+    {
+        localTransforms[j] = XMLoadFloat4x4(&bones[j].transform);
+    }
+}
+
+
+_Use_decl_annotations_
+void Model::CopyAbsoluteBoneTransforms(size_t nbones, const XMMATRIX* localTransforms, XMMATRIX* absoluteTransforms) const
+{
+    if (nbones < bones.size())
+        throw std::out_of_range("Bone transforms array too small");
+
+    assert(localTransforms != 0 && absoluteTransforms != 0);
+
+    // Bones are stored parent-before-child, so a single forward pass suffices.
+    for (size_t j = 0; j < bones.size(); ++j)
+    {
+        uint32_t parent = bones[j].parentIndex;
+        if (parent == ModelBone::c_Invalid)
+        {
+            absoluteTransforms[j] = localTransforms[j];
+        }
+        else
+        {
+            assert(parent < j);
+            absoluteTransforms[j] = XMMatrixMultiply(localTransforms[j], absoluteTransforms[parent]);
+        }
+    }
+}
+
+
+_Use_decl_annotations_
+void Model::EvaluateAnimation(const AnimationClip& clip, const ModelMesh& mesh, size_t count, const float* times, bool loop, XMMATRIX* localTransforms, XMMATRIX* boneTransforms) const
+{
+    if (!count)
+        return;
+
+    if (bones.empty())
+        throw std::exception("Model has no bones");
+
+    assert(times != 0 && localTransforms != 0 && boneTransforms != 0);
+
+    const size_t nbones = bones.size();
+
+    // Start every instance from the rest pose, then overlay the animated channels
+    XMMATRIX* local = localTransforms;
+    CopyBoneTransformsTo(nbones, local);
+    for (size_t j = 1; j < count; ++j)
+    {
+        memcpy(local + j * nbones, local, sizeof(XMMATRIX) * nbones);
+    }
+
+    clip.Evaluate(count, times, loop, nbones, local);
+
+    const size_t ninfluences = mesh.boneInfluences.size();
+
+    for (size_t j = 0; j < count; ++j)
+    {
+        XMMATRIX* pose = local + j * nbones;
+        CopyAbsoluteBoneTransforms(nbones, pose, pose);
+
+        XMMATRIX* dest = boneTransforms + j * ninfluences;
+        for (size_t k = 0; k < ninfluences; ++k)
+        {
+            uint32_t bone = mesh.boneInfluences[k];
+            if (bone >= nbones)
+                throw std::out_of_range("Invalid bone influence");
+
+            dest[k] = XMMatrixMultiply(XMLoadFloat4x4(&bones[bone].invBindPose), pose[bone]);
+        }
+    }
+}
+
+
+namespace
+{
+    // Copies a buffer back from the GPU through a staging buffer
+    void ReadBackBuffer(ID3D11DeviceContext* deviceContext, ID3D11Buffer* buffer, std::vector<uint8_t>& data)
+    {
+        ComPtr<ID3D11Device> device;
+        deviceContext->GetDevice(device.GetAddressOf());
+
+        D3D11_BUFFER_DESC desc;
+        buffer->GetDesc(&desc);
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.BindFlags = 0;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        desc.MiscFlags = 0;
+        desc.StructureByteStride = 0;
+
+        ComPtr<ID3D11Buffer> staging;
+        ThrowIfFailed(
+            device->CreateBuffer(&desc, nullptr, staging.GetAddressOf())
+            );
+
+        deviceContext->CopyResource(staging.Get(), buffer);
+
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        ThrowIfFailed(
+            deviceContext->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped)
+            );
+
+        auto bytes = static_cast<const uint8_t*>(mapped.pData);
+        data.assign(bytes, bytes + desc.ByteWidth);
+
+        deviceContext->Unmap(staging.Get(), 0);
+    }
+
+
+    const size_t c_NoPosition = size_t(-1);
+
+    // Offset of the float position in each vertex. All the loaders put it first.
+    size_t FindPosition(const std::vector<D3D11_INPUT_ELEMENT_DESC>& decl)
+    {
+        for (size_t j = 0; j < decl.size(); ++j)
+        {
+            auto& element = decl[j];
+            if (element.SemanticIndex != 0
+                || (_stricmp(element.SemanticName, "SV_Position") != 0 && _stricmp(element.SemanticName, "POSITION") != 0))
+                continue;
+
+            if (element.InputSlot != 0
+                || (element.Format != DXGI_FORMAT_R32G32B32_FLOAT && element.Format != DXGI_FORMAT_R32G32B32A32_FLOAT))
+                return c_NoPosition;
+
+            if (element.AlignedByteOffset != D3D11_APPEND_ALIGNED_ELEMENT)
+                return element.AlignedByteOffset;
+
+            return (j == 0) ? 0 : c_NoPosition;
+        }
+
+        return c_NoPosition;
+    }
+}
+
+
+_Use_decl_annotations_
+void Model::GenerateLODs(ID3D11DeviceContext* deviceContext, size_t nlevels, const float* triangleRatios, const float* screenSizes, float maxError)
+{
+    assert(deviceContext != 0);
+
+    if (nlevels && (!triangleRatios || !screenSizes))
+        throw std::exception("GenerateLODs");
+
+    ComPtr<ID3D11Device> device;
+    deviceContext->GetDevice(device.GetAddressOf());
+
+    // Parts usually share their buffers, so each is only read back once
+    std::map<ID3D11Buffer*, std::vector<uint8_t>> readBack;
+    auto getData = [&](ID3D11Buffer* buffer) -> const std::vector<uint8_t>&
+    {
+        auto it = readBack.find(buffer);
+        if (it == readBack.end())
+        {
+            it = readBack.insert(std::make_pair(buffer, std::vector<uint8_t>())).first;
+            ReadBackBuffer(deviceContext, buffer, it->second);
+        }
+
+        return it->second;
+    };
+
+    for (auto mit = meshes.cbegin(); mit != meshes.cend(); ++mit)
+    {
+        auto mesh = mit->get();
+        assert(mesh != 0);
+
+        mesh->lods.clear();
+        mesh->lods.resize(nlevels);
+        mesh->lodScreenSizes.assign(screenSizes, screenSizes + nlevels);
+
+        for (auto it = mesh->meshParts.cbegin(); it != mesh->meshParts.cend(); ++it)
+        {
+            auto part = it->get();
+            assert(part != 0);
+
+            size_t positionOffset = part->vbDecl ? FindPosition(*part->vbDecl) : c_NoPosition;
+
+            // Anything other than an indexed triangle list is drawn as-is at every level
+            bool simplify = part->primitiveType == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST
+                            && (part->indexFormat == DXGI_FORMAT_R16_UINT || part->indexFormat == DXGI_FORMAT_R32_UINT)
+                            && part->indexBuffer && part->vertexBuffer
+                            && positionOffset != c_NoPosition
+                            && positionOffset + sizeof(float) * 3 <= part->vertexStride;
+
+            std::vector<uint8_t> indices;
+            const float* positions = nullptr;
+            size_t nverts = 0;
+            size_t indexSize = (part->indexFormat == DXGI_FORMAT_R32_UINT) ? sizeof(uint32_t) : sizeof(uint16_t);
+            size_t nfaces = part->indexCount / 3;
+
+            if (simplify)
+            {
+                auto& ib = getData(part->indexBuffer.Get());
+                auto& vb = getData(part->vertexBuffer.Get());
+
+                size_t firstByte = size_t(part->startIndex) * indexSize;
+                size_t vertexStart = size_t(part->vertexOffset) * part->vertexStride;
+                if (firstByte + nfaces * 3 * indexSize > ib.size() || vertexStart > vb.size())
+                    throw std::exception("Mesh part is outside its buffers");
+
+                indices.assign(ib.begin() + firstByte, ib.begin() + firstByte + nfaces * 3 * indexSize);
+                positions = reinterpret_cast<const float*>(vb.data() + vertexStart + positionOffset);
+                nverts = (vb.size() - vertexStart) / part->vertexStride;
+            }
+
+            const size_t originalFaces = nfaces;
+            ComPtr<ID3D11Buffer> indexBuffer = part->indexBuffer;
+            uint32_t startIndex = part->startIndex;
+            uint32_t indexCount = part->indexCount;
+
+            for (size_t j = 0; j < nlevels; ++j)
+            {
+                if (simplify && nfaces > 0)
+                {
+                    // Each level carries on from the one before, so they nest and later levels are quicker to make
+                    size_t target = static_cast<size_t>(float(originalFaces) * std::max(triangleRatios[j], 0.f));
+                    size_t count;
+                    if (indexSize == sizeof(uint32_t))
+                    {
+                        auto ptr = reinterpret_cast<uint32_t*>(indices.data());
+                        count = MeshOptimizer::SimplifyFaces(ptr, nfaces, positions, part->vertexStride, nverts, target, maxError, ptr);
+                    }
+                    else
+                    {
+                        auto ptr = reinterpret_cast<uint16_t*>(indices.data());
+                        count = MeshOptimizer::SimplifyFaces(ptr, nfaces, positions, part->vertexStride, nverts, target, maxError, ptr);
+                    }
+
+                    if (count > 0 && count < nfaces)
+                    {
+                        D3D11_BUFFER_DESC desc = {};
+                        desc.Usage = D3D11_USAGE_DEFAULT;
+                        desc.ByteWidth = static_cast<UINT>(count * 3 * indexSize);
+                        desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+                        D3D11_SUBRESOURCE_DATA initData = {};
+                        initData.pSysMem = indices.data();
+
+                        ComPtr<ID3D11Buffer> ib;
+                        ThrowIfFailed(
+                            device->CreateBuffer(&desc, &initData, ib.GetAddressOf())
+                            );
+
+                        SetDebugObjectName(ib.Get(), "ModelLOD");
+
+                        indexBuffer = ib;
+                        startIndex = 0;
+                        indexCount = static_cast<uint32_t>(count * 3);
+                        nfaces = count;
+                    }
+                }
+
+                // Levels share the vertex buffer, input layout and effect, and the index buffer of the level before
+                // if nothing more could be removed
+                auto lodPart = new ModelMeshPart(*part);
+                lodPart->indexBuffer = indexBuffer;
+                lodPart->startIndex = startIndex;
+                lodPart->indexCount = indexCount;
+
+                mesh->lods[j].emplace_back(lodPart);
+            }
+        }
+    }
+}
@@ -244,6 +244,74 @@ namespace
             VertexPositionNormalTangentColorTextureSkinning::InputElements + VertexPositionNormalTangentColorTextureSkinning::InputElementCount);
         return TRUE;
     }
+
+    // Converts CMO keyframes (a matrix per bone per time) into per-bone channels of decomposed SoA keys.
+    void CreateAnimationChannels(AnimationClip& anim, _In_reads_(nKeys) const VSD3DStarter::Keyframe* keys, size_t nKeys, UINT nBones, uint32_t boneBase)
+    {
+        std::vector<uint32_t> order;
+        order.reserve(nKeys);
+        for (size_t j = 0; j < nKeys; ++j)
+        {
+            if (keys[j].BoneIndex >= nBones)
+                throw std::exception("Invalid keyframe bone index\n");
+
+            order.push_back(static_cast<uint32_t>(j));
+        }
+
+        // Group keys by bone while preserving time order within each bone
+        std::stable_sort(order.begin(), order.end(), [=](uint32_t a, uint32_t b)
+        {
+            if (keys[a].BoneIndex != keys[b].BoneIndex)
+                return keys[a].BoneIndex < keys[b].BoneIndex;
+            return keys[a].Time < keys[b].Time;
+        });
+
+        anim.keyTimes.reserve(nKeys);
+        anim.keyScales.reserve(nKeys);
+        anim.keyRotations.reserve(nKeys);
+        anim.keyTranslations.reserve(nKeys);
+
+        for (size_t j = 0; j < nKeys; ++j)
+        {
+            auto& key = keys[order[j]];
+
+            if (anim.channels.empty() || anim.channels.back().boneIndex != boneBase + key.BoneIndex)
+            {
+                AnimationClip::Channel channel;
+                channel.boneIndex = boneBase + key.BoneIndex;
+                channel.firstKey = static_cast<uint32_t>(j);
+                channel.keyCount = 0;
+                anim.channels.push_back(channel);
+            }
+
+            ++anim.channels.back().keyCount;
+
+            XMMATRIX m = XMLoadFloat4x4(&key.Transform);
+
+            XMVECTOR scale, rotation, translation;
+            if (!XMMatrixDecompose(&scale, &rotation, &translation, m))
+            {
+                DebugTrace("WARNING: keyframe transform for bone %u could not be decomposed\n", key.BoneIndex);
+                scale = g_XMOne;
+                rotation = XMQuaternionIdentity();
+                translation = m.r[3];
+            }
+
+            anim.keyTimes.push_back(key.Time);
+
+            XMFLOAT3 s;
+            XMStoreFloat3(&s, scale);
+            anim.keyScales.push_back(s);
+
+            XMFLOAT4 r;
+            XMStoreFloat4(&r, rotation);
+            anim.keyRotations.push_back(r);
+
+            XMFLOAT3 t;
+            XMStoreFloat3(&t, translation);
+            anim.keyTranslations.push_back(t);
+        }
+    }
 }
 
 
@@ -545,7 +613,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
         XMVECTOR max = XMVectorSet( extents->MaxX, extents->MaxY, extents->MaxZ, 0.f );
         BoundingBox::CreateFromPoints( mesh->boundingBox, min, max );
 
-#if 0
         // Animation data
         if ( *bSkeleton )
         {
@@ -558,6 +625,12 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
             if ( !*nBones )
                 throw std::exception("Animation bone data is missing\n");
 
+            // Each mesh has its own skeleton, so its bones are appended after any earlier mesh's bones
+            auto boneBase = static_cast<uint32_t>( model->bones.size() );
+
+            model->bones.reserve( boneBase + *nBones );
+            mesh->boneInfluences.reserve( *nBones );
+
             for( UINT j = 0; j < *nBones; ++j )
             {
                 // Bone name
@@ -571,9 +644,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 usedSize += sizeof(wchar_t)*(*nName);
                 if ( dataSize < usedSize )
                     throw std::exception("End of file");
-                
-                // TODO - What to do with bone name?
-                boneName;
 
                 // Bone settings
                 auto bones = reinterpret_cast<const VSD3DStarter::Bone*>( meshData + usedSize );
@@ -581,8 +651,22 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 if ( dataSize < usedSize )  
                     throw std::exception("End of file");
 
-                // TODO - What to do with bone data?
-                bones;
+                ModelBone bone;
+                bone.name.assign( boneName, *nName );
+                bone.transform = bones->LocalTransform;
+                bone.invBindPose = bones->InvBindPos;
+
+                if ( bones->ParentIndex >= 0 )
+                {
+                    // Transform evaluation relies on parents preceding their children
+                    if ( static_cast<UINT>( bones->ParentIndex ) >= j )
+                        throw std::exception("Invalid bone parent index\n");
+
+                    bone.parentIndex = boneBase + static_cast<uint32_t>( bones->ParentIndex );
+                }
+
+                model->bones.emplace_back( bone );
+                mesh->boneInfluences.push_back( boneBase + j );
             }
 
             // Animation Clips
@@ -604,9 +688,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 usedSize += sizeof(wchar_t)*(*nName);
                 if ( dataSize < usedSize )
                     throw std::exception("End of file");
-                
-                // TODO - What to do with clip name?
-                clipName;
 
                 auto clip = reinterpret_cast<const VSD3DStarter::Clip*>( meshData + usedSize );
                 usedSize += sizeof(VSD3DStarter::Clip);
@@ -621,13 +702,16 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 if ( dataSize < usedSize )  
                     throw std::exception("End of file");
 
-                // TODO - What to do with keys and clip->StartTime, clip->EndTime?
-                keys;
+                auto anim = std::make_shared<AnimationClip>();
+                anim->name.assign( clipName, *nName );
+                anim->startTime = clip->StartTime;
+                anim->endTime = clip->EndTime;
+
+                CreateAnimationChannels( *anim, keys, clip->keys, *nBones, boneBase );
+
+                model->animations.emplace_back( anim );
             }
         }
-#else
-        UNREFERENCED_PARAMETER(bSkeleton);
-#endif
 
         bool enableSkinning = ( *nSkinVBs ) != 0;
 
@@ -861,15 +945,17 @@ _Use_decl_annotations_
 std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, const wchar_t* szFileName, IEffectFactory& fxFactory, bool ccw, bool pmalpha )
 {
     size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile( szFileName, data, &dataSize );
+    uint8_t const* data = nullptr;
+    BinaryReader::ScopedMappedView mappedData;
+    std::unique_ptr<uint8_t[]> ownedData;
+    HRESULT hr = BinaryReader::LoadEntireFile( szFileName, mappedData, ownedData, &data, &dataSize );
     if ( FAILED(hr) )
     {
         DebugTrace( "CreateFromCMO failed (%08X) loading '%ls'\n", hr, szFileName );
         throw std::exception( "CreateFromCMO" );
     }
 
-    auto model = CreateFromCMO( d3dDevice, data.get(), dataSize, fxFactory, ccw, pmalpha );
+    auto model = CreateFromCMO( d3dDevice, data, dataSize, fxFactory, ccw, pmalpha );
 
     model->name = szFileName;
 
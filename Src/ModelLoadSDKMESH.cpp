@@ -324,6 +324,115 @@ namespace
 
         SetDebugObjectName(*pInputLayout, "ModelSDKMESH");
     }
+
+    // Flattens the frame tree into bones stored parent-before-child (depth-first order), so the hierarchy can be
+    // updated with a single forward pass. Returns the bone index for each frame in 'frameToBone'. A hierarchy which
+    // is not a tree (a cycle, a link to a missing frame, or frames left out of it) gives no bones, and returns false.
+    bool CreateBonesFromFrames(_In_reads_(nframes) const DXUT::SDKMESH_FRAME* frames, uint32_t nframes,
+        ModelBone::Collection& bones, std::vector<uint32_t>& frameToBone)
+    {
+        frameToBone.assign(nframes, ModelBone::c_Invalid);
+
+        if (!nframes)
+            return true;
+
+        bones.reserve(nframes);
+
+        struct PendingFrame
+        {
+            uint32_t frame;
+            uint32_t parentBone;
+        };
+
+        std::vector<PendingFrame> stack;
+
+        // Frame 0 is the root of the tree, but any other frame without a parent starts a tree of its own
+        for (uint32_t root = 0; root < nframes; ++root)
+        {
+            if (frameToBone[root] != ModelBone::c_Invalid)
+                continue;
+
+            if (root > 0 && frames[root].ParentFrame != DXUT::INVALID_FRAME)
+                continue;
+
+            PendingFrame start = { root, ModelBone::c_Invalid };
+            stack.push_back(start);
+
+            while (!stack.empty())
+            {
+                PendingFrame pending = stack.back();
+                stack.pop_back();
+
+                if (pending.frame >= nframes)
+                {
+                    DebugTrace("WARNING: Frame hierarchy links to invalid frame %u, so no bones are created\n", pending.frame);
+                    bones.clear();
+                    frameToBone.clear();
+                    return false;
+                }
+
+                if (frameToBone[pending.frame] != ModelBone::c_Invalid)
+                {
+                    DebugTrace("WARNING: Frame hierarchy contains a cycle at frame %u, so no bones are created\n", pending.frame);
+                    bones.clear();
+                    frameToBone.clear();
+                    return false;
+                }
+
+                auto& frame = frames[pending.frame];
+                auto boneIndex = static_cast<uint32_t>(bones.size());
+                frameToBone[pending.frame] = boneIndex;
+
+                ModelBone bone;
+                bone.parentIndex = pending.parentBone;
+                bone.transform = frame.Matrix;
+
+                wchar_t frameName[DXUT::MAX_FRAME_NAME];
+                MultiByteToWideChar(CP_ACP, MB_PRECOMPOSED, frame.Name, -1, frameName, DXUT::MAX_FRAME_NAME);
+                bone.name = frameName;
+
+                bones.emplace_back(bone);
+
+                // The sibling is pushed first so the whole subtree of the child is visited before it
+                if (frame.SiblingFrame != DXUT::INVALID_FRAME)
+                {
+                    PendingFrame sibling = { frame.SiblingFrame, pending.parentBone };
+                    stack.push_back(sibling);
+                }
+
+                if (frame.ChildFrame != DXUT::INVALID_FRAME)
+                {
+                    PendingFrame child = { frame.ChildFrame, boneIndex };
+                    stack.push_back(child);
+                }
+            }
+        }
+
+        if (bones.size() != nframes)
+        {
+            DebugTrace("WARNING: Frame hierarchy leaves out %Iu of its frames, so no bones are created\n", nframes - bones.size());
+            bones.clear();
+            frameToBone.clear();
+            return false;
+        }
+
+        // The file's frame matrices are the bind pose
+        std::unique_ptr<XMMATRIX[], aligned_deleter> bindPose(
+            reinterpret_cast<XMMATRIX*>(_aligned_malloc(sizeof(XMMATRIX) * nframes, 16)));
+        if (!bindPose)
+            throw std::bad_alloc();
+
+        for (size_t j = 0; j < bones.size(); ++j)
+        {
+            XMMATRIX local = XMLoadFloat4x4(&bones[j].transform);
+            uint32_t parent = bones[j].parentIndex;
+            bindPose[j] = (parent == ModelBone::c_Invalid) ? local : XMMatrixMultiply(local, bindPose[parent]);
+
+            XMStoreFloat4x4(&bones[j].invBindPose, XMMatrixInverse(nullptr, bindPose[j]));
+        }
+
+        return true;
+    }
 }
 
 
@@ -396,7 +505,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH( ID3D11Device* d3dDevic
     if ( dataSize < header->FrameDataOffset
          || (dataSize < (header->FrameDataOffset + header->NumFrames * sizeof(DXUT::SDKMESH_FRAME) ) ) )
         throw std::exception("End of file");
-    // TODO - auto frameArray = reinterpret_cast<const DXUT::SDKMESH_FRAME*>( meshData + header->FrameDataOffset );
+    auto frameArray = reinterpret_cast<const DXUT::SDKMESH_FRAME*>( meshData + header->FrameDataOffset );
 
     if ( dataSize < header->MaterialDataOffset
          || (dataSize < (header->MaterialDataOffset + header->NumMaterials * sizeof(DXUT::SDKMESH_MATERIAL) ) ) )
@@ -498,6 +607,11 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH( ID3D11Device* d3dDevic
     std::unique_ptr<Model> model(new Model());
     model->meshes.reserve( header->NumMeshes );
 
+    // Frame hierarchy
+    // Without a usable hierarchy the model still loads, just with no bones for skinning or animation
+    std::vector<uint32_t> frameToBone;
+    bool hasBones = CreateBonesFromFrames( frameArray, header->NumFrames, model->bones, frameToBone );
+
     for( UINT meshIndex = 0; meshIndex < header->NumMeshes; ++meshIndex )
     {
         auto& mh = meshArray[ meshIndex ];
@@ -516,16 +630,27 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH( ID3D11Device* d3dDevic
 
         auto subsets = reinterpret_cast<const UINT*>( meshData + mh.SubsetOffset );
 
-        if ( mh.NumFrameInfluences > 0 )
+        auto mesh = std::make_shared<ModelMesh>();
+
+        if ( mh.NumFrameInfluences > 0 && hasBones )
         {
             if ( dataSize < mh.FrameInfluenceOffset
                  || (dataSize < mh.FrameInfluenceOffset + mh.NumFrameInfluences*sizeof(UINT) ) )
                 throw std::exception("End of file");
 
-            // TODO - auto influences = reinterpret_cast<const UINT*>( meshData + mh.FrameInfluenceOffset );
+            auto influences = reinterpret_cast<const UINT*>( meshData + mh.FrameInfluenceOffset );
+
+            // Blend indices refer to the mesh's frame influences, which map to bones
+            mesh->boneInfluences.reserve( mh.NumFrameInfluences );
+            for( UINT j = 0; j < mh.NumFrameInfluences; ++j )
+            {
+                if ( influences[ j ] >= header->NumFrames )
+                    throw std::exception("Invalid frame influence found");
+
+                mesh->boneInfluences.push_back( frameToBone[ influences[ j ] ] );
+            }
         }
 
-        auto mesh = std::make_shared<ModelMesh>();
         wchar_t meshName[ DXUT::MAX_MESH_NAME ];
         MultiByteToWideChar( CP_ACP, MB_PRECOMPOSED, mh.Name, -1, meshName, DXUT::MAX_MESH_NAME );
         mesh->name = meshName;
@@ -616,17 +741,140 @@ _Use_decl_annotations_
 std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH( ID3D11Device* d3dDevice, const wchar_t* szFileName, IEffectFactory& fxFactory, bool ccw, bool pmalpha )
 {
     size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile( szFileName, data, &dataSize );
+    uint8_t const* data = nullptr;
+    BinaryReader::ScopedMappedView mappedData;
+    std::unique_ptr<uint8_t[]> ownedData;
+    HRESULT hr = BinaryReader::LoadEntireFile( szFileName, mappedData, ownedData, &data, &dataSize );
     if ( FAILED(hr) )
     {
         DebugTrace( "CreateFromSDKMESH failed (%08X) loading '%ls'\n", hr, szFileName );
         throw std::exception( "CreateFromSDKMESH" );
     }
 
-    auto model = CreateFromSDKMESH( d3dDevice, data.get(), dataSize, fxFactory, ccw, pmalpha );
+    auto model = CreateFromSDKMESH( d3dDevice, data, dataSize, fxFactory, ccw, pmalpha );
 
     model->name = szFileName;
 
     return model;
 }
+
+
+//======================================================================================
+// Animation Loader
+//======================================================================================
+
+_Use_decl_annotations_
+std::shared_ptr<AnimationClip> DirectX::Model::LoadSDKMESHAnimation( const uint8_t* animData, size_t dataSize )
+{
+    if ( !animData )
+        throw std::exception("animData cannot be null");
+
+    // File Header
+    if ( dataSize < sizeof(DXUT::SDKANIMATION_FILE_HEADER) )
+        throw std::exception("End of file");
+    auto header = reinterpret_cast<const DXUT::SDKANIMATION_FILE_HEADER*>( animData );
+
+    if ( header->IsBigEndian )
+        throw std::exception("Loading BigEndian SDKMESH_ANIM files not supported");
+
+    if ( header->FrameTransformType != DXUT::FTT_RELATIVE )
+        throw std::exception("Only relative frame transforms are supported");
+
+    if ( !header->NumAnimationKeys || !header->AnimationFPS )
+        throw std::exception("No animation keys found");
+
+    if ( dataSize < header->AnimationDataOffset
+         || ( dataSize < ( header->AnimationDataOffset + uint64_t( header->NumFrames ) * sizeof(DXUT::SDKANIMATION_FRAME_DATA) ) ) )
+        throw std::exception("End of file");
+    auto frameData = reinterpret_cast<const DXUT::SDKANIMATION_FRAME_DATA*>( animData + header->AnimationDataOffset );
+
+    // Frames are bound to bones by name
+    std::map<std::wstring, uint32_t> boneNames;
+    for( size_t j = 0; j < bones.size(); ++j )
+    {
+        boneNames.insert( std::make_pair( bones[ j ].name, static_cast<uint32_t>( j ) ) );
+    }
+
+    // The first key is the bind pose, and DXUT loops over the keys after it, holding each for a tick
+    const uint32_t firstKey = ( header->NumAnimationKeys > 1 ) ? 1u : 0u;
+    const uint32_t keyCount = header->NumAnimationKeys - firstKey;
+    const float tick = 1.f / float( header->AnimationFPS );
+
+    auto clip = std::make_shared<AnimationClip>();
+    clip->startTime = 0.f;
+    clip->endTime = float( keyCount ) * tick;
+
+    clip->channels.reserve( header->NumFrames );
+
+    for( uint32_t j = 0; j < header->NumFrames; ++j )
+    {
+        auto& frame = frameData[ j ];
+
+        // Keys are relative to the end of the file header
+        uint64_t keysOffset = sizeof(DXUT::SDKANIMATION_FILE_HEADER) + frame.DataOffset;
+        if ( frame.DataOffset > dataSize
+             || ( dataSize < ( keysOffset + uint64_t( header->NumAnimationKeys ) * sizeof(DXUT::SDKANIMATION_DATA) ) ) )
+            throw std::exception("End of file");
+        auto keys = reinterpret_cast<const DXUT::SDKANIMATION_DATA*>( animData + keysOffset );
+
+        wchar_t frameName[DXUT::MAX_FRAME_NAME];
+        MultiByteToWideChar( CP_ACP, MB_PRECOMPOSED, frame.FrameName, -1, frameName, DXUT::MAX_FRAME_NAME );
+
+        auto it = boneNames.find( frameName );
+        if ( it == boneNames.end() )
+        {
+            DebugTrace( "WARNING: Animation frame '%s' does not match any bone in the model\n", frame.FrameName );
+            continue;
+        }
+
+        AnimationClip::Channel channel;
+        channel.boneIndex = it->second;
+        channel.firstKey = static_cast<uint32_t>( clip->keyTimes.size() );
+        channel.keyCount = keyCount;
+        clip->channels.push_back( channel );
+
+        for( uint32_t k = 0; k < keyCount; ++k )
+        {
+            auto& key = keys[ firstKey + k ];
+
+            // DXUT ignores the scaling, and treats a zero orientation as the identity
+            XMVECTOR rotation = XMLoadFloat4( &key.Orientation );
+            rotation = XMVector4Equal( rotation, g_XMZero ) ? XMQuaternionIdentity() : XMQuaternionNormalize( rotation );
+
+            XMFLOAT4 r;
+            XMStoreFloat4( &r, rotation );
+
+            clip->keyTimes.push_back( float( k ) * tick );
+            clip->keyScales.push_back( XMFLOAT3( 1.f, 1.f, 1.f ) );
+            clip->keyRotations.push_back( r );
+            clip->keyTranslations.push_back( key.Translation );
+        }
+    }
+
+    animations.emplace_back( clip );
+
+    return clip;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+std::shared_ptr<AnimationClip> DirectX::Model::LoadSDKMESHAnimation( const wchar_t* szFileName )
+{
+    size_t dataSize = 0;
+    uint8_t const* data = nullptr;
+    BinaryReader::ScopedMappedView mappedData;
+    std::unique_ptr<uint8_t[]> ownedData;
+    HRESULT hr = BinaryReader::LoadEntireFile( szFileName, mappedData, ownedData, &data, &dataSize );
+    if ( FAILED(hr) )
+    {
+        DebugTrace( "LoadSDKMESHAnimation failed (%08X) loading '%ls'\n", hr, szFileName );
+        throw std::exception( "LoadSDKMESHAnimation" );
+    }
+
+    auto clip = LoadSDKMESHAnimation( data, dataSize );
+
+    clip->name = szFileName;
+
+    return clip;
+}
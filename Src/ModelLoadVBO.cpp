@@ -172,15 +172,17 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(ID3D11Device* d3dDevice, co
                                                      std::shared_ptr<IEffect> ieffect, bool ccw, bool pmalpha)
 {
     size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile( szFileName, data, &dataSize );
+    uint8_t const* data = nullptr;
+    BinaryReader::ScopedMappedView mappedData;
+    std::unique_ptr<uint8_t[]> ownedData;
+    HRESULT hr = BinaryReader::LoadEntireFile( szFileName, mappedData, ownedData, &data, &dataSize );
     if ( FAILED(hr) )
     {
         DebugTrace( "CreateFromVBO failed (%08X) loading '%ls'\n", hr, szFileName );
         throw std::exception( "CreateFromVBO" );
     }
 
-    auto model = CreateFromVBO( d3dDevice, data.get(), dataSize, ieffect, ccw, pmalpha );
+    auto model = CreateFromVBO( d3dDevice, data, dataSize, ieffect, ccw, pmalpha );
 
     model->name = szFileName;
 
@@ -83,6 +83,131 @@ public:
         FXMVECTOR originRotationDepth,
         int flags);
 
+    void Submit(_In_ Recorder::Impl* recorder);
+
+    // Converts the arguments of each public Draw overload for Impl::Draw, shared by SpriteBatch and Recorder.
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl, ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
+    {
+        XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), g_XMOne); // x, y, 1, 1
+
+        impl.Draw(texture, destination, nullptr, color, g_XMZero, 0);
+    }
+
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl,
+        ID3D11ShaderResourceView* texture,
+        XMFLOAT2 const& position,
+        RECT const* sourceRectangle,
+        FXMVECTOR color,
+        float rotation,
+        XMFLOAT2 const& origin,
+        float scale,
+        SpriteEffects effects,
+        float layerDepth)
+    {
+        XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(XMLoadFloat2(&position), XMLoadFloat(&scale)); // x, y, scale, scale
+
+        XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+
+        impl.Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    }
+
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl,
+        ID3D11ShaderResourceView* texture,
+        XMFLOAT2 const& position,
+        RECT const* sourceRectangle,
+        FXMVECTOR color,
+        float rotation,
+        XMFLOAT2 const& origin,
+        XMFLOAT2 const& scale,
+        SpriteEffects effects,
+        float layerDepth)
+    {
+        XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), XMLoadFloat2(&scale)); // x, y, scale.x, scale.y
+
+        XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+
+        impl.Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    }
+
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl, ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color)
+    {
+        XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, g_XMOne); // x, y, 1, 1
+
+        impl.Draw(texture, destination, nullptr, color, g_XMZero, 0);
+    }
+
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl,
+        ID3D11ShaderResourceView* texture,
+        FXMVECTOR position,
+        RECT const* sourceRectangle,
+        FXMVECTOR color,
+        float rotation,
+        FXMVECTOR origin,
+        float scale,
+        SpriteEffects effects,
+        float layerDepth)
+    {
+        XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(position, XMLoadFloat(&scale)); // x, y, scale, scale
+
+        XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
+
+        XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
+
+        impl.Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    }
+
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl,
+        ID3D11ShaderResourceView* texture,
+        FXMVECTOR position,
+        RECT const* sourceRectangle,
+        FXMVECTOR color,
+        float rotation,
+        FXMVECTOR origin,
+        GXMVECTOR scale,
+        SpriteEffects effects,
+        float layerDepth)
+    {
+        XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, scale); // x, y, scale.x, scale.y
+
+        XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
+
+        XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
+
+        impl.Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    }
+
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl, ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color)
+    {
+        XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
+
+        impl.Draw(texture, destination, nullptr, color, g_XMZero, SpriteInfo::DestSizeInPixels);
+    }
+
+    template<typename TImpl>
+    static void XM_CALLCONV Queue(TImpl& impl,
+        ID3D11ShaderResourceView* texture,
+        RECT const& destinationRectangle,
+        RECT const* sourceRectangle,
+        FXMVECTOR color,
+        float rotation,
+        XMFLOAT2 const& origin,
+        SpriteEffects effects,
+        float layerDepth)
+    {
+        XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
+
+        XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+
+        impl.Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects | SpriteInfo::DestSizeInPixels);
+    }
+
 
     // Info about a single sprite that is waiting to be drawn.
     __declspec(align(16)) struct SpriteInfo : public AlignedNew<SpriteInfo>
@@ -102,6 +227,16 @@ public:
         static_assert((SpriteEffects_FlipBoth & (SourceInTexels | DestSizeInPixels)) == 0, "Flag bits must not overlap");
     };
 
+    static void XM_CALLCONV FillSpriteInfo(_Out_ SpriteInfo* sprite,
+        _In_ ID3D11ShaderResourceView* texture,
+        FXMVECTOR destination,
+        _In_opt_ RECT const* sourceRectangle,
+        FXMVECTOR color,
+        FXMVECTOR originRotationDepth,
+        int flags);
+
+    static void GrowSpriteArray(std::unique_ptr<SpriteInfo[]>& spriteArray, size_t count, size_t& arraySize);
+
     DXGI_MODE_ROTATION mRotation;
 
     bool mSetViewport;
@@ -110,9 +245,11 @@ public:
 private:
     // Implementation helper methods.
     void GrowSpriteQueue();
+    void MergeRecordedSprites();
     void PrepareForRendering();
     void FlushBatch();
     void SortSprites();
+    void RadixSortSprites();
     void GrowSortedSprites();
 
     void RenderBatch(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteInfo const* const* sprites, size_t count);
@@ -122,6 +259,12 @@ private:
         FXMVECTOR textureSize,
         FXMVECTOR inverseTextureSize);
 
+    static void XM_CALLCONV RenderSprites(_In_reads_(count) SpriteInfo const* const* sprites,
+        size_t count,
+        _Out_writes_(count * VerticesPerSprite) VertexPositionColorTexture* vertices,
+        FXMVECTOR textureSize,
+        FXMVECTOR inverseTextureSize);
+
     static XMVECTOR GetTextureSize(_In_ ID3D11ShaderResourceView* texture);
     XMMATRIX GetViewportTransform(_In_ ID3D11DeviceContext* deviceContext, DXGI_MODE_ROTATION rotation );
 
@@ -132,6 +275,7 @@ private:
     static const size_t InitialQueueSize = 64;
     static const size_t VerticesPerSprite = 4;
     static const size_t IndicesPerSprite = 6;
+    static const size_t RadixSortThreshold = 512;
 
 
     // Queue of sprites waiting to be drawn.
@@ -148,12 +292,40 @@ private:
     std::vector<SpriteInfo const*> mSortedSprites;
 
 
+    // Large queues are sorted by a stable radix sort on packed keys instead of comparing SpriteInfo
+    // fields through pointers. These buffers are kept between batches so sorting does not allocate.
+    struct SortEntry
+    {
+        uint64_t key;
+        SpriteInfo const* sprite;
+    };
+
+    std::vector<SortEntry> mSortEntries;
+    std::vector<SortEntry> mSortScratch;
+
+
     // If each SpriteInfo instance held a refcount on its texture, could end up with
     // many redundant AddRef/Release calls on the same object, so instead we use
     // this separate list to hold just a single refcount each time we change texture.
     std::vector<ComPtr<ID3D11ShaderResourceView>> mSpriteTextureReferences;
 
 
+    // Sprites taken from recorders by Submit since Begin, appended to mSpriteQueue by End in recorder order.
+    struct RecordedRange
+    {
+        uint32_t order;
+        size_t start;
+        size_t count;
+    };
+
+    std::unique_ptr<SpriteInfo[]> mRecordedSprites;
+
+    size_t mRecordedSpriteCount;
+    size_t mRecordedSpriteArraySize;
+
+    std::vector<RecordedRange> mRecordedRanges;
+
+
     // Mode settings from the last Begin call.
     bool mInBeginEndPair;
 
@@ -219,6 +391,42 @@ private:
 };
 
 
+// Internal SpriteBatch::Recorder implementation class.
+class SpriteBatch::Recorder::Impl
+{
+public:
+    explicit Impl(uint32_t order)
+      : mOrder(order),
+        mSpriteQueueCount(0),
+        mSpriteQueueArraySize(0)
+    {
+    }
+
+    void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture,
+        FXMVECTOR destination,
+        _In_opt_ RECT const* sourceRectangle,
+        FXMVECTOR color,
+        FXMVECTOR originRotationDepth,
+        int flags);
+
+    void Clear()
+    {
+        mSpriteQueueCount = 0;
+        mSpriteTextureReferences.clear();
+    }
+
+    uint32_t mOrder;
+
+    // Same layout and growth policy as the SpriteBatch queue, so merging is a straight copy.
+    std::unique_ptr<SpriteBatch::Impl::SpriteInfo[]> mSpriteQueue;
+
+    size_t mSpriteQueueCount;
+    size_t mSpriteQueueArraySize;
+
+    std::vector<ComPtr<ID3D11ShaderResourceView>> mSpriteTextureReferences;
+};
+
+
 // Global pools of per-device and per-context SpriteBatch resources.
 SharedResourcePool<ID3D11Device*, SpriteBatch::Impl::DeviceResources> SpriteBatch::Impl::deviceResourcesPool;
 SharedResourcePool<ID3D11DeviceContext*, SpriteBatch::Impl::ContextResources> SpriteBatch::Impl::contextResourcesPool;
@@ -376,6 +584,8 @@ SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
     mViewPort{},
     mSpriteQueueCount(0),
     mSpriteQueueArraySize(0),
+    mRecordedSpriteCount(0),
+    mRecordedSpriteArraySize(0),
     mInBeginEndPair(false),
     mSortMode(SpriteSortMode_Deferred),
     mTransformMatrix(MatrixIdentity),
@@ -406,6 +616,10 @@ void XM_CALLCONV SpriteBatch::Impl::Begin(SpriteSortMode sortMode,
     mSetCustomShaders = setCustomShaders;
     mTransformMatrix = transformMatrix;
 
+    // Drop anything left over from an End that threw.
+    mRecordedSpriteCount = 0;
+    mRecordedRanges.clear();
+
     if (sortMode == SpriteSortMode_Immediate)
     {
         // If we are in immediate mode, set device state ready for drawing.
@@ -438,6 +652,8 @@ void SpriteBatch::Impl::End()
         if (mContextResources->inImmediateMode)
             throw std::exception("Cannot end one SpriteBatch while another is using SpriteSortMode_Immediate");
 
+        MergeRecordedSprites();
+
         PrepareForRendering();
         FlushBatch();
     }
@@ -473,6 +689,40 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
 
     SpriteInfo* sprite = &mSpriteQueue[mSpriteQueueCount];
 
+    FillSpriteInfo(sprite, texture, destination, sourceRectangle, color, originRotationDepth, flags);
+
+    if (mSortMode == SpriteSortMode_Immediate)
+    {
+        // If we are in immediate mode, draw this sprite straight away.
+        RenderBatch(texture, &sprite, 1);
+    }
+    else
+    {
+        // Queue this sprite for later sorting and batched rendering.
+        mSpriteQueueCount++;
+
+        // Make sure we hold a refcount on this texture until the sprite has been drawn. Only checking the
+        // back of the vector means we will add duplicate references if the caller switches back and forth
+        // between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
+        // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
+        if (mSpriteTextureReferences.empty() || texture != mSpriteTextureReferences.back().Get())
+        {
+            mSpriteTextureReferences.emplace_back(texture);
+        }
+    }
+}
+
+
+// Stores the parameters of a single sprite.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::FillSpriteInfo(SpriteInfo* sprite,
+    ID3D11ShaderResourceView* texture,
+    FXMVECTOR destination,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    FXMVECTOR originRotationDepth,
+    int flags)
+{
     XMVECTOR dest = destination;
 
     if (sourceRectangle)
@@ -505,50 +755,132 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
 
     sprite->texture = texture;
     sprite->flags = flags;
+}
+
+
+// Dynamically expands the array used to store pending sprite information.
+void SpriteBatch::Impl::GrowSpriteQueue()
+{
+    GrowSpriteArray(mSpriteQueue, mSpriteQueueCount, mSpriteQueueArraySize);
+
+    // Clear any dangling SpriteInfo pointers left over from previous rendering.
+    mSortedSprites.clear();
+}
+
+
+// Doubles the size of a sprite array, preserving the first 'count' entries.
+void SpriteBatch::Impl::GrowSpriteArray(std::unique_ptr<SpriteInfo[]>& spriteArray, size_t count, size_t& arraySize)
+{
+    // Grow by a factor of 2.
+    size_t newSize = std::max(InitialQueueSize, arraySize * 2);
+
+    // Allocate the new array.
+    std::unique_ptr<SpriteInfo[]> newArray(new SpriteInfo[newSize]);
+
+    // Copy over any existing sprites.
+    for (size_t i = 0; i < count; i++)
+    {
+        newArray[i] = spriteArray[i];
+    }
+
+    // Replace the previous array with the new one.
+    spriteArray = std::move(newArray);
+    arraySize = newSize;
+}
+
+
+// Takes the sprites from a recorder, to be merged at End. The recorder is left empty and can be reused at once.
+_Use_decl_annotations_
+void SpriteBatch::Impl::Submit(Recorder::Impl* recorder)
+{
+    if (!recorder)
+        throw std::exception("Recorder has been moved from");
+
+    if (!mInBeginEndPair)
+        throw std::exception("Begin must be called before Submit");
 
     if (mSortMode == SpriteSortMode_Immediate)
+        throw std::exception("Recorders cannot be submitted when using SpriteSortMode_Immediate");
+
+    size_t count = recorder->mSpriteQueueCount;
+
+    while (mRecordedSpriteArraySize < mRecordedSpriteCount + count)
     {
-        // If we are in immediate mode, draw this sprite straight away.
-        RenderBatch(texture, &sprite, 1);
+        GrowSpriteArray(mRecordedSprites, mRecordedSpriteCount, mRecordedSpriteArraySize);
     }
-    else
+
+    RecordedRange range = { recorder->mOrder, mRecordedSpriteCount, count };
+    mRecordedRanges.push_back(range);
+
+    for (size_t i = 0; i < count; i++)
     {
-        // Queue this sprite for later sorting and batched rendering.
-        mSpriteQueueCount++;
+        mRecordedSprites[mRecordedSpriteCount++] = recorder->mSpriteQueue[i];
+    }
 
-        // Make sure we hold a refcount on this texture until the sprite has been drawn. Only checking the
-        // back of the vector means we will add duplicate references if the caller switches back and forth
-        // between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
-        // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
-        if (mSpriteTextureReferences.empty() || texture != mSpriteTextureReferences.back().Get())
+    // Take over the recorder's texture references; they must stay alive until the sprites are drawn.
+    mSpriteTextureReferences.insert(mSpriteTextureReferences.end(),
+        std::make_move_iterator(recorder->mSpriteTextureReferences.begin()),
+        std::make_move_iterator(recorder->mSpriteTextureReferences.end()));
+
+    recorder->Clear();
+}
+
+
+// Appends the sprites taken from all submitted recorders to the queue.
+void SpriteBatch::Impl::MergeRecordedSprites()
+{
+    if (mRecordedRanges.empty())
+        return;
+
+    // Merge order depends only on each recorder's order value and submission order, never on thread timing.
+    std::stable_sort(mRecordedRanges.begin(), mRecordedRanges.end(), [](RecordedRange const& x, RecordedRange const& y) -> bool
+    {
+        return x.order < y.order;
+    });
+
+    while (mSpriteQueueArraySize < mSpriteQueueCount + mRecordedSpriteCount)
+    {
+        GrowSpriteQueue();
+    }
+
+    for (auto it = mRecordedRanges.cbegin(); it != mRecordedRanges.cend(); ++it)
+    {
+        for (size_t i = 0; i < it->count; i++)
         {
-            mSpriteTextureReferences.emplace_back(texture);
+            mSpriteQueue[mSpriteQueueCount++] = mRecordedSprites[it->start + i];
         }
     }
+
+    mRecordedSpriteCount = 0;
+    mRecordedRanges.clear();
 }
 
 
-// Dynamically expands the array used to store pending sprite information.
-void SpriteBatch::Impl::GrowSpriteQueue()
+// Adds a single sprite to a recorder.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Impl::Draw(ID3D11ShaderResourceView* texture,
+    FXMVECTOR destination,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    FXMVECTOR originRotationDepth,
+    int flags)
 {
-    // Grow by a factor of 2.
-    size_t newSize = std::max(InitialQueueSize, mSpriteQueueArraySize * 2);
-
-    // Allocate the new array.
-    std::unique_ptr<SpriteInfo[]> newArray(new SpriteInfo[newSize]);
+    if (!texture)
+        throw std::exception("Texture cannot be null");
 
-    // Copy over any existing sprites.
-    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    if (mSpriteQueueCount >= mSpriteQueueArraySize)
     {
-        newArray[i] = mSpriteQueue[i];
+        SpriteBatch::Impl::GrowSpriteArray(mSpriteQueue, mSpriteQueueCount, mSpriteQueueArraySize);
     }
 
-    // Replace the previous array with the new one.
-    mSpriteQueue = std::move(newArray);
-    mSpriteQueueArraySize = newSize;
+    SpriteBatch::Impl::FillSpriteInfo(&mSpriteQueue[mSpriteQueueCount], texture, destination, sourceRectangle, color, originRotationDepth, flags);
 
-    // Clear any dangling SpriteInfo pointers left over from previous rendering.
-    mSortedSprites.clear();
+    mSpriteQueueCount++;
+
+    if (mSpriteTextureReferences.empty() || texture != mSpriteTextureReferences.back().Get())
+    {
+        mSpriteTextureReferences.emplace_back(texture);
+    }
 }
 
 
@@ -674,11 +1006,21 @@ void SpriteBatch::Impl::SortSprites()
         GrowSortedSprites();
     }
 
+    if (mSpriteQueueCount >= RadixSortThreshold
+        && (mSortMode == SpriteSortMode_Texture
+            || mSortMode == SpriteSortMode_BackToFront
+            || mSortMode == SpriteSortMode_FrontToBack))
+    {
+        RadixSortSprites();
+        return;
+    }
+
+    // These must be stable like the radix sort, so sprites with equal keys draw in the same order whatever the queue size.
     switch (mSortMode)
     {
         case SpriteSortMode_Texture:
             // Sort by texture.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            std::stable_sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
             {
                 return x->texture < y->texture;
             });
@@ -686,7 +1028,7 @@ void SpriteBatch::Impl::SortSprites()
 
         case SpriteSortMode_BackToFront:
             // Sort back to front.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            std::stable_sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
             {
                 return x->originRotationDepth.w > y->originRotationDepth.w;
             });
@@ -694,7 +1036,7 @@ void SpriteBatch::Impl::SortSprites()
 
         case SpriteSortMode_FrontToBack:
             // Sort front to back.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            std::stable_sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
             {
                 return x->originRotationDepth.w < y->originRotationDepth.w;
             });
@@ -706,6 +1048,102 @@ void SpriteBatch::Impl::SortSprites()
 }
 
 
+// Sorts the array of queued sprites using a stable LSD radix sort on packed keys.
+void SpriteBatch::Impl::RadixSortSprites()
+{
+    static const size_t RadixBits = 8;
+    static const size_t RadixBuckets = 1 << RadixBits;
+    static const size_t RadixPasses = sizeof(uint64_t) * 8 / RadixBits;
+
+    const size_t count = mSpriteQueueCount;
+
+    if (count > UINT32_MAX)
+        throw std::exception("Too many sprites to sort");
+
+    if (mSortEntries.size() < count)
+    {
+        mSortEntries.resize(count);
+        mSortScratch.resize(count);
+    }
+
+    // Build the keys, and histogram every digit position in the same pass.
+    uint32_t histogram[RadixPasses][RadixBuckets] = {};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        SpriteInfo const* sprite = mSortedSprites[i];
+
+        uint64_t key;
+
+        if (mSortMode == SpriteSortMode_Texture)
+        {
+            key = reinterpret_cast<uintptr_t>(sprite->texture);
+        }
+        else
+        {
+            // Map the float depth onto an unsigned integer with the same ordering (treating -0 as +0).
+            float depth = sprite->originRotationDepth.w;
+
+            uint32_t bits = 0;
+            if (depth != 0)
+            {
+                memcpy(&bits, &depth, sizeof(bits));
+            }
+
+            bits = (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+
+            if (mSortMode == SpriteSortMode_BackToFront)
+            {
+                bits = ~bits;
+            }
+
+            key = bits;
+        }
+
+        mSortEntries[i].key = key;
+        mSortEntries[i].sprite = sprite;
+
+        for (size_t pass = 0; pass < RadixPasses; pass++)
+        {
+            histogram[pass][(key >> (pass * RadixBits)) & (RadixBuckets - 1)]++;
+        }
+    }
+
+    SortEntry* src = mSortEntries.data();
+    SortEntry* dst = mSortScratch.data();
+
+    for (size_t pass = 0; pass < RadixPasses; pass++)
+    {
+        uint32_t* counts = histogram[pass];
+        size_t shift = pass * RadixBits;
+
+        // Skip digits that are the same for every sprite (e.g. the high bits of texture pointers).
+        if (counts[(src[0].key >> shift) & (RadixBuckets - 1)] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (size_t bucket = 0; bucket < RadixBuckets; bucket++)
+        {
+            uint32_t n = counts[bucket];
+            counts[bucket] = offset;
+            offset += n;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[counts[(src[i].key >> shift) & (RadixBuckets - 1)]++] = src[i];
+        }
+
+        std::swap(src, dst);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        mSortedSprites[i] = src[i].sprite;
+    }
+}
+
+
 // Populates the mSortedSprites vector with pointers to individual elements of the mSpriteQueue array.
 void SpriteBatch::Impl::GrowSortedSprites()
 {
@@ -774,14 +1212,9 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 #endif
 
         // Generate sprite vertex data.
-        for (size_t i = 0; i < batchSize; i++)
-        {
-            assert(i < count);
-            _Analysis_assume_(i < count);
-            RenderSprite(sprites[i], vertices, textureSize, inverseTextureSize);
-
-            vertices += VerticesPerSprite;
-        }
+        assert(batchSize <= count);
+        _Analysis_assume_(batchSize <= count);
+        RenderSprites(sprites, batchSize, vertices, textureSize, inverseTextureSize);
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
         deviceContext->IASetPlacementVertexBuffer(0, mContextResources->vertexBuffer.Get(), grfxMemory, sizeof(VertexPositionColorTexture));
@@ -921,6 +1354,163 @@ void XM_CALLCONV SpriteBatch::Impl::RenderSprite(SpriteInfo const* sprite,
 }
 
 
+// Generates vertex data for a run of sprites, four at a time.
+//
+// This computes exactly what RenderSprite does, but with each SIMD lane holding a different
+// sprite rather than a different vector component. The per-sprite parameters are transposed
+// into structure-of-arrays form, the rotations are evaluated with a single vector sin/cos, and
+// the results are transposed back so vertices are still written in order (the destination is
+// usually a write-combined mapped buffer). Any leftover sprites use the scalar RenderSprite.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::RenderSprites(SpriteInfo const* const* sprites,
+    size_t count,
+    VertexPositionColorTexture* vertices,
+    FXMVECTOR textureSize,
+    FXMVECTOR inverseTextureSize)
+{
+    static const size_t LaneCount = 4;
+
+    XMVECTOR textureWidth = XMVectorSplatX(textureSize);
+    XMVECTOR textureHeight = XMVectorSplatY(textureSize);
+    XMVECTOR inverseTextureWidth = XMVectorSplatX(inverseTextureSize);
+    XMVECTOR inverseTextureHeight = XMVectorSplatY(inverseTextureSize);
+
+    size_t i = 0;
+
+    for (; i + LaneCount <= count; i += LaneCount)
+    {
+        SpriteInfo const* s0 = sprites[i];
+        SpriteInfo const* s1 = sprites[i + 1];
+        SpriteInfo const* s2 = sprites[i + 2];
+        SpriteInfo const* s3 = sprites[i + 3];
+
+        // Transpose sprite parameters so each vector holds one field of all four sprites.
+        XMMATRIX source = XMMatrixTranspose(XMMATRIX(XMLoadFloat4A(&s0->source),
+                                                     XMLoadFloat4A(&s1->source),
+                                                     XMLoadFloat4A(&s2->source),
+                                                     XMLoadFloat4A(&s3->source)));
+
+        XMMATRIX destination = XMMatrixTranspose(XMMATRIX(XMLoadFloat4A(&s0->destination),
+                                                          XMLoadFloat4A(&s1->destination),
+                                                          XMLoadFloat4A(&s2->destination),
+                                                          XMLoadFloat4A(&s3->destination)));
+
+        XMMATRIX originRotationDepth = XMMatrixTranspose(XMMATRIX(XMLoadFloat4A(&s0->originRotationDepth),
+                                                                  XMLoadFloat4A(&s1->originRotationDepth),
+                                                                  XMLoadFloat4A(&s2->originRotationDepth),
+                                                                  XMLoadFloat4A(&s3->originRotationDepth)));
+
+        // Expand the per-sprite flags into lane masks.
+        XMVECTOR flags = XMVectorSetInt(static_cast<uint32_t>(s0->flags),
+                                        static_cast<uint32_t>(s1->flags),
+                                        static_cast<uint32_t>(s2->flags),
+                                        static_cast<uint32_t>(s3->flags));
+
+        XMVECTOR sourceInTexels = XMVectorNotEqualInt(XMVectorAndInt(flags, XMVectorReplicateInt(SpriteInfo::SourceInTexels)), XMVectorZero());
+        XMVECTOR destSizeInPixels = XMVectorNotEqualInt(XMVectorAndInt(flags, XMVectorReplicateInt(SpriteInfo::DestSizeInPixels)), XMVectorZero());
+        XMVECTOR flipHorizontally = XMVectorNotEqualInt(XMVectorAndInt(flags, XMVectorReplicateInt(SpriteEffects_FlipHorizontally)), XMVectorZero());
+        XMVECTOR flipVertically = XMVectorNotEqualInt(XMVectorAndInt(flags, XMVectorReplicateInt(SpriteEffects_FlipVertically)), XMVectorZero());
+
+        XMVECTOR sourceX = source.r[0];
+        XMVECTOR sourceY = source.r[1];
+        XMVECTOR sourceWidth = source.r[2];
+        XMVECTOR sourceHeight = source.r[3];
+
+        // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+        XMVECTOR originX = XMVectorDivide(originRotationDepth.r[0],
+            XMVectorSelect(sourceWidth, g_XMEpsilon, XMVectorEqual(sourceWidth, XMVectorZero())));
+        XMVECTOR originY = XMVectorDivide(originRotationDepth.r[1],
+            XMVectorSelect(sourceHeight, g_XMEpsilon, XMVectorEqual(sourceHeight, XMVectorZero())));
+
+        // Convert the source region from texels to mod-1 texture coordinate format.
+        sourceX = XMVectorSelect(sourceX, sourceX * inverseTextureWidth, sourceInTexels);
+        sourceY = XMVectorSelect(sourceY, sourceY * inverseTextureHeight, sourceInTexels);
+        sourceWidth = XMVectorSelect(sourceWidth, sourceWidth * inverseTextureWidth, sourceInTexels);
+        sourceHeight = XMVectorSelect(sourceHeight, sourceHeight * inverseTextureHeight, sourceInTexels);
+
+        originX = XMVectorSelect(originX * inverseTextureWidth, originX, sourceInTexels);
+        originY = XMVectorSelect(originY * inverseTextureHeight, originY, sourceInTexels);
+
+        // If the destination size is relative to the source region, convert it to pixels.
+        XMVECTOR destinationWidth = XMVectorSelect(destination.r[2] * textureWidth, destination.r[2], destSizeInPixels);
+        XMVECTOR destinationHeight = XMVectorSelect(destination.r[3] * textureHeight, destination.r[3], destSizeInPixels);
+
+        // Compute all four 2x2 rotation matrices at once, keeping unrotated sprites exact.
+        XMVECTOR rotation = originRotationDepth.r[2];
+        XMVECTOR sinV, cosV;
+        XMVectorSinCos(&sinV, &cosV, rotation);
+
+        XMVECTOR isUnrotated = XMVectorEqual(rotation, XMVectorZero());
+        sinV = XMVectorSelect(sinV, XMVectorZero(), isUnrotated);
+        cosV = XMVectorSelect(cosV, g_XMOne, isUnrotated);
+
+        XMVECTOR depth = originRotationDepth.r[3];
+
+        // Texture coordinates for the left/right and top/bottom edges, swapped when mirrored.
+        XMVECTOR u0 = sourceX;
+        XMVECTOR u1 = sourceX + sourceWidth;
+        XMVECTOR v0 = sourceY;
+        XMVECTOR v1 = sourceY + sourceHeight;
+
+        XMVECTOR texLeft = XMVectorSelect(u0, u1, flipHorizontally);
+        XMVECTOR texRight = XMVectorSelect(u1, u0, flipHorizontally);
+        XMVECTOR texTop = XMVectorSelect(v0, v1, flipVertically);
+        XMVECTOR texBottom = XMVectorSelect(v1, v0, flipVertically);
+
+        // Corner offsets relative to the origin, for the unit-square corners 0 and 1 on each axis.
+        XMVECTOR offsetX0 = XMVectorNegate(originX) * destinationWidth;
+        XMVECTOR offsetX1 = (g_XMOne - originX) * destinationWidth;
+        XMVECTOR offsetY0 = XMVectorNegate(originY) * destinationHeight;
+        XMVECTOR offsetY1 = (g_XMOne - originY) * destinationHeight;
+
+        XMVECTOR offsetX[2] = { offsetX0, offsetX1 };
+        XMVECTOR offsetY[2] = { offsetY0, offsetY1 };
+        XMVECTOR texU[2] = { texLeft, texRight };
+        XMVECTOR texV[2] = { texTop, texBottom };
+
+        // Build the four corners (same order as cornerOffsets in RenderSprite), then transpose back to one vector per sprite.
+        XMMATRIX positions[VerticesPerSprite];
+        XMMATRIX textureCoordinates[VerticesPerSprite];
+
+        for (size_t corner = 0; corner < VerticesPerSprite; corner++)
+        {
+            XMVECTOR cornerX = offsetX[corner & 1];
+            XMVECTOR cornerY = offsetY[corner >> 1];
+
+            XMVECTOR positionX = XMVectorMultiplyAdd(cornerX, cosV, XMVectorNegativeMultiplySubtract(cornerY, sinV, destination.r[0]));
+            XMVECTOR positionY = XMVectorMultiplyAdd(cornerX, sinV, XMVectorMultiplyAdd(cornerY, cosV, destination.r[1]));
+
+            positions[corner] = XMMatrixTranspose(XMMATRIX(positionX, positionY, depth, rotation));
+            textureCoordinates[corner] = XMMatrixTranspose(XMMATRIX(texU[corner & 1], texV[corner >> 1], XMVectorZero(), XMVectorZero()));
+        }
+
+        // Write the output vertices in memory order.
+        for (size_t lane = 0; lane < LaneCount; lane++)
+        {
+            XMVECTOR color = XMLoadFloat4A(&sprites[i + lane]->color);
+
+            for (size_t corner = 0; corner < VerticesPerSprite; corner++)
+            {
+                // As in RenderSprite, the Float4 position store is immediately followed by the color store it clobbers.
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices->position), positions[corner].r[lane]);
+                XMStoreFloat4(&vertices->color, color);
+                XMStoreFloat2(&vertices->textureCoordinate, textureCoordinates[corner].r[lane]);
+
+                vertices++;
+            }
+        }
+    }
+
+    // Handle any remaining sprites one at a time.
+    for (; i < count; i++)
+    {
+        RenderSprite(sprites[i], vertices, textureSize, inverseTextureSize);
+
+        vertices += VerticesPerSprite;
+    }
+}
+
+
 // Helper looks up the size of the specified texture.
 XMVECTOR SpriteBatch::Impl::GetTextureSize(_In_ ID3D11ShaderResourceView* texture)
 {
@@ -1059,9 +1649,7 @@ void SpriteBatch::End()
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
 {
-    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), g_XMOne); // x, y, 1, 1
-    
-    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+    Impl::Queue(*pImpl, texture, position, color);
 }
 
 
@@ -1076,11 +1664,7 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(XMLoadFloat2(&position), XMLoadFloat(&scale)); // x, y, scale, scale
-    
-    XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
-
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
@@ -1095,20 +1679,14 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), XMLoadFloat2(&scale)); // x, y, scale.x, scale.y
-    
-    XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
-    
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color)
 {
-    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, g_XMOne); // x, y, 1, 1
-    
-    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+    Impl::Queue(*pImpl, texture, position, color);
 }
 
 
@@ -1123,13 +1701,7 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(position, XMLoadFloat(&scale)); // x, y, scale, scale
-
-    XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
-
-    XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
-    
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
@@ -1144,22 +1716,14 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, scale); // x, y, scale.x, scale.y
-    
-    XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
-
-    XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
-
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+    Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color)
 {
-    XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
-
-    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, Impl::SpriteInfo::DestSizeInPixels);
+    Impl::Queue(*pImpl, texture, destinationRectangle, color);
 }
 
 
@@ -1173,11 +1737,7 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
-
-    XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
-    
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects | Impl::SpriteInfo::DestSizeInPixels);
+    Impl::Queue(*pImpl, texture, destinationRectangle, sourceRectangle, color, rotation, origin, effects, layerDepth);
 }
 
 
@@ -1198,3 +1758,160 @@ void SpriteBatch::SetViewport( const D3D11_VIEWPORT& viewPort )
     pImpl->mSetViewport = true;
     pImpl->mViewPort = viewPort;
 }
+
+
+void SpriteBatch::Submit(Recorder& recorder)
+{
+    pImpl->Submit(recorder.pImpl.get());
+}
+
+
+//--------------------------------------------------------------------------------------
+// SpriteBatch::Recorder
+//--------------------------------------------------------------------------------------
+
+// Public constructor.
+SpriteBatch::Recorder::Recorder(uint32_t order)
+  : pImpl(new Impl(order))
+{
+}
+
+
+// Move constructor.
+SpriteBatch::Recorder::Recorder(Recorder&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+SpriteBatch::Recorder& SpriteBatch::Recorder::operator= (Recorder&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+SpriteBatch::Recorder::~Recorder()
+{
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, position, color);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    XMFLOAT2 const& position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    float scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    XMFLOAT2 const& position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    XMFLOAT2 const& scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, position, color);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    FXMVECTOR position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR origin,
+    float scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    FXMVECTOR position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR origin,
+    GXMVECTOR scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, destinationRectangle, color);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    RECT const& destinationRectangle,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    SpriteBatch::Impl::Queue(*pImpl, texture, destinationRectangle, sourceRectangle, color, rotation, origin, effects, layerDepth);
+}
+
+
+void SpriteBatch::Recorder::Clear()
+{
+    pImpl->Clear();
+}
+
+
+size_t SpriteBatch::Recorder::GetCount() const
+{
+    return pImpl->mSpriteQueueCount;
+}
+
+
+uint32_t SpriteBatch::Recorder::GetOrder() const
+{
+    return pImpl->mOrder;
+}
+
+
+void SpriteBatch::Recorder::SetOrder(uint32_t order)
+{
+    pImpl->mOrder = order;
+}
@@ -14,6 +14,8 @@
 #include "pch.h"
 
 #include <algorithm>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "SpriteFont.h"
@@ -32,12 +34,35 @@ public:
     Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, bool forceSRGB);
     Impl(_In_ ID3D11ShaderResourceView* texture, _In_reads_(glyphCount) Glyph const* glyphs, _In_ size_t glyphCount, _In_ float lineSpacing);
 
-    Glyph const* FindGlyph(wchar_t character) const;
+    Glyph const* FindGlyph(uint32_t character) const;
+    Glyph const* LookupGlyph(uint32_t character) const;
 
-    void SetDefaultCharacter(wchar_t character);
+    void SetDefaultCharacter(uint32_t character);
 
-    template<typename TAction>
-    void ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const;
+    template<typename TChar, typename TAction>
+    void ForEachGlyph(_In_z_ TChar const* text, TAction action) const;
+
+    template<typename TChar, typename TAction>
+    void ForEachCachedGlyph(_In_z_ TChar const* text, TAction action) const;
+
+    // Shared by the UTF-16 (wchar_t) and UTF-8 (char) public overloads.
+    template<typename TChar>
+    void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ TChar const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const;
+
+    template<typename TChar>
+    XMVECTOR MeasureString(_In_z_ TChar const* text) const;
+
+    template<typename TChar>
+    RECT MeasureDrawBounds(_In_z_ TChar const* text, XMFLOAT2 const& position) const;
+
+    template<typename TChar>
+    void LayoutText(_In_z_ TChar const* text, float maxWidth, TextAlignment alignment, TextLayout& layout) const;
+
+    void AlignLayout(TextLayout& layout) const;
+
+    void BuildGlyphTable();
+    void SetLayoutCacheSize(size_t maxEntries);
+    void ClearLayoutCache() const;
 
 
     // Fields.
@@ -45,6 +70,45 @@ public:
     std::vector<Glyph> glyphs;
     Glyph const* defaultGlyph;
     float lineSpacing;
+
+
+    // Densely populated runs of the Basic Multilingual Plane are looked up by direct index into
+    // glyphTable; anything outside these runs falls back to a binary search of the glyphs vector.
+    struct GlyphRange
+    {
+        uint32_t first;
+        uint32_t last;
+        size_t tableOffset;
+    };
+
+    static const uint32_t NoGlyph = uint32_t(-1);
+
+    std::vector<GlyphRange> glyphRanges;
+    std::vector<uint32_t> glyphTable;
+
+
+    // Optional most-recently-used cache of ForEachGlyph results, keyed on the string contents.
+    struct CachedGlyph
+    {
+        Glyph const* glyph;
+        float x;
+        float y;
+        float advance;
+    };
+
+    struct CachedLayout
+    {
+        size_t hash;
+        size_t charSize;
+        std::string text;
+        std::vector<CachedGlyph> glyphs;
+    };
+
+    typedef std::list<CachedLayout> LayoutList;
+
+    size_t layoutCacheSize;
+    mutable LayoutList layoutCache;
+    mutable std::unordered_map<size_t, LayoutList::iterator> layoutCacheIndex;
 };
 
 
@@ -54,29 +118,100 @@ const XMFLOAT2 SpriteFont::Float2Zero(0, 0);
 static const char spriteFontMagic[] = "DXTKfont";
 
 
-// Comparison operators make our sorted glyph vector work with std::binary_search and lower_bound.
-namespace DirectX
+namespace
 {
-    static inline bool operator< (SpriteFont::Glyph const& left, SpriteFont::Glyph const& right)
+    const uint32_t ReplacementCharacter = 0xFFFD;
+
+    // Decodes one codepoint from a null-terminated UTF-16 string, advancing past it. Unpaired
+    // surrogates are returned unchanged, so they resolve to the default glyph like any other
+    // character missing from the font.
+    inline uint32_t DecodeCodepoint(_Inout_ _In_z_ wchar_t const*& text)
     {
-        return left.Character < right.Character;
+        uint32_t c = static_cast<uint32_t>(*text++);
+
+        if (c >= 0xD800 && c <= 0xDBFF)
+        {
+            uint32_t low = static_cast<uint32_t>(*text);
+
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                text++;
+                return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            }
+        }
+
+        return c;
     }
 
-    static inline bool operator< (wchar_t left, SpriteFont::Glyph const& right)
+
+    // Decodes one codepoint from a null-terminated UTF-8 string, advancing past it. Malformed,
+    // overlong, or truncated sequences decode as U+FFFD without reading past the terminator.
+    inline uint32_t DecodeCodepoint(_Inout_ _In_z_ char const*& text)
     {
-        return left < right.Character;
+        uint32_t c = static_cast<uint8_t>(*text++);
+
+        if (c < 0x80)
+            return c;
+
+        size_t trailing;
+        uint32_t minimum;
+
+        if (c >= 0xC2 && c <= 0xDF)
+        {
+            trailing = 1;
+            minimum = 0x80;
+            c &= 0x1F;
+        }
+        else if (c >= 0xE0 && c <= 0xEF)
+        {
+            trailing = 2;
+            minimum = 0x800;
+            c &= 0x0F;
+        }
+        else if (c >= 0xF0 && c <= 0xF4)
+        {
+            trailing = 3;
+            minimum = 0x10000;
+            c &= 0x07;
+        }
+        else
+        {
+            return ReplacementCharacter;
+        }
+
+        for (; trailing > 0; trailing--)
+        {
+            uint32_t next = static_cast<uint8_t>(*text);
+
+            if ((next & 0xC0) != 0x80)
+                return ReplacementCharacter;
+
+            c = (c << 6) | (next & 0x3F);
+            text++;
+        }
+
+        if (c < minimum || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+            return ReplacementCharacter;
+
+        return c;
     }
+}
+
 
-    static inline bool operator< (SpriteFont::Glyph const& left, wchar_t right)
+// Comparison operator lets us validate the glyph vector is sorted with std::is_sorted.
+namespace DirectX
+{
+    static inline bool operator< (SpriteFont::Glyph const& left, SpriteFont::Glyph const& right)
     {
-        return left.Character < right;
+        return left.Character < right.Character;
     }
 }
 
 
 // Reads a SpriteFont from the binary format created by the MakeSpriteFont utility.
 SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, bool forceSRGB) :
-    defaultGlyph(nullptr)
+    defaultGlyph(nullptr),
+    layoutCacheSize(0)
 {
     // Validate the header.
     for (char const* magic = spriteFontMagic; *magic; magic++)
@@ -94,10 +229,12 @@ SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, boo
 
     glyphs.assign(glyphData, glyphData + glyphCount);
 
+    BuildGlyphTable();
+
     // Read font properties.
     lineSpacing = reader->Read<float>();
 
-    SetDefaultCharacter((wchar_t)reader->Read<uint32_t>());
+    SetDefaultCharacter(reader->Read<uint32_t>());
 
     // Read the texture data.
     auto textureWidth = reader->Read<uint32_t>();
@@ -137,38 +274,134 @@ SpriteFont::Impl::Impl(ID3D11ShaderResourceView* texture, Glyph const* glyphs, s
   : texture(texture),
     glyphs(glyphs, glyphs + glyphCount),
     defaultGlyph(nullptr),
-    lineSpacing(lineSpacing)
+    lineSpacing(lineSpacing),
+    layoutCacheSize(0)
 {
     if (!std::is_sorted(glyphs, glyphs + glyphCount))
     {
         throw std::exception("Glyphs must be in ascending codepoint order");
     }
+
+    BuildGlyphTable();
 }
 
 
-// Looks up the requested glyph, falling back to the default character if it is not in the font.
-SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
+// Builds direct lookup tables for the densely populated character ranges of the font.
+void SpriteFont::Impl::BuildGlyphTable()
+{
+    // Glyphs closer together than this are considered part of the same range.
+    static const uint32_t MaxRangeGap = 32;
+
+    // Ranges smaller than this, or less than half populated, are left to the binary search.
+    static const size_t MinRangeGlyphs = 16;
+
+    static const size_t MaxRanges = 8;
+
+    glyphRanges.clear();
+    glyphTable.clear();
+
+    size_t i = 0;
+
+    while (i < glyphs.size() && glyphRanges.size() < MaxRanges)
+    {
+        uint32_t first = glyphs[i].Character;
+
+        if (first > 0xFFFF)
+            break;
+
+        size_t j = i + 1;
+
+        while (j < glyphs.size()
+               && glyphs[j].Character <= 0xFFFF
+               && glyphs[j].Character - glyphs[j - 1].Character <= MaxRangeGap)
+        {
+            j++;
+        }
+
+        uint32_t last = glyphs[j - 1].Character;
+        size_t count = j - i;
+        size_t span = size_t(last - first) + 1;
+
+        if (count >= MinRangeGlyphs && count * 2 >= span)
+        {
+            GlyphRange range = { first, last, glyphTable.size() };
+
+            glyphTable.resize(glyphTable.size() + span, uint32_t(NoGlyph));
+
+            for (size_t k = i; k < j; k++)
+            {
+                uint32_t& entry = glyphTable[range.tableOffset + glyphs[k].Character - first];
+
+                // Match lower_bound behavior if a character appears more than once.
+                if (entry == NoGlyph)
+                {
+                    entry = static_cast<uint32_t>(k);
+                }
+            }
+
+            glyphRanges.push_back(range);
+        }
+
+        i = j;
+    }
+}
+
+
+// Looks up the requested glyph, returning null if it is not in the font.
+SpriteFont::Glyph const* SpriteFont::Impl::LookupGlyph(uint32_t character) const
 {
-    auto glyph = std::lower_bound(glyphs.begin(), glyphs.end(), character);
+    for (auto it = glyphRanges.cbegin(); it != glyphRanges.cend(); ++it)
+    {
+        if (character < it->first)
+            break;
+
+        if (character <= it->last)
+        {
+            uint32_t index = glyphTable[it->tableOffset + character - it->first];
+
+            return (index != NoGlyph) ? &glyphs[index] : nullptr;
+        }
+    }
+
+    auto glyph = std::lower_bound(glyphs.begin(), glyphs.end(), character, [](Glyph const& left, uint32_t right) -> bool
+    {
+        return left.Character < right;
+    });
 
     if (glyph != glyphs.end() && glyph->Character == character)
     {
         return &*glyph;
     }
 
+    return nullptr;
+}
+
+
+// Looks up the requested glyph, falling back to the default character if it is not in the font.
+SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(uint32_t character) const
+{
+    auto glyph = LookupGlyph(character);
+
+    if (glyph)
+    {
+        return glyph;
+    }
+
     if (defaultGlyph)
     {
         return defaultGlyph;
     }
 
-    DebugTrace( "SpriteFont encountered a character not in the font (%u, %C), and no default glyph was provided\n", character, character );
+    DebugTrace( "SpriteFont encountered a character not in the font (U+%04X), and no default glyph was provided\n", character );
     throw std::exception("Character not in font");
 }
 
 
 // Sets the missing-character fallback glyph.
-void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
+void SpriteFont::Impl::SetDefaultCharacter(uint32_t character)
 {
+    ClearLayoutCache();
+
     defaultGlyph = nullptr;
 
     if (character)
@@ -179,15 +412,15 @@ void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
 
 
 // The core glyph layout algorithm, shared between DrawString and MeasureString.
-template<typename TAction>
-void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const
+template<typename TChar, typename TAction>
+void SpriteFont::Impl::ForEachGlyph(_In_z_ TChar const* text, TAction action) const
 {
     float x = 0;
     float y = 0;
 
-    for (; *text; text++)
+    while (*text)
     {
-        wchar_t character = *text;
+        uint32_t character = DecodeCodepoint(text);
 
         switch (character)
         {
@@ -212,7 +445,8 @@ void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action)
 
                 float advance = glyph->Subrect.right - glyph->Subrect.left + glyph->XAdvance;
 
-                if ( !iswspace(character)
+                if ( character > 0xFFFF
+                     || !iswspace(static_cast<wint_t>(character))
                      || ( ( glyph->Subrect.right - glyph->Subrect.left ) > 1 )
                      || ( ( glyph->Subrect.bottom - glyph->Subrect.top ) > 1 ) )
                 {
@@ -226,6 +460,97 @@ void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action)
 }
 
 
+// Runs ForEachGlyph through the layout cache, if enabled.
+template<typename TChar, typename TAction>
+void SpriteFont::Impl::ForEachCachedGlyph(_In_z_ TChar const* text, TAction action) const
+{
+    if (!layoutCacheSize)
+    {
+        ForEachGlyph(text, action);
+        return;
+    }
+
+    // FNV-1a hash of the string code units, which also gives us its length.
+    size_t hash = 2166136261u ^ sizeof(TChar);
+    size_t length = 0;
+    for (; text[length]; length++)
+    {
+        hash = (hash ^ size_t(text[length])) * 16777619u;
+    }
+
+    const size_t bytes = length * sizeof(TChar);
+
+    auto index = layoutCacheIndex.find(hash);
+    if (index != layoutCacheIndex.end())
+    {
+        auto layout = index->second;
+
+        if (layout->charSize == sizeof(TChar)
+            && layout->text.size() == bytes
+            && memcmp(layout->text.data(), text, bytes) == 0)
+        {
+            // Move to the front of the most-recently-used list.
+            layoutCache.splice(layoutCache.begin(), layoutCache, layout);
+
+            for (auto it = layout->glyphs.cbegin(); it != layout->glyphs.cend(); ++it)
+            {
+                action(it->glyph, it->x, it->y, it->advance);
+            }
+            return;
+        }
+
+        // Hash collision with a different string; leave the existing entry alone.
+        ForEachGlyph(text, action);
+        return;
+    }
+
+    // Lay the text out before touching the cache, so nothing is cached if ForEachGlyph throws.
+    CachedLayout layout;
+    layout.hash = hash;
+    layout.charSize = sizeof(TChar);
+    layout.text.assign(reinterpret_cast<char const*>(text), bytes);
+
+    ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
+    {
+        CachedGlyph cached = { glyph, x, y, advance };
+        layout.glyphs.push_back(cached);
+    });
+
+    // Replace the least recently used entry once the cache is full.
+    if (layoutCache.size() >= layoutCacheSize)
+    {
+        layoutCacheIndex.erase(layoutCache.back().hash);
+        layoutCache.pop_back();
+    }
+
+    layoutCache.push_front(std::move(layout));
+
+    layoutCacheIndex[hash] = layoutCache.begin();
+
+    auto& cachedLayout = layoutCache.front();
+    for (auto it = cachedLayout.glyphs.cbegin(); it != cachedLayout.glyphs.cend(); ++it)
+    {
+        action(it->glyph, it->x, it->y, it->advance);
+    }
+}
+
+
+// Enables (or disables, with a size of zero) the layout cache.
+void SpriteFont::Impl::SetLayoutCacheSize(size_t maxEntries)
+{
+    layoutCacheSize = maxEntries;
+
+    ClearLayoutCache();
+}
+
+
+void SpriteFont::Impl::ClearLayoutCache() const
+{
+    layoutCache.clear();
+    layoutCacheIndex.clear();
+}
+
+
 // Construct from a binary file created by the MakeSpriteFont utility.
 SpriteFont::SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB)
 {
@@ -274,25 +599,9 @@ SpriteFont::~SpriteFont()
 }
 
 
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
-{
-    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
-}
-
-
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
-{
-    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
-}
-
-
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
-{
-    DrawString(spriteBatch, text, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
-}
-
-
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+// Draws a string by emitting one sprite per glyph.
+template<typename TChar>
+void XM_CALLCONV SpriteFont::Impl::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ TChar const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
 {
     static_assert(SpriteEffects_FlipHorizontally == 1 &&
                   SpriteEffects_FlipVertically == 2, "If you change these enum values, the following tables must be updated to match");
@@ -324,7 +633,7 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
     }
 
     // Draw each character in turn.
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
+    ForEachCachedGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
     {
         UNREFERENCED_PARAMETER(advance);
 
@@ -341,23 +650,25 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
             offset = XMVectorMultiplyAdd(glyphRect, axisIsMirroredTable[effects & 3], offset);
         }
 
-        spriteBatch->Draw(pImpl->texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
+        spriteBatch->Draw(texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
     });
 }
 
 
-XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text) const
+// Measures the size of a string, in pixels.
+template<typename TChar>
+XMVECTOR SpriteFont::Impl::MeasureString(_In_z_ TChar const* text) const
 {
     XMVECTOR result = XMVectorZero();
 
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
+    ForEachCachedGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
     {
         UNREFERENCED_PARAMETER(advance);
 
         float w = (float)(glyph->Subrect.right - glyph->Subrect.left);
         float h = (float)(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
 
-        h = std::max(h, pImpl->lineSpacing);
+        h = std::max(h, lineSpacing);
 
         result = XMVectorMax(result, XMVectorSet(x + w, y + h, 0, 0));
     });
@@ -366,11 +677,13 @@ XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text) const
 }
 
 
-RECT SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position) const
+// Measures the pixel bounds of a string as it would be drawn at the given position.
+template<typename TChar>
+RECT SpriteFont::Impl::MeasureDrawBounds(_In_z_ TChar const* text, XMFLOAT2 const& position) const
 {
     RECT result = { LONG_MAX, LONG_MAX, 0, 0 };
 
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
+    ForEachCachedGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
     {
         float w = (float)(glyph->Subrect.right - glyph->Subrect.left);
         float h = (float)(glyph->Subrect.bottom - glyph->Subrect.top);
@@ -403,6 +716,306 @@ RECT SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& p
     return result;
 }
 
+// Lays out a paragraph with word wrapping. Lines are broken greedily in a single pass: when a character
+// would cross maxWidth, the partial word following the last whitespace is laid out again on a new line
+// (or, if the line has no whitespace, the break goes between characters). Every line starts from a fresh
+// pen position, so a previous layout is kept up to the line before the first changed character, and the
+// text is only decoded and looked up in the font from the first changed code unit onward.
+template<typename TChar>
+void SpriteFont::Impl::LayoutText(_In_z_ TChar const* text, float maxWidth, TextAlignment alignment, TextLayout& layout) const
+{
+    typedef typename std::make_unsigned<TChar>::type TUnit;
+
+    auto& source = layout.mSource;
+    auto& codepoints = layout.mText;
+    auto& offsets = layout.mTextOffsets;
+    auto& textGlyphs = layout.mTextGlyphs;
+    auto& lines = layout.lines;
+    auto& placed = layout.glyphs;
+
+    const bool sameFont = layout.mFont == this
+                          && layout.mDefaultGlyph == defaultGlyph
+                          && layout.mCharSize == sizeof(TChar);
+
+    // Find the first code unit that differs from the previous text.
+    size_t changedUnit = 0;
+
+    if (sameFont)
+    {
+        while (changedUnit < source.size() && text[changedUnit] && static_cast<TUnit>(text[changedUnit]) == source[changedUnit])
+            changedUnit++;
+    }
+
+    size_t length = changedUnit;
+    while (text[length])
+        length++;
+
+    if (sameFont && changedUnit == source.size() && length == source.size()
+        && layout.mMaxWidth == maxWidth && layout.mLineSpacing == lineSpacing && !lines.empty())
+    {
+        if (layout.mAlignment != alignment)
+        {
+            layout.mAlignment = alignment;
+            AlignLayout(layout);
+        }
+        return;
+    }
+
+    if (length >= UINT32_MAX)
+        throw std::exception("Text too long");
+
+    // Decode again from the codepoint holding the first change. The one before it is redone as well, as an
+    // unpaired surrogate or truncated UTF-8 sequence may now combine with what follows.
+    size_t changed = 0;
+
+    if (sameFont && !offsets.empty())
+    {
+        changed = size_t(std::upper_bound(offsets.begin(), offsets.end(), uint32_t(changedUnit)) - offsets.begin());
+        changed = (changed > 1) ? changed - 2 : 0;
+    }
+
+    try
+    {
+        size_t restartUnit = (changed < offsets.size()) ? offsets[changed] : 0;
+
+        source.resize(length);
+        for (size_t j = changedUnit; j < length; j++)
+        {
+            source[j] = static_cast<TUnit>(text[j]);
+        }
+
+        codepoints.resize(changed);
+        offsets.resize(changed);
+        textGlyphs.resize(changed);
+
+        TChar const* next = text + restartUnit;
+        while (*next)
+        {
+            offsets.push_back(static_cast<uint32_t>(next - text));
+
+            uint32_t character = DecodeCodepoint(next);
+            codepoints.push_back(character);
+            textGlyphs.push_back((character == '\r' || character == '\n') ? nullptr : FindGlyph(character));
+        }
+    }
+    catch (...)
+    {
+        layout.Clear();
+        throw;
+    }
+
+    size_t restartLine = 0;
+
+    if (sameFont && layout.mMaxWidth == maxWidth && layout.mLineSpacing == lineSpacing && !lines.empty())
+    {
+        // Find the line holding the first change. The line before it is redone as well, because
+        // whether it wrapped depended on the width of the word that now starts the changed line.
+        size_t line = lines.size() - 1;
+
+        while (line > 0 && lines[line].textStart > changed)
+            line--;
+
+        restartLine = (line > 0) ? line - 1 : 0;
+    }
+
+    layout.mCharSize = sizeof(TChar);
+    layout.mFont = this;
+    layout.mDefaultGlyph = defaultGlyph;
+    layout.mMaxWidth = maxWidth;
+    layout.mLineSpacing = lineSpacing;
+    layout.mAlignment = alignment;
+
+    TextLayout::Line current = {};
+
+    if (restartLine < lines.size())
+    {
+        current.firstGlyph = lines[restartLine].firstGlyph;
+        current.textStart = lines[restartLine].textStart;
+    }
+
+    placed.resize(current.firstGlyph);
+    lines.resize(restartLine);
+
+    current.y = float(lines.size()) * lineSpacing;
+
+    const bool wrap = maxWidth > 0;
+
+    float x = 0;
+    float lineRight = 0;
+
+    // Most recent point on this line where a break is allowed (the start of the word after whitespace).
+    bool lineHasWord = false;
+    bool canBreak = false;
+    size_t breakGlyph = 0;
+    size_t breakText = 0;
+    float breakRight = 0;
+
+    auto finishLine = [&](size_t glyphEnd, size_t textEnd, float width)
+    {
+        current.glyphCount = glyphEnd - current.firstGlyph;
+        current.textEnd = textEnd;
+        current.width = width;
+
+        lines.push_back(current);
+
+        current.firstGlyph = glyphEnd;
+        current.textStart = textEnd;
+        current.y += lineSpacing;
+        x = 0;
+        lineRight = 0;
+        lineHasWord = false;
+        canBreak = false;
+    };
+
+    for (size_t i = current.textStart; i < codepoints.size(); i++)
+    {
+        uint32_t character = codepoints[i];
+
+        if (character == '\r')
+            continue;
+
+        if (character == '\n')
+        {
+            finishLine(placed.size(), i, lineRight);
+
+            current.textStart = i + 1;
+            continue;
+        }
+
+        auto glyph = textGlyphs[i];
+
+        // The same rule places the first glyph of every line, however the line was started.
+        float penX = std::max(x + glyph->XOffset, 0.f);
+
+        float width = float(glyph->Subrect.right - glyph->Subrect.left);
+        float advance = width + glyph->XAdvance;
+
+        bool isSpace = character <= 0xFFFF && iswspace(static_cast<wint_t>(character));
+
+        if (isSpace)
+        {
+            // Whitespace is allowed to hang past the wrap width.
+            if ( ( glyph->Subrect.right - glyph->Subrect.left ) > 1
+                 || ( glyph->Subrect.bottom - glyph->Subrect.top ) > 1 )
+            {
+                TextLayout::PlacedGlyph entry = { glyph, penX, i };
+                placed.push_back(entry);
+            }
+
+            x = penX + advance;
+
+            // Leading whitespace is not a break opportunity, or we would emit an empty line.
+            canBreak = lineHasWord;
+            breakGlyph = placed.size();
+            breakText = i + 1;
+            breakRight = lineRight;
+            continue;
+        }
+
+        if (wrap && lineHasWord && penX + width > maxWidth)
+        {
+            if (canBreak)
+            {
+                // Lay the partial word out again from the start of a new line.
+                placed.resize(breakGlyph);
+                finishLine(breakGlyph, breakText, breakRight);
+
+                i = breakText - 1;
+                continue;
+            }
+
+            // The word is wider than the line by itself.
+            finishLine(placed.size(), i, lineRight);
+
+            penX = std::max(glyph->XOffset, 0.f);
+        }
+
+        TextLayout::PlacedGlyph entry = { glyph, penX, i };
+        placed.push_back(entry);
+
+        lineRight = std::max(lineRight, penX + width);
+        lineHasWord = true;
+        x = penX + advance;
+    }
+
+    finishLine(placed.size(), codepoints.size(), lineRight);
+
+    AlignLayout(layout);
+}
+
+
+// Applies the horizontal alignment of each line and updates the overall size of a layout.
+void SpriteFont::Impl::AlignLayout(TextLayout& layout) const
+{
+    float widest = 0;
+
+    for (auto it = layout.lines.cbegin(); it != layout.lines.cend(); ++it)
+    {
+        widest = std::max(widest, it->width);
+    }
+
+    float boxWidth = (layout.mMaxWidth > 0) ? layout.mMaxWidth : widest;
+
+    float factor = 0;
+
+    switch (layout.mAlignment)
+    {
+        case TextAlignment_Center:
+            factor = 0.5f;
+            break;
+
+        case TextAlignment_Right:
+            factor = 1;
+            break;
+
+        default:
+            break;
+    }
+
+    for (auto it = layout.lines.begin(); it != layout.lines.end(); ++it)
+    {
+        it->x = std::max(0.f, (boxWidth - it->width) * factor);
+    }
+
+    layout.size = XMFLOAT2(widest, float(layout.lines.size()) * lineSpacing);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawString(spriteBatch, text, position, color, rotation, origin, scale, effects, layerDepth);
+}
+
+
+XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text) const
+{
+    return pImpl->MeasureString(text);
+}
+
+
+RECT SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position) const
+{
+    return pImpl->MeasureDrawBounds(text, position);
+}
+
 
 RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position) const
 {
@@ -413,6 +1026,52 @@ RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVE
 }
 
 
+// UTF-8 overloads
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawString(spriteBatch, text, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawString(spriteBatch, text, position, color, rotation, origin, scale, effects, layerDepth);
+}
+
+
+XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ char const* text) const
+{
+    return pImpl->MeasureString(text);
+}
+
+
+RECT SpriteFont::MeasureDrawBounds(_In_z_ char const* text, XMFLOAT2 const& position) const
+{
+    return pImpl->MeasureDrawBounds(text, position);
+}
+
+
+RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ char const* text, FXMVECTOR position) const
+{
+    XMFLOAT2 pos;
+    XMStoreFloat2(&pos, position);
+
+    return pImpl->MeasureDrawBounds(text, pos);
+}
+
+
 // Spacing properties
 float SpriteFont::GetLineSpacing() const
 {
@@ -423,6 +1082,7 @@ float SpriteFont::GetLineSpacing() const
 void SpriteFont::SetLineSpacing(float spacing)
 {
     pImpl->lineSpacing = spacing;
+    pImpl->ClearLayoutCache();
 }
 
 
@@ -433,15 +1093,33 @@ wchar_t SpriteFont::GetDefaultCharacter() const
 }
 
 
+uint32_t SpriteFont::GetDefaultCodepoint() const
+{
+    return pImpl->defaultGlyph ? pImpl->defaultGlyph->Character : 0;
+}
+
+
 void SpriteFont::SetDefaultCharacter(wchar_t character)
 {
     pImpl->SetDefaultCharacter(character);
 }
 
 
+void SpriteFont::SetDefaultCodepoint(uint32_t codepoint)
+{
+    pImpl->SetDefaultCharacter(codepoint);
+}
+
+
 bool SpriteFont::ContainsCharacter(wchar_t character) const
 {
-    return std::binary_search(pImpl->glyphs.begin(), pImpl->glyphs.end(), character);
+    return pImpl->LookupGlyph(character) != nullptr;
+}
+
+
+bool SpriteFont::ContainsCodepoint(uint32_t codepoint) const
+{
+    return pImpl->LookupGlyph(codepoint) != nullptr;
 }
 
 
@@ -452,6 +1130,12 @@ SpriteFont::Glyph const* SpriteFont::FindGlyph(wchar_t character) const
 }
 
 
+SpriteFont::Glyph const* SpriteFont::FindGlyphByCodepoint(uint32_t codepoint) const
+{
+    return pImpl->FindGlyph(codepoint);
+}
+
+
 void SpriteFont::GetSpriteSheet( ID3D11ShaderResourceView** texture ) const
 {
     if ( !texture )
@@ -459,3 +1143,79 @@ void SpriteFont::GetSpriteSheet( ID3D11ShaderResourceView** texture ) const
 
     ThrowIfFailed( pImpl->texture.CopyTo( texture ) );
 }
+
+
+// Layout cache
+void SpriteFont::SetLayoutCacheSize(size_t maxEntries)
+{
+    pImpl->SetLayoutCacheSize(maxEntries);
+}
+
+
+size_t SpriteFont::GetLayoutCacheSize() const
+{
+    return pImpl->layoutCacheSize;
+}
+
+
+// Paragraph layout
+SpriteFont::TextLayout::TextLayout()
+  : size(0, 0),
+    mCharSize(0),
+    mFont(nullptr),
+    mDefaultGlyph(nullptr),
+    mMaxWidth(0),
+    mLineSpacing(0),
+    mAlignment(TextAlignment_Left)
+{
+}
+
+
+void SpriteFont::TextLayout::Clear()
+{
+    lines.clear();
+    glyphs.clear();
+    size = XMFLOAT2(0, 0);
+    mSource.clear();
+    mText.clear();
+    mTextOffsets.clear();
+    mTextGlyphs.clear();
+    mCharSize = 0;
+    mFont = nullptr;
+}
+
+
+void SpriteFont::LayoutText(_In_z_ wchar_t const* text, float maxWidth, TextAlignment alignment, TextLayout& layout) const
+{
+    pImpl->LayoutText(text, maxWidth, alignment, layout);
+}
+
+
+void SpriteFont::LayoutText(_In_z_ char const* text, float maxWidth, TextAlignment alignment, TextLayout& layout) const
+{
+    pImpl->LayoutText(text, maxWidth, alignment, layout);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, float layerDepth) const
+{
+    if (layout.lines.empty())
+        return;
+
+    if (layout.mFont != pImpl.get())
+    {
+        throw std::exception("TextLayout was not created by this SpriteFont");
+    }
+
+    for (auto line = layout.lines.cbegin(); line != layout.lines.cend(); ++line)
+    {
+        for (size_t j = line->firstGlyph; j < line->firstGlyph + line->glyphCount; j++)
+        {
+            auto const& entry = layout.glyphs[j];
+
+            XMVECTOR offset = origin - XMVectorSet(line->x + entry.x, line->y + entry.glyph->YOffset, 0, 0);
+
+            spriteBatch->Draw(pImpl->texture.Get(), position, &entry.glyph->Subrect, color, rotation, offset, scale, SpriteEffects_None, layerDepth);
+        }
+    }
+}
@@ -35,13 +35,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <float.h>
+#include <math.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
 #include "WAVFileReader.h"
 
 //////////////////////////////////////////////////////////////////////////////
@@ -267,6 +276,10 @@ namespace
         return bitCount;
     }
 
+    // Microsoft ADPCM standard encoding coefficients
+    const short g_pAdpcmCoefficients1[] = { 256,  512, 0, 192, 240,  460,  392 };
+    const short g_pAdpcmCoefficients2[] = { 0, -256, 0,  64,   0, -208, -232 };
+
     WORD AdpcmBlockSizeFromPcmFrames(WORD nPcmFrames, WORD nChannels)
     {
         // The full calculation is as follows:
@@ -412,7 +425,7 @@ namespace
             return true;
 
         case WAVE_FORMAT_IEEE_FLOAT:
-            wprintf(L"ERROR: Wave banks do not support IEEE float PCM data\n");
+            wprintf(L"ERROR: Wave banks do not support IEEE float PCM data (use -adpcm to encode it)\n");
             return false;
 
         case WAVE_FORMAT_ADPCM:
@@ -446,10 +459,6 @@ namespace
                 bool valid = true;
                 for (int j = 0; j < 7 /*MSADPCM_NUM_COEFFICIENTS*/; ++j)
                 {
-                    // Microsoft ADPCM standard encoding coefficients
-                    static const short g_pAdpcmCoefficients1[] = { 256,  512, 0, 192, 240,  460,  392 };
-                    static const short g_pAdpcmCoefficients2[] = { 0, -256, 0,  64,   0, -208, -232 };
-
                     if (wfadpcm->aCoef[j].iCoef1 != g_pAdpcmCoefficients1[j]
                         || wfadpcm->aCoef[j].iCoef2 != g_pAdpcmCoefficients2[j])
                     {
@@ -693,7 +702,7 @@ namespace
                     break;
 
                 case WAVE_FORMAT_IEEE_FLOAT:
-                    wprintf(L"ERROR: Wave banks do not support float PCM data\n");
+                    wprintf(L"ERROR: Wave banks do not support float PCM data (use -adpcm to encode it)\n");
                     return false;
 
                 case WAVE_FORMAT_ADPCM:
@@ -770,6 +779,581 @@ namespace
             return false;
         }
     }
+
+    //----------------------------------------------------------------------------------
+    // MS-ADPCM encoding
+    //----------------------------------------------------------------------------------
+
+    // Smallest and largest samples per block whose block size fits the 8-bit MINIWAVEFORMAT wBlockAlign
+    const WORD ADPCM_MIN_SAMPLES_PER_BLOCK = 32;
+    const WORD ADPCM_MAX_SAMPLES_PER_BLOCK = 542;
+    const WORD ADPCM_DEFAULT_SAMPLES_PER_BLOCK = 512;
+
+    const int g_AdpcmAdaptationTable[16] = { 230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230 };
+
+    // Returns the format tag of 8-bit, 16-bit, or 32-bit float PCM data which can be converted, or 0 otherwise
+    WORD GetConvertibleFormatTag(const WAVEFORMATEX* wfx)
+    {
+        WORD tag = wfx->wFormatTag;
+        if (tag == WAVE_FORMAT_EXTENSIBLE)
+        {
+            if (wfx->cbSize < (sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX)))
+                return 0;
+
+            tag = WORD(reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(wfx)->SubFormat.Data1);
+        }
+
+        if (!wfx->nChannels || wfx->nChannels > 8)
+            return 0;
+
+        switch (tag)
+        {
+        case WAVE_FORMAT_PCM:
+            return (wfx->wBitsPerSample == 8 || wfx->wBitsPerSample == 16) ? tag : 0;
+
+        case WAVE_FORMAT_IEEE_FLOAT:
+            return (wfx->wBitsPerSample == 32) ? tag : 0;
+
+        default:
+            return 0;
+        }
+    }
+
+    // Converts interleaved PCM data to 16-bit, with float data clamped to -1..1
+    void ConvertToPcm16(WORD tag, WORD bitsPerSample, const uint8_t* src, size_t count, int16_t* dest)
+    {
+        if (tag == WAVE_FORMAT_IEEE_FLOAT)
+        {
+            using namespace DirectX;
+            using namespace DirectX::PackedVector;
+
+            auto fsrc = reinterpret_cast<const float*>(src);
+
+            size_t j = 0;
+            for (; j + 4 <= count; j += 4)
+            {
+                XMVECTOR v = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(fsrc + j));
+                XMStoreShortN4(reinterpret_cast<XMSHORTN4*>(dest + j), v);
+            }
+
+            for (; j < count; ++j)
+            {
+                float v = std::max(-1.f, std::min(1.f, fsrc[j]));
+                dest[j] = int16_t(v * 32767.f + ((v < 0.f) ? -0.5f : 0.5f));
+            }
+        }
+        else if (bitsPerSample == 8)
+        {
+            for (size_t j = 0; j < count; ++j)
+            {
+                dest[j] = int16_t((int(src[j]) - 128) * 256);
+            }
+        }
+        else
+        {
+            memcpy(dest, src, count * sizeof(int16_t));
+        }
+    }
+
+    // Encodes one channel of a block with the given predictor and initial delta, writing a 4-bit code for every
+    // frame after the first two. Returns the total squared error of the samples as they will be decoded.
+    uint64_t EncodeAdpcmChannel(const int16_t* samples, size_t stride, size_t frames, int predictor, int delta, uint8_t* codes)
+    {
+        const int coef1 = g_pAdpcmCoefficients1[predictor];
+        const int coef2 = g_pAdpcmCoefficients2[predictor];
+
+        int samp2 = samples[0];
+        int samp1 = samples[stride];
+
+        uint64_t error = 0;
+        for (size_t j = 2; j < frames; ++j)
+        {
+            int sample = samples[j * stride];
+            // Division rather than a shift, so negative predictions round toward zero as they do when decoded
+            int prediction = (samp1 * coef1 + samp2 * coef2) / 256;
+
+            int diff = sample - prediction;
+            int bias = (diff >= 0) ? (delta / 2) : -(delta / 2);
+            int code = std::max(-8, std::min(7, (diff + bias) / delta));
+
+            int decoded = std::max(-32768, std::min(32767, prediction + code * delta));
+
+            int64_t e = sample - decoded;
+            error += uint64_t(e * e);
+
+            codes[j - 2] = uint8_t(code & 0xF);
+
+            delta = std::max(16, (g_AdpcmAdaptationTable[code & 0xF] * delta) / 256);
+            samp2 = samp1;
+            samp1 = decoded;
+        }
+
+        return error;
+    }
+
+    // Average prediction error over the start of a block, from which the initial delta is chosen
+    int EstimateAdpcmDelta(const int16_t* samples, size_t stride, size_t frames, int predictor)
+    {
+        const int coef1 = g_pAdpcmCoefficients1[predictor];
+        const int coef2 = g_pAdpcmCoefficients2[predictor];
+
+        size_t count = std::min<size_t>(frames, 6);
+
+        int total = 0;
+        for (size_t j = 2; j < count; ++j)
+        {
+            int prediction = (samples[(j - 1) * stride] * coef1 + samples[(j - 2) * stride] * coef2) / 256;
+            total += abs(samples[j * stride] - prediction);
+        }
+
+        int delta = (count > 2) ? int(total / (2 * (count - 2))) : 0;
+        return std::max(16, std::min(32767, delta));
+    }
+
+    // Picks the predictor which best fits a block, from the sum of its absolute prediction errors
+    int EstimateAdpcmPredictor(const int16_t* samples, size_t stride, size_t frames)
+    {
+        using namespace DirectX;
+
+        float x[ADPCM_MAX_SAMPLES_PER_BLOCK];
+        assert(frames <= ADPCM_MAX_SAMPLES_PER_BLOCK);
+
+        for (size_t j = 0; j < frames; ++j)
+        {
+            x[j] = float(samples[j * stride]);
+        }
+
+        XMVECTOR coef1[7];
+        XMVECTOR coef2[7];
+        XMVECTOR total[7];
+        for (int k = 0; k < 7; ++k)
+        {
+            coef1[k] = XMVectorReplicate(float(g_pAdpcmCoefficients1[k]) / 256.f);
+            coef2[k] = XMVectorReplicate(float(g_pAdpcmCoefficients2[k]) / 256.f);
+            total[k] = XMVectorZero();
+        }
+
+        // Four frames at a time against every predictor
+        size_t j = 2;
+        for (; j + 4 <= frames; j += 4)
+        {
+            XMVECTOR x0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + j));
+            XMVECTOR x1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + j - 1));
+            XMVECTOR x2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + j - 2));
+
+            for (int k = 0; k < 7; ++k)
+            {
+                XMVECTOR prediction = XMVectorMultiplyAdd(x1, coef1[k], XMVectorMultiply(x2, coef2[k]));
+                total[k] = XMVectorAdd(total[k], XMVectorAbs(XMVectorSubtract(x0, prediction)));
+            }
+        }
+
+        int best = 0;
+        float bestError = FLT_MAX;
+        for (int k = 0; k < 7; ++k)
+        {
+            float error = XMVectorGetX(XMVector4Dot(total[k], g_XMOne));
+
+            for (size_t i = j; i < frames; ++i)
+            {
+                error += fabsf(x[i] - (x[i - 1] * XMVectorGetX(coef1[k]) + x[i - 2] * XMVectorGetX(coef2[k])));
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                best = k;
+            }
+        }
+
+        return best;
+    }
+
+    // Encodes a block of interleaved 16-bit samples. The fast mode encodes with the predictor estimated to fit best,
+    // while otherwise every predictor is tried with a few initial deltas and the one with the least error is kept.
+    void EncodeAdpcmBlock(const int16_t* samples, WORD channels, WORD samplesPerBlock, bool fast, uint8_t* block)
+    {
+        assert(channels == 1 || channels == 2);
+        assert(samplesPerBlock >= ADPCM_MIN_SAMPLES_PER_BLOCK && samplesPerBlock <= ADPCM_MAX_SAMPLES_PER_BLOCK);
+
+        uint8_t codes[2][ADPCM_MAX_SAMPLES_PER_BLOCK];
+        uint8_t trial[ADPCM_MAX_SAMPLES_PER_BLOCK];
+        int predictors[2] = {};
+        int deltas[2] = {};
+
+        for (WORD ch = 0; ch < channels; ++ch)
+        {
+            const int16_t* channelSamples = samples + ch;
+
+            if (fast)
+            {
+                int predictor = EstimateAdpcmPredictor(channelSamples, channels, samplesPerBlock);
+                int delta = EstimateAdpcmDelta(channelSamples, channels, samplesPerBlock, predictor);
+
+                (void)EncodeAdpcmChannel(channelSamples, channels, samplesPerBlock, predictor, delta, codes[ch]);
+                predictors[ch] = predictor;
+                deltas[ch] = delta;
+            }
+            else
+            {
+                uint64_t bestError = UINT64_MAX;
+                for (int predictor = 0; predictor < 7; ++predictor)
+                {
+                    int estimate = EstimateAdpcmDelta(channelSamples, channels, samplesPerBlock, predictor);
+
+                    const int candidates[] = { estimate / 2, estimate, estimate * 2 };
+                    for (size_t j = 0; j < _countof(candidates); ++j)
+                    {
+                        int delta = std::max(16, std::min(32767, candidates[j]));
+
+                        uint64_t error = EncodeAdpcmChannel(channelSamples, channels, samplesPerBlock, predictor, delta, trial);
+                        if (error < bestError)
+                        {
+                            bestError = error;
+                            predictors[ch] = predictor;
+                            deltas[ch] = delta;
+                            memcpy(codes[ch], trial, samplesPerBlock - 2);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Block header: predictors, then initial deltas, then the second and first samples of each channel
+        uint8_t* ptr = block;
+        for (WORD ch = 0; ch < channels; ++ch)
+        {
+            *ptr++ = uint8_t(predictors[ch]);
+        }
+
+        // The header words are unaligned for mono blocks
+        int16_t header[6];
+        for (WORD ch = 0; ch < channels; ++ch)
+        {
+            header[ch] = int16_t(deltas[ch]);
+            header[channels + ch] = samples[channels + ch];
+            header[2 * channels + ch] = samples[ch];
+        }
+
+        memcpy(ptr, header, 3 * channels * sizeof(int16_t));
+        ptr += 3 * channels * sizeof(int16_t);
+
+        // Codes for the remaining frames in order, with channels interleaved, high nibble first
+        size_t count = size_t(samplesPerBlock - 2) * channels;
+        for (size_t j = 0; j < count; j += 2)
+        {
+            uint8_t high = codes[j % channels][j / channels];
+            uint8_t low = codes[(j + 1) % channels][(j + 1) / channels];
+            *ptr++ = uint8_t((high << 4) | low);
+        }
+
+        assert(size_t(ptr - block) == AdpcmBlockSizeFromPcmFrames(samplesPerBlock, channels));
+    }
+
+    //----------------------------------------------------------------------------------
+    // Sample rate and channel conversion
+    //----------------------------------------------------------------------------------
+
+    // Converts interleaved PCM data to float
+    void ConvertToFloat(WORD tag, WORD bitsPerSample, const uint8_t* src, size_t count, float* dest)
+    {
+        if (tag == WAVE_FORMAT_IEEE_FLOAT)
+        {
+            memcpy(dest, src, count * sizeof(float));
+        }
+        else if (bitsPerSample == 8)
+        {
+            for (size_t j = 0; j < count; ++j)
+            {
+                dest[j] = float(int(src[j]) - 128) / 128.f;
+            }
+        }
+        else
+        {
+            using namespace DirectX;
+            using namespace DirectX::PackedVector;
+
+            auto ssrc = reinterpret_cast<const int16_t*>(src);
+
+            size_t j = 0;
+            for (; j + 4 <= count; j += 4)
+            {
+                XMVECTOR v = XMLoadShortN4(reinterpret_cast<const XMSHORTN4*>(ssrc + j));
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(dest + j), v);
+            }
+
+            for (; j < count; ++j)
+            {
+                dest[j] = std::max(-1.f, float(ssrc[j]) / 32767.f);
+            }
+        }
+    }
+
+    // Gains from each input channel to a mono or stereo output, as a row per output channel. Multichannel input
+    // is mixed by speaker position, from the channel mask if there is one or else the default layout.
+    void ComputeDownMix(const WAVEFORMATEX* wfx, WORD outChannels, _Out_writes_(2 * 8) float* matrix)
+    {
+        assert(outChannels == 1 || outChannels == 2);
+        assert(wfx->nChannels <= 8);
+
+        const WORD inChannels = wfx->nChannels;
+        memset(matrix, 0, sizeof(float) * 2 * 8);
+
+        if (inChannels == outChannels)
+        {
+            for (WORD j = 0; j < inChannels; ++j)
+                matrix[j * inChannels + j] = 1.f;
+            return;
+        }
+
+        if (inChannels == 1)
+        {
+            for (WORD j = 0; j < outChannels; ++j)
+                matrix[j] = 1.f;
+            return;
+        }
+
+        DWORD channelMask = 0;
+        if (wfx->wFormatTag == WAVE_FORMAT_EXTENSIBLE)
+        {
+            channelMask = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(wfx)->dwChannelMask;
+        }
+
+        if (!channelMask || ChannelsSpecifiedInMask(channelMask) != inChannels)
+        {
+            static const DWORD s_defaultMasks[9] =
+            {
+                0,
+                SPEAKER_FRONT_CENTER,
+                SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT,
+                SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT | SPEAKER_FRONT_CENTER,
+                SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT | SPEAKER_BACK_LEFT | SPEAKER_BACK_RIGHT,
+                SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT | SPEAKER_FRONT_CENTER | SPEAKER_BACK_LEFT | SPEAKER_BACK_RIGHT,
+                SPEAKER_5POINT1,
+                SPEAKER_5POINT1 | SPEAKER_BACK_CENTER,
+                SPEAKER_7POINT1_SURROUND,
+            };
+
+            channelMask = s_defaultMasks[inChannels];
+        }
+
+        // Left and right gains for each speaker position that has a channel, in channel order
+        float left[8] = {};
+        float right[8] = {};
+        WORD channel = 0;
+        for (DWORD speaker = 1; speaker && channel < inChannels; speaker <<= 1)
+        {
+            if (!(channelMask & speaker))
+                continue;
+
+            switch (speaker)
+            {
+            case SPEAKER_FRONT_LEFT:            left[channel] = 1.f; break;
+            case SPEAKER_FRONT_RIGHT:           right[channel] = 1.f; break;
+            case SPEAKER_FRONT_CENTER:
+            case SPEAKER_BACK_CENTER:           left[channel] = right[channel] = 0.7071068f; break;
+            case SPEAKER_FRONT_LEFT_OF_CENTER:  left[channel] = 0.9238795f; right[channel] = 0.3826834f; break;
+            case SPEAKER_FRONT_RIGHT_OF_CENTER: left[channel] = 0.3826834f; right[channel] = 0.9238795f; break;
+            case SPEAKER_BACK_LEFT:
+            case SPEAKER_SIDE_LEFT:             left[channel] = 0.7071068f; break;
+            case SPEAKER_BACK_RIGHT:
+            case SPEAKER_SIDE_RIGHT:            right[channel] = 0.7071068f; break;
+            default:                            break; // LFE and height channels are dropped
+            }
+
+            ++channel;
+        }
+
+        // Scaled so a signal on every channel at once can't clip
+        float leftTotal = 0.f;
+        float rightTotal = 0.f;
+        for (WORD j = 0; j < inChannels; ++j)
+        {
+            leftTotal += left[j];
+            rightTotal += right[j];
+        }
+
+        float scale = std::max(leftTotal, rightTotal);
+        scale = (scale > 1.f) ? (1.f / scale) : 1.f;
+
+        for (WORD j = 0; j < inChannels; ++j)
+        {
+            if (outChannels == 1)
+            {
+                matrix[j] = 0.5f * (left[j] + right[j]) * scale;
+            }
+            else
+            {
+                matrix[j] = left[j] * scale;
+                matrix[inChannels + j] = right[j] * scale;
+            }
+        }
+    }
+
+    // Polyphase windowed-sinc resampler for rates in any integer ratio. The input is upsampled by mUp, filtered
+    // below the lower of the two Nyquist frequencies, and decimated by mDown, using only the filter phase needed
+    // for each output sample. Output only depends on the input, so conversions are repeatable.
+    class Resampler
+    {
+    public:
+        static const size_t TAPS = 64;      // Per phase; a multiple of 4
+        static const size_t PADDING = TAPS; // Silence needed before and after the input
+
+        Resampler(DWORD srcRate, DWORD destRate)
+        {
+            assert(srcRate > 0 && destRate > 0);
+
+            DWORD a = srcRate;
+            DWORD b = destRate;
+            while (b)
+            {
+                DWORD t = a % b;
+                a = b;
+                b = t;
+            }
+
+            mUp = destRate / a;
+            mDown = srcRate / a;
+
+            mCenter = TAPS * mUp / 2;
+
+            // Each phase is stored reversed, so it lines up with the input window it is applied to, and scaled to
+            // unity gain at DC
+            mCoefficients.resize(TAPS * mUp);
+            for (size_t phase = 0; phase < mUp; ++phase)
+            {
+                double prototype[TAPS];
+                double total = 0.0;
+                for (size_t k = 0; k < TAPS; ++k)
+                {
+                    prototype[k] = Prototype(phase + k * mUp);
+                    total += prototype[k];
+                }
+
+                float* coefficients = &mCoefficients[phase * TAPS];
+                for (size_t k = 0; k < TAPS; ++k)
+                {
+                    coefficients[TAPS - 1 - k] = float(prototype[k] / total);
+                }
+            }
+        }
+
+        Resampler(Resampler const&) = delete;
+        Resampler& operator= (Resampler const&) = delete;
+
+        uint64_t ConvertPosition(uint64_t frames) const
+        {
+            return (frames * mUp + mDown / 2) / mDown;
+        }
+
+        size_t GetOutputFrames(size_t inFrames) const
+        {
+            return size_t((uint64_t(inFrames) * mUp + mDown - 1) / mDown);
+        }
+
+        // Resamples one channel. The input must have PADDING samples of silence either side of it.
+        void Process(const float* input, size_t outFrames, float* output, size_t outStride) const
+        {
+            using namespace DirectX;
+
+            for (size_t n = 0; n < outFrames; ++n)
+            {
+                uint64_t position = uint64_t(n) * mDown + mCenter;
+                size_t last = size_t(position / mUp);
+                size_t phase = size_t(position % mUp);
+
+                const float* x = input + last - (TAPS - 1);
+                const float* h = &mCoefficients[phase * TAPS];
+
+                XMVECTOR total = XMVectorZero();
+                for (size_t k = 0; k < TAPS; k += 4)
+                {
+                    total = XMVectorMultiplyAdd(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + k)),
+                                                XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(h + k)), total);
+                }
+
+                output[n * outStride] = XMVectorGetX(XMVector4Dot(total, g_XMOne));
+            }
+        }
+
+    private:
+        // Kaiser-windowed sinc at the upsampled rate, with its cutoff a little below the lower Nyquist frequency to
+        // leave room for the transition band
+        double Prototype(size_t m) const
+        {
+            const double pi = 3.14159265358979323846;
+            const double beta = 8.6;
+            const double cutoff = 0.5 * 0.92 / double(std::max(mUp, mDown));
+
+            double t = double(m) - double(mCenter);
+            double sinc = (t == 0.0) ? (2.0 * cutoff) : (sin(2.0 * pi * cutoff * t) / (pi * t));
+
+            double r = t / double(mCenter);
+            double window = (fabs(r) < 1.0) ? (BesselI0(beta * sqrt(1.0 - r * r)) / BesselI0(beta)) : 0.0;
+
+            return sinc * window;
+        }
+
+        static double BesselI0(double x)
+        {
+            double sum = 1.0;
+            double term = 1.0;
+            for (int k = 1; k < 64; ++k)
+            {
+                double f = x / (2.0 * k);
+                term *= f * f;
+                sum += term;
+                if (term < sum * 1e-12)
+                    break;
+            }
+            return sum;
+        }
+
+        size_t              mUp;
+        size_t              mDown;
+        size_t              mCenter;
+        std::vector<float>  mCoefficients;
+    };
+
+    // Resamplers for each pair of rates seen so far. Building the filter is the expensive part, and a Resampler does
+    // not change once built, so one is shared by every file and loader thread converting between the same rates.
+    class ResamplerCache
+    {
+    public:
+        ResamplerCache() {}
+
+        ResamplerCache(ResamplerCache const&) = delete;
+        ResamplerCache& operator= (ResamplerCache const&) = delete;
+
+        const Resampler& Get(DWORD srcRate, DWORD destRate)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            for (auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
+            {
+                if (it->srcRate == srcRate && it->destRate == destRate)
+                    return *it->resampler;
+            }
+
+            mEntries.emplace_back();
+            auto& entry = mEntries.back();
+            entry.srcRate = srcRate;
+            entry.destRate = destRate;
+            entry.resampler.reset(new Resampler(srcRate, destRate));
+            return *entry.resampler;
+        }
+
+    private:
+        struct Entry
+        {
+            DWORD                       srcRate;
+            DWORD                       destRate;
+            std::unique_ptr<Resampler>  resampler;
+        };
+
+        std::mutex          mMutex;
+        std::list<Entry>    mEntries;
+    };
 }
 
 
@@ -789,6 +1373,11 @@ enum OPTIONS
     OPT_FRIENDLY_NAMES,
     OPT_NOLOGO,
     OPT_FILELIST,
+    OPT_ADPCM,
+    OPT_ADPCM_FAST,
+    OPT_SAMPLES_PER_BLOCK,
+    OPT_SAMPLE_RATE,
+    OPT_CHANNELS,
     OPT_MAX
 };
 
@@ -799,6 +1388,15 @@ struct SConversion
     wchar_t szSrc[MAX_PATH];
 };
 
+struct SEncodeOptions
+{
+    bool adpcm;                 // Encode PCM and float input as MS-ADPCM
+    bool fast;                  // Estimate each ADPCM block's predictor rather than trying them all
+    WORD samplesPerBlock;
+    WORD channels;              // Mix PCM and float input to this many channels, if non-zero
+    DWORD sampleRate;           // Resample PCM and float input to this rate, if non-zero
+};
+
 struct SValue
 {
     LPCWSTR pName;
@@ -810,9 +1408,17 @@ struct WaveFile
     DirectX::WAVData data;
     size_t conv;
     MINIWAVEFORMAT miniFmt;
-    std::unique_ptr<uint8_t[]> waveData;
+    uint64_t audioOffset;                   // Where data.audioBytes of audio data start in the source file
+    std::unique_ptr<uint8_t[]> waveData;    // Holds data.wfx and data.seek; the audio data is read again when writing
+    std::unique_ptr<uint8_t[]> audioData;   // Audio data converted by the tool, which is written instead of the source's
+    WAVEFORMATEX sourceFormat;              // Format of the source if the audio data was converted, otherwise zeroed
 
-    WaveFile() : conv(0) { memset(&data, 0, sizeof(data)); }
+    WaveFile() : conv(0), audioOffset(0)
+    {
+        memset(&data, 0, sizeof(data));
+        memset(&miniFmt, 0, sizeof(miniFmt));
+        memset(&sourceFormat, 0, sizeof(sourceFormat));
+    }
 
     // VS 2013 does not perform impliclit creation of move construtors nor does it support =default,
     // so we explictly add one here
@@ -820,8 +1426,23 @@ struct WaveFile
         data(std::move(moveFrom.data)),
         conv(std::move(moveFrom.conv)),
         miniFmt(std::move(moveFrom.miniFmt)),
-        waveData(std::move(moveFrom.waveData))
+        audioOffset(std::move(moveFrom.audioOffset)),
+        waveData(std::move(moveFrom.waveData)),
+        audioData(std::move(moveFrom.audioData)),
+        sourceFormat(std::move(moveFrom.sourceFormat))
+    {
+    }
+
+    WaveFile& operator= (WaveFile&& moveFrom)
     {
+        data = moveFrom.data;
+        conv = moveFrom.conv;
+        miniFmt = moveFrom.miniFmt;
+        audioOffset = moveFrom.audioOffset;
+        waveData = std::move(moveFrom.waveData);
+        audioData = std::move(moveFrom.audioData);
+        sourceFormat = moveFrom.sourceFormat;
+        return *this;
     }
 };
 
@@ -856,6 +1477,11 @@ const SValue g_pOptions [] =
     { L"f",         OPT_FRIENDLY_NAMES },
     { L"nologo",    OPT_NOLOGO },
     { L"flist",     OPT_FILELIST },
+    { L"adpcm",     OPT_ADPCM },
+    { L"adpcmfast", OPT_ADPCM_FAST },
+    { L"spb",       OPT_SAMPLES_PER_BLOCK },
+    { L"sr",        OPT_SAMPLE_RATE },
+    { L"ch",        OPT_CHANNELS },
     { nullptr,      0 }
 };
 
@@ -994,6 +1620,12 @@ namespace
         wprintf(L"   -f                  include entry friendly names\n");
         wprintf(L"   -nologo             suppress copyright message\n");
         wprintf(L"   -flist <filename>   use text file with a list of input files (one per line)\n");
+        wprintf(L"   -adpcm              encode 8-bit, 16-bit, and float PCM input as MS-ADPCM\n");
+        wprintf(L"   -adpcmfast          faster, lower quality MS-ADPCM encoding\n");
+        wprintf(L"   -spb <samples>      MS-ADPCM samples per block (even, %u to %u; defaults to %u)\n",
+            ADPCM_MIN_SAMPLES_PER_BLOCK, ADPCM_MAX_SAMPLES_PER_BLOCK, ADPCM_DEFAULT_SAMPLES_PER_BLOCK);
+        wprintf(L"   -sr <rate>          resample PCM and float input to this rate in Hz\n");
+        wprintf(L"   -ch <1|2>           mix PCM and float input to mono or stereo\n");
     }
 
     const char* GetFormatTagName(WORD wFormatTag)
@@ -1036,6 +1668,11 @@ namespace
     void PrintInfo(const WaveFile& wave)
     {
         wprintf(L" (%hs %u channels, %u-bit, %u Hz)", GetFormatTagName(wave.data.wfx->wFormatTag), wave.data.wfx->nChannels, wave.data.wfx->wBitsPerSample, wave.data.wfx->nSamplesPerSec);
+
+        if (wave.sourceFormat.wFormatTag)
+        {
+            wprintf(L" from (%hs %u channels, %u-bit, %u Hz)", GetFormatTagName(wave.sourceFormat.wFormatTag), wave.sourceFormat.nChannels, wave.sourceFormat.wBitsPerSample, wave.sourceFormat.nSamplesPerSec);
+        }
     }
 
     bool FileExists(const wchar_t* pszFilename)
@@ -1051,6 +1688,416 @@ namespace
 
         return false;
     }
+
+    // Converts PCM or float audio data to 16-bit PCM, mixed and resampled to the requested channels and rate
+    HRESULT ConvertAudio(const DirectX::WAVData& data, WORD tag, const SEncodeOptions& options, ResamplerCache& resamplers, WaveFile& wave)
+    {
+        const WAVEFORMATEX* wfx = data.wfx;
+        const WORD inChannels = wfx->nChannels;
+        const WORD outChannels = options.channels ? options.channels : inChannels;
+        const DWORD outRate = options.sampleRate ? options.sampleRate : wfx->nSamplesPerSec;
+
+        const size_t inFrames = data.audioBytes / wfx->nBlockAlign;
+        size_t outFrames = inFrames;
+
+        uint32_t loopStart = data.loopStart;
+        uint32_t loopLength = data.loopLength;
+
+        std::unique_ptr<uint8_t[]> pcm;
+
+        if (inChannels == outChannels && wfx->nSamplesPerSec == outRate)
+        {
+            pcm.reset(new uint8_t[inFrames * inChannels * sizeof(int16_t)]);
+            ConvertToPcm16(tag, wfx->wBitsPerSample, data.startAudio, inFrames * inChannels, reinterpret_cast<int16_t*>(pcm.get()));
+        }
+        else
+        {
+            const Resampler* resampler = nullptr;
+            if (wfx->nSamplesPerSec != outRate)
+            {
+                resampler = &resamplers.Get(wfx->nSamplesPerSec, outRate);
+                outFrames = resampler->GetOutputFrames(inFrames);
+
+                uint64_t loopEnd = resampler->ConvertPosition(uint64_t(data.loopStart) + data.loopLength);
+                loopStart = uint32_t(resampler->ConvertPosition(data.loopStart));
+                loopLength = uint32_t(loopEnd - loopStart);
+            }
+
+            if (uint64_t(outFrames) * outChannels * sizeof(int16_t) > UINT32_MAX)
+                return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+            std::unique_ptr<float[]> input(new float[inFrames * inChannels]);
+            ConvertToFloat(tag, wfx->wBitsPerSample, data.startAudio, inFrames * inChannels, input.get());
+
+            float matrix[2 * 8];
+            ComputeDownMix(wfx, outChannels, matrix);
+
+            // One output channel at a time, mixed into a buffer with silence either side for the resampler
+            std::unique_ptr<float[]> channel(new float[inFrames + 2 * Resampler::PADDING]);
+            std::unique_ptr<float[]> output(new float[outFrames * outChannels]);
+
+            memset(channel.get(), 0, sizeof(float) * Resampler::PADDING);
+            memset(channel.get() + Resampler::PADDING + inFrames, 0, sizeof(float) * Resampler::PADDING);
+
+            for (WORD ch = 0; ch < outChannels; ++ch)
+            {
+                const float* gains = &matrix[ch * inChannels];
+                float* mixed = channel.get() + Resampler::PADDING;
+
+                for (size_t j = 0; j < inFrames; ++j)
+                {
+                    const float* frame = &input[j * inChannels];
+
+                    float value = 0.f;
+                    for (WORD k = 0; k < inChannels; ++k)
+                    {
+                        value += frame[k] * gains[k];
+                    }
+                    mixed[j] = value;
+                }
+
+                if (resampler)
+                {
+                    resampler->Process(mixed, outFrames, output.get() + ch, outChannels);
+                }
+                else
+                {
+                    for (size_t j = 0; j < outFrames; ++j)
+                    {
+                        output[j * outChannels + ch] = mixed[j];
+                    }
+                }
+            }
+
+            pcm.reset(new uint8_t[outFrames * outChannels * sizeof(int16_t)]);
+            ConvertToPcm16(WAVE_FORMAT_IEEE_FLOAT, 32, reinterpret_cast<const uint8_t*>(output.get()), outFrames * outChannels, reinterpret_cast<int16_t*>(pcm.get()));
+        }
+
+        const size_t fmtBytes = BLOCKALIGNPAD(sizeof(WAVEFORMATEX), sizeof(uint32_t));
+        wave.waveData.reset(new uint8_t[fmtBytes]);
+        memset(wave.waveData.get(), 0, fmtBytes);
+
+        auto pcmFormat = reinterpret_cast<WAVEFORMATEX*>(wave.waveData.get());
+        pcmFormat->wFormatTag = WAVE_FORMAT_PCM;
+        pcmFormat->nChannels = outChannels;
+        pcmFormat->nSamplesPerSec = outRate;
+        pcmFormat->nBlockAlign = WORD(outChannels * sizeof(int16_t));
+        pcmFormat->nAvgBytesPerSec = outRate * pcmFormat->nBlockAlign;
+        pcmFormat->wBitsPerSample = 16;
+
+        wave.audioData = std::move(pcm);
+
+        wave.data = data;
+        wave.data.wfx = pcmFormat;
+        wave.data.startAudio = nullptr;
+        wave.data.audioBytes = uint32_t(outFrames * pcmFormat->nBlockAlign);
+        wave.data.loopStart = loopStart;
+        wave.data.loopLength = loopLength;
+        wave.data.seek = nullptr;
+        wave.data.seekCount = 0;
+        wave.audioOffset = 0;
+
+        memcpy(&wave.sourceFormat, wfx, 16 /*sizeof(PCMWAVEFORMAT)*/);
+        wave.sourceFormat.wFormatTag = tag;
+
+        return S_OK;
+    }
+
+    // Encodes 16-bit PCM audio data from ConvertAudio as MS-ADPCM. The last block is padded with silence.
+    HRESULT EncodeAdpcm(const SEncodeOptions& options, WaveFile& wave)
+    {
+        const WAVEFORMATEX* wfx = wave.data.wfx;
+        assert(wfx->wFormatTag == WAVE_FORMAT_PCM && wfx->wBitsPerSample == 16);
+
+        const WORD channels = wfx->nChannels;
+        const WORD samplesPerBlock = options.samplesPerBlock;
+        const WORD blockAlign = AdpcmBlockSizeFromPcmFrames(samplesPerBlock, channels);
+
+        size_t frames = wave.data.audioBytes / wfx->nBlockAlign;
+        size_t blocks = (frames + samplesPerBlock - 1) / samplesPerBlock;
+
+        uint64_t audioBytes = uint64_t(blocks) * blockAlign;
+        if (audioBytes > UINT32_MAX)
+            return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+        auto pcm = reinterpret_cast<const int16_t*>(wave.audioData.get());
+
+        std::unique_ptr<uint8_t[]> audioData(new uint8_t[size_t(audioBytes)]);
+        for (size_t j = 0; j < blocks; ++j)
+        {
+            size_t start = j * samplesPerBlock;
+            uint8_t* block = audioData.get() + j * blockAlign;
+
+            if (start + samplesPerBlock <= frames)
+            {
+                EncodeAdpcmBlock(pcm + start * channels, channels, samplesPerBlock, options.fast, block);
+            }
+            else
+            {
+                int16_t last[ADPCM_MAX_SAMPLES_PER_BLOCK * 2] = {};
+                memcpy(last, pcm + start * channels, (frames - start) * channels * sizeof(int16_t));
+                EncodeAdpcmBlock(last, channels, samplesPerBlock, options.fast, block);
+            }
+        }
+
+        const size_t fmtBytes = BLOCKALIGNPAD(sizeof(WAVEFORMATEX) + 32 /*MSADPCM_FORMAT_EXTRA_BYTES*/, sizeof(uint32_t));
+        std::unique_ptr<uint8_t[]> waveData(new uint8_t[fmtBytes]);
+        memset(waveData.get(), 0, fmtBytes);
+
+        auto adpcm = reinterpret_cast<ADPCMWAVEFORMAT*>(waveData.get());
+        adpcm->wfx.wFormatTag = WAVE_FORMAT_ADPCM;
+        adpcm->wfx.nChannels = channels;
+        adpcm->wfx.nSamplesPerSec = wfx->nSamplesPerSec;
+        adpcm->wfx.nAvgBytesPerSec = DWORD(uint64_t(wfx->nSamplesPerSec) * blockAlign / samplesPerBlock);
+        adpcm->wfx.nBlockAlign = blockAlign;
+        adpcm->wfx.wBitsPerSample = 4 /*MSADPCM_BITS_PER_SAMPLE*/;
+        adpcm->wfx.cbSize = 32 /*MSADPCM_FORMAT_EXTRA_BYTES*/;
+        adpcm->wSamplesPerBlock = samplesPerBlock;
+        adpcm->wNumCoef = 7 /*MSADPCM_NUM_COEFFICIENTS*/;
+        for (int j = 0; j < 7 /*MSADPCM_NUM_COEFFICIENTS*/; ++j)
+        {
+            adpcm->aCoef[j].iCoef1 = g_pAdpcmCoefficients1[j];
+            adpcm->aCoef[j].iCoef2 = g_pAdpcmCoefficients2[j];
+        }
+
+        wave.waveData = std::move(waveData);
+        wave.audioData = std::move(audioData);
+        wave.data.wfx = &adpcm->wfx;
+        wave.data.audioBytes = uint32_t(audioBytes);
+
+        return S_OK;
+    }
+
+    // Parses a .wav file, keeping only the format, seek table, and location of the audio data. Only the chunk headers
+    // and the small chunks describing the audio are read, so large metadata and the audio data itself are skipped. PCM
+    // data is converted and encoded here if requested, in which case the converted audio data is kept instead.
+    HRESULT LoadWaveFile(const wchar_t* szFile, const SEncodeOptions& options, ResamplerCache& resamplers, WaveFile& wave)
+    {
+        std::unique_ptr<uint8_t[]> fileData;
+        DirectX::WAVData data;
+        uint64_t audioOffset;
+        HRESULT hr = DirectX::LoadWAVInfoFromFile(szFile, fileData, data, &audioOffset);
+        if (FAILED(hr))
+            return hr;
+
+        WORD tag = GetConvertibleFormatTag(data.wfx);
+        if (tag && (options.adpcm || options.channels || options.sampleRate))
+        {
+            const WAVEFORMATEX* wfx = data.wfx;
+            WORD outChannels = options.channels ? options.channels : wfx->nChannels;
+
+            // 16-bit PCM which is already in the requested format is copied as it is
+            bool unchanged = !options.adpcm
+                && tag == WAVE_FORMAT_PCM && wfx->wBitsPerSample == 16
+                && outChannels == wfx->nChannels
+                && (!options.sampleRate || options.sampleRate == wfx->nSamplesPerSec);
+
+            if (!unchanged)
+            {
+                // Converting needs the audio data as well
+                hr = DirectX::LoadWAVAudioFromFileEx(szFile, fileData, data);
+                if (FAILED(hr))
+                    return hr;
+
+                // MS-ADPCM is only mono or stereo, so anything wider is left as 16-bit PCM (and reported when collected)
+                hr = ConvertAudio(data, tag, options, resamplers, wave);
+                if (SUCCEEDED(hr) && options.adpcm && outChannels <= 2)
+                {
+                    hr = EncodeAdpcm(options, wave);
+                }
+                return hr;
+            }
+        }
+
+        wave.audioOffset = audioOffset;
+
+        // PCM files may only have a PCMWAVEFORMAT, which is extended to a WAVEFORMATEX with no extra bytes
+        size_t fmtBytes = sizeof(WAVEFORMATEX);
+        size_t fmtCopy = 16 /*sizeof(PCMWAVEFORMAT)*/;
+        if (data.wfx->wFormatTag != WAVE_FORMAT_PCM && data.wfx->wFormatTag != WAVE_FORMAT_IEEE_FLOAT)
+        {
+            fmtBytes += data.wfx->cbSize;
+            fmtCopy = fmtBytes;
+        }
+
+        fmtBytes = BLOCKALIGNPAD(fmtBytes, sizeof(uint32_t));
+        size_t seekBytes = sizeof(uint32_t) * data.seekCount;
+
+        wave.waveData.reset(new uint8_t[fmtBytes + seekBytes]);
+        memset(wave.waveData.get(), 0, fmtBytes);
+        memcpy(wave.waveData.get(), data.wfx, fmtCopy);
+        if (seekBytes > 0)
+            memcpy(wave.waveData.get() + fmtBytes, data.seek, seekBytes);
+
+        wave.data = data;
+        wave.data.wfx = reinterpret_cast<const WAVEFORMATEX*>(wave.waveData.get());
+        wave.data.startAudio = nullptr;
+        wave.data.seek = (seekBytes > 0) ? reinterpret_cast<const uint32_t*>(wave.waveData.get() + fmtBytes) : nullptr;
+
+        return S_OK;
+    }
+
+    // Loads (and encodes) the input files on a pool of worker threads. Files are handed out in command-line order and collected
+    // in the same order, so the console output and the layout of the wave bank don't depend on the timing.
+    class WaveLoader
+    {
+    public:
+        WaveLoader(const std::list<SConversion>& conversion, const SEncodeOptions& options, unsigned int threadCount) :
+            mOptions(options),
+            mNext(0),
+            mCancel(false)
+        {
+            for (auto it = conversion.cbegin(); it != conversion.cend(); ++it)
+            {
+                mFiles.push_back(it->szSrc);
+            }
+
+            mWaves.resize(mFiles.size());
+            mResults.resize(mFiles.size(), E_PENDING);
+
+            threadCount = std::max(1u, std::min(threadCount, static_cast<unsigned int>(mFiles.size())));
+            for (unsigned int j = 0; j < threadCount; ++j)
+            {
+                mThreads.emplace_back(&WaveLoader::Worker, this);
+            }
+        }
+
+        WaveLoader(WaveLoader const&) = delete;
+        WaveLoader& operator= (WaveLoader const&) = delete;
+
+        ~WaveLoader()
+        {
+            // Stops handing out files if the build failed part way through
+            mCancel = true;
+
+            for (auto it = mThreads.begin(); it != mThreads.end(); ++it)
+            {
+                it->join();
+            }
+        }
+
+        size_t GetThreadCount() const { return mThreads.size(); }
+
+        // Waits for the given file to finish loading, then takes its result
+        HRESULT Get(size_t index, WaveFile& wave)
+        {
+            assert(index < mFiles.size());
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            mReady.wait(lock, [&]() { return mResults[index] != E_PENDING; });
+
+            wave = std::move(mWaves[index]);
+            return mResults[index];
+        }
+
+    private:
+        void Worker()
+        {
+            while (!mCancel)
+            {
+                size_t index = mNext++;
+                if (index >= mFiles.size())
+                    break;
+
+                // Each worker only touches its own element, so loading needs no lock
+                HRESULT hr;
+                try
+                {
+                    hr = LoadWaveFile(mFiles[index], mOptions, mResamplers, mWaves[index]);
+                }
+                catch (const std::bad_alloc&)
+                {
+                    hr = E_OUTOFMEMORY;
+                }
+                catch (...)
+                {
+                    // Anything else thrown while reading or converting fails just this file, as it would if loaded serially
+                    hr = E_FAIL;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mResults[index] = hr;
+                }
+
+                mReady.notify_all();
+            }
+        }
+
+        SEncodeOptions                  mOptions;
+        ResamplerCache                  mResamplers;
+        std::vector<const wchar_t*>     mFiles;
+        std::vector<WaveFile>           mWaves;
+        std::vector<HRESULT>            mResults;
+        std::atomic<size_t>             mNext;
+        std::atomic<bool>               mCancel;
+        std::mutex                      mMutex;
+        std::condition_variable         mReady;
+        std::vector<std::thread>        mThreads;
+    };
+
+    // Copies a range of a file to the current position in the output file, a buffer at a time
+    bool CopyFileRange(const wchar_t* szFile, uint64_t offset, uint32_t bytes, HANDLE hOutput, uint8_t* buffer, DWORD bufferSize)
+    {
+        ScopedHandle hInput(safe_handle(CreateFileW(szFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)));
+        if (!hInput)
+            return false;
+
+        LARGE_INTEGER pos;
+        pos.QuadPart = LONGLONG(offset);
+        if (!SetFilePointerEx(hInput.get(), pos, nullptr, FILE_BEGIN))
+            return false;
+
+        while (bytes > 0)
+        {
+            DWORD chunk = std::min<DWORD>(bytes, bufferSize);
+
+            DWORD bytesRead = 0;
+            if (!ReadFile(hInput.get(), buffer, chunk, &bytesRead, nullptr))
+                return false;
+
+            if (bytesRead != chunk)
+            {
+                // The file has been truncated since it was loaded
+                SetLastError(ERROR_HANDLE_EOF);
+                return false;
+            }
+
+            DWORD bytesWritten = 0;
+            if (!WriteFile(hOutput, buffer, chunk, &bytesWritten, nullptr))
+                return false;
+
+            bytes -= chunk;
+        }
+
+        return true;
+    }
+
+    // Elapsed wall-clock time, for reporting how long each phase of the build takes
+    class PhaseTimer
+    {
+    public:
+        PhaseTimer()
+        {
+            QueryPerformanceFrequency(&mFrequency);
+            QueryPerformanceCounter(&mStart);
+        }
+
+        // Returns the seconds since construction or the last call
+        double Lap()
+        {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+
+            double seconds = double(now.QuadPart - mStart.QuadPart) / double(mFrequency.QuadPart);
+            mStart = now;
+            return seconds;
+        }
+
+    private:
+        LARGE_INTEGER mFrequency;
+        LARGE_INTEGER mStart;
+    };
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1074,6 +2121,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     DWORD dwOptions = 0;
     std::list<SConversion> conversion;
 
+    SEncodeOptions encodeOptions = {};
+    encodeOptions.samplesPerBlock = ADPCM_DEFAULT_SAMPLES_PER_BLOCK;
+
     for (int iArg = 1; iArg < argc; iArg++)
     {
         PWSTR pArg = argv[iArg];
@@ -1104,6 +2154,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case OPT_OUTPUTFILE:
             case OPT_OUTPUTHEADER:
             case OPT_FILELIST:
+            case OPT_SAMPLES_PER_BLOCK:
+            case OPT_SAMPLE_RATE:
+            case OPT_CHANNELS:
                 if (!*pValue)
                 {
                     if ((iArg + 1 >= argc))
@@ -1144,6 +2197,65 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
                 break;
 
+            case OPT_ADPCM:
+                encodeOptions.adpcm = true;
+                break;
+
+            case OPT_ADPCM_FAST:
+                encodeOptions.adpcm = true;
+                encodeOptions.fast = true;
+                break;
+
+            case OPT_SAMPLES_PER_BLOCK:
+                {
+                    unsigned int samplesPerBlock = 0;
+                    if (swscanf_s(pValue, L"%u", &samplesPerBlock) != 1
+                        || samplesPerBlock < ADPCM_MIN_SAMPLES_PER_BLOCK
+                        || samplesPerBlock > ADPCM_MAX_SAMPLES_PER_BLOCK
+                        || (samplesPerBlock % 2) != 0)
+                    {
+                        wprintf(L"Invalid value specified with -spb (%ls)\n", pValue);
+                        wprintf(L"\n");
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    encodeOptions.samplesPerBlock = WORD(samplesPerBlock);
+                }
+                break;
+
+            case OPT_SAMPLE_RATE:
+                {
+                    unsigned int sampleRate = 0;
+                    if (swscanf_s(pValue, L"%u", &sampleRate) != 1
+                        || sampleRate < 1000 /*XAUDIO2_MIN_SAMPLE_RATE*/
+                        || sampleRate > 200000 /*XAUDIO2_MAX_SAMPLE_RATE*/)
+                    {
+                        wprintf(L"Invalid value specified with -sr (%ls)\n", pValue);
+                        wprintf(L"\n");
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    encodeOptions.sampleRate = sampleRate;
+                }
+                break;
+
+            case OPT_CHANNELS:
+                {
+                    unsigned int channels = 0;
+                    if (swscanf_s(pValue, L"%u", &channels) != 1 || (channels != 1 && channels != 2))
+                    {
+                        wprintf(L"Invalid value specified with -ch (%ls)\n", pValue);
+                        wprintf(L"\n");
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    encodeOptions.channels = WORD(channels);
+                }
+                break;
+
             case OPT_FILELIST:
                 {
                     std::wifstream inFile(pValue);
@@ -1216,6 +2328,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     if (~dwOptions & (1 << OPT_NOLOGO))
         PrintLogo();
 
+    PhaseTimer timer;
+    PhaseTimer totalTimer;
+
     // Gather wave files
     std::unique_ptr<uint8_t[]> entries;
     std::unique_ptr<char[]> entryNames;
@@ -1224,6 +2339,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
     bool xma = false;
 
+    // Files are parsed ahead on worker threads while they are reported here in order
+    std::unique_ptr<WaveLoader> loader(new WaveLoader(conversion, encodeOptions, std::thread::hardware_concurrency()));
+
+    waves.reserve(conversion.size());
+
     size_t index = 0;
     for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv, ++index)
     {
@@ -1249,20 +2369,30 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         fflush(stdout);
 
         WaveFile wave;
-        wave.conv = index;
-        std::unique_ptr<uint8_t[]> waveData;
-
-        HRESULT hr = DirectX::LoadWAVAudioFromFileEx(pConv->szSrc, waveData, wave.data);
+        HRESULT hr = loader->Get(index, wave);
         if (FAILED(hr))
         {
             wprintf(L"\nERROR: Failed to load file (%08X)\n", hr);
             return 1;
         }
 
-        wave.waveData = std::move(waveData);
+        wave.conv = index;
 
         PrintInfo(wave);
 
+        if (encodeOptions.adpcm && wave.data.wfx->wFormatTag == WAVE_FORMAT_PCM && wave.data.wfx->nChannels > 2)
+        {
+            wprintf(L"\nWARNING: %ls has %u channels, but ADPCM is only mono or stereo, so it is stored as PCM",
+                pConv->szSrc, wave.data.wfx->nChannels);
+        }
+
+        if (wave.data.wfx->wFormatTag == WAVE_FORMAT_ADPCM && wave.sourceFormat.wFormatTag
+            && wave.data.loopLength > 0 && (wave.data.loopStart % encodeOptions.samplesPerBlock) != 0)
+        {
+            wprintf(L"\nWARNING: Loop start %u is not a multiple of the %u samples per block, so the loop may not play",
+                wave.data.loopStart, encodeOptions.samplesPerBlock);
+        }
+
         if (wave.data.wfx->wFormatTag == WAVE_FORMAT_XMA2)
             xma = true;
 
@@ -1271,6 +2401,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
     wprintf(L"\n");
 
+    size_t threadCount = loader->GetThreadCount();
+    loader.reset();
+
+    double loadTime = timer.Lap();
+
     DWORD dwAlignment = ALIGNMENT_MIN;
     if (dwOptions & (1 << OPT_STREAMING))
         dwAlignment = ALIGNMENT_DVD;
@@ -1452,6 +2587,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
     assert(count > 0 && count == waves.size());
 
+    double layoutTime = timer.Lap();
+
     // Create wave bank
     assert(*szOutputFile != 0);
 
@@ -1672,7 +2809,13 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset = segmentOffset;
     header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = uint32_t(waveOffset);
 
-    for (auto it = waves.begin(); it != waves.end(); ++it)
+    // Only the audio data of one file at a time is held in memory, however large the bank
+    static const DWORD COPY_BUFFER_SIZE = 1024 * 1024;
+    std::unique_ptr<uint8_t[]> copyBuffer(new uint8_t[COPY_BUFFER_SIZE]);
+
+    // Waves are in the same order as the input files
+    auto cit = conversion.cbegin();
+    for (auto it = waves.begin(); it != waves.end(); ++it, ++cit)
     {
         if (SetFilePointer(hFile.get(), segmentOffset, 0, FILE_BEGIN) == INVALID_SET_FILE_POINTER)
         {
@@ -1680,9 +2823,17 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             return 1;
         }
 
-        if (!WriteFile(hFile.get(), it->data.startAudio, it->data.audioBytes, nullptr, nullptr))
+        if (it->audioData)
         {
-            wprintf(L"ERROR: Failed writing audio data to %ls, %u\n", szOutputFile, GetLastError());
+            if (!WriteFile(hFile.get(), it->audioData.get(), it->data.audioBytes, nullptr, nullptr))
+            {
+                wprintf(L"ERROR: Failed writing audio data to %ls, %u\n", szOutputFile, GetLastError());
+                return 1;
+            }
+        }
+        else if (!CopyFileRange(cit->szSrc, it->audioOffset, it->data.audioBytes, hFile.get(), copyBuffer.get(), COPY_BUFFER_SIZE))
+        {
+            wprintf(L"ERROR: Failed copying audio data from %ls to %ls, %u\n", cit->szSrc, szOutputFile, GetLastError());
             return 1;
         }
 
@@ -1724,6 +2875,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         return 1;
     }
 
+    double writeTime = timer.Lap();
+
     // Write C header if requested
     if (*szHeaderFile)
     {
@@ -1765,5 +2918,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
     }
 
+    wprintf(L"load %.3f s (%Iu threads), layout %.3f s, write %.3f s, total %.3f s\n",
+            loadTime, threadCount, layoutTime, writeTime, totalTimer.Lap());
+
     return 0;
 }